@@ -0,0 +1,445 @@
+#!/bin/sh
+
+######################################################################
+#
+# BENCH.SH - Measure the Timing Accuracy and Throughput of the C-progs
+#
+# USAGE   : BENCH.sh [options] [test ...]
+#           BENCH.sh -T [options] [test ...]
+# Args    : test ....... Tests to run (default: all of them)
+#                          valve-fixed  : valve -l with the input ready
+#                          valve-bursty : valve -l with the input which
+#                                         comes in bursts (80% load)
+#                          tscat        : tscat -e with the lines of
+#                                         the interval
+#                          tscat-dense  : the same with 1/10 interval
+#                          linets       : linets stamping the ticks of
+#                                         "sleep -a -t"
+#                          sleep        : sleep -a -t
+#                          sleep-spin   : sleep -a -t -s 200
+#                        The followings are for -T.
+#                          tp-linets    : linets -3 (to /dev/null)
+#                          tp-valve     : valve 100% (to /dev/null)
+#                          tp-tscat     : tscat -e with the timestamps
+#                                         in the past (to /dev/null)
+# Options : -T ......... Throughput mode. Measure how fast the commands
+#                        process the lines in the no-wait configurations
+#                        instead of the timing accuracy.
+#           -d dir ..... The directory which has the compiled commands
+#                        (default: compile them by MAKE.sh into a work
+#                        directory)
+#           -p n ....... Process priority for valve and tscat (default 1)
+#           -n lines ... The number of lines for each test (default 200)
+#           -i msec .... The interval of the lines (default 10)
+#           -b bytes ... The size of each line (default 64)
+#           [The following options are for -T]
+#           -s MB ...... The size of the input for each test (default 16)
+#           -L sizes ... The sizes of each line to test, separated by
+#                        commas (default: 16,128,1024,8192)
+#           -H ......... Print the header line first
+# Output  : One line for each test which has the following 15 fields.
+#             1:host 2:test 3:priority 4:lines 5:requested_interval
+#             6:achieved_lines/s 7:achieved/requested 8:err_p50
+#             9:err_p90 10:err_p99 11:err_p99.9 12:err_max
+#             13:cpu_sec 14:cpu_usec/line 15:cpu_sec/MB
+#           * All the times are in seconds.
+#           * "err" is the error of the emission time observed by
+#             "linets -e -9" in the following meanings.
+#               valve-* ........ |interval - requested_interval|
+#                                (valve-bursty ignores the intervals
+#                                 longer than 1.5 x requested one
+#                                 since they are waiting for the input)
+#               tscat* ......... |emitted_time - timestamp|
+#               linets, sleep* . stamped/emitted_time - scheduled_time
+#           * cpu_* are the user+system CPU time of the tested command
+#             only, measured by "times" of the shell. So, their
+#             resolution is often only 10ms and a large -n is required
+#             to see them. They are "-" for linets and sleep*.
+#           With -T, one line for each test and line size which has
+#           the following 11 fields.
+#             1:host 2:test 3:line_bytes 4:lines 5:sec 6:lines/s
+#             7:bytes/s 8:cpu_sec 9:syscalls/line 10:syscall_source
+#             11:peak_rss_kb
+#           * syscall_source tells how syscalls/line was counted.
+#               strace ... all syscalls by "strace -c -f"
+#               perf ..... all syscalls by "perf stat"
+#               procio ... only read and write family syscalls by
+#                          /proc/<pid>/io (Linux)
+#           * peak_rss_kb is gotten by GNU time if available, or by
+#             sampling VmHWM in /proc/<pid>/status (Linux).
+#           * "-" means that it can't be measured on the host.
+#           * BENCH-baseline.txt in this directory has the results on
+#             a reference host to see regressions and improvements.
+# Ret     : $?=0 (when all of the tests have run)
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+######################################################################
+
+
+######################################################################
+# Initial Configuration
+######################################################################
+
+# === Initialize shell environment ===================================
+set -u
+umask 0022
+export LC_ALL=C
+type command >/dev/null 2>&1 && type getconf >/dev/null 2>&1 &&
+export PATH="$(command -p getconf PATH)${PATH+:}${PATH-}"
+export POSIXLY_CORRECT=1 # to make Linux comply with POSIX
+export UNIX_STD=2003     # to make HP-UX comply with POSIX
+
+# === Define the functions for printing usage and error message ======
+print_usage_and_exit () {
+  cat <<-USAGE 1>&2
+	Usage   : ${0##*/} [options] [test ...]
+	          ${0##*/} -T [options] [test ...]
+	Args    : test ....... Tests to run (default: all of them)
+	                         valve-fixed  : valve -l with the input ready
+	                         valve-bursty : valve -l with the input which
+	                                        comes in bursts (80% load)
+	                         tscat        : tscat -e with the lines of
+	                                        the interval
+	                         tscat-dense  : the same with 1/10 interval
+	                         linets       : linets stamping the ticks of
+	                                        "sleep -a -t"
+	                         sleep        : sleep -a -t
+	                         sleep-spin   : sleep -a -t -s 200
+	                       The followings are for -T.
+	                         tp-linets    : linets -3 (to /dev/null)
+	                         tp-valve     : valve 100% (to /dev/null)
+	                         tp-tscat     : tscat -e with the timestamps
+	                                        in the past (to /dev/null)
+	Options : -T ......... Throughput mode. Measure how fast the commands
+	                       process the lines in the no-wait configurations
+	                       instead of the timing accuracy.
+	          -d dir ..... The directory which has the compiled commands
+	                       (default: compile them by MAKE.sh into a work
+	                       directory)
+	          -p n ....... Process priority for valve and tscat (default 1)
+	          -n lines ... The number of lines for each test (default 200)
+	          -i msec .... The interval of the lines (default 10)
+	          -b bytes ... The size of each line (default 64)
+	          [The following options are for -T]
+	          -s MB ...... The size of the input for each test (default 16)
+	          -L sizes ... The sizes of each line to test, separated by
+	                       commas (default: 16,128,1024,8192)
+	          -H ......... Print the header line first
+	Version : 2026-10-19 19:52:10 JST
+	USAGE
+  exit 1
+}
+error_exit() {
+  ${2+:} false && echo "${0##*/}: $2" 1>&2
+  exit $1
+}
+
+# === Get my directory path ==========================================
+Homedir=$(d=${0%/*}/; [ "_$d" = "_$0/" ] && d='./'; cd "$d"; pwd)
+
+# === Define the other parameters ====================================
+ALLTESTS='valve-fixed valve-bursty tscat tscat-dense linets sleep sleep-spin'
+HEADER='host test priority lines requested_interval achieved_lines/s'
+HEADER="$HEADER achieved/requested err_p50 err_p90 err_p99 err_p99.9"
+HEADER="$HEADER err_max cpu_sec cpu_usec/line cpu_sec/MB"
+TPTESTS='tp-linets tp-valve tp-tscat'
+TPHEADER='host test line_bytes lines sec lines/s bytes/s cpu_sec'
+TPHEADER="$TPHEADER syscalls/line syscall_source peak_rss_kb"
+
+
+
+######################################################################
+# Parse arguments
+######################################################################
+
+# === Get the options ================================================
+Dir_bin=''
+prio=1
+lines=200
+msec=10
+bytes=64
+optH=0
+optT=0
+mbytes=16
+sizes='16,128,1024,8192'
+while getopts Td:p:n:i:b:s:L:H opt; do
+  case $opt in
+    T) optT=1                                                           ;;
+    d) Dir_bin=$OPTARG                                                  ;;
+    p) printf '%s\n' "$OPTARG" | grep -q '^[0-3]$'  || print_usage_and_exit
+       prio=$OPTARG                                                     ;;
+    n) printf '%s\n' "$OPTARG" | grep -q '^[1-9][0-9]*$' ||
+         print_usage_and_exit
+       lines=$OPTARG                                                    ;;
+    i) printf '%s\n' "$OPTARG" | grep -q '^[1-9][0-9]*$' ||
+         print_usage_and_exit
+       msec=$OPTARG                                                     ;;
+    b) printf '%s\n' "$OPTARG" | grep -q '^[1-9][0-9]*$' ||
+         print_usage_and_exit
+       bytes=$OPTARG                                                    ;;
+    s) printf '%s\n' "$OPTARG" | grep -q '^[1-9][0-9]*$' ||
+         print_usage_and_exit
+       mbytes=$OPTARG                                                   ;;
+    L) printf '%s\n' "$OPTARG" | grep -q '^[1-9][0-9]*\(,[1-9][0-9]*\)*$' ||
+         print_usage_and_exit
+       sizes=$OPTARG                                                    ;;
+    H) optH=1                                                           ;;
+    *) print_usage_and_exit                                             ;;
+  esac
+done
+shift $((OPTIND-1))
+case $optT in 1) ALLTESTS=$TPTESTS; HEADER=$TPHEADER;; esac
+[ $# -gt 0 ] || set -- $ALLTESTS
+for s in "$@"; do
+  case " $ALLTESTS " in *" $s "*) :;; *) print_usage_and_exit;; esac
+done
+
+
+######################################################################
+# Functions
+######################################################################
+
+# === Print the summary of the errors ================================
+# [in] $1..$6 : host test priority lines interval(s) cpu_file
+#      stdin  : "<observed_time> <error>" for each measured line
+#               (observed_time is used for the achieved rate)
+summarize() {
+  cat > "$Tmp/OBSERVED"
+  cpu=$(sed -n 's/^\([0-9]*\)m\([0-9.]*\)s \([0-9]*\)m\([0-9.]*\)s$/\1 \2 \3 \4/p' \
+          "$6" 2>/dev/null                                                      |
+        tail -n 1                                                               |
+        awk '{printf("%.6f",$1*60+$2+$3*60+$4)}'                                )
+  rate=$(awk 'NR==1 {t0=$1;} {t1=$1;}
+              END   {printf("%.3f", (NR>1 && t1>t0) ? (NR-1)/(t1-t0) : 0);}' \
+           "$Tmp/OBSERVED"                                                   )
+  awk '{printf("%.9f\n", ($2<0) ? -$2 : $2);}' "$Tmp/OBSERVED"          |
+  sort -n                                                                |
+  awk -v host="$1" -v test="$2" -v prio="$3" -v lines="$4" -v itv="$5" \
+      -v rate="$rate" -v cpu="${cpu:--}" -v bytes="$bytes"             '
+    {e[NR]=$1;}
+    function pct(q,  i) {i=int(q*NR); if (i<q*NR) {i++;} if (i<1) {i=1;}
+                         return e[i];}
+    END {printf("%s %s %s %d %.6f %.3f %.4f", host, test, prio, lines,
+                itv, rate, rate*itv);
+         if (NR==0) {printf(" - - - - -");}
+         else       {printf(" %.6f %.6f %.6f %.6f %.6f", pct(.5), pct(.9),
+                            pct(.99), pct(.999), e[NR]);}
+         if (cpu=="-") {printf(" - - -\n");}
+         else          {printf(" %s %.3f %.6f\n", cpu, cpu/lines*1e6,
+                               cpu/(lines*bytes/1e6));}
+        }'
+}
+
+# === Get the current time in UNIX time ==============================
+now() {
+  echo | "$LINETS" -e -9 | awk '{print $1}'
+}
+
+# === Measure the throughput of a command ============================
+# [in] $1    : host
+#      $2    : test
+#      $3    : line size
+#      $4    : The number of lines
+#      $5    : The input file
+#      $6... : The command and its arguments (stdout goes to /dev/null)
+throughput() {
+  host=$1 test=$2 size=$3 nl=$4 file=$5
+  shift 5
+  nb=$(wc -c < "$file")
+  # --- the lines and bytes per second, and the CPU time -------------
+  t0=$(now)
+  (exec 2>"$Tmp/CPU"; "$@" "$file" >/dev/null; times 1>&2)
+  t1=$(now)
+  cpu=$(sed -n 's/^\([0-9]*\)m\([0-9.]*\)s \([0-9]*\)m\([0-9.]*\)s$/\1 \2 \3 \4/p' \
+          "$Tmp/CPU"                                                            |
+        tail -n 1                                                               |
+        awk '{printf("%.3f",$1*60+$2+$3*60+$4)}'                                )
+  # --- the syscalls per line ----------------------------------------
+  sc='-' src='-'
+  if   type strace >/dev/null 2>&1; then
+    strace -c -f -o "$Tmp/SC" "$@" "$file" >/dev/null 2>&1 &&
+    sc=$(awk '$NF=="total" {print $(NF-2)}' "$Tmp/SC") && src=strace
+  elif type perf   >/dev/null 2>&1; then
+    perf stat -x, -e raw_syscalls:sys_enter -o "$Tmp/SC" \
+      "$@" "$file" >/dev/null 2>&1 &&
+    sc=$(awk -F, '$3 ~ /sys_enter/ {print $1}' "$Tmp/SC") && src=perf
+  elif [ -r /proc/self/io ]; then
+    # (The counts of the reaped child are added to the shell's ones)
+    sc=$(sh -c 'cat /proc/$$/io > "$1"; shift; "$@" >/dev/null 2>&1;
+                cat /proc/$$/io >> "$0"' "$Tmp/SC" "$Tmp/SC" "$@" "$file" &&
+         awk '/^sysc[rw]:/ {n[$1]++; s+=(n[$1]==1) ? -$2 : $2;}
+              END          {print s;}' "$Tmp/SC"                           ) &&
+    src=procio
+  fi
+  case "$sc" in [0-9]*) :;; *) sc='-'; src='-';; esac
+  # --- the peak RSS -------------------------------------------------
+  rss='-'
+  for s in /usr/bin/time gtime; do
+    type $s >/dev/null 2>&1 || continue
+    $s -f '%M' -o "$Tmp/RSS" "$@" "$file" >/dev/null 2>&1 &&
+    rss=$(tail -n 1 "$Tmp/RSS") && break
+  done
+  case "$rss" in '-') [ -r /proc/self/status ] && {
+    # (The input is kept open for a while after the data has been sent
+    #  so that the command stays alive to be sampled after the work)
+    { cat "$file"; "$SLEEP" 0.2; } | "$@" >/dev/null 2>&1 &
+    pid=$!
+    while s=$(sed -n 's/^VmHWM:[^0-9]*\([0-9]*\).*/\1/p' \
+                /proc/$pid/status 2>/dev/null); [ -n "$s" ]; do
+      rss=$s
+      "$SLEEP" 0.002
+    done
+    wait $pid
+  };; esac
+  case "$rss" in [0-9]*) :;; *) rss='-';; esac
+  # --- print them ---------------------------------------------------
+  awk -v host="$host" -v test="$test" -v size="$size" -v nl="$nl"    \
+      -v nb="$nb" -v t0="$t0" -v t1="$t1" -v cpu="${cpu:--}"         \
+      -v sc="$sc" -v src="$src" -v rss="$rss"                        '
+    BEGIN {t = t1 - t0;
+           printf("%s %s %d %d %.3f %.0f %.0f %s", host, test, size, nl,
+                  t, (t>0)?nl/t:0, (t>0)?nb/t:0, cpu);
+           if (sc=="-") {printf(" - -");                }
+           else         {printf(" %.3f %s", sc/nl, src);}
+           printf(" %s\n", rss);
+          }'
+}
+
+# === Generate the lines (with the line number at the top) ===========
+# [in] $1 : The number of lines
+#      $2 : The first line number (default 1)
+gen_lines() {
+  awk -v n="$1" -v b="$bytes" -v s="${2:-1}" 'BEGIN {
+    for (pad="x"; length(pad)<b-12; pad=pad "x");
+    for (i=s; i<s+n; i++) {printf("%010d %s\n", i, pad);}
+  }'
+}
+
+
+######################################################################
+# Main
+######################################################################
+
+# === Prepare the commands ===========================================
+Tmp="${TMPDIR:-/tmp}/${0##*/}.$$"
+trap 'rm -rf "${Tmp:?}"' EXIT HUP INT TERM
+mkdir -m 700 "$Tmp" || error_exit 1 "$Tmp: Can't make the work directory"
+case "$Dir_bin" in
+  '') mkdir "$Tmp/bin"                              &&
+      sh "$Homedir/MAKE.sh" -d "$Tmp/bin" 2>"$Tmp/MAKE.log" || {
+        cat "$Tmp/MAKE.log" 1>&2
+        error_exit 1 'Failed to compile the commands'
+      }
+      Dir_bin="$Tmp/bin"                                                ;;
+  /*) :                                                                 ;;
+   *) Dir_bin="$(pwd)/$Dir_bin"                                         ;;
+esac
+for s in valve tscat linets sleep; do
+  [ -x "$Dir_bin/$s" ] || error_exit 1 "$Dir_bin/$s: Not found"
+done
+VALVE="$Dir_bin/valve"
+TSCAT="$Dir_bin/tscat"
+LINETS="$Dir_bin/linets"
+SLEEP="$Dir_bin/sleep"
+OBSERVER="$LINETS -e -9"
+host=$(uname -n)
+itv=$(awk -v m="$msec" 'BEGIN{printf("%.6f", m/1000)}')
+
+# === Run the tests (throughput mode) ================================
+case $optT in 1)
+  [ $optH -eq 1 ] && printf '%s\n' "$HEADER"
+  for test in "$@"; do
+    for size in $(printf '%s\n' "$sizes" | tr ',' ' '); do
+      nl=$(( mbytes*1048576/size ))
+      [ $nl -gt 0 ] || nl=1
+      case "$test" in
+        tp-linets)
+          bytes=$size; gen_lines $nl > "$Tmp/INPUT"
+          throughput "$host" "$test" $size $nl "$Tmp/INPUT" "$LINETS" -3
+          ;;
+        tp-valve)
+          bytes=$size; gen_lines $nl > "$Tmp/INPUT"
+          throughput "$host" "$test" $size $nl "$Tmp/INPUT" "$VALVE" 100%
+          ;;
+        tp-tscat)
+          # --- "1 " (1 sec after the epoch) is in the size ----------
+          bytes=$(( size>14 ? size-2 : 12 ))
+          gen_lines $nl | sed 's/^/1 /' > "$Tmp/INPUT"
+          throughput "$host" "$test" $size $nl "$Tmp/INPUT" "$TSCAT" -e
+          ;;
+      esac
+    done
+  done
+  exit 0
+;; esac
+
+# === Run the tests ==================================================
+[ $optH -eq 1 ] && printf '%s\n' "$HEADER"
+for test in "$@"; do
+  rm -f "$Tmp/CPU"
+  case "$test" in
+    valve-fixed)
+      gen_lines $lines                                                  |
+      (exec 2>"$Tmp/CPU"; "$VALVE" -l -p $prio ${msec}ms; times 1>&2)   |
+      $OBSERVER                                                         |
+      awk -v itv="$itv" 'NR>1 {print $1, $1-p-itv} {p=$1}'              |
+      summarize "$host" "$test" $prio $lines "$itv" "$Tmp/CPU"
+      ;;
+    valve-bursty)
+      # --- 8 lines every 10 intervals (80% load) --------------------
+      n=$(( (lines+7)/8 ))
+      "$SLEEP" -t -c $n $(awk -v i="$itv" 'BEGIN{printf("%.6f", i*10)}') |
+      awk -v b="$bytes" 'BEGIN {for (pad="x"; length(pad)<b-12; pad=pad "x");}
+                         {for (i=1; i<=8; i++) {
+                            printf("%010d %s\n", ($1-1)*8+i, pad);
+                          } fflush();}'                                 |
+      (exec 2>"$Tmp/CPU"; "$VALVE" -l -p $prio ${msec}ms; times 1>&2)   |
+      $OBSERVER                                                         |
+      awk -v itv="$itv" 'NR>1 && $1-p<=itv*1.5 {print $1, $1-p-itv}
+                         {p=$1}'                                        |
+      summarize "$host" "$test" $prio $(( n*8 )) "$itv" "$Tmp/CPU"
+      ;;
+    tscat|tscat-dense)
+      case "$test" in
+        tscat) d=$itv                                             ;;
+        *)     d=$(awk -v i="$itv" 'BEGIN{printf("%.6f", i/10)}') ;;
+      esac
+      t0=$(echo | $OBSERVER | awk '{printf("%.9f", $1+0.3)}')
+      gen_lines $lines                                                  |
+      awk -v t0="$t0" -v d="$d" '{printf("%.9f %s\n", t0+($1-1)*d, $0)}' |
+      (exec 2>"$Tmp/CPU"; "$TSCAT" -e -p $prio; times 1>&2)             |
+      $OBSERVER                                                         |
+      awk -v t0="$t0" -v d="$d" '{print $1, $1-(t0+($2-1)*d)}'          |
+      summarize "$host" "$test" $prio $lines "$d" "$Tmp/CPU"
+      ;;
+    linets)
+      "$SLEEP" -a -t -c $lines "$itv"                                   |
+      "$LINETS" -e -9                                                   |
+      awk -v d="$itv" '{n=int($1/d); print $1, $1-n*d}'                 |
+      summarize "$host" "$test" - $lines "$itv" /dev/null
+      ;;
+    sleep|sleep-spin)
+      case "$test" in sleep) s='';; *) s='-s 200';; esac
+      "$SLEEP" -a -t -c $lines $s "$itv"                                |
+      $OBSERVER                                                         |
+      awk -v d="$itv" '{n=int($1/d); print $1, $1-n*d}'                 |
+      summarize "$host" "$test" - $lines "$itv" /dev/null
+      ;;
+  esac
+done
+
+
+######################################################################
+# Finish
+######################################################################
+
+exit 0
@@ -13,6 +13,14 @@
 #                        the base directory of the relative path is
 #                        regarded as the directory which MAKE.sh is in.
 #           -c compiler  Set the compiler command to "compiler"
+#           -m ......... Make one statically linked multi-call executable
+#                        file "misc-tools" and symbolic links to it for
+#                        every command instead of the separate ones.
+#                        It chooses the command by the name it was
+#                        called by (like busybox), and "misc-tools cmd
+#                        args..." also works. Since it needs no dynamic
+#                        linking at startup, the commands start quicker.
+#                        (objcopy in GNU binutils or LLVM is required)
 # Ret     : $?=0 (when all of the options are valid)
 #
 # Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2020-03-19
@@ -53,7 +61,15 @@ print_usage_and_exit () {
 	                       the base directory of the relative path is
 	                       regarded as the directory which MAKE.sh is in.
 	          -c compiler  Set the compiler command to "compiler"
-	Version : 2020-03-19 12:18:14 JST
+	          -m ......... Make one statically linked multi-call executable
+	                       file "misc-tools" and symbolic links to it for
+	                       every command instead of the separate ones.
+	                       It chooses the command by the name it was
+	                       called by (like busybox), and "misc-tools cmd
+	                       args..." also works. Since it needs no dynamic
+	                       linking at startup, the commands start quicker.
+	                       (objcopy in GNU binutils or LLVM is required)
+	Version : 2026-10-19 10:04:37 JST
 	USAGE
   exit 1
 }
@@ -67,6 +83,8 @@ Homedir=$(d=${0%/*}/; [ "_$d" = "_$0/" ] && d='./'; cd "$d"; pwd)
 
 # === Define the other parameters ====================================
 COMPILERS='clang gcc xlc cc c99 tcc'
+OBJCOPIERS='objcopy llvm-objcopy gobjcopy'
+NAME_MULTI='misc-tools'
 ACK=$(printf '\006')
 NAK=$(printf '\025')
 EE=$(printf 's/[]\t -\044\046-\052\073\074\076\077\134\140\173-\176[]/\\\\&/g')
@@ -80,6 +98,7 @@ EE=$(printf 's/[]\t -\044\046-\052\073\074\076\077\134\140\173-\176[]/\\\\&/g')
 # === Get the options ================================================
 # --- initialize option parameters -----------------------------------
 optu=0
+optm=0
 CMD_cc=''
 Dir_bin=''
 #
@@ -89,26 +108,29 @@ while [ $# -gt 0 ]; do
   case $# in 0) break;; esac
   case "$optmode" in
     '') case "$1" in
-          -[cdu]*)      s=$(printf '%s\n' "${1#-}"                           |
-                            awk '{c = "_"; d = "_"; u = "_"; err = 0;        #
+          -[cdmu]*)     s=$(printf '%s\n' "${1#-}"                           |
+                            awk '{c="_"; d="_"; m="_"; u="_"; err=0;         #
                                   for (i=1;i<=length($0);i++) {              #
                                     s = substr($0,i,1);                      #
                                     if      (s == "c") {c  ="c";i++;break;}  #
                                     else if (s == "d") {d  ="d";i++;break;}  #
+                                    else if (s == "m") {m  ="m";          }  #
                                     else if (s == "u") {u  ="u";          }  #
                                     else               {err= 1 ;          }  #
                                   }                                          #
                                   arg=substr($0,i);                          #
-                                  printf("%s%s%s%s %s",c,d,u,err,arg);     }')
+                                  printf("%s%s%s%s%s %s",c,d,m,u,err,arg); }')
                         optarg=${s#* }
                         case "${s%% *}" in *1*) print_usage_and_exit;; esac
                         case "${s%% *}" in *c*) optmode='c'         ;; esac
                         case "${s%% *}" in *d*) optmode='d'         ;; esac
+                        case "${s%% *}" in *m*) optm=1;             ;; esac
                         case "${s%% *}" in *u*) optu=1;             ;; esac
                         case "$optarg" in
                           '') shift; continue;;
                            *) s=$optarg      ;;                        esac ;;
           --upperdir)   optu=1     ; shift; continue                        ;;
+          --multicall)  optm=1     ; shift; continue                        ;;
           --compiler=*) optmode='c'; s=${1#--compiler=}                     ;;
           --bindir=*)   optmode='d'; s=${1#--bindir=}                       ;;
           -*)           print_usage_and_exit                                ;;
@@ -167,6 +189,140 @@ case "$CMD_cc" in
    *) echo "I will use \"$CMD_cc\" as compiler" 1>&2                          ;;
 esac
 
+# === Complie all c-progs into a multi-call executable (-m) ==========
+case $optm in 1)
+  # --- choose the objcopy command -----------------------------------
+  # (to make all global symbols but main() local in each object file,
+  #  because helpers like error_exit() are defined in every source)
+  CMD_objcopy=''
+  for s in $OBJCOPIERS; do
+    type $s >/dev/null 2>&1 && { CMD_objcopy=$s; break; }
+  done
+  case "$CMD_objcopy" in '')
+    error_exit 1 'No objcopy found. It is required for -m,--multicall option'
+  ;; esac
+  # --- make the work directory --------------------------------------
+  Tmp="${TMPDIR:-/tmp}/${0##*/}.$$"
+  trap 'rm -rf "${Tmp:?}"' EXIT HUP INT TERM
+  mkdir -m 700 "$Tmp" || error_exit 1 "$Tmp: Can't make the work directory"
+  cd "$Homedir"       || error_exit 1 "$Homedir: Can't move to the directory"
+  : > "$Tmp/TOOLS"
+  # --- compile all c-progs into object files ------------------------
+  find . -name '[0-9A-Za-z]*.c' |
+  sed 's/^\.\///'               |
+  sort                          |
+  while IFS= read -r File_src; do
+    # --- set filenames and the name of main() -----------------------
+    file_aout=${File_src%.c}
+    Func_main=mc_$(printf '%s\n' "$file_aout" | tr -c '0-9A-Za-z\n' '_')_main
+    File_src_e=$( printf '%s\n' "$File_src"         | sed "$EE")
+    File_aout_e=$(printf '%s\n' "$Tmp/$Func_main.o" | sed "$EE")
+    export CMD_cc File_src_e File_aout_e Func_main NAK
+    # --- generate one liners to compile it into an object file ------
+    #     (the libraries to link are separated by NAK)
+    s=$(cat "$File_src"                                                    |
+        sed -n '1,/^##*\*\/$/p'                                            |
+        sed -n '/^# *How to compile *: */{s/^# *How to compile *: *//;p;}' |
+        awk '{                                                             #
+               line=""; libs="";                                           #
+               for (i=1; i<=NF; i++) {                                     #
+                 if      ($i=="cc" && i==1 ) {s=ENVIRON["CMD_cc"] " -c " \
+                                                "-fno-common -Dmain="     \
+                                                ENVIRON["Func_main"]    ;} #
+                 else if ($i=="__CMDNAME__") {s=ENVIRON["File_aout_e"];}   #
+                 else if ($i=="__SRCNAME__") {s=ENVIRON["File_src_e" ];}   #
+                 else if ($i ~ /^-l/       ) {libs=libs " " $i; continue;} #
+                 else                        {s=$i;                    }   #
+                 line = line " " s;                                        #
+               }                                                           #
+               print substr(line,2) ENVIRON["NAK"] substr(libs,2);         #
+             }'                                                            )
+    # --- Try to compile it ------------------------------------------
+    printf '%s\n' "$s$ACK" |
+    while IFS= read -r line; do
+      if [ "${line%$ACK}" != "$line" ]; then
+        line=${line%$ACK}
+        last=1
+      else
+        last=0
+      fi
+      libs=${line#*$NAK}
+      line=${line%%$NAK*}
+      eval echo $line 1>&2
+      eval $line                                                         &&
+      $CMD_objcopy --keep-global-symbol="$Func_main" "$Tmp/$Func_main.o" && {
+        echo '==> OK' 1>&2
+        printf '%s %s %s\n' "$file_aout" "$Func_main" "$libs" >> "$Tmp/TOOLS"
+        break
+      }
+      case $last in
+        1) echo '==> FAILED!! Give up compiling the source file.' 1>&2;;
+        0) echo '==> Failed! Retry compiling in another way.'     1>&2;;
+      esac
+    done
+  done
+  [ -s "$Tmp/TOOLS" ] || error_exit 1 'No source file was compiled'
+  # --- generate the dispatcher --------------------------------------
+  awk '{print "int " $2 "(int argc, char *argv[]);"}' "$Tmp/TOOLS" \
+    > "$Tmp/$NAME_MULTI.c"
+  cat <<-'DISPATCHER' >> "$Tmp/$NAME_MULTI.c"
+	#include <stdio.h>
+	#include <string.h>
+	struct {const char *pszName; int (*pfMain)(int, char**);} gaTools[] = {
+	DISPATCHER
+  awk '{print "  {\"" $1 "\", " $2 "},"}' "$Tmp/TOOLS" >> "$Tmp/$NAME_MULTI.c"
+  cat <<-'DISPATCHER' >> "$Tmp/$NAME_MULTI.c"
+	  {NULL, NULL}
+	};
+	int main(int argc, char *argv[]) {
+	  const char *pszName, *psz;
+	  int i, iTry;
+	  for (iTry=0; iTry<2 && argc>0; iTry++) {
+	    for (psz=pszName=argv[0]; *psz!='\0'; psz++) {
+	      if (*psz=='/') {pszName=psz+1;}
+	    }
+	    for (i=0; gaTools[i].pszName!=NULL; i++) {
+	      if (strcmp(pszName,gaTools[i].pszName)==0) {
+	        return gaTools[i].pfMain(argc, argv);
+	      }
+	    }
+	    argc--; argv++; /* for "misc-tools cmd args..." */
+	  }
+	  fprintf(stderr, "USAGE   : misc-tools command [args...]\n"
+	                  "Commands:");
+	  for (i=0; gaTools[i].pszName!=NULL; i++) {
+	    fprintf(stderr, " %s", gaTools[i].pszName);
+	  }
+	  fprintf(stderr, "\n");
+	  return 1;
+	}
+	DISPATCHER
+  # --- link them statically (or dynamically if impossible) ----------
+  libs=$(awk '{for(i=3;i<=NF;i++){if(!($i in a)){a[$i]=1;printf(" %s",$i)}}}' \
+           "$Tmp/TOOLS"                                                      )
+  set -- "$Tmp"/mc_*.o
+  File_aout="$Dir_aout/$NAME_MULTI"
+  for s in '-static' ''; do
+    echo "$CMD_cc -O3 $s -o $File_aout $NAME_MULTI.c (objects)$libs" 1>&2
+    $CMD_cc -O3 $s -o "$File_aout" "$Tmp/$NAME_MULTI.c" "$@" $libs && {
+      echo '==> OK' 1>&2
+      break
+    }
+    case "$s" in
+      '') error_exit 1 'FAILED!! Give up making the multi-call executable.';;
+       *) echo '==> Failed! Retry linking dynamically.' 1>&2               ;;
+    esac
+  done
+  # --- make the symbolic links --------------------------------------
+  while read -r file_aout s; do
+    rm -f "${Dir_aout:?}/${file_aout:?}"
+    ln -s "$NAME_MULTI" "$Dir_aout/$file_aout" || {
+      error_exit 1 "$Dir_aout/$file_aout: Can't make the symbolic link"
+    }
+  done < "$Tmp/TOOLS"
+  exit 0
+;; esac
+
 # === Complie all c-progs ============================================
 cd "$Homedir" || error_exit 1 "$Homedir: Can't move to the directory"
 find . -name '[0-9A-Za-z]*.c' |
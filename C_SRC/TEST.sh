@@ -0,0 +1,362 @@
+#!/bin/sh
+
+######################################################################
+#
+# TEST.SH - Check the Native Engines against Their POSIX Versions
+#
+# USAGE   : TEST.sh [options] [test ...]
+# Args    : test ....... Tests to run (default: all of them)
+#                          fsed-args   : how "fsed" takes "-f", "--"
+#                                        and the patterns like "-fPIC"
+#                          fsed-map    : fsed -f with the overlapping
+#                                        patterns
+#                          fsed-worst  : fsed -f with "a" and 2000 "a"s
+#                                        followed by "b" on a 5MB line
+#                                        of "a"s (must be in 10 sec.)
+#                          sigamp      : the formulas on the integers,
+#                                        the decimals, the big numbers
+#                                        and the hexadecimal strings
+#                          gres        : BRE/ERE/fixed strings with the
+#                                        back references and the empty
+#                                        matches
+#                          greo        : the files overwritten by -p
+#                          hirakata    : hira2kata and kata2hira on the
+#                                        fields, with +<n>h and -d
+#                          is_furigana : the return values for every
+#                                        option on the valid and the
+#                                        broken strings
+#                        Each test but fsed-worst compares the outputs
+#                        (and the return values) of the command with
+#                        and without the native engine.
+# Options : -d dir ..... The directory which has the compiled commands
+#                        (default: compile them by MAKE.sh into a work
+#                        directory)
+# Output  : "PASS <test>" or "FAIL <test>: <reason>" for each test
+# Ret     : $?=0 only when all of the tests have passed
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+######################################################################
+
+
+######################################################################
+# Initial Configuration
+######################################################################
+
+# === Initialize shell environment ===================================
+set -u
+umask 0022
+export LC_ALL=C
+type command >/dev/null 2>&1 && type getconf >/dev/null 2>&1 &&
+export PATH="$(command -p getconf PATH)${PATH+:}${PATH-}"
+export POSIXLY_CORRECT=1 # to make Linux comply with POSIX
+export UNIX_STD=2003     # to make HP-UX comply with POSIX
+
+# === Define the functions for printing usage and error message ======
+print_usage_and_exit () {
+  cat <<-USAGE 1>&2
+	Usage   : ${0##*/} [options] [test ...]
+	Args    : test ....... Tests to run (default: all of them)
+	                         fsed-args   : how "fsed" takes "-f", "--"
+	                                       and the patterns like "-fPIC"
+	                         fsed-map    : fsed -f with the overlapping
+	                                       patterns
+	                         fsed-worst  : fsed -f with "a" and 2000 "a"s
+	                                       followed by "b" on a 5MB line
+	                                       of "a"s (must be in 10 sec.)
+	                         sigamp      : the formulas on the integers,
+	                                       the decimals, the big numbers
+	                                       and the hexadecimal strings
+	                         gres        : BRE/ERE/fixed strings with the
+	                                       back references and the empty
+	                                       matches
+	                         greo        : the files overwritten by -p
+	                         hirakata    : hira2kata and kata2hira on the
+	                                       fields, with +<n>h and -d
+	                         is_furigana : the return values for every
+	                                       option on the valid and the
+	                                       broken strings
+	                       Each test but fsed-worst compares the outputs
+	                       (and the return values) of the command with
+	                       and without the native engine.
+	Options : -d dir ..... The directory which has the compiled commands
+	                       (default: compile them by MAKE.sh into a work
+	                       directory)
+	Version : 2026-10-19 23:05:47 JST
+	USAGE
+  exit 1
+}
+error_exit() {
+  ${2+:} false && echo "${0##*/}: $2" 1>&2
+  exit $1
+}
+
+# === Get my directory path ==========================================
+Homedir=$(d=${0%/*}/; [ "_$d" = "_$0/" ] && d='./'; cd "$d"; pwd)
+
+# === Define the other parameters ====================================
+ALLTESTS='fsed-args fsed-map fsed-worst sigamp gres greo hirakata is_furigana'
+# (the commands to test and the native engines which they use)
+COMMANDS='fsed:fsed sigamp:sigamp gres:gres greo:greo hira2kata:hirakata
+          kata2hira:hirakata is_furigana:is_furigana'
+
+
+
+######################################################################
+# Parse arguments
+######################################################################
+
+# === Get the options ================================================
+Dir_bin=''
+while getopts d: opt; do
+  case $opt in
+    d) Dir_bin=$OPTARG                                                  ;;
+    *) print_usage_and_exit                                             ;;
+  esac
+done
+shift $((OPTIND-1))
+
+# === Get the tests ==================================================
+case $# in 0) set -- $ALLTESTS;; esac
+for t in "$@"; do
+  case " $ALLTESTS " in *" $t "*) :;; *) print_usage_and_exit;; esac
+done
+
+
+
+######################################################################
+# Functions
+######################################################################
+
+# === Report the result of a test ====================================
+# [in] $1 : the test, $2 : the reason of the failure (none if passed)
+report() {
+  case $# in
+    1) echo "PASS $1"                        ;;
+    *) echo "FAIL $1: $2"; ret=1             ;;
+  esac
+}
+
+# === Run a command with and without the native engine ===============
+# [in]  $1 : the command, $2... : the arguments for it
+# [out] $Tmp/out_n, $Tmp/out_p : the outputs of them
+# [ret] 0 only when both of them print the same and return the same
+same_both() {
+  cmd=$1; shift
+  "$Tmp/native/$cmd" "$@" > "$Tmp/out_n" 2>/dev/null; rn=$?
+  "$Tmp/posix/$cmd"  "$@" > "$Tmp/out_p" 2>/dev/null; rp=$?
+  [ $rn -eq $rp ] && cmp -s "$Tmp/out_n" "$Tmp/out_p"
+}
+
+# === Test "fsed" on the arguments ===================================
+# [in] $1 : the "fsed" to test
+test_fsed_args() {
+  printf 'CFLAGS=-fPIC -O2\n-f -- x\n' > "$Tmp/mk"
+  printf -- '-fPIC\t-fpic\n'           > "$Tmp/map"
+  {
+    "$1" -fPIC -fpic "$Tmp/mk"
+    "$1" -- -f F     "$Tmp/mk"
+    "$1" -- -- D     "$Tmp/mk"
+    "$1" -f "$Tmp/map" "$Tmp/mk"
+  } > "$Tmp/out" 2>&1
+  printf '%s\n' 'CFLAGS=-fpic -O2' '-f -- x' 'CFLAGS=FPIC -O2' 'F -- x' \
+                'CFLAGS=-fPIC -O2' '-f D x'  'CFLAGS=-fpic -O2' '-f -- x' |
+  cmp -s - "$Tmp/out"
+}
+
+
+
+######################################################################
+# Main
+######################################################################
+
+# === Prepare the commands ===========================================
+Tmp="${TMPDIR:-/tmp}/${0##*/}.$$"
+trap 'rm -rf "${Tmp:?}"' EXIT HUP INT TERM
+mkdir -m 700 "$Tmp" || error_exit 1 "$Tmp: Can't make the work directory"
+case "$Dir_bin" in
+  '') mkdir "$Tmp/bin"                              &&
+      sh "$Homedir/MAKE.sh" -d "$Tmp/bin" 2>"$Tmp/MAKE.log" || {
+        cat "$Tmp/MAKE.log" 1>&2
+        error_exit 1 'Failed to compile the commands'
+      }
+      Dir_bin="$Tmp/bin"                                                ;;
+  /*) :                                                                 ;;
+   *) Dir_bin="$(pwd)/$Dir_bin"                                         ;;
+esac
+# (The scripts use the native engines next to them, so the POSIX
+#  versions are the copies of them in a directory without the engines.)
+mkdir "$Tmp/native" "$Tmp/posix" || error_exit 1 "$Tmp: Can't make dirs"
+for c in $COMMANDS; do
+  [ -x "$Dir_bin/${c#*:}-native" ] ||
+  error_exit 1 "$Dir_bin/${c#*:}-native: Not found"
+  cp "$Homedir/../${c%:*}" "$Tmp/native/"                              &&
+  cp "$Homedir/../${c%:*}" "$Tmp/posix/"                               &&
+  { [ -e "$Tmp/native/${c#*:}-native" ]                                ||
+    ln -s "$Dir_bin/${c#*:}-native" "$Tmp/native/${c#*:}-native"; }    ||
+  error_exit 1 "$Tmp: Can't prepare the commands"
+done
+
+# === Run the tests ==================================================
+ret=0
+for t in "$@"; do
+  case $t in
+    fsed-args)
+      if   ! test_fsed_args "$Tmp/posix/fsed" ; then report $t 'the POSIX version'
+      elif ! test_fsed_args "$Tmp/native/fsed"; then report $t 'the native engine'
+      else                                           report $t
+      fi
+      ;;
+    fsed-map)
+      printf '%s\t%s\n' a X ab Y abc Z bc W cab V aab U b T > "$Tmp/map"
+      awk 'BEGIN{for(i=0;i<2000;i++){s="";                               #
+                   for(j=0;j<(i*7)%61;j++){s=s substr("abcab",(i+j)%5+1,1)}#
+                   print s;}}' > "$Tmp/in"
+      if same_both fsed -f "$Tmp/map" "$Tmp/in"; then report $t
+      else                                            report $t 'differs'
+      fi
+      ;;
+    fsed-worst)
+      awk 'BEGIN{s="a"; while(length(s)<2000){s=s s}; s=substr(s,1,2000); #
+                 printf("a\tX\n%sb\tY\n", s);}' > "$Tmp/map"
+      dd if=/dev/zero bs=1000000 count=5 2>/dev/null | tr '\000' 'a' > "$Tmp/in"
+      t0=$(date +%s)
+      "$Tmp/native/fsed" -f "$Tmp/map" "$Tmp/in" > "$Tmp/out_n"
+      t1=$(date +%s)
+      if [ $((t1-t0)) -gt 10 ]; then
+        report $t "took $((t1-t0)) sec."
+      elif [ "$(tr -d 'X' < "$Tmp/out_n" | wc -c)" -ne 0 ] ||
+           [ "$(wc -c < "$Tmp/out_n")" -ne 5000000 ]; then
+        report $t 'wrong output'
+      else
+        report $t
+      fi
+      ;;
+    sigamp)
+      awk 'BEGIN{srand(7);                                               #
+                 for (i=0; i<3000; i++) {                                #
+                   for (j=0; j<5; j++) {                                 #
+                     r=rand(); k=int(rand()*1e6);                        #
+                     if      (r<.15) {v=int(rand()*5e9)-2.5e9;          }#
+                     else if (r<.30) {v=sprintf("%.4f",rand()*1e6-5e5); }#
+                     else if (r<.40) {v="0x" k;                         }#
+                     else if (r<.50) {v=-rand()*100;                    }#
+                     else if (r<.60) {v=int(rand()*1e12) "" k;          }#
+                     else if (r<.70) {v=sprintf("%.3e",rand()*1e15);    }#
+                     else if (r<.75) {v="abc";                          }#
+                     else if (r<.80) {v=k/8;                            }#
+                     else            {v=k%1000;                         }#
+                     printf("%s%s", v, (j<4)?" ":"\n");                  #
+                   }                                                     #
+                 }                                                       #
+               }' > "$Tmp/in"
+      fail=''
+      for f in '*1000 +1 r2 *3/0,5 ='                                     \
+               '*1 /3/f1 *-2.5+1/c0 1,100000:0,7 -0.5'                    \
+               '*1000/r3 -7/c2 *3/-5,5 = 4,20:0,255/0/0,255'              \
+               'r12 c3 x-2-0.5 /7/f10 *1000000/c11'                        \
+               '+0 *1 0,1 ,0 0,'                                          ; do
+        set -f; same_both sigamp $f "$Tmp/in" || fail="$fail [$f]"; set +f
+      done
+      case "$fail" in '') report $t;; *) report $t "differs on$fail";; esac
+      ;;
+    gres)
+      awk 'BEGIN{srand(11); n=split("foo bar baz typo -R a.b [x] / \\ & " \
+                                    "aab ab b 12 345 ~ *",w," ");         #
+                 for (i=0; i<2000; i++) {                                #
+                   s=""; m=int(rand()*9);                                #
+                   for (j=0; j<m; j++) {s=s w[int(rand()*n)+1] " ";}     #
+                   print s;                                              #
+                 }                                                       #
+               }' > "$Tmp/in"
+      printf 'typo\nfoo bar' > "$Tmp/in2"
+      fail=''
+      while IFS=':' read -r o p s; do
+        case "$o" in '') set -- "$p" "$s";; *) set -- "$o" "$p" "$s";; esac
+        same_both gres "$@" "$Tmp/in" "$Tmp/in2" || fail="$fail [$*]"
+      done <<-CASES
+	:typo:type
+	--:-R:-r
+	:\(b[a-z]*\):<\1>
+	:a*:-
+	:^:>
+	:\$:<
+	:\([ab]\)\1:=\1=
+	:[0-9]\{2,\}:#
+	:o:&&/
+	-E:(fo+|ba[rz]):[&]
+	-E:([0-9])([0-9])?:\2\1
+	-F:a.b:&x/
+	-F:[x]:\1
+	-F:\\\\:/
+	CASES
+      case "$fail" in '') report $t;; *) report $t "differs on$fail";; esac
+      ;;
+    greo)
+      awk 'BEGIN{for(i=0;i<3000;i++){print "foo" i%7, "bar/" i%13, "typo"}}'\
+      > "$Tmp/in"
+      fail=''
+      while IFS=':' read -r o p s; do
+        case "$o" in '') set -- "$p" "$s";; *) set -- "$o" "$p" "$s";; esac
+        for d in native posix; do
+          rm -rf "$Tmp/g_$d" && mkdir "$Tmp/g_$d"                         &&
+          cp "$Tmp/in" "$Tmp/g_$d/f1" && printf 'foo\nbar' > "$Tmp/g_$d/f2" &&
+          "$Tmp/$d/greo" -p "$@" "$Tmp/g_$d/f1" "$Tmp/g_$d/f2" >/dev/null 2>&1
+        done
+        cmp -s "$Tmp/g_native/f1" "$Tmp/g_posix/f1" &&
+        cmp -s "$Tmp/g_native/f2" "$Tmp/g_posix/f2" || fail="$fail [$*]"
+      done <<-CASES
+	:typo:type
+	:foo\([0-9]\):\1oof
+	:o*:.
+	-E:(bar)/([0-9]+):\2\1
+	-F:bar/1:&
+	CASES
+      case "$fail" in '') report $t;; *) report $t "differs on$fail";; esac
+      ;;
+    hirakata)
+      cat <<-'TEXT' > "$Tmp/in"
+	# あいう アイウ ｱｲｳ
+	あいう アイウ ｱｲｳ がぎぐぱぴぷ ガギグパピプ ｶﾞｷﾞﾊﾟﾋﾟ abc
+	ゔゕゖ ヴヵヶ ゝゞ ヽヾ ー ･ｰ ﾞﾟ ぁぃぅ ァィゥ ヷヸヹヺ
+	漢字 かな カナ ｶﾅ 123 ー
+	TEXT
+      fail=''
+      for c in hira2kata kata2hira; do
+        for a in '1 2 3 4 5 6 7 8 9 10 11 12' '1 3 5' '+1h 1 2 3 4' '2'; do
+          set -f
+          same_both $c $a "$Tmp/in" || fail="$fail [$c $a]"
+          same_both $c -d $a 'あい ｱｲ アイ ｶﾞ がー' || fail="$fail [$c -d $a]"
+          set +f
+        done
+      done
+      case "$fail" in '') report $t;; *) report $t "differs on$fail";; esac
+      ;;
+    is_furigana)
+      fail=''
+      i=0
+      for s in 'あか\n' 'ﾐﾄﾞﾘ\n' 'ｱｲｳｴｵ\n' 'アイウ\n' 'あア\n' 'ゔー\n' \
+               'ｱｵ1号\n' 'とうきょうと ちよだく\n' 'ｱｲ\nｳｴｵ' '' '\n'    \
+               'ヴヵヶ' 'ｧｨｩｰﾞﾟ\n' 'ゝゞヽヾ\n' '\377\n' '\343\201\n'  \
+               'あ\343\201' '\n\n' 'a'                                 ; do
+        i=$((i+1))
+        printf "$s" > "$Tmp/s$i"
+        for o in '' --hira --kata --hankata --zenkata; do
+          same_both is_furigana $o "$Tmp/s$i" || fail="$fail [$o #$i]"
+        done
+      done
+      case "$fail" in '') report $t;; *) report $t "differs on$fail";; esac
+      ;;
+  esac
+done
+
+# === Finish =========================================================
+exit $ret
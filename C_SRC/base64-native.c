@@ -0,0 +1,678 @@
+/*####################################################################
+#
+# BASE64-NATIVE - The Native Base64 Codec for the "base64" Command
+#
+# USAGE   : base64-native [-w cols] [file]
+#           base64-native -d [-i] [file]
+# Args    : file ...... Filepath to be encoded or decoded ("-" means
+#                       STDIN)
+# Options : -d ........ Decode instead of encode
+#           -i ........ When decoding, ignore non-alphabet characters
+#           -w cols ... When encoding, wrap encoded lines after cols
+#                       characters (default 76). 0 means preventing from
+#                       wrapping.
+# Retuen  : Return 0 only when finished successfully
+#
+# * This is the engine which the "base64" command in the upper
+#   directory uses when it has been compiled. So, it makes exactly the
+#   same output as the POSIX version of "base64" does, which means
+#   - the encoded text always ends with <0x0A>, even with -w 0,
+#   - the padding "=" are attached to the last line without wrapping,
+#   - every character but <0x0A> takes one of the four places of an
+#     encoded group when decoding without -i, even if it's out of the
+#     alphabet ("=" and <0x0D> are also so), and it has no bits,
+#   - the last incomplete group is decoded only when the line it ends
+#     in (cut every 508 bytes as "fold -b -w 508" does) has 4 or more
+#     characters together with the rest of the previous line, e.g.
+#     "QUJ" and "QU=" make nothing but "QUJDQUJ" makes "ABCAB".
+# * SSSE3 or AVX2 is used if the CPU supports them.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define ENC_IBUF (3*65536)  /* input buffer size for encoding (3x)  */
+#define DEC_IBUF (4*65536)  /* input buffer size for decoding (4x)  */
+#define OBUF     65536      /* output buffer size                   */
+#define SLACK    64         /* room for the SIMD stores over the end */
+#define CLS_NL   0xFF       /* character classes in gau8Dec[]       */
+#define CLS_EQ   0xFE
+#define CLS_BAD  0xFD
+#define FOLD_W   508        /* line width which the POSIX version cuts
+                               the encoded text into when decoding  */
+
+/*--- prototype functions ------------------------------------------*/
+void   init_tables(void);
+void   encode(int iFd);
+void   decode(int iFd);
+size_t enc_scalar(const uint8_t *pu8Src, size_t uLen, char *pcDst);
+size_t dec_scalar(const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst);
+void   put_wrapped(const char *pcEnc, size_t uLen);
+void   put_bytes(const void *pv, size_t uLen);
+void   flush_out(void);
+#ifdef HAVE_X86SIMD
+  size_t enc_ssse3(const uint8_t *pu8Src, size_t uLen, char *pcDst);
+  size_t enc_avx2 (const uint8_t *pu8Src, size_t uLen, char *pcDst);
+  size_t dec_ssse3(const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst,
+                   size_t *puUsed);
+  size_t dec_avx2 (const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst,
+                   size_t *puUsed);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname;    /* The name of this command                 */
+int     giWidth;        /* -w option value                          */
+int     giIgnore;       /* 1 when -i option is set                  */
+char    gac12[4096][2]; /* 12 bits to 2 characters                  */
+uint8_t gau8Dec[256];   /* character to 6 bits (or CLS_*)           */
+char    gacOut[OBUF];   /* output buffer                            */
+size_t  guOut;          /* the length of the data in gacOut         */
+size_t  guCol;          /* the current column of the encoded text   */
+/* The encoder and decoder for bulk data (chosen on the CPU)        */
+size_t (*gpfEnc)(const uint8_t*, size_t, char*) = enc_scalar;
+#ifdef HAVE_X86SIMD
+  size_t (*gpfDec)(const uint8_t*, size_t, uint8_t*, size_t*) = NULL;
+#endif
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-w cols] [file]\n"
+    "          %s -d [-i] [file]\n"
+    "Args    : file ...... Filepath to be encoded or decoded (\"-\" means\n"
+    "                      STDIN)\n"
+    "Options : -d ........ Decode instead of encode\n"
+    "          -i ........ When decoding, ignore non-alphabet characters\n"
+    "          -w cols ... When encoding, wrap encoded lines after cols\n"
+    "                      characters (default 76). 0 means preventing from\n"
+    "                      wrapping.\n"
+    "Retuen  : Return 0 only when finished successfully\n"
+    "Version : 2026-10-19 11:38:05 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  int iDecode;  /* 1 when -d option is set */
+  int iFd;
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  iDecode  = 0;
+  giIgnore = 0;
+  giWidth  = 76;
+  while ((i=getopt(argc, argv, "diw:h")) != -1) {
+    switch (i) {
+      case 'd': iDecode  = 1;
+                break;
+      case 'i': giIgnore = 1;
+                break;
+      case 'w': if (sscanf(optarg,"%d",&giWidth) != 1) {print_usage_and_exit();}
+                if (giWidth < 0                      ) {print_usage_and_exit();}
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc > 1) {print_usage_and_exit();}
+
+  /*=== Open the file ==============================================*/
+  if (argc==0 || strcmp(argv[0],"-")==0) {
+    iFd = STDIN_FILENO;
+  } else if ((iFd=open(argv[0],O_RDONLY)) < 0) {
+    error_exit(errno,"%s: %s\n", argv[0], strerror(errno));
+  }
+
+  /*=== Encode or decode ===========================================*/
+  init_tables();
+  if (iDecode) {decode(iFd);}
+  else         {encode(iFd);}
+  flush_out();
+
+  /*=== Finish =====================================================*/
+  return 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Make the tables and choose the kernels for the CPU =============*/
+void init_tables(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const char szAlpha[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  int i;
+
+  /*--- Make the tables --------------------------------------------*/
+  for (i=0; i<4096; i++) {
+    gac12[i][0] = szAlpha[i >> 6];
+    gac12[i][1] = szAlpha[i & 63];
+  }
+  memset(gau8Dec, CLS_BAD, sizeof(gau8Dec));
+  for (i=0; i<64; i++) {gau8Dec[(uint8_t)szAlpha[i]] = (uint8_t)i;}
+  gau8Dec['='] = CLS_EQ;
+  gau8Dec['\n'] = CLS_NL;
+
+  /*--- Choose the kernels -----------------------------------------*/
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if        (__builtin_cpu_supports("avx2" )) {
+    gpfEnc = enc_avx2;
+    gpfDec = dec_avx2;
+  } else if (__builtin_cpu_supports("ssse3")) {
+    gpfEnc = enc_ssse3;
+    gpfDec = dec_ssse3;
+  }
+#endif
+}
+
+/*=== Encode the data from the file ==================================
+ * [in] iFd : The file descriptor to read                           */
+void encode(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  static uint8_t au8In[ENC_IBUF];
+  static char    acEnc[ENC_IBUF/3*4+SLACK];
+  size_t  uHave;  /* bytes in au8In                                 */
+  size_t  uBulk;  /* bytes to be encoded by the bulk encoder        */
+  size_t  uEnc;   /* characters encoded                             */
+  ssize_t iRead;
+  uint32_t u4;
+  int     iAny;   /* 1 after some characters have been written      */
+
+  /*--- Encode every multiple of 3 bytes ---------------------------*/
+  uHave = 0;
+  iAny  = 0;
+  while (1) {
+    iRead = read(iFd, au8In+uHave, ENC_IBUF-uHave);
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"read(): %s\n", strerror(errno));
+    }
+    if (iRead == 0) {break;}
+    uHave += (size_t)iRead;
+    uBulk  = uHave - uHave%3;
+    if (uBulk == 0) {continue;}
+    uEnc = gpfEnc(au8In, uBulk, acEnc);
+    put_wrapped(acEnc, uEnc);
+    iAny = 1;
+    memmove(au8In, au8In+uBulk, uHave-uBulk);
+    uHave -= uBulk;
+  }
+
+  /*--- Encode the last 1 or 2 bytes and attach the padding --------*/
+  /* The padding is attached without wrapping as the POSIX version  */
+  switch (uHave) {
+    case 1:  u4 = (uint32_t)au8In[0]<<16;
+             put_wrapped(gac12[u4>>12], 2);
+             put_bytes("==", 2);
+             iAny = 1;
+             break;
+    case 2:  u4 = (uint32_t)au8In[0]<<16 | (uint32_t)au8In[1]<<8;
+             put_wrapped(gac12[u4>>12], 2);
+             put_wrapped(&gac12[u4&0xFFF][0], 1);
+             put_bytes("=", 1);
+             iAny = 1;
+             break;
+  }
+  if (iAny) {put_bytes("\n", 1);}
+}
+
+/*=== Decode the data from the file ==================================
+ * [in] iFd : The file descriptor to read                           */
+void decode(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  static uint8_t au8In[DEC_IBUF];
+  static uint8_t au8Out[DEC_IBUF/4*3+SLACK];
+  uint8_t *pu8R, *pu8W, *pu8End, *pu8Nl;
+  size_t   uHave, uDec;
+#ifdef HAVE_X86SIMD
+  size_t   uUsed;
+#endif
+  ssize_t  iRead;
+  uint32_t u4Acc;  /* the bits of the current group                 */
+  int      iBits;  /* the number of the bits in u4Acc               */
+  int      iSlot;  /* the number of the characters in the group     */
+  uint8_t  u8;
+  size_t   uCol;   /* the bytes in the current line (as "fold" cuts) */
+  size_t   uKept;  /* the characters kept in the current line       */
+  size_t   uLast;  /* the characters which the POSIX version has had
+                      at the last line where a character was kept
+                      (the rest of the previous line included)      */
+  int      iCarry; /* the rest of the previous line (mod 4)         */
+  size_t   u, uSeg;
+
+  u4Acc = 0; iBits = 0; iSlot = 0;
+  uCol  = 0; uKept = 0; uLast = 0; iCarry = 0;
+  while (1) {
+    /*--- Read and remove the characters which take no place -------*/
+    iRead = read(iFd, au8In, DEC_IBUF);
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"read(): %s\n", strerror(errno));
+    }
+    if (iRead == 0) {break;}
+    /* (The lines are also counted as the POSIX version cuts them
+        to know whether the last incomplete group is decoded.)       */
+    pu8End = au8In + iRead;
+    if (giIgnore) {
+      for (pu8R=pu8W=au8In; pu8R<pu8End; pu8R++) {
+        if (*pu8R=='\n' || uCol==FOLD_W) {
+          iCarry = (int)((iCarry+uKept)&3); uCol = 0; uKept = 0;
+          if (*pu8R == '\n') {continue;}
+        }
+        uCol++;
+        if (gau8Dec[*pu8R]<64 || *pu8R=='=') {
+          *pu8W++ = *pu8R;
+          uKept++; uLast = iCarry + uKept;
+        }
+      }
+    } else {
+      pu8W = au8In;
+      for (pu8R=au8In; pu8R<pu8End; pu8R=pu8Nl+1) {
+        pu8Nl = memchr(pu8R, '\n', pu8End-pu8R);
+        if (pu8Nl == NULL) {pu8Nl = pu8End;}
+        for (u=pu8Nl-pu8R; u>0; u-=uSeg) {
+          if (uCol == FOLD_W) {
+            iCarry = (int)((iCarry+uKept)&3); uCol = 0; uKept = 0;
+          }
+          uSeg   = (u < FOLD_W-uCol) ? u : FOLD_W-uCol;
+          uCol  += uSeg;
+          uKept += uSeg;
+          uLast  = iCarry + uKept;
+        }
+        if (pu8Nl < pu8End) {
+          iCarry = (int)((iCarry+uKept)&3); uCol = 0; uKept = 0;
+        }
+        if (pu8W != pu8R) {memmove(pu8W, pu8R, pu8Nl-pu8R);}
+        pu8W += pu8Nl-pu8R;
+      }
+    }
+    uHave = pu8W - au8In;
+
+    /*--- Decode them ----------------------------------------------*/
+    pu8R = au8In;
+    pu8W = au8Out;
+    while (uHave > 0) {
+      /* Decode the groups in bulk while they are all in the alphabet */
+      if (iSlot == 0) {
+#ifdef HAVE_X86SIMD
+        if (gpfDec != NULL) {
+          pu8W  += gpfDec(pu8R, uHave, pu8W, &uUsed);
+          pu8R  += uUsed;
+          uHave -= uUsed;
+        }
+#endif
+        uDec   = dec_scalar(pu8R, uHave & ~(size_t)3, pu8W);
+        pu8R  += uDec/3*4;
+        pu8W  += uDec;
+        uHave -= uDec/3*4;
+        if (uHave == 0) {break;}
+      }
+      /* Otherwise, decode the group character by character          */
+      u8 = gau8Dec[*pu8R++];
+      uHave--;
+      if (u8 < 64) {u4Acc = u4Acc<<6 | u8; iBits += 6;}
+      if (++iSlot < 4) {continue;}
+      switch (iBits) {
+        case 24: *pu8W++ = (uint8_t)(u4Acc>>16);
+                 *pu8W++ = (uint8_t)(u4Acc>> 8);
+                 *pu8W++ = (uint8_t)(u4Acc    ); break;
+        case 18: *pu8W++ = (uint8_t)(u4Acc>>10);
+                 *pu8W++ = (uint8_t)(u4Acc>> 2); break;
+        case 12: *pu8W++ = (uint8_t)(u4Acc>> 4); break;
+      }
+      u4Acc = 0; iBits = 0; iSlot = 0;
+    }
+    put_bytes(au8Out, pu8W-au8Out);
+  }
+
+  /*--- Decode the last incomplete group ---------------------------*/
+  if (uLast < 4) {return;} /* the POSIX version doesn't */
+  switch (iBits) {
+    case 18: u8 = (uint8_t)(u4Acc>>10); put_bytes(&u8, 1);
+             u8 = (uint8_t)(u4Acc>> 2); put_bytes(&u8, 1); break;
+    case 12: u8 = (uint8_t)(u4Acc>> 4); put_bytes(&u8, 1); break;
+  }
+}
+
+/*=== Encode bytes (scalar version) ==================================
+ * [in]  pu8Src : The bytes
+ *       uLen   : The number of them (must be a multiple of 3)
+ * [out] pcDst  : The encoded characters
+ * [ret]        : The number of the characters                      */
+size_t enc_scalar(const uint8_t *pu8Src, size_t uLen, char *pcDst) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8End = pu8Src + uLen;
+  char          *pc     = pcDst;
+  uint32_t       u4;
+
+  /*--- Encode 3 bytes into 4 characters by the 12-bit table -------*/
+  for (; pu8Src<pu8End; pu8Src+=3, pc+=4) {
+    u4 = (uint32_t)pu8Src[0]<<16 | (uint32_t)pu8Src[1]<<8 | pu8Src[2];
+    memcpy(pc  , gac12[u4>>12  ], 2);
+    memcpy(pc+2, gac12[u4&0xFFF], 2);
+  }
+  return pc - pcDst;
+}
+
+/*=== Decode characters (scalar version) =============================
+ * It stops at the first group which has a character out of the
+ * alphabet.
+ * [in]  pu8Src : The characters
+ *       uLen   : The number of them (must be a multiple of 4)
+ * [out] pu8Dst : The decoded bytes
+ * [ret]        : The number of the bytes (3 per valid group)       */
+size_t dec_scalar(const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8End = pu8Src + uLen;
+  uint8_t       *pu8    = pu8Dst;
+  uint32_t       a, b, c, d;
+
+  /*--- Decode 4 characters into 3 bytes ---------------------------*/
+  for (; pu8Src<pu8End; pu8Src+=4, pu8+=3) {
+    a = gau8Dec[pu8Src[0]]; b = gau8Dec[pu8Src[1]];
+    c = gau8Dec[pu8Src[2]]; d = gau8Dec[pu8Src[3]];
+    if ((a|b|c|d) >= 64) {break;}
+    a = a<<18 | b<<12 | c<<6 | d;
+    pu8[0] = (uint8_t)(a>>16);
+    pu8[1] = (uint8_t)(a>> 8);
+    pu8[2] = (uint8_t)(a    );
+  }
+  return pu8 - pu8Dst;
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Encode bytes (SSSE3 version) ===================================
+ * The same as enc_scalar(). The algorithm is by Wojciech Mula.     */
+__attribute__((target("ssse3")))
+size_t enc_ssse3(const uint8_t *pu8Src, size_t uLen, char *pcDst) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m128i shuf = _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+  const __m128i lut  = _mm_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52,
+                                     '0'-52, '0'-52, '0'-52, '0'-52,
+                                     '0'-52, '0'-52, '0'-52, '+'-62,
+                                     '/'-63, 'A'   , 0     , 0     );
+  __m128i v, t0, t1;
+  size_t  i, o;
+
+  /*--- Encode 12 bytes into 16 characters -------------------------*/
+  for (i=0,o=0; i+16<=uLen; i+=12,o+=16) {
+    v  = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pu8Src+i)), shuf);
+    t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                                          _mm_set1_epi32(0x04000040));
+    t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                                          _mm_set1_epi32(0x01000010));
+    v  = _mm_or_si128(t0, t1);          /* 6-bit indices */
+    t0 = _mm_subs_epu8(v, _mm_set1_epi8(51));
+    t1 = _mm_cmpgt_epi8(_mm_set1_epi8(26), v);
+    t0 = _mm_or_si128(t0, _mm_and_si128(t1, _mm_set1_epi8(13)));
+    v  = _mm_add_epi8(_mm_shuffle_epi8(lut, t0), v);
+    _mm_storeu_si128((__m128i*)(pcDst+o), v);
+  }
+  return o + enc_scalar(pu8Src+i, uLen-i, pcDst+o);
+}
+
+/*=== Encode bytes (AVX2 version) ====================================
+ * The same as enc_ssse3() but 24 bytes at a time.                  */
+__attribute__((target("avx2")))
+size_t enc_avx2(const uint8_t *pu8Src, size_t uLen, char *pcDst) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m256i shuf = _mm256_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10,
+                                        1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+  const __m256i lut  = _mm256_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52,
+                                        '0'-52, '0'-52, '0'-52, '0'-52,
+                                        '0'-52, '0'-52, '0'-52, '+'-62,
+                                        '/'-63, 'A'   , 0     , 0     ,
+                                        'a'-26, '0'-52, '0'-52, '0'-52,
+                                        '0'-52, '0'-52, '0'-52, '0'-52,
+                                        '0'-52, '0'-52, '0'-52, '+'-62,
+                                        '/'-63, 'A'   , 0     , 0     );
+  __m256i v, t0, t1;
+  size_t  i, o;
+
+  /*--- Encode 24 bytes into 32 characters -------------------------*/
+  for (i=0,o=0; i+28<=uLen; i+=24,o+=32) {
+    v  = _mm256_inserti128_si256(
+           _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(pu8Src+i))),
+           _mm_loadu_si128((const __m128i*)(pu8Src+i+12)), 1);
+    v  = _mm256_shuffle_epi8(v, shuf);
+    t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                                _mm256_set1_epi32(0x04000040));
+    t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                                _mm256_set1_epi32(0x01000010));
+    v  = _mm256_or_si256(t0, t1);
+    t0 = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+    t1 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), v);
+    t0 = _mm256_or_si256(t0, _mm256_and_si256(t1, _mm256_set1_epi8(13)));
+    v  = _mm256_add_epi8(_mm256_shuffle_epi8(lut, t0), v);
+    _mm256_storeu_si256((__m256i*)(pcDst+o), v);
+  }
+  return o + enc_scalar(pu8Src+i, uLen-i, pcDst+o);
+}
+
+/*=== Decode characters (SSSE3 version) ==============================
+ * It stops at the first block of 16 characters which has a character
+ * out of the alphabet. The algorithm is by Wojciech Mula.
+ * [in]  pu8Src : The characters
+ *       uLen   : The number of them
+ * [out] pu8Dst : The decoded bytes (16 bytes are written at a time)
+ *       puUsed : The number of the characters decoded
+ * [ret]        : The number of the bytes                           */
+__attribute__((target("ssse3")))
+size_t dec_ssse3(const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst,
+                 size_t *puUsed) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m128i lut_lo = _mm_setr_epi8(0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                                       0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A);
+  const __m128i lut_hi = _mm_setr_epi8(0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                                       0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10);
+  const __m128i lut_rl = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                       0,  0,  0, 0,   0,   0,   0,   0);
+  const __m128i pack   = _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12,
+                                       -1,-1,-1,-1);
+  __m128i v, hi, lo;
+  size_t  i, o;
+
+  /*--- Decode 16 characters into 12 bytes -------------------------*/
+  for (i=0,o=0; i+16<=uLen; i+=16,o+=12) {
+    v  = _mm_loadu_si128((const __m128i*)(pu8Src+i));
+    hi = _mm_and_si128(_mm_srli_epi32(v, 4), _mm_set1_epi8(0x0f));
+    lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(v, _mm_set1_epi8(0x0f)));
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(
+          _mm_and_si128(lo, _mm_shuffle_epi8(lut_hi, hi)),
+          _mm_setzero_si128()                              )) != 0) {break;}
+    hi = _mm_add_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x2f)), hi);
+    v  = _mm_add_epi8(v, _mm_shuffle_epi8(lut_rl, hi));
+    v  = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v  = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128((__m128i*)(pu8Dst+o), _mm_shuffle_epi8(v, pack));
+  }
+  *puUsed = i;
+  return o;
+}
+
+/*=== Decode characters (AVX2 version) ===============================
+ * The same as dec_ssse3() but 32 characters at a time.             */
+__attribute__((target("avx2")))
+size_t dec_avx2(const uint8_t *pu8Src, size_t uLen, uint8_t *pu8Dst,
+                size_t *puUsed) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m256i lut_lo = _mm256_setr_epi8(
+                    0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                    0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A,
+                    0x15,0x11,0x11,0x11,0x11,0x11,0x11,0x11,
+                    0x11,0x11,0x13,0x1A,0x1B,0x1B,0x1B,0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(
+                    0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                    0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,
+                    0x10,0x10,0x01,0x02,0x04,0x08,0x04,0x08,
+                    0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10);
+  const __m256i lut_rl = _mm256_setr_epi8(
+                    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i pack   = _mm256_setr_epi8(
+                    2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1,
+                    2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1);
+  const __m256i perm   = _mm256_setr_epi32(0,1,2, 4,5,6, -1,-1);
+  __m256i v, hi, lo;
+  size_t  i, o;
+
+  /*--- Decode 32 characters into 24 bytes -------------------------*/
+  for (i=0,o=0; i+32<=uLen; i+=32,o+=24) {
+    v  = _mm256_loadu_si256((const __m256i*)(pu8Src+i));
+    hi = _mm256_and_si256(_mm256_srli_epi32(v, 4), _mm256_set1_epi8(0x0f));
+    lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(v,_mm256_set1_epi8(0x0f)));
+    if (! _mm256_testz_si256(lo, _mm256_shuffle_epi8(lut_hi, hi))) {break;}
+    hi = _mm256_add_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x2f)), hi);
+    v  = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut_rl, hi));
+    v  = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v  = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v  = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, pack), perm);
+    _mm256_storeu_si256((__m256i*)(pu8Dst+o), v);
+  }
+  *puUsed = i;
+  return o;
+}
+#endif
+
+/*=== Write encoded characters with wrapping =========================
+ * A <0x0A> is put before the character which exceeds the width, so
+ * the last line never gets an extra <0x0A> here.
+ * [in] pcEnc : The characters
+ *      uLen  : The number of them                                  */
+void put_wrapped(const char *pcEnc, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  size_t uPut;
+
+  /*--- Put them without wrapping if -w 0 --------------------------*/
+  if (giWidth == 0) {put_bytes(pcEnc, uLen); return;}
+
+  /*--- Put them with wrapping -------------------------------------*/
+  while (uLen > 0) {
+    if (guCol == (size_t)giWidth) {put_bytes("\n", 1); guCol = 0;}
+    uPut = (size_t)giWidth - guCol;
+    if (uPut > uLen) {uPut = uLen;}
+    put_bytes(pcEnc, uPut);
+    pcEnc += uPut;
+    uLen  -= uPut;
+    guCol += uPut;
+  }
+}
+
+/*=== Write bytes to STDOUT through the buffer =======================
+ * [in] pv   : The bytes
+ *      uLen : The number of them                                   */
+void put_bytes(const void *pv, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc = pv;
+  size_t      uPut;
+
+  /*--- Put them ---------------------------------------------------*/
+  while (uLen > 0) {
+    if (guOut == OBUF) {flush_out();}
+    uPut = OBUF - guOut;
+    if (uPut > uLen) {uPut = uLen;}
+    memcpy(gacOut+guOut, pc, uPut);
+    guOut += uPut;
+    pc    += uPut;
+    uLen  -= uPut;
+  }
+}
+
+/*=== Flush the output buffer ========================================*/
+void flush_out(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  size_t  uDone;
+  ssize_t iWritten;
+
+  /*--- Write all of them ------------------------------------------*/
+  for (uDone=0; uDone<guOut; uDone+=(size_t)iWritten) {
+    iWritten = write(STDOUT_FILENO, gacOut+uDone, guOut-uDone);
+    if (iWritten < 0) {
+      if (errno == EINTR) {iWritten = 0; continue;}
+      error_exit(errno,"write(): %s\n", strerror(errno));
+    }
+  }
+  guOut = 0;
+}
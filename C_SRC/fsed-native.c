@@ -0,0 +1,592 @@
+/*####################################################################
+#
+# FSED-NATIVE - The Native Substitution Engine for "fsed"
+#
+# USAGE   : fsed-native [--] <pattern_str> <substitute_str> [file ...]
+#           fsed-native -f <mapping_file> [--] [file ...]
+# Args    : pattern_str, substitute_str
+#               The string to find and the one to replace it with.
+#               All of the characters are regarded as they are.
+#           file ...... Filepath to be substituted ("-" means STDIN).
+#                       The files are regarded as one stream like "cat"
+#                       does.
+# Options : -f ........ Substitute all of the pairs in the mapping file
+#                       instead of one pair. Every line of the file has
+#                       a pair, <pattern_str><TAB><substitute_str>
+#                       (the first <TAB> separates them, and the empty
+#                       lines are ignored). When two or more patterns
+#                       can be found at the same place, the longest one
+#                       is chosen.
+#           Only the 1st argument which is exactly "-f" is the option,
+#           and "--" after it (or at first) ends the options. So,
+#           <pattern_str> can be "-fPIC" as it is, and "-f" or "--"
+#           after "--".
+# Retuen  : Return 0 only when all of the files were read successfully
+#
+# * This is the engine which the "fsed" command in the upper directory
+#   uses when it has been compiled. So, it makes exactly the same
+#   output as the script does.
+# * All of the reversed patterns are compiled into one Aho-Corasick
+#   automaton (a DFA whose columns are only for the bytes which appear
+#   in the patterns). It reads every block of the lines backward once
+#   and finds the longest pattern which begins at every place, and
+#   then the matches are taken from the head by the leftmost-longest
+#   rule. So, it takes the time in proportion to the input however
+#   many and long pairs the mapping file has. The text between the
+#   matches is copied straight from the input buffer.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF  1048576 /* input buffer size (the first one)             */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {
+  uint8_t *p;        /* the bytes (1 more byte is always allocated) */
+  size_t   n;        /* the number of the bytes                     */
+  size_t   uSize;    /* the allocated size                          */
+} buf_t;
+typedef struct {
+  size_t  uPos;      /* the place where the pattern begins          */
+  int32_t iPair;     /* the pair of the longest pattern there       */
+} hit_t;
+typedef struct {
+  size_t uPatOff;    /* the offset of the pattern in gbPair         */
+  size_t uPatLen;    /* the length of it                            */
+  size_t uRepOff;    /* the offset of the replacement in gbPair     */
+  size_t uRepLen;    /* the length of it                            */
+} pair_t;
+
+/*--- prototype functions ------------------------------------------*/
+void    add_pair(const void *pvPat, size_t uPatLen,
+                 const void *pvRep, size_t uRepLen);
+void    read_mapping(const char *pszFile);
+void    build_automaton(void);
+int32_t new_node(void);
+size_t  read_input(uint8_t *pu8Buf, size_t uSize);
+void    subst_stream(void);
+void    emit(uint8_t *pu8, size_t uLen, buf_t *pbOut);
+size_t  subst_bytes(uint8_t *pu8, size_t uLen, buf_t *pbOut);
+void    buf_add(buf_t *pb, const void *pv, size_t uLen);
+void    write_all(const void *pv, size_t uLen);
+
+/*--- global variables ---------------------------------------------*/
+char*     gpszCmdname;   /* The name of this command                */
+char**    gppszFiles;    /* The files to read                       */
+int       giNfiles;      /* The number of them                      */
+int       giFd;          /* The file descriptor reading now (or -1) */
+int       giRet;         /* The return code                         */
+buf_t     gbPair;        /* The patterns and the replacements       */
+pair_t   *gpPair;        /* The pairs (in gbPair)                   */
+size_t    guNpair;       /* The number of them                      */
+size_t    guPairSize;    /* The allocated number of gpPair          */
+/* The automaton (node 0 is the root)                               */
+uint16_t  gau16Cls[256]; /* the column for every byte (0: not used) */
+size_t    guNcls;        /* the number of the columns               */
+int32_t  *gpi32Next;     /* the next node [node*guNcls+column]      */
+uint32_t *gpu32OutLen;   /* the length of the longest pattern which
+                            ends at the node (0 means none)         */
+int32_t  *gpi32OutPair;  /* the pair of it                          */
+int32_t   giNnode;       /* the number of the nodes                 */
+int32_t   giNodeSize;    /* the allocated number of them            */
+uint8_t   gau8Last[256]; /* 1 for the bytes which end a pattern     */
+buf_t     gbHit;         /* the places found by subst_bytes() (hit_t)*/
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [--] <pattern_str> <substitute_str> [file ...]\n"
+    "          %s -f <mapping_file> [--] [file ...]\n"
+    "Args    : pattern_str, substitute_str\n"
+    "              The string to find and the one to replace it with.\n"
+    "              All of the characters are regarded as they are.\n"
+    "          file ...... Filepath to be substituted (\"-\" means STDIN).\n"
+    "                      The files are regarded as one stream like \"cat\"\n"
+    "                      does.\n"
+    "Options : -f ........ Substitute all of the pairs in the mapping file\n"
+    "                      instead of one pair. Every line of the file has\n"
+    "                      a pair, <pattern_str><TAB><substitute_str>\n"
+    "                      (the first <TAB> separates them, and the empty\n"
+    "                      lines are ignored). When two or more patterns\n"
+    "                      can be found at the same place, the longest one\n"
+    "                      is chosen.\n"
+    "          Only the 1st argument which is exactly \"-f\" is the option,\n"
+    "          and \"--\" after it (or at first) ends the options. So,\n"
+    "          <pattern_str> can be \"-fPIC\" as it is, and \"-f\" or \"--\"\n"
+    "          after \"--\".\n"
+    "Retuen  : Return 0 only when all of the files were read successfully\n"
+    "Version : 2026-10-19 17:31:06 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  static char *apszStdin[] = {"-"};
+  char *pszMapping;  /* the mapping file (-f) */
+  int   i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  /* (Not by getopt() to take "-fPIC" and so on as <pattern_str> as
+     the script does)                                               */
+  pszMapping = NULL;
+  argc--;
+  argv++;
+  if (argc > 0 && strcmp(argv[0],"-f") == 0) {
+    if (argc < 2) {print_usage_and_exit();}
+    pszMapping = argv[1];
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc > 0 && strcmp(argv[0],"--") == 0) {argc--; argv++;}
+
+  /*=== Take the pairs =============================================*/
+  if (pszMapping != NULL) {
+    read_mapping(pszMapping);
+  } else {
+    if (argc < 2) {print_usage_and_exit();}
+    if (strchr(argv[0],'\n') != NULL) {
+      error_exit(1,"It is impossible to contain <0x0A> in <pattern_str>\n");
+    }
+    if (argv[0][0] == '\0') {
+      error_exit(1,"no previous regular expression\n");
+    }
+    add_pair(argv[0], strlen(argv[0]), argv[1], strlen(argv[1]));
+    argc -= 2;
+    argv += 2;
+  }
+  build_automaton();
+
+  /*=== Substitute =================================================*/
+  giFd  = -1;
+  giRet = 0;
+  if (argc == 0) {gppszFiles = apszStdin; giNfiles = 1;   }
+  else           {gppszFiles = argv;      giNfiles = argc;}
+  subst_stream();
+
+  /*=== Finish =====================================================*/
+  return giRet;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Add a pair of a pattern and its replacement ====================
+ * [in] pvPat, uPatLen : the pattern (not empty, without <0x0A>)
+ *      pvRep, uRepLen : the replacement                            */
+void add_pair(const void *pvPat, size_t uPatLen,
+              const void *pvRep, size_t uRepLen) {
+  if (guNpair >= guPairSize) {
+    guPairSize = (guPairSize==0) ? 1024 : guPairSize*2;
+    if ((gpPair=realloc(gpPair, sizeof(pair_t)*guPairSize)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  gpPair[guNpair].uPatOff = gbPair.n;
+  gpPair[guNpair].uPatLen = uPatLen;
+  buf_add(&gbPair, pvPat, uPatLen);
+  gpPair[guNpair].uRepOff = gbPair.n;
+  gpPair[guNpair].uRepLen = uRepLen;
+  buf_add(&gbPair, pvRep, uRepLen);
+  guNpair++;
+}
+
+/*=== Read the pairs from the mapping file ===========================
+ * [in] pszFile : the mapping file                                  */
+void read_mapping(const char *pszFile) {
+
+  /*--- Variables --------------------------------------------------*/
+  buf_t    stMap;
+  uint8_t *pu8, *pu8End, *pu8Eol, *pu8Tab;
+  ssize_t  iRead;
+  size_t   uLine;
+  int      iFd;
+
+  /*--- Read the whole file ----------------------------------------*/
+  if ((iFd=open(pszFile,O_RDONLY)) < 0) {
+    error_exit(1,"%s: %s\n", pszFile, strerror(errno));
+  }
+  memset(&stMap, 0, sizeof(stMap));
+  while (1) {
+    buf_add(&stMap, NULL, IBUF);
+    stMap.n -= IBUF;
+    iRead = read(iFd, stMap.p+stMap.n, IBUF);
+    if (iRead > 0) {stMap.n += (size_t)iRead; continue;}
+    if (iRead == 0) {break;}
+    if (errno == EINTR) {continue;}
+    error_exit(1,"%s: %s\n", pszFile, strerror(errno));
+  }
+  close(iFd);
+
+  /*--- Take the pair on every line --------------------------------*/
+  pu8End = stMap.p + stMap.n;
+  uLine  = 0;
+  for (pu8=stMap.p; pu8<pu8End; pu8=pu8Eol+1) {
+    uLine++;
+    if ((pu8Eol=memchr(pu8,'\n',pu8End-pu8)) == NULL) {pu8Eol = pu8End;}
+    if (pu8Eol == pu8) {continue;}
+    if ((pu8Tab=memchr(pu8,'\t',pu8Eol-pu8)) == NULL) {
+      error_exit(1,"%s: No <TAB> on line %zu\n", pszFile, uLine);
+    }
+    if (pu8Tab == pu8) {
+      error_exit(1,"%s: Empty pattern on line %zu\n", pszFile, uLine);
+    }
+    add_pair(pu8, pu8Tab-pu8, pu8Tab+1, pu8Eol-pu8Tab-1);
+  }
+  free(stMap.p);
+}
+
+/*=== Build the Aho-Corasick automaton from the reversed patterns ====
+ * Every node knows the next node for every column, that is, it is
+ * a DFA. When two or more pairs have the same pattern, the first one
+ * is used. The patterns are put in backward, so that the automaton
+ * reading the input backward finds the patterns which begin at the
+ * place it has just read.                                          */
+void build_automaton(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  int32_t *pi32Fail;  /* the failure link of every node              */
+  int32_t *pi32Queue; /* the nodes in breadth-first order            */
+  int32_t  iHead, iTail, iNode, iChild, iFail;
+  uint8_t *pu8Pat;
+  size_t   u, uPair, uCls;
+
+  /*--- Give a column to every byte in the patterns ----------------*/
+  memset(gau16Cls , 0, sizeof(gau16Cls ));
+  memset(gau8Last , 0, sizeof(gau8Last ));
+  for (uPair=0; uPair<guNpair; uPair++) {
+    pu8Pat = gbPair.p + gpPair[uPair].uPatOff;
+    gau8Last[pu8Pat[gpPair[uPair].uPatLen-1]] = 1;
+    for (u=0; u<gpPair[uPair].uPatLen; u++) {gau16Cls[pu8Pat[u]] = 1;}
+  }
+  guNcls = 1;
+  for (u=0; u<256; u++) {
+    if (gau16Cls[u]) {gau16Cls[u] = (uint16_t)guNcls++;}
+  }
+
+  /*--- Make the trie ----------------------------------------------*/
+  giNnode = 0;
+  new_node();
+  for (uPair=0; uPair<guNpair; uPair++) {
+    pu8Pat = gbPair.p + gpPair[uPair].uPatOff;
+    iNode  = 0;
+    for (u=gpPair[uPair].uPatLen; u>0; u--) {
+      uCls = gau16Cls[pu8Pat[u-1]];
+      if (gpi32Next[(size_t)iNode*guNcls+uCls] < 0) {
+        iChild = new_node();
+        gpi32Next[(size_t)iNode*guNcls+uCls] = iChild;
+      }
+      iNode = gpi32Next[(size_t)iNode*guNcls+uCls];
+    }
+    if (gpu32OutLen[iNode] == 0) {
+      gpu32OutLen[iNode]  = (uint32_t)gpPair[uPair].uPatLen;
+      gpi32OutPair[iNode] = (int32_t)uPair;
+    }
+  }
+
+  /*--- Make the failure links and complete the DFA ----------------*/
+  /* (The nodes are visited in breadth-first order, so the failure
+     node of every node has always been completed before it.)       */
+  if ((pi32Fail =malloc(sizeof(int32_t)*(size_t)giNnode)) == NULL ||
+      (pi32Queue=malloc(sizeof(int32_t)*(size_t)giNnode)) == NULL   ) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  iHead = iTail = 0;
+  for (uCls=0; uCls<guNcls; uCls++) {
+    iChild = gpi32Next[uCls];
+    if (iChild < 0) {gpi32Next[uCls] = 0; continue;}
+    pi32Fail[iChild]   = 0;
+    pi32Queue[iTail++] = iChild;
+  }
+  while (iHead < iTail) {
+    iNode = pi32Queue[iHead++];
+    iFail = pi32Fail[iNode];
+    if (gpu32OutLen[iNode] == 0) {
+      gpu32OutLen[iNode]  = gpu32OutLen[iFail];
+      gpi32OutPair[iNode] = gpi32OutPair[iFail];
+    }
+    for (uCls=0; uCls<guNcls; uCls++) {
+      iChild = gpi32Next[(size_t)iNode*guNcls+uCls];
+      if (iChild < 0) {
+        gpi32Next[(size_t)iNode*guNcls+uCls] =
+          gpi32Next[(size_t)iFail*guNcls+uCls];
+        continue;
+      }
+      pi32Fail[iChild]   = gpi32Next[(size_t)iFail*guNcls+uCls];
+      pi32Queue[iTail++] = iChild;
+    }
+  }
+  free(pi32Fail);
+  free(pi32Queue);
+}
+
+/*=== Add a node to the automaton ====================================
+ * [ret] the new node                                               */
+int32_t new_node(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  size_t u;
+
+  /*--- Make the room ----------------------------------------------*/
+  if (giNnode >= giNodeSize) {
+    if (giNodeSize >= INT32_MAX/2) {error_exit(1,"Too many patterns\n");}
+    giNodeSize   = (giNodeSize==0) ? 1024 : giNodeSize*2;
+    gpi32Next    = realloc(gpi32Next   ,
+                           sizeof(int32_t )*(size_t)giNodeSize*guNcls);
+    gpu32OutLen  = realloc(gpu32OutLen , sizeof(uint32_t)*(size_t)giNodeSize);
+    gpi32OutPair = realloc(gpi32OutPair, sizeof(int32_t )*(size_t)giNodeSize);
+    if (gpi32Next==NULL || gpu32OutLen==NULL || gpi32OutPair==NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+
+  /*--- Initialize it ----------------------------------------------*/
+  for (u=0; u<guNcls; u++) {gpi32Next[(size_t)giNnode*guNcls+u] = -1;}
+  gpu32OutLen[giNnode]  = 0;
+  gpi32OutPair[giNnode] = -1;
+  return giNnode++;
+}
+
+/*=== Read the next bytes from the files one after another ===========
+ * [out] pu8Buf : The buffer to store them
+ * [in]  uSize  : The size of the buffer
+ * [ret]        : The number of the bytes read (0 at the end of all)*/
+size_t read_input(uint8_t *pu8Buf, size_t uSize) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iRead;
+
+  while (1) {
+    /*--- Open the next file if no file is open --------------------*/
+    if (giFd < 0) {
+      if (giNfiles == 0) {return 0;}
+      if (strcmp(gppszFiles[0],"-") == 0) {
+        giFd = STDIN_FILENO;
+      } else if ((giFd=open(gppszFiles[0],O_RDONLY)) < 0) {
+        warning("%s: %s\n", gppszFiles[0], strerror(errno));
+        giRet = 1;
+        gppszFiles++; giNfiles--;
+        continue;
+      }
+    }
+    /*--- Read it --------------------------------------------------*/
+    iRead = read(giFd, pu8Buf, uSize);
+    if (iRead > 0) {return (size_t)iRead;}
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      warning("%s: %s\n", gppszFiles[0], strerror(errno));
+      giRet = 1;
+    }
+    /*--- Go to the next file at the end of this one ---------------*/
+    if (giFd != STDIN_FILENO) {close(giFd);}
+    giFd = -1;
+    gppszFiles++; giNfiles--;
+  }
+}
+
+/*=== Substitute the files as one stream =============================
+ * No pattern has <0x0A>, so a match never goes over a line. The
+ * input is substituted every block of the complete lines.          */
+void subst_stream(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  buf_t    stIn, stOut;
+  size_t   uRead, uLines;
+
+  /*--- Prepare the buffers ----------------------------------------*/
+  memset(&stIn , 0, sizeof(stIn ));
+  memset(&stOut, 0, sizeof(stOut));
+  buf_add(&stIn, NULL, IBUF-1);
+  stIn.n = 0;
+
+  /*--- Substitute every block of the complete lines ---------------*/
+  while (1) {
+    if (stIn.n+1 >= stIn.uSize) {buf_add(&stIn, NULL, 1); stIn.n--;}
+    if ((uRead=read_input(stIn.p+stIn.n, stIn.uSize-1-stIn.n)) == 0) {break;}
+    stIn.n += uRead;
+    /* (the bytes before the new ones have no <0x0A>) */
+    for (uLines=stIn.n; uLines>stIn.n-uRead; uLines--) {
+      if (stIn.p[uLines-1] == '\n') {break;}
+    }
+    if (uLines == stIn.n-uRead) {continue;}
+    emit(stIn.p, uLines, &stOut);
+    memmove(stIn.p, stIn.p+uLines, stIn.n-uLines);
+    stIn.n -= uLines;
+  }
+
+  /*--- Substitute the last line -----------------------------------*/
+  emit(stIn.p, stIn.n, &stOut);
+}
+
+/*=== Substitute the bytes and write them ============================
+ * [in] pu8   : the bytes
+ *      uLen  : the size of them
+ *      pbOut : the buffer to write them through                    */
+void emit(uint8_t *pu8, size_t uLen, buf_t *pbOut) {
+  pbOut->n = 0;
+  if (subst_bytes(pu8, uLen, pbOut) > 0) {
+    write_all(pbOut->p, pbOut->n);
+  } else {
+    write_all(pu8, uLen);
+  }
+}
+
+/*=== Substitute the bytes by the automaton ==========================
+ * The automaton reads the bytes backward and notes the longest
+ * pattern which begins at every place. Then, the places are taken
+ * from the head, skipping the ones in the patterns taken before, as
+ * the script does. No byte is read twice however the patterns
+ * overlap.
+ * The result is made in the buffer only when something has been
+ * substituted, to let the caller write the input as it is otherwise.
+ * [in]  pu8   : the bytes
+ *       uLen  : the size of them
+ * [out] pbOut : the buffer to append the result to
+ * [ret]         the number of the substitutions                    */
+size_t subst_bytes(uint8_t *pu8, size_t uLen, buf_t *pbOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8Copy;  /* the bytes from here are not copied yet */
+  hit_t         *pHit, stHit;
+  size_t         i, uCnt;
+  int32_t        iNode;
+
+  /*--- Find the longest pattern at every place backward -----------*/
+  gbHit.n = 0;
+  iNode   = 0;
+  for (i=uLen; i>0; i--) {
+    /* skip the bytes which can't end a pattern at the root */
+    if (iNode == 0) {
+      while (i>0 && ! gau8Last[pu8[i-1]]) {i--;}
+      if (i == 0) {break;}
+    }
+    iNode = gpi32Next[(size_t)iNode*guNcls+gau16Cls[pu8[i-1]]];
+    if (gpu32OutLen[iNode] > 0) {
+      stHit.uPos  = i-1;
+      stHit.iPair = gpi32OutPair[iNode];
+      buf_add(&gbHit, &stHit, sizeof(stHit));
+    }
+  }
+
+  /*--- Replace them from the head ---------------------------------*/
+  pu8Copy = pu8;
+  uCnt    = 0;
+  for (pHit=(hit_t*)(gbHit.p+gbHit.n); (uint8_t*)pHit>gbHit.p; ) {
+    pHit--;
+    if (pu8+pHit->uPos < pu8Copy) {continue;}
+    buf_add(pbOut, pu8Copy, pu8+pHit->uPos-pu8Copy);
+    buf_add(pbOut, gbPair.p+gpPair[pHit->iPair].uRepOff,
+            gpPair[pHit->iPair].uRepLen                 );
+    pu8Copy = pu8 + pHit->uPos + gpPair[pHit->iPair].uPatLen;
+    uCnt++;
+  }
+
+  /*--- Copy the rest ----------------------------------------------*/
+  if (uCnt > 0) {buf_add(pbOut, pu8Copy, pu8+uLen-pu8Copy);}
+  return uCnt;
+}
+
+/*=== Append bytes to a buffer =======================================
+ * [in,out] pb   : the buffer
+ * [in]     pv   : the bytes (NULL means just making the room)
+ *          uLen : the number of them                               */
+void buf_add(buf_t *pb, const void *pv, size_t uLen) {
+  if (pb->n+uLen+1 > pb->uSize) {
+    pb->uSize = (pb->uSize==0) ? 4096 : pb->uSize;
+    while (pb->n+uLen+1 > pb->uSize) {pb->uSize *= 2;}
+    if ((pb->p=realloc(pb->p, pb->uSize)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  if (pv != NULL) {memcpy(pb->p+pb->n, pv, uLen);}
+  pb->n += uLen;
+}
+
+/*=== Write bytes to the stdout ======================================
+ * [in] pv   : the bytes
+ *      uLen : the number of them                                   */
+void write_all(const void *pv, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc = pv;
+  ssize_t     iWritten;
+
+  /*--- Write them -------------------------------------------------*/
+  while (uLen > 0) {
+    iWritten = write(STDOUT_FILENO, pc, uLen);
+    if (iWritten < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write(): %s\n", strerror(errno));
+    }
+    pc   += iWritten;
+    uLen -= (size_t)iWritten;
+  }
+}
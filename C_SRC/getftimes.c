@@ -3,18 +3,44 @@
 # GETFTIMES - Get Timestamps of Each File
 #
 # USAGE   : getftimes [options] file [file ...]
+#           getftimes [options] -i|-0 [file ...]
 # Options : -l ... Prints the timestamps in ISO8601 format
 #           -u ... Prints the timestamps in UNIX time
+#           -n ... Prints the timestamps in nanoseconds (".nnnnnnnnn"
+#                  is attached to the seconds)
+#           -b ... Also prints the birth time as the 4th timestamp
+#                  ("-" when the filesystem doesn't provide it)
+#           -j n . Gets the timestamps of n files in parallel by n
+#                  threads (default: 1). The output order is the same
+#                  as the arguments anyway.
+#           -r ... Walks into the directories recursively and also
+#                  prints all files in them (symbolic links in the tree
+#                  are not followed)
+#           -i ... Also reads the filenames from the standard input, one
+#                  per line, after the ones in the arguments
+#           -0 ... Same as -i but the filenames are delimited by NUL
+#                  (for "find -print0")
+#           -w ... Watch mode. After printing the timestamps of all the
+#                  files, keeps watching them and prints the line again
+#                  every time one of them has been changed until killed.
+#                  The files are watched through their directories by
+#                  name, so a file replaced by rename() or deleted and
+#                  made again is still watched. With -r, files created
+#                  in the directories later are also watched. (Linux
+#                  only)
 #           -- ... Finishes parsing arguments as options
 # Output  : * Print the following 4 fields by each file
 #             <atime> <mtime> <ctime> <filename>
+#             (<atime> <mtime> <ctime> <btime> <filename> with -b)
 #           * The format of each time is either <YYYYMMDDhhmmss> or
 #             <YYYY-MM-DDThh:mm:ss+hhmm>.
 #           * The latter format is set by -l option.
 # Retuen  : Return 0 only when timestamps of all files were able to be
 #           gotten.
 #
-# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lpthread
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOTHREAD -o __CMDNAME__ __SRCNAME__
 #
 # Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2020-03-19
 #
@@ -34,31 +60,155 @@
 ####################################################################*/
 
 /*=== Initial Setting ==============================================*/
+#if defined(__linux) || defined(__linux__)
+  /* This definition is for statx() and getdelim() on Linux */
+  #define _GNU_SOURCE
+#endif
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#ifndef NOTHREAD
+  #include <pthread.h>
+#endif
+#if defined(__linux__) && defined(STATX_BTIME)
+  #define HAVE_STATX
+#endif
+#if defined(__linux__)
+  #include <sys/syscall.h>
+  #include <sys/inotify.h>
+  #define HAVE_INOTIFY
+  #if defined(SYS_getdents64)
+    #define HAVE_GETDENTS64
+    struct linux_dirent64 {
+      unsigned long long d_ino;
+      long long          d_off;
+      unsigned short     d_reclen;
+      unsigned char      d_type;
+      char               d_name[];
+    };
+  #endif
+#endif
+
+#define MAX_THREADS 256
+#define BATCH_NUM   4096  /* files to hand the threads at a time (-j)   */
+#define DENTS_BUF   32768 /* buffer size for reading a directory        */
+#define PATH_BUF    65536 /* max length of a path in the recursive walk */
+#define TCACHE_NUM  256   /* slots of the rendered timestamp cache      */
+#define WATCH_BUF   65536 /* buffer size for reading inotify events     */
+#define WATCH_DEDUP 256   /* paths remembered not to print twice at once*/
+/* (IN_ACCESS is not watched since reading the directories causes it) */
+#define WATCH_MASK  (IN_MODIFY|IN_ATTRIB|IN_CLOSE_WRITE|                \
+                     IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO|     \
+                     IN_DELETE_SELF|IN_MOVE_SELF|IN_ONLYDIR           )
+#define WATCH_DENT  (IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO)
+#define WT_ALL      1     /* (watch) print all the files in it (-r)     */
+#define WT_SELF     2     /* (watch) print itself when its entries change*/
+
+typedef struct {
+  struct timespec tsA, tsM, tsC, tsB; /* tsB.tv_nsec<0 means unknown */
+  int   iOk;                          /* 1:gotten 0:failed -1:not yet */
+} ftimes;
 
 char* gpszCmdname;
+int   giFmttype;   /* 0:YYYYMMDDhhmmss 1:ISO8601 2:UnixTime */
+int   giNsec;      /* 1 when -n option is set               */
+int   giBirth;     /* 1 when -b option is set               */
+int   giRecurse;   /* 1 when -r option is set               */
+int   giNthread;   /* The number of threads (-j)            */
+int   giNerror;    /* The number of error to get timestamps */
+int   giWatch;     /* 1 when -w option is set               */
+#ifdef HAVE_INOTIFY
+  typedef struct {
+    char *pszName;   /* the name of a file in the watched directory   */
+    char *pszPath;   /* the path of it given by the user              */
+  } wname;
+  typedef struct {
+    char  *pszPath;  /* the watched directory (NULL: unused slot)     */
+    int    iMode;    /* WT_ALL and/or WT_SELF (or 0)                  */
+    wname *pwn;      /* the files given by the user in it             */
+    int    iNwn;     /* the number of them                            */
+    dev_t  dev;      /* the device and the inode of the directory     */
+    ino_t  ino;      /*   (to know whether the path still means it)   */
+  } watched;
+  int      giInfd;   /* the inotify fd                                 */
+  watched *gpwt;     /* the watched paths indexed by watch descriptors */
+  int      giNwt;    /* the size of gpwt                               */
+#endif
+#ifndef NOTHREAD
+  char          **gppszPath;  /* files to get the timestamps of        */
+  ftimes         *gpft;       /* the timestamps of them                */
+  int             giNfile;    /* the number of them                    */
+  int             giNext;     /* the next file for a thread to take    */
+  pthread_mutex_t gmtx = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t  gcnd = PTHREAD_COND_INITIALIZER;
+#endif
+
+void take_file(char *pszPath);
+void put_file(int iDirfd, const char *pszName, const char *pszPath);
+void flush_files(void);
+void walk_top(char *pszPath);
+void walk_dir(int iFd, char *pszPath, size_t uLen);
+void read_filenames(int iDelim);
+void track_file(const char *pszPath);
+int  add_watch(const char *pszPath, int iMode);
+void watch_files(void);
+#ifdef HAVE_INOTIFY
+  void put_changed_file(const char *pszPath, char **apszDone, int *piNdone);
+  int  cmp_wname(const void *pv1, const void *pv2);
+#endif
+int  get_ftimes(int iDirfd, const char *pszName, ftimes *pft);
+void print_ftimes(ftimes *pft, const char *pszPath);
+void format_time(char *pszBuf, struct timespec *pts);
+#ifndef NOTHREAD
+  void *ftimes_worker(void *pv);
+#endif
 
 /*=== Define the functions for printing usage and error ============*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
     "Usage   : %s [options] file [file ...]\n"
+    "          %s [options] -i|-0 [file ...]\n"
     "Options : -l ... Prints the timestamps in ISO8601 format\n"
     "          -u ... Prints the timestamps in UNIX time\n"
+    "          -n ... Prints the timestamps in nanoseconds (\".nnnnnnnnn\"\n"
+    "                 is attached to the seconds)\n"
+    "          -b ... Also prints the birth time as the 4th timestamp\n"
+    "                 (\"-\" when the filesystem doesn't provide it)\n"
+    "          -j n . Gets the timestamps of n files in parallel by n\n"
+    "                 threads (default: 1). The output order is the same\n"
+    "                 as the arguments anyway.\n"
+    "          -r ... Walks into the directories recursively and also\n"
+    "                 prints all files in them (symbolic links in the tree\n"
+    "                 are not followed)\n"
+    "          -i ... Also reads the filenames from the standard input, one\n"
+    "                 per line, after the ones in the arguments\n"
+    "          -0 ... Same as -i but the filenames are delimited by NUL\n"
+    "                 (for \"find -print0\")\n"
+    "          -w ... Watch mode. After printing the timestamps of all the\n"
+    "                 files, keeps watching them and prints the line again\n"
+    "                 every time one of them has been changed until killed.\n"
+    "                 The files are watched through their directories by\n"
+    "                 name, so a file replaced by rename() or deleted and\n"
+    "                 made again is still watched. With -r, files created\n"
+    "                 in the directories later are also watched. (Linux\n"
+    "                 only)\n"
     "          -- ... Finishes parsing arguments as options\n"
     "Output  : * Print the following 4 fields by each file\n"
     "            <atime> <mtime> <ctime> <filename>\n"
+    "            (<atime> <mtime> <ctime> <btime> <filename> with -b)\n"
     "          * The format of each time is either <YYYYMMDDhhmmss> or\n"
     "            <YYYY-MM-DDThh:mm:ss+hhmm>.\n"
     "          * The latter format is set by -l option.\n"
     "Retuen  : Return 0 only when timestamps of all files were able to be\n"
     "          gotten. \n"
-    "Version : 2020-03-19 12:18:14 JST\n"
+    "Version : 2026-10-19 18:27:40 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -66,9 +216,17 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/misc-tools\n"
-    ,gpszCmdname);
+    ,gpszCmdname,gpszCmdname);
   exit(1);
 }
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
 void error_exit(int iErrno, const char* szFormat, ...) {
   va_list va;
   va_start(va, szFormat);
@@ -86,12 +244,8 @@ void error_exit(int iErrno, const char* szFormat, ...) {
 int main(int argc, char *argv[]){
 
   /*=== Initial Setting ============================================*/
-  struct stat stFileinfo;
-  struct tm*  pstTm;
-  char        szAtim[256], szMtim[256], szCtim[256], szFmt[256], szDummy[256];
-  int         iFmttype;    /* Long option switch */
   int         i;           /* It means the argument position */
-  int         iNerror = 0; /* The number of error to get timestamps */
+  int         iDelim;      /* Delimiter of filenames on stdin (-1:none) */
 
   gpszCmdname = argv[0];
   for (i=0; *(gpszCmdname+i)!='\0'; i++) {
@@ -103,16 +257,42 @@ int main(int argc, char *argv[]){
 
   /*=== Parse options ==============================================*/
   /*--- initialize option parameters -------------------------------*/
-  iFmttype = 0; /* 0:YYYYMMDDhhmmss 1:ISO8601 2:UnixTime */
+  giFmttype = 0; /* 0:YYYYMMDDhhmmss 1:ISO8601 2:UnixTime */
+  giNsec    = 0;
+  giBirth   = 0;
+  giRecurse = 0;
+  giNthread = 1;
+  giNerror  = 0;
+  giWatch   = 0;
+  iDelim    = -1;
   /*--- get them ---------------------------------------------------*/
   for (i=1; i<argc; i++) {
     if        (strcmp (argv[i], "--"  )==0) {
       i++;
       break;
     } else if (strcmp (argv[i], "-l"  )==0) {
-      iFmttype = 1;
+      giFmttype = 1;
     } else if (strcmp (argv[i], "-u"  )==0) {
-      iFmttype = 2;
+      giFmttype = 2;
+    } else if (strcmp (argv[i], "-n"  )==0) {
+      giNsec    = 1;
+    } else if (strcmp (argv[i], "-b"  )==0) {
+      giBirth   = 1;
+    } else if (strcmp (argv[i], "-j"  )==0) {
+      i++;
+      if (i >= argc                           ) {print_usage_and_exit();}
+      if (sscanf(argv[i], "%d",&giNthread) !=1) {print_usage_and_exit();}
+      if (giNthread<1||giNthread>MAX_THREADS  ) {print_usage_and_exit();}
+    } else if (strcmp (argv[i], "-r"  )==0) {
+      giRecurse = 1;
+    } else if (strcmp (argv[i], "-i"  )==0) {
+      iDelim    = '\n';
+    } else if (strcmp (argv[i], "-0"  )==0) {
+      iDelim    = '\0';
+#ifdef HAVE_INOTIFY
+    } else if (strcmp (argv[i], "-w"  )==0) {
+      giWatch   = 1;
+#endif
     } else if (strncmp(argv[i], "-" ,1)==0) {
       print_usage_and_exit();
     } else {
@@ -120,39 +300,700 @@ int main(int argc, char *argv[]){
     }
   }
   /*--- print the usage if no filename has given -------------------*/
-  if (i >= argc) { print_usage_and_exit(); }
-
-  /*=== Swtich to the long format mode if -l option has been set ===*/
-  switch (iFmttype) {
-    case  0: strcpy(szFmt  ,"%Y%m%d%H%M%S"       );
-             strcpy(szDummy,"%-14s %-14s %-14s " );
-             break;
-    case  1: strcpy(szFmt  ,"%Y-%m-%dT%H:%M:%S%z");
-             strcpy(szDummy,"%-24s %-24s %-24s " );
-             break;
-    case  2: strcpy(szFmt  ,"%s"                 );
-             strcpy(szDummy,"%-10s %-10s %-10s " );
-             break;
-    default: error_exit(1, "Unexpected Error!\n");
+  if (i >= argc && iDelim < 0) { print_usage_and_exit(); }
+#ifdef NOTHREAD
+  giNthread = 1;
+#endif
+
+#ifdef HAVE_INOTIFY
+  if (giWatch) {
+    if ((giInfd=inotify_init1(IN_CLOEXEC)) < 0) {
+      error_exit(errno,"inotify_init1(): %s\n", strerror(errno));
+    }
   }
+#endif
 
   /*=== Main loop ==================================================*/
-  for (   ; i<argc; i++) {
-    if (stat(argv[i],&stFileinfo)==0) {
-      pstTm = localtime(&stFileinfo.st_atime); /* Not use st_*tim.tv_sec for */
-      strftime(szAtim, 256, szFmt, pstTm);     /* compatibility with earlier */
-      pstTm = localtime(&stFileinfo.st_mtime); /* versions */
-      strftime(szMtim, 256, szFmt, pstTm);
-      pstTm = localtime(&stFileinfo.st_ctime);
-      strftime(szCtim, 256, szFmt, pstTm);
-      printf("%s %s %s ",szAtim,szMtim,szCtim);
+  for (   ; i<argc; i++) {take_file(argv[i]);}
+  if (iDelim >= 0) {read_filenames(iDelim);}
+  flush_files();
+
+  /*=== Watch the files (-w) =======================================*/
+  if (giWatch) {watch_files();}
+
+  /*=== Finish =====================================================*/
+  return (giNerror==0) ? 0 : 1;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Get and print the timestamps of a file given by the user =======
+ * [in] pszPath : The file                                          */
+void take_file(char *pszPath) {
+  if (giWatch  ) {track_file(pszPath);              }
+  if (giRecurse) {walk_top(pszPath);                }
+  else           {put_file(AT_FDCWD,pszPath,pszPath);}
+}
+
+/*=== Get and print the timestamps of a file =========================
+ * In the serial mode, the timestamps are gotten and printed at once.
+ * In the parallel mode (-j), the file is queued and the queue is
+ * processed by the threads when it gets full.
+ * [in] iDirfd  : The directory fd which pszName is relative to
+ *      pszName : The filename to get the timestamps by
+ *      pszPath : The filename to print                             */
+void put_file(int iDirfd, const char *pszName, const char *pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  ftimes ft;
+
+  /*--- Serial mode ------------------------------------------------*/
+  if (giNthread <= 1) {
+    if (get_ftimes(iDirfd,pszName,&ft) != 0) {giNerror++;}
+    print_ftimes(&ft, pszPath);
+    return;
+  }
+
+#ifndef NOTHREAD
+  /*--- Parallel mode ----------------------------------------------*/
+  /* The directory fds will have been closed by the time the threads
+   * take the files, so they are queued with the whole path.        */
+  if (gppszPath == NULL) {
+    if ((gppszPath=malloc(sizeof(char*)*BATCH_NUM)) == NULL) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+    if ((gpft     =malloc(sizeof(ftimes)*BATCH_NUM)) == NULL) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+    giNfile = 0;
+  }
+  if ((gppszPath[giNfile]=strdup(pszPath)) == NULL) {
+    error_exit(errno,"strdup(): %s\n", strerror(errno));
+  }
+  giNfile++;
+  if (giNfile >= BATCH_NUM) {flush_files();}
+#endif
+}
+
+/*=== Get and print the timestamps of the queued files by threads ====
+ * [in] gppszPath, giNfile : (must be defined as global vars)       */
+void flush_files(void) {
+#ifndef NOTHREAD
+
+  /*--- Variables --------------------------------------------------*/
+  pthread_t athr[MAX_THREADS];
+  int       iNthread;
+  int       i;
+
+  if (giNthread <= 1 || gppszPath == NULL || giNfile == 0) {return;}
+
+  /*--- Start the threads ------------------------------------------*/
+  iNthread = (giNthread < giNfile) ? giNthread : giNfile;
+  giNext   = 0;
+  for (i=0; i<giNfile; i++) {gpft[i].iOk = -1;}
+  for (i=0; i<iNthread; i++) {
+    if ((errno=pthread_create(&athr[i],NULL,ftimes_worker,NULL)) != 0) {
+      error_exit(errno,"pthread_create(): %s\n", strerror(errno));
+    }
+  }
+
+  /*--- Print the results in order as they come --------------------*/
+  for (i=0; i<giNfile; i++) {
+    pthread_mutex_lock(&gmtx);
+    while (gpft[i].iOk < 0) {pthread_cond_wait(&gcnd,&gmtx);}
+    pthread_mutex_unlock(&gmtx);
+    if (gpft[i].iOk == 0) {giNerror++;}
+    print_ftimes(&gpft[i], gppszPath[i]);
+    free(gppszPath[i]);
+  }
+  for (i=0; i<iNthread; i++) {pthread_join(athr[i],NULL);}
+  giNfile = 0;
+#endif
+}
+
+/*=== Print a file given by the user and walk into it if a directory =
+ * [in] pszPath : The file                                          */
+void walk_top(char *pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char *pszBuf = NULL;
+  size_t      uLen;
+  int         iFd;
+
+  /*--- Print the file itself --------------------------------------*/
+  put_file(AT_FDCWD, pszPath, pszPath);
+
+  /*--- Walk into it if it is a directory --------------------------*/
+  iFd = open(pszPath, O_RDONLY|O_DIRECTORY);
+  if (iFd < 0) {
+    if (errno != ENOTDIR && errno != ENOENT) {
+      warning("%s: %s\n", pszPath, strerror(errno));
+      giNerror++;
+    }
+    return;
+  }
+  if (giWatch) {(void)add_watch(pszPath,WT_ALL);}
+  uLen = strlen(pszPath);
+  if (uLen >= PATH_BUF) {
+    warning("%s: %s\n", pszPath, strerror(ENAMETOOLONG));
+    giNerror++;
+    close(iFd);
+    return;
+  }
+  if (pszBuf==NULL && (pszBuf=malloc(PATH_BUF))==NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  memcpy(pszBuf, pszPath, uLen+1);
+  walk_dir(iFd, pszBuf, uLen); /* iFd is closed in it */
+}
+
+/*=== Print all files in a directory recursively =====================
+ * [in] iFd     : The directory (closed before returning)
+ *      pszPath : The path of the directory (PATH_BUF bytes buffer;
+ *                it is used as a work area but restored on return)
+ *      uLen    : The length of pszPath                             */
+void walk_dir(int iFd, char *pszPath, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  const char *pszName;
+  size_t      uNlen, uSep;
+  int         iIsdir;
+  int         iSubfd;
+#ifdef HAVE_GETDENTS64
+  struct linux_dirent64 *pde;
+  char       *pcBuf;
+  long        lRead, lPos;
+#else
+  struct dirent *pde;
+  DIR        *pdir;
+#endif
+
+  /*--- Prepare the reading ----------------------------------------*/
+  uSep = (uLen>0 && pszPath[uLen-1]=='/') ? 0 : 1;
+#ifdef HAVE_GETDENTS64
+  if ((pcBuf=malloc(DENTS_BUF)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  while ((lRead=syscall(SYS_getdents64,iFd,pcBuf,DENTS_BUF)) > 0) {
+    for (lPos=0; lPos<lRead; lPos+=pde->d_reclen) {
+      pde = (struct linux_dirent64 *)(pcBuf+lPos);
+#else
+  if ((pdir=fdopendir(iFd)) == NULL) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    giNerror++;
+    close(iFd);
+    return;
+  }
+  while (errno=0, (pde=readdir(pdir)) != NULL) {
+    {
+#endif
+      /*--- Skip "." and ".." --------------------------------------*/
+      pszName = pde->d_name;
+      if (pszName[0]=='.' && (pszName[1]=='\0' ||
+          (pszName[1]=='.' &&  pszName[2]=='\0'))) {continue;}
+
+      /*--- Make the path ------------------------------------------*/
+      uNlen = strlen(pszName);
+      if (uLen+uSep+uNlen >= PATH_BUF) {
+        warning("%s/%s: %s\n", pszPath, pszName, strerror(ENAMETOOLONG));
+        giNerror++;
+        continue;
+      }
+      if (uSep) {pszPath[uLen]='/';}
+      memcpy(pszPath+uLen+uSep, pszName, uNlen+1);
+
+      /*--- Print it -----------------------------------------------*/
+      put_file(iFd, pszName, pszPath);
+
+      /*--- Walk into it if it is a directory ----------------------*/
+      #ifdef DT_DIR
+        iIsdir = (pde->d_type==DT_DIR);
+        if (pde->d_type == DT_UNKNOWN)
+      #endif
+      {
+        iIsdir = (fstatat(iFd,pszName,&stInfo,AT_SYMLINK_NOFOLLOW)==0 &&
+                  S_ISDIR(stInfo.st_mode)                             );
+      }
+      if (iIsdir) {
+        iSubfd = openat(iFd, pszName, O_RDONLY|O_DIRECTORY|O_NOFOLLOW);
+        if (iSubfd < 0) {
+          warning("%s: %s\n", pszPath, strerror(errno));
+          giNerror++;
+        } else {
+          if (giWatch) {(void)add_watch(pszPath,WT_ALL);}
+          walk_dir(iSubfd, pszPath, uLen+uSep+uNlen);
+        }
+      }
+      pszPath[uLen] = '\0';
+    }
+  }
+
+  /*--- Finish -----------------------------------------------------*/
+#ifdef HAVE_GETDENTS64
+  if (lRead < 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    giNerror++;
+  }
+  free(pcBuf);
+  close(iFd);
+#else
+  if (errno != 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    giNerror++;
+  }
+  closedir(pdir);
+#endif
+}
+
+/*=== Print the files whose names are given via the standard input ===
+ * [in] iDelim : The delimiter of the filenames ('\n' or '\0')      */
+void read_filenames(int iDelim) {
+
+  /*--- Variables --------------------------------------------------*/
+  char   *pszLine = NULL;
+  size_t  uSize   = 0;
+  ssize_t iLen;
+
+  /*--- Read and print them one by one -----------------------------*/
+  while ((iLen=getdelim(&pszLine,&uSize,iDelim,stdin)) >= 0) {
+    if (iLen>0 && pszLine[iLen-1]==(char)iDelim) {pszLine[--iLen]='\0';}
+    if (iLen == 0) {continue;}
+    take_file(pszLine);
+  }
+  if (ferror(stdin)) {
+    error_exit(errno,"getdelim(): %s\n", strerror(errno));
+  }
+  free(pszLine);
+}
+
+/*=== Start watching a file given by the user (-w) ==================
+ * The file is watched through its directory by its name so as to
+ * keep watching it even after being replaced. A directory given
+ * without -r is also watched itself to print it when its entries
+ * change (with -r, walk_top() watches it).
+ * [in] pszPath : The file                                          */
+void track_file(const char *pszPath) {
+#ifdef HAVE_INOTIFY
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  watched    *pwt;
+  wname      *pwn;
+  char       *pszDir;
+  size_t      uLen, uBase;
+  int         iWd;
+
+  /*--- Watch a directory given without -r itself ------------------*/
+  if (!giRecurse && stat(pszPath,&stInfo)==0 && S_ISDIR(stInfo.st_mode)) {
+    (void)add_watch(pszPath, WT_SELF);
+  }
+
+  /*--- Split the path into the directory and the name -------------*/
+  uLen = strlen(pszPath);
+  while (uLen>1 && pszPath[uLen-1]=='/') {uLen--;}
+  for (uBase=uLen; uBase>0 && pszPath[uBase-1]!='/'; uBase--);
+  if (uBase==uLen                                              ||
+      (uLen-uBase==1 && pszPath[uBase]=='.')                   ||
+      (uLen-uBase==2 && pszPath[uBase]=='.' && pszPath[uBase+1]=='.')) {
+    return; /* "/", "." or ".." can't be replaced */
+  }
+  if ((pszDir=malloc(uBase+2)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  if      (uBase == 0) {strcpy(pszDir, "."); }
+  else if (uBase == 1) {strcpy(pszDir, "/"); }
+  else                 {memcpy(pszDir, pszPath, uBase-1);
+                        pszDir[uBase-1] = '\0';}
+
+  /*--- Watch the directory and remember the name in it ------------*/
+  iWd = add_watch(pszDir, 0);
+  free(pszDir);
+  if (iWd < 0) {return;}
+  pwt = &gpwt[iWd];
+  if ((pwn=realloc(pwt->pwn,sizeof(wname)*(pwt->iNwn+1))) == NULL) {
+    error_exit(errno,"realloc(): %s\n", strerror(errno));
+  }
+  pwt->pwn = pwn;
+  pwn     += pwt->iNwn;
+  if ((pwn->pszName=strndup(pszPath+uBase,uLen-uBase)) == NULL ||
+      (pwn->pszPath=strdup (pszPath               )) == NULL   ) {
+    error_exit(errno,"strdup(): %s\n", strerror(errno));
+  }
+  pwt->iNwn++;
+#endif
+}
+
+/*=== Start watching a directory (-w) ================================
+ * [in] pszPath : The directory
+ *      iMode   : WT_ALL  : All the files in it are printed (-r)
+ *                WT_SELF : It is printed when its entries change
+ *                0       : Only the files registered by track_file()
+ * [ret] The watch descriptor (-1 when failed)                      */
+int add_watch(const char *pszPath, int iMode) {
+#ifdef HAVE_INOTIFY
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  watched    *pwt;
+  int         iWd, iNew;
+
+  /*--- Add the watch ----------------------------------------------*/
+  if ((iWd=inotify_add_watch(giInfd,pszPath,WATCH_MASK)) < 0) {
+    warning("%s: inotify_add_watch(): %s\n", pszPath, strerror(errno));
+    giNerror++;
+    return -1;
+  }
+
+  /*--- Remember the path for the watch descriptor -----------------*/
+  if (iWd >= giNwt) {
+    iNew = (giNwt==0) ? 1024 : giNwt;
+    while (iWd >= iNew) {iNew *= 2;}
+    if ((pwt=realloc(gpwt,sizeof(watched)*iNew)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+    memset(pwt+giNwt, 0, sizeof(watched)*(iNew-giNwt));
+    gpwt  = pwt;
+    giNwt = iNew;
+  }
+  pwt = &gpwt[iWd];
+  if (pwt->pszPath != NULL) {
+    /* The same directory has been watched already (e.g. given twice,
+     * as the directory of a file, or moved in the tree by -r). The
+     * latest path given with -r is preferred since the files in it
+     * are printed with it.                                         */
+    pwt->iMode |= iMode;
+    if (!(iMode & WT_ALL)) {return iWd;}
+    free(pwt->pszPath);
+  }
+  if ((pwt->pszPath=strdup(pszPath)) == NULL) {
+    error_exit(errno,"strdup(): %s\n", strerror(errno));
+  }
+  pwt->iMode |= iMode;
+  if (stat(pszPath,&stInfo) == 0) {pwt->dev=stInfo.st_dev; pwt->ino=stInfo.st_ino;}
+  return iWd;
+#else
+  return -1;
+#endif
+}
+
+/*=== Print the timestamps of the files again when changed (-w) ======
+ * It never returns. The files to watch have to be registered by
+ * add_watch() in advance.                                          */
+void watch_files(void) {
+#ifdef HAVE_INOTIFY
+
+  /*--- Variables --------------------------------------------------*/
+  struct inotify_event *pev;
+  struct stat stInfo;
+  watched *pwt;
+  wname   *pwn, stWn;
+  char    *pcBuf;
+  char    *apszDone[WATCH_DEDUP];  /* paths already printed this time */
+  char    *pszPath;
+  ssize_t  iLen;
+  size_t   uLen;
+  int      iNdone;
+  int      i, j, iDent;
+
+  /*--- Prepare ----------------------------------------------------*/
+  if ((pcBuf=malloc(WATCH_BUF)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  if ((pszPath=malloc(PATH_BUF)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  for (i=0; i<giNwt; i++) { /* to find the names by bsearch() */
+    if (gpwt[i].iNwn > 1) {
+      qsort(gpwt[i].pwn, gpwt[i].iNwn, sizeof(wname), cmp_wname);
+    }
+  }
+  fflush(stdout);
+
+  /*--- Main loop --------------------------------------------------*/
+  while (1) {
+    if ((iLen=read(giInfd,pcBuf,WATCH_BUF)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"read() on inotify: %s\n", strerror(errno));
+    }
+    iNdone = 0;
+    for (i=0; i<iLen; i+=sizeof(struct inotify_event)+pev->len) {
+      pev = (struct inotify_event *)(pcBuf+i);
+      /*--- Handle the special events ------------------------------*/
+      if (pev->mask & IN_Q_OVERFLOW) {
+        warning("Too many changes at once. Some of them were lost.\n");
+        continue;
+      }
+      if (pev->wd<0 || pev->wd>=giNwt || gpwt[pev->wd].pszPath==NULL) {
+        continue;
+      }
+      pwt = &gpwt[pev->wd];
+      if (pev->mask & IN_IGNORED) {
+        /* The directory has gone. The files in it have been printed
+         * on the events of their directories by their names.       */
+        for (j=0; j<pwt->iNwn; j++) {
+          free(pwt->pwn[j].pszName);
+          free(pwt->pwn[j].pszPath);
+        }
+        free(pwt->pwn);
+        free(pwt->pszPath);
+        memset(pwt, 0, sizeof(watched));
+        continue;
+      }
+      if (pev->mask & IN_DELETE_SELF) {continue;} /* IN_IGNORED follows */
+      if (pev->mask & IN_MOVE_SELF  ) {
+        /* Stop watching it unless it has been watched by the new name
+         * already (moved in the tree by -r), because the path no
+         * longer means the directory.                              */
+        if (stat(pwt->pszPath,&stInfo) != 0 ||
+            stInfo.st_dev != pwt->dev || stInfo.st_ino != pwt->ino) {
+          (void)inotify_rm_watch(giInfd, pev->wd);
+        }
+        continue;
+      }
+      iDent = ((pev->mask & WATCH_DENT) != 0);
+      /*--- The directory itself -----------------------------------*/
+      if (pev->len == 0) {
+        if (pwt->iMode) {put_changed_file(pwt->pszPath,apszDone,&iNdone);}
+        continue;
+      }
+      /*--- A file in a directory being watched with -r ------------*/
+      if (pwt->iMode & WT_ALL) {
+        uLen = strlen(pwt->pszPath);
+        snprintf(pszPath, PATH_BUF, "%s%s%s", pwt->pszPath,
+                 (uLen>0 && pwt->pszPath[uLen-1]=='/') ? "" : "/",
+                 pev->name);
+        if ((pev->mask & (IN_CREATE|IN_MOVED_TO)) && (pev->mask & IN_ISDIR)) {
+          walk_top(pszPath); /* made or moved in */
+        } else {
+          put_changed_file(pszPath, apszDone, &iNdone);
+        }
+        if (iDent) {put_changed_file(pwt->pszPath,apszDone,&iNdone);}
+        continue;
+      }
+      /*--- A file given by the user -------------------------------*/
+      stWn.pszName = pev->name;
+      pwn = (pwt->iNwn == 0) ? NULL
+                             : bsearch(&stWn, pwt->pwn, pwt->iNwn,
+                                       sizeof(wname), cmp_wname);
+      if (pwn != NULL) {
+        if ((pev->mask & (IN_CREATE|IN_MOVED_TO)) && (pev->mask & IN_ISDIR)) {
+          /* made again as a directory: watch the new one */
+          if (giRecurse) {walk_top(pwn->pszPath);                    }
+          else           {(void)add_watch(pwn->pszPath, WT_SELF);
+                          put_changed_file(pwn->pszPath,apszDone,&iNdone);}
+        } else {
+          put_changed_file(pwn->pszPath, apszDone, &iNdone);
+        }
+      }
+      /*--- The directory given by the user whose entries changed --*/
+      if (iDent && (pwt->iMode & WT_SELF)) {
+        put_changed_file(pwt->pszPath, apszDone, &iNdone);
+      }
+    }
+    /*--- Flush the lines at every read() ----------------------------*/
+    flush_files();
+    fflush(stdout);
+    for (j=0; j<iNdone; j++) {free(apszDone[j]);}
+  }
+#endif
+}
+
+#ifdef HAVE_INOTIFY
+/*=== Print a changed file unless printed already at this time (-w) ==
+ * [in]     pszPath  : The file
+ * [in/out] apszDone : The files printed already (WATCH_DEDUP slots)
+ *          piNdone  : The number of them                           */
+void put_changed_file(const char *pszPath, char **apszDone, int *piNdone){
+
+  /*--- Variables --------------------------------------------------*/
+  int i;
+
+  /*--- Print it unless printed already ----------------------------*/
+  for (i=0; i<*piNdone; i++) {
+    if (strcmp(apszDone[i],pszPath)==0) {return;}
+  }
+  put_file(AT_FDCWD, pszPath, pszPath);
+  if (*piNdone < WATCH_DEDUP) {
+    if ((apszDone[*piNdone]=strdup(pszPath)) == NULL) {
+      error_exit(errno,"strdup(): %s\n", strerror(errno));
+    }
+    (*piNdone)++;
+  }
+}
+
+/*=== Compare the names of two watched files (for qsort/bsearch) ===*/
+int cmp_wname(const void *pv1, const void *pv2) {
+  return strcmp(((const wname*)pv1)->pszName, ((const wname*)pv2)->pszName);
+}
+#endif
+
+/*=== Get the timestamps of a file ===================================
+ * [in]  iDirfd  : The directory fd which pszName is relative to
+ *                 (AT_FDCWD for the current directory)
+ *       pszName : The file
+ * [out] pft     : Its timestamps (iOk is also set)
+ * [ret] 0       : Success
+ *       -1      : Failed (errno is set)                            */
+int get_ftimes(int iDirfd, const char *pszName, ftimes *pft) {
+
+#ifdef HAVE_STATX
+  /*--- Variables --------------------------------------------------*/
+  struct statx stx;
+
+  /*--- Get them by statx() ----------------------------------------*/
+  if (statx(iDirfd, pszName, 0,
+            STATX_ATIME|STATX_MTIME|STATX_CTIME|STATX_BTIME, &stx) != 0) {
+    if (errno != ENOSYS) {pft->iOk = 0; return -1;}
+    /* Fall back to stat() below on old kernels */
+  } else {
+    pft->tsA.tv_sec = stx.stx_atime.tv_sec; pft->tsA.tv_nsec = stx.stx_atime.tv_nsec;
+    pft->tsM.tv_sec = stx.stx_mtime.tv_sec; pft->tsM.tv_nsec = stx.stx_mtime.tv_nsec;
+    pft->tsC.tv_sec = stx.stx_ctime.tv_sec; pft->tsC.tv_nsec = stx.stx_ctime.tv_nsec;
+    if (stx.stx_mask & STATX_BTIME) {
+      pft->tsB.tv_sec = stx.stx_btime.tv_sec; pft->tsB.tv_nsec = stx.stx_btime.tv_nsec;
     } else {
-      iNerror++;
-       printf(szDummy, "-", "-", "-");
+      pft->tsB.tv_sec = 0;                    pft->tsB.tv_nsec = -1;
     }
-    printf("%s\n",argv[i]);
+    pft->iOk = 1;
+    return 0;
   }
+#endif
+  {
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFileinfo;
 
-  /*=== Finish =====================================================*/
-  return (iNerror==0) ? 0 : 1;
+  /*--- Get them by fstatat() --------------------------------------*/
+  if (fstatat(iDirfd,pszName,&stFileinfo,0) != 0) {pft->iOk=0; return -1;}
+  #if defined(__APPLE__)
+    pft->tsA = stFileinfo.st_atimespec;
+    pft->tsM = stFileinfo.st_mtimespec;
+    pft->tsC = stFileinfo.st_ctimespec;
+    pft->tsB = stFileinfo.st_birthtimespec;
+  #elif defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+    pft->tsA = stFileinfo.st_atim;
+    pft->tsM = stFileinfo.st_mtim;
+    pft->tsC = stFileinfo.st_ctim;
+    #if defined(__FreeBSD__) || defined(__NetBSD__)
+      pft->tsB = stFileinfo.st_birthtim;
+    #else
+      pft->tsB.tv_sec = 0; pft->tsB.tv_nsec = -1;
+    #endif
+  #else
+    pft->tsA.tv_sec = stFileinfo.st_atime; pft->tsA.tv_nsec = 0;
+    pft->tsM.tv_sec = stFileinfo.st_mtime; pft->tsM.tv_nsec = 0;
+    pft->tsC.tv_sec = stFileinfo.st_ctime; pft->tsC.tv_nsec = 0;
+    pft->tsB.tv_sec = 0;                   pft->tsB.tv_nsec = -1;
+  #endif
+  if (pft->tsB.tv_sec <= 0 && pft->tsB.tv_nsec <= 0) {pft->tsB.tv_nsec = -1;}
+  pft->iOk = 1;
+  return 0;
+  }
+}
+
+/*=== Print the timestamps of a file =================================
+ * [in] pft     : The timestamps
+ *      pszPath : The file                                          */
+void print_ftimes(ftimes *pft, const char *pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const int aiWidth[3] = {14, 24, 10};
+  char szAtim[256], szMtim[256], szCtim[256], szBtim[256];
+  int  iWidth;
+
+  /*--- Print dummies if failed ------------------------------------*/
+  iWidth = aiWidth[giFmttype] + ((giNsec) ? 10 : 0);
+  if (pft->iOk != 1) {
+    printf("%-*s %-*s %-*s ", iWidth, "-", iWidth, "-", iWidth, "-");
+    if (giBirth) {printf("%-*s ", iWidth, "-");}
+    printf("%s\n",pszPath);
+    return;
+  }
+
+  /*--- Print the timestamps ---------------------------------------*/
+  format_time(szAtim, &pft->tsA);
+  format_time(szMtim, &pft->tsM);
+  format_time(szCtim, &pft->tsC);
+  printf("%s %s %s ",szAtim,szMtim,szCtim);
+  if (giBirth) {
+    if (pft->tsB.tv_nsec < 0) {printf("%-*s ", iWidth, "-");}
+    else                      {format_time(szBtim, &pft->tsB);
+                               printf("%s ", szBtim);       }
+  }
+  printf("%s\n",pszPath);
+}
+
+/*=== Format a timestamp in the format by -l/-u/-n ===================
+ * Since many files share the same seconds, the rendered strings are
+ * cached by the second not to call localtime() and strftime() again.
+ * [in]  pts    : The timestamp
+ * [out] pszBuf : The formatted string (256 bytes at least)         */
+void format_time(char *pszBuf, struct timespec *pts) {
+
+  /*--- Variables --------------------------------------------------*/
+  static struct {
+    time_t t;
+    int    iLen;          /* 0 means the slot is empty */
+    char   szSec[64];     /* the part before the nanoseconds */
+    char   szTz[16];      /* the part after them (for -l)    */
+  } astCache[TCACHE_NUM];
+  struct tm* pstTm;
+  int        i, iSlot;
+
+  /*--- Render the seconds unless cached ---------------------------*/
+  iSlot = (int)((unsigned long)pts->tv_sec % TCACHE_NUM);
+  if (astCache[iSlot].iLen==0 || astCache[iSlot].t!=pts->tv_sec) {
+    pstTm = localtime(&pts->tv_sec);
+    switch (giFmttype) {
+      case  0: i=strftime(astCache[iSlot].szSec,64,"%Y%m%d%H%M%S"     ,pstTm);
+               break;
+      case  1: i=strftime(astCache[iSlot].szSec,64,"%Y-%m-%dT%H:%M:%S",pstTm);
+               strftime(astCache[iSlot].szTz,16,"%z",pstTm);
+               break;
+      case  2: i=strftime(astCache[iSlot].szSec,64,"%s"               ,pstTm);
+               break;
+      default: error_exit(1, "Unexpected Error!\n");
+    }
+    astCache[iSlot].t    = pts->tv_sec;
+    astCache[iSlot].iLen = i;
+  }
+
+  /*--- Format it --------------------------------------------------*/
+  i = astCache[iSlot].iLen;
+  memcpy(pszBuf, astCache[iSlot].szSec, i);
+  if (giNsec       ) {i += sprintf(pszBuf+i, ".%09ld", pts->tv_nsec);}
+  if (giFmttype==1) {strcpy(pszBuf+i, astCache[iSlot].szTz);        }
+  else              {pszBuf[i] = '\0';                              }
+}
+
+#ifndef NOTHREAD
+/*=== (Thread) Get the timestamps of the files one after another =====
+ * [in] gppszPath, giNfile, giNext : (must be defined as global vars)
+ * [out] gpft                      : (must be defined as a global var) */
+void *ftimes_worker(void *pv) {
+
+  /*--- Variables --------------------------------------------------*/
+  ftimes ft;
+  int    i;
+
+  while (1) {
+    /*--- Take the next file ---------------------------------------*/
+    pthread_mutex_lock(&gmtx);
+    i = giNext++;
+    pthread_mutex_unlock(&gmtx);
+    if (i >= giNfile) {break;}
+
+    /*--- Get its timestamps and tell the main thread --------------*/
+    (void)get_ftimes(AT_FDCWD, gppszPath[i], &ft);
+    pthread_mutex_lock(&gmtx);
+    gpft[i] = ft;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  return NULL;
 }
+#endif
@@ -0,0 +1,1521 @@
+/*####################################################################
+#
+# GREO-NATIVE - The Native Overwriting Engine for "greo"
+#
+# USAGE   : greo-native [-E|-F] [-R] [-t] [--] regexp replacement
+#                       [file ...]
+# Args    : regexp, replacement
+#               These are the 1st and 2nd arguments of s/1/2/g.
+#               (See the usage of "greo" for the details)
+#           file ...... Filepath to overwrite. When no file is given,
+#                       the list of them is read from STDIN (one on a
+#                       line) as "greo" does.
+# Options : -E ........ Regard "regexp" as an extended regular
+#                       expression (ERE) instead of a basic one (BRE)
+#           -F ........ Regard both of the arguments as not regexp
+#                       strings but simple strings
+#           -R, -r .... Read all files under each directory recursively
+#                       (symbolic links in them are not followed)
+#           -t ........ Preserve modification times
+# Retuen  : Return 0 only when one or more files were overwritten and
+#           there was no failure
+#
+# * This is the engine which the "greo" command in the upper directory
+#   uses for the "-p" mode when it has been compiled. Every file is
+#   substituted in exactly the same way as "gres-native" does and
+#   reported with the same "Success:"/"Failure:" lines as "greo" does.
+# * The files which have no match are not touched at all. Whether a
+#   file has one is checked by the same prefilter as "gres-native"
+#   (the -F string or the literal prefix of the regexp is searched for
+#   16 or 32 bytes at a time by SSE2 or AVX2) before the regexp runs.
+#   The file is mapped into the memory by mmap() for it instead of
+#   being read when possible.
+# * A file which has one is written into a temporary file in the same
+#   directory, which gets the mode, the owner, the group and the
+#   extended attributes (the ACLs, the security labels and so on) of
+#   the file (and also the times with -t), and it replaces the file
+#   by rename() at last. So, the file is never left half-written. The
+#   lines before the first match and the long parts which have no
+#   match are copied by copy_file_range() on Linux without passing
+#   through this process again. However, the file is overwritten in
+#   place instead as "greo" does when it has two or more hard links
+#   or when the owner or an attribute cannot be kept.
+# * The files are processed by as many threads as the CPUs in
+#   parallel, and reported in the order of them anyway. The paths
+#   which lead to the same file (by symbolic links and so on) are
+#   processed only at the first one.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lpthread
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -DNOTHREAD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+#if defined(__linux) || defined(__linux__)
+  /* This definition is for the GNU regex functions and
+     copy_file_range() on Linux                                     */
+  #define _GNU_SOURCE
+#endif
+/*--- headers ------------------------------------------------------*/
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <regex.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+#ifndef NOTHREAD
+  #include <pthread.h>
+#endif
+#if defined(__GLIBC__) && defined(RE_DOT_NOT_NULL)
+  /* compile the regexp in the same way as GNU sed does */
+  #define HAVE_GNU_REGEX
+#endif
+#if defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+  #define HAVE_COPY_FILE_RANGE
+#endif
+#if defined(__linux__)
+  #include <sys/xattr.h>
+  #define HAVE_XATTR
+#endif
+#if defined(HAVE_GNU_REGEX) || defined(REG_STARTEND)
+  /* rx_exec() never writes the byte after the line, so the content
+     can be a read-only mapping of the file                         */
+  #define HAVE_RO_CONTENT
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define OBUF        1048576 /* output size to write at a time          */
+#define CFR_MIN     65536   /* min size to copy by copy_file_range()   */
+#define MAX_THREADS 64      /* max number of the threads               */
+#define MAX_REPS    1024    /* max number of the pieces of replacement */
+#define ST_UNTOUCHED 0      /* (job) no match or could not be read     */
+#define ST_GREOED    1      /* (job) overwritten                       */
+#define ST_FAILED    2      /* (job) failed to overwrite halfway       */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {
+  uint8_t *p;        /* the bytes (1 more byte is always allocated) */
+  size_t   n;        /* the number of the bytes                     */
+  size_t   uSize;    /* the allocated size                          */
+} buf_t;
+typedef struct {
+  int    iGrp;       /* the group to put (-1 means the literal)     */
+  size_t uOff;       /* the offset of the literal in gpu8RepLit     */
+  size_t uLen;       /* the length of the literal                   */
+} rpiece_t;
+typedef struct {
+  regex_t rx;        /* the compiled regexp (one for each thread)   */
+#ifdef HAVE_GNU_REGEX
+  struct re_registers stRegs; /* the matches (by re_search())       */
+#endif
+} rx_t;
+typedef struct {
+  int            iFdIn;   /* the original file (-1 means not to copy
+                             from it by copy_file_range())          */
+  int            iFdOut;  /* the file to write into                 */
+  const uint8_t *pu8Base; /* the content of the original one        */
+  buf_t          b;       /* the bytes to write                     */
+  int            iErrno;  /* errno when failed to write (0: not)    */
+} out_t;
+typedef struct {
+  const char *pszPath; /* the file                                  */
+  int         iStat;   /* the result (ST_*)                         */
+  int         iDone;   /* 1 when the thread has finished it         */
+} job_t;
+typedef struct {
+  dev_t dev;         /* the device of the file                      */
+  ino_t ino;         /* the i-node of it                            */
+  int   iIdx;        /* the index of the path in gppszFiles         */
+} fid_t;
+
+/*--- prototype functions ------------------------------------------*/
+void    parse_regexp(const char *pszPat);
+void    parse_replacement(const char *pszRep);
+void    read_list(int iRecurse);
+void    take_path(const char *pszPath, int iFollow);
+void    walk_dir(const char *pszDir);
+void    add_file(const char *pszPath);
+int     cmp_path(const void *pv1, const void *pv2);
+void    drop_aliases(void);
+int     cmp_fid(const void *pv1, const void *pv2);
+int     greo_file(const char *pszPath, rx_t *pRx);
+int     load_file(int iFd, size_t uSize, buf_t *pb);
+void    unload_file(buf_t *pb);
+void    own_file(buf_t *pb);
+int     write_file(int iFd, int iFdIn, uint8_t *pu8, size_t uLen,
+                   size_t uOff, rx_t *pRx);
+int     close_file(int iFd, int iErr, const struct stat *pstInfo);
+int     keep_attrs(int iFdIn, int iFdOut, const struct stat *pstInfo);
+#ifdef HAVE_XATTR
+  int   list_xattrs(int iFd, buf_t *pb);
+  int   get_xattr(int iFd, const char *pszName, buf_t *pb);
+  int   has_name(const buf_t *pb, const char *pszName);
+#endif
+int     scan_lines(uint8_t *pu8, size_t uLen, rx_t *pRx, size_t *puOff);
+void    subst_lines(uint8_t *pu8, size_t uLen, size_t uOff, rx_t *pRx,
+                    out_t *pOut);
+void    subst_line(uint8_t *pu8Line, size_t uLen, size_t uOff, rx_t *pRx,
+                   const uint8_t **ppu8Copy, out_t *pOut);
+void    rx_compile(rx_t *pRx);
+int     rx_exec(rx_t *pRx, uint8_t *pu8Line, size_t uLen, size_t uOff,
+                regmatch_t *pm);
+void    out_copy(out_t *pOut, const uint8_t *pu8, size_t uLen);
+void    out_add(out_t *pOut, const void *pv, size_t uLen);
+void    out_flush(out_t *pOut);
+void    out_write(out_t *pOut, const uint8_t *pu8, size_t uLen);
+void    buf_add(buf_t *pb, const void *pv, size_t uLen);
+const uint8_t *find_scalar(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+#ifdef HAVE_X86SIMD
+  const uint8_t *find_sse2(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+  const uint8_t *find_avx2(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+#endif
+#ifndef NOTHREAD
+  void *greo_worker(void *pv);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*     gpszCmdname;   /* The name of this command                */
+char**    gppszFiles;    /* The files to overwrite                  */
+int       giNfiles;      /* The number of them                      */
+int       giFilesSize;   /* The allocated number of gppszFiles      */
+int       giFixed;       /* 1 when -F option is set                 */
+int       giTimes;       /* 1 when -t option is set                 */
+uint8_t  *gpu8Lit;       /* -F string or the literal prefix of regexp*/
+size_t    guLitLen;      /* the length of it (0 means no prefix)    */
+char     *gpszRx;        /* the regexp to compile (without -F)      */
+int       giExtended;    /* 1 when -E option is set                 */
+size_t    guNsub;        /* the number of the groups in it          */
+rx_t     *garx;          /* the compiled ones (for each thread)     */
+size_t    guNmatch;      /* the number of the groups to get + 1     */
+rpiece_t  garp[MAX_REPS];/* the pieces of the replacement           */
+int       giNrp;         /* the number of them                      */
+uint8_t  *gpu8RepLit;    /* the literals in the replacement         */
+job_t    *gpJob;         /* the files to overwrite (as the jobs)    */
+/* The function to find a string (chosen on the CPU)                */
+const uint8_t *(*gpfFind)(const uint8_t*, const uint8_t*,
+                          const uint8_t*, size_t) = find_scalar;
+#ifndef NOTHREAD
+  int             giNext;      /* the next job for a thread to take   */
+  pthread_mutex_t gmtx = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t  gcnd = PTHREAD_COND_INITIALIZER;
+#endif
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-E|-F] [-R] [-t] [--] regexp replacement\n"
+    "                      [file ...]\n"
+    "Args    : regexp, replacement\n"
+    "              These are the 1st and 2nd arguments of s/1/2/g.\n"
+    "              (See the usage of \"greo\" for the details)\n"
+    "          file ...... Filepath to overwrite. When no file is given,\n"
+    "                      the list of them is read from STDIN (one on a\n"
+    "                      line) as \"greo\" does.\n"
+    "Options : -E ........ Regard \"regexp\" as an extended regular\n"
+    "                      expression (ERE) instead of a basic one (BRE)\n"
+    "          -F ........ Regard both of the arguments as not regexp\n"
+    "                      strings but simple strings\n"
+    "          -R, -r .... Read all files under each directory recursively\n"
+    "                      (symbolic links in them are not followed)\n"
+    "          -t ........ Preserve modification times\n"
+    "Retuen  : Return 0 only when one or more files were overwritten and\n"
+    "          there was no failure\n"
+    "Version : 2026-10-19 14:08:45 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  int iRecurse;  /* 1 when -R option is set */
+  int iNrx;      /* the number of the compiled regexps */
+  int iNgreoed;  /* the number of the files overwritten */
+  int iRet;      /* the return code */
+#ifndef NOTHREAD
+  pthread_t athr[MAX_THREADS];
+  int iNthread;  /* the number of the threads */
+#endif
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  giExtended = 0;
+  giFixed    = 0;
+  giTimes    = 0;
+  iRecurse   = 0;
+  while ((i=getopt(argc, argv, "EFRrth")) != -1) {
+    switch (i) {
+      case 'E': giExtended = 1;
+                break;
+      case 'F': giFixed    = 1;
+                break;
+      case 'R':
+      case 'r': iRecurse   = 1;
+                break;
+      case 't': giTimes    = 1;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc < 2) {print_usage_and_exit();}
+  if (giExtended && giFixed) {
+    error_exit(1,"conflicting matchers specified\n");
+  }
+  if (strchr(argv[0],'\n') != NULL) {
+    error_exit(1,"<0x0A> in \"regexp\" argument is not allowed\n");
+  }
+  if (argv[0][0] == '\0') {
+    error_exit(1,"no previous regular expression\n");
+  }
+
+  /*=== Compile the arguments and choose the kernel for the CPU ====*/
+  parse_regexp(argv[0]);
+  parse_replacement(argv[1]);
+  argc -= 2;
+  argv += 2;
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if      (__builtin_cpu_supports("avx2")) {gpfFind = find_avx2;}
+  else if (__builtin_cpu_supports("sse2")) {gpfFind = find_sse2;}
+#endif
+
+  /*=== Make the file list =========================================*/
+  if (argc == 0) {read_list(iRecurse);}
+  for (i=0; i<argc; i++) {
+    if (iRecurse) {take_path(argv[i], 1);}
+    else          {add_file(argv[i]);    }
+  }
+  drop_aliases();
+  if ((gpJob=calloc((size_t)giNfiles+1, sizeof(job_t))) == NULL) {
+    error_exit(errno,"calloc(): %s\n", strerror(errno));
+  }
+  for (i=0; i<giNfiles; i++) {gpJob[i].pszPath = gppszFiles[i];}
+
+  /*=== Decide the number of the threads ==========================*/
+  iNrx = 1;
+#ifndef NOTHREAD
+  iNthread = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (iNthread > MAX_THREADS) {iNthread = MAX_THREADS;}
+  if (iNthread > giNfiles   ) {iNthread = giNfiles;   }
+  if (iNthread > 1) {iNrx = iNthread;}
+#endif
+
+  /*=== Compile the regexp for every thread ========================*/
+  /* (A compiled regexp is locked while used, so each thread has its
+     own. They must be compiled here before the threads start.)     */
+  if (! giFixed) {
+    if ((garx=calloc((size_t)iNrx, sizeof(rx_t))) == NULL) {
+      error_exit(errno,"calloc(): %s\n", strerror(errno));
+    }
+    for (i=0; i<iNrx; i++) {rx_compile(&garx[i]);}
+  }
+
+  /*=== Overwrite the files ========================================*/
+#ifndef NOTHREAD
+  giNext = 0;
+  if (iNthread > 1) {
+    for (i=0; i<iNthread; i++) {
+      if ((errno=pthread_create(&athr[i],NULL,greo_worker,
+                                (giFixed)?NULL:&garx[i]  )) != 0) {
+        error_exit(errno,"pthread_create(): %s\n", strerror(errno));
+      }
+    }
+  }
+#endif
+
+  /*=== Report the results in order ================================*/
+  iRet     = 0;
+  iNgreoed = 0;
+  for (i=0; i<giNfiles; i++) {
+#ifndef NOTHREAD
+    if (iNthread > 1) {
+      pthread_mutex_lock(&gmtx);
+      while (! gpJob[i].iDone) {pthread_cond_wait(&gcnd,&gmtx);}
+      pthread_mutex_unlock(&gmtx);
+    } else
+#endif
+    gpJob[i].iStat = greo_file(gpJob[i].pszPath, garx);
+    switch (gpJob[i].iStat) {
+      case ST_GREOED: printf("Success: GREOed: %s\n", gpJob[i].pszPath);
+                      iNgreoed++;
+                      break;
+      case ST_FAILED: printf("Failure: failed to greo halfway: %s\n",
+                             gpJob[i].pszPath                      );
+                      iRet = 1;
+                      break;
+    }
+    fflush(stdout);
+  }
+#ifndef NOTHREAD
+  if (iNthread > 1) {
+    for (i=0; i<iNthread; i++) {pthread_join(athr[i],NULL);}
+  }
+#endif
+
+  /*=== Finish =====================================================*/
+  return (iNgreoed == 0) ? 1 : iRet;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Prepare the regexp (or the fixed string) =======================
+ * The escapes which GNU sed converts before compiling are converted,
+ * and the literal string which all the matches begin with is taken
+ * for skipping the lines quickly. The regexp is compiled here only
+ * to be checked.
+ * [in] pszPat : the regexp                                         */
+void parse_regexp(const char *pszPat) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc;
+  char       *pszRx, *pc2;
+  size_t      uLen;
+  int         iExtended = giExtended;
+  rx_t        stRx;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  uLen = strlen(pszPat);
+  if ((gpu8Lit=malloc(uLen+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  if (giFixed) {
+    memcpy(gpu8Lit, pszPat, uLen);
+    guLitLen = uLen;
+    return;
+  }
+
+  /*--- Convert the escapes ----------------------------------------*/
+  if ((pszRx=malloc(uLen+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  for (pc=pszPat, pc2=pszRx; *pc!='\0'; pc++) {
+    if (*pc != '\\' || pc[1] == '\0') {*pc2++ = *pc; continue;}
+    switch (pc[1]) {
+      case 'n': *pc2++ = '\n'; pc++; break;
+      case 't': *pc2++ = '\t'; pc++; break;
+      case 'a': *pc2++ = '\a'; pc++; break;
+      case 'f': *pc2++ = '\f'; pc++; break;
+      case 'v': *pc2++ = '\v'; pc++; break;
+      case 'r': *pc2++ = '\r'; pc++; break;
+      case 'c': case 'd': case 'o': case 'x':
+        error_exit(1,"\\%c in \"regexp\" argument is not supported\n",pc[1]);
+        break;
+      default : *pc2++ = *pc++; *pc2++ = *pc; break;
+    }
+  }
+  *pc2 = '\0';
+
+  /*--- Check it ---------------------------------------------------*/
+  gpszRx = pszRx;
+  rx_compile(&stRx);
+  guNsub = stRx.rx.re_nsub;
+  regfree(&stRx.rx);
+
+  /*--- Take the literal prefix ------------------------------------*/
+  /* (given up when there is an alternation anywhere)               */
+  guLitLen = 0;
+  if (strstr(pszRx, (iExtended)?"|":"\\|") != NULL) {return;}
+  pc = pszRx;
+  if (*pc == '^') {pc++;}
+  while (*pc != '\0') {
+    if (*pc == '\\') {
+      if (pc[1]=='\0' || strchr(".[]*^$\\/",pc[1])==NULL) {
+        if (! iExtended || pc[1]=='\0' || strchr("+?{}()|",pc[1])==NULL) {
+          break;
+        }
+      }
+      gpu8Lit[guLitLen++] = (uint8_t)pc[1];
+      pc += 2;
+    } else {
+      if (strchr((iExtended)?".[]*^$+?{}()|":".[]*^$",*pc) != NULL) {break;}
+      gpu8Lit[guLitLen++] = (uint8_t)*pc;
+      pc++;
+    }
+    /* the last one is not a must if a quantifier follows it */
+    if (*pc=='*' || (  iExtended && (*pc=='+' || *pc=='?' || *pc=='{')) ||
+        (! iExtended && pc[0]=='\\' &&
+         (pc[1]=='{' || pc[1]=='+' || pc[1]=='?')                       )) {
+      guLitLen--;
+      break;
+    }
+  }
+}
+
+/*=== Compile the replacement ========================================
+ * [in] pszRep : the replacement                                    */
+void parse_replacement(const char *pszRep) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc;
+  size_t      uLit;
+  int         iGrp;
+
+  /*--- Prepare ----------------------------------------------------*/
+  if ((gpu8RepLit=malloc(strlen(pszRep)+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  giNrp    = 0;
+  guNmatch = 1;
+  uLit     = 0;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  if (giFixed) {
+    uLit = strlen(pszRep);
+    memcpy(gpu8RepLit, pszRep, uLit);
+    garp[0].iGrp = -1;
+    garp[0].uOff =  0;
+    garp[0].uLen = uLit;
+    giNrp = 1;
+    return;
+  }
+
+  /*--- Split it into the literals and the groups ------------------*/
+  garp[0].iGrp = -1;
+  garp[0].uOff =  0;
+  garp[0].uLen =  0;
+  for (pc=pszRep; *pc!='\0'; pc++) {
+    iGrp = -1;
+    if        (*pc == '&' ) {
+      iGrp = 0;
+    } else if (*pc == '\n') {
+      error_exit(1,"unterminated `s' command\n");
+    } else if (*pc == '\\') {
+      pc++;
+      switch (*pc) {
+        case '\0': error_exit(1,"unterminated `s' command\n");
+                   break;
+        case 'n' : gpu8RepLit[uLit++] = '\n'; break;
+        case 't' : gpu8RepLit[uLit++] = '\t'; break;
+        case 'a' : gpu8RepLit[uLit++] = '\a'; break;
+        case 'f' : gpu8RepLit[uLit++] = '\f'; break;
+        case 'v' : gpu8RepLit[uLit++] = '\v'; break;
+        case 'r' : gpu8RepLit[uLit++] = '\r'; break;
+        case 'L' : case 'U': case 'l': case 'u': case 'E':
+        case 'c' : case 'd': case 'o': case 'x':
+          error_exit(1,"\\%c in \"replacement\" argument is not supported\n",
+                     *pc);
+          break;
+        default  : if (*pc>='0' && *pc<='9') {iGrp = *pc - '0';       }
+                   else                      {gpu8RepLit[uLit++] = *pc;}
+                   break;
+      }
+    } else {
+      gpu8RepLit[uLit++] = (uint8_t)*pc;
+    }
+    if (iGrp < 0) {continue;}
+    /*--- close the literal and add the group ----------------------*/
+    if (iGrp > (int)guNsub) {
+      error_exit(1,"invalid reference \\%d on `s' command's RHS\n",iGrp);
+    }
+    if (giNrp+2 >= MAX_REPS) {error_exit(1,"Too long replacement\n");}
+    garp[giNrp].uLen = uLit - garp[giNrp].uOff;
+    giNrp++;
+    garp[giNrp].iGrp = iGrp;
+    giNrp++;
+    garp[giNrp].iGrp = -1;
+    garp[giNrp].uOff = uLit;
+    garp[giNrp].uLen = 0;
+    if ((size_t)iGrp >= guNmatch) {guNmatch = (size_t)iGrp+1;}
+  }
+  garp[giNrp].uLen = uLit - garp[giNrp].uOff;
+  giNrp++;
+}
+
+/*=== Read the list of the files from STDIN ==========================
+ * They are sorted and the duplicates are removed as "greo" does.
+ * [in] iRecurse : 1 when -R option is set                          */
+void read_list(int iRecurse) {
+
+  /*--- Variables --------------------------------------------------*/
+  buf_t   stIn;
+  char  **ppszList, *pc, *pcEol;
+  size_t  uSize;
+  ssize_t iRead;
+  int     iN, i;
+
+  /*--- Read all of them -------------------------------------------*/
+  memset(&stIn, 0, sizeof(stIn));
+  while (1) {
+    buf_add(&stIn, NULL, OBUF);
+    stIn.n -= OBUF;
+    iRead = read(STDIN_FILENO, stIn.p+stIn.n, OBUF);
+    if (iRead > 0) {stIn.n += (size_t)iRead; continue;}
+    if (iRead == 0) {break;}
+    if (errno == EINTR) {continue;}
+    error_exit(errno,"read(): %s\n", strerror(errno));
+  }
+  stIn.p[stIn.n] = '\0';
+
+  /*--- Split them into the lines (the empty ones are ignored) -----*/
+  ppszList = NULL;
+  uSize    = 0;
+  iN       = 0;
+  for (pc=(char*)stIn.p; pc<(char*)stIn.p+stIn.n; pc=pcEol+1) {
+    if ((pcEol=strchr(pc,'\n')) == NULL) {pcEol = pc+strlen(pc);}
+    *pcEol = '\0';
+    if (*pc == '\0') {continue;}
+    if ((size_t)iN >= uSize) {
+      uSize    = (uSize==0) ? 1024 : uSize*2;
+      ppszList = realloc(ppszList, sizeof(char*)*uSize);
+      if (ppszList == NULL) {
+        error_exit(errno,"realloc(): %s\n", strerror(errno));
+      }
+    }
+    ppszList[iN++] = pc;
+  }
+
+  /*--- Add them ---------------------------------------------------*/
+  if (iN == 0) {return;}
+  qsort(ppszList, (size_t)iN, sizeof(char*), cmp_path);
+  for (i=0; i<iN; i++) {
+    if (i>0 && strcmp(ppszList[i-1],ppszList[i])==0) {continue;}
+    if (iRecurse) {take_path(ppszList[i], 1);}
+    else          {add_file(ppszList[i]);    }
+  }
+  free(ppszList);
+}
+
+/*=== Compare two filepaths (for qsort()) ============================*/
+int cmp_path(const void *pv1, const void *pv2) {
+  return strcmp(*(char* const*)pv1, *(char* const*)pv2);
+}
+
+/*=== Drop the paths which lead to the same file as an earlier one ===
+ * (Otherwise, two threads could overwrite one file at a time.) The
+ * paths which cannot be stat()ed are left to greo_file() to warn.
+ * [in,out] gppszFiles, giNfiles : (must be defined as global vars) */
+void drop_aliases(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  fid_t      *pfid;
+  int         iN, i, j;
+
+  /*--- Get the i-nodes and sort them ------------------------------*/
+  if (giNfiles < 2) {return;}
+  if ((pfid=malloc(sizeof(fid_t)*(size_t)giNfiles)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  for (i=0, iN=0; i<giNfiles; i++) {
+    if (stat(gppszFiles[i],&stInfo) < 0) {continue;}
+    pfid[iN].dev  = stInfo.st_dev;
+    pfid[iN].ino  = stInfo.st_ino;
+    pfid[iN].iIdx = i;
+    iN++;
+  }
+  qsort(pfid, (size_t)iN, sizeof(fid_t), cmp_fid);
+
+  /*--- Mark the ones after the first of the same file -------------*/
+  for (i=1; i<iN; i++) {
+    if (pfid[i].dev==pfid[i-1].dev && pfid[i].ino==pfid[i-1].ino) {
+      gppszFiles[pfid[i].iIdx] = NULL;
+    }
+  }
+  free(pfid);
+
+  /*--- Remove them ------------------------------------------------*/
+  for (i=0, j=0; i<giNfiles; i++) {
+    if (gppszFiles[i] != NULL) {gppszFiles[j++] = gppszFiles[i];}
+  }
+  giNfiles = j;
+}
+
+/*=== Compare two files by the i-nodes (for qsort()) =================
+ * The same ones are ordered by the indexes of the paths.           */
+int cmp_fid(const void *pv1, const void *pv2) {
+  const fid_t *p1 = (const fid_t*)pv1;
+  const fid_t *p2 = (const fid_t*)pv2;
+
+  if (p1->dev  != p2->dev ) {return (p1->dev  < p2->dev ) ? -1 : 1;}
+  if (p1->ino  != p2->ino ) {return (p1->ino  < p2->ino ) ? -1 : 1;}
+  return (p1->iIdx < p2->iIdx) ? -1 : (p1->iIdx > p2->iIdx);
+}
+
+/*=== Add a file given by the user (-R) ==============================
+ * Only the regular files are added, and the directories are walked
+ * into, in the same order as "find" does.
+ * [in] pszPath : The file
+ *      iFollow : 1 when it may be a symbolic link to follow        */
+void take_path(const char *pszPath, int iFollow) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+
+  /*--- Add or walk into it ----------------------------------------*/
+  if (((iFollow) ? stat(pszPath,&stInfo) : lstat(pszPath,&stInfo)) < 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    return;
+  }
+  if      (S_ISREG(stInfo.st_mode)) {add_file(pszPath);}
+  else if (S_ISDIR(stInfo.st_mode)) {walk_dir(pszPath);}
+}
+
+/*=== Add all files in a directory recursively =======================
+ * [in] pszDir : The directory                                      */
+void walk_dir(const char *pszDir) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct dirent *pde;
+  DIR           *pdir;
+  char          *pszPath;
+  size_t         uLen, uSep;
+
+  /*--- Open it ----------------------------------------------------*/
+  if ((pdir=opendir(pszDir)) == NULL) {
+    warning("%s: %s\n", pszDir, strerror(errno));
+    return;
+  }
+  uLen = strlen(pszDir);
+  uSep = (uLen>0 && pszDir[uLen-1]=='/') ? 0 : 1;
+
+  /*--- Add or walk into every entry -------------------------------*/
+  while (errno=0, (pde=readdir(pdir)) != NULL) {
+    if (pde->d_name[0]=='.' && (pde->d_name[1]=='\0' ||
+        (pde->d_name[1]=='.' && pde->d_name[2]=='\0'))) {continue;}
+    if ((pszPath=malloc(uLen+uSep+strlen(pde->d_name)+1)) == NULL) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+    memcpy(pszPath, pszDir, uLen);
+    if (uSep) {pszPath[uLen] = '/';}
+    strcpy(pszPath+uLen+uSep, pde->d_name);
+    #ifdef DT_DIR
+      if      (pde->d_type == DT_REG) {add_file(pszPath);             }
+      else if (pde->d_type == DT_DIR) {walk_dir(pszPath);free(pszPath);}
+      else if (pde->d_type != DT_UNKNOWN) {free(pszPath);             }
+      else
+    #endif
+    {
+      take_path(pszPath, 0);
+      if (giNfiles==0 || gppszFiles[giNfiles-1]!=pszPath) {free(pszPath);}
+    }
+  }
+  if (errno != 0) {warning("%s: %s\n", pszDir, strerror(errno));}
+  closedir(pdir);
+}
+
+/*=== Add a file to the list =========================================
+ * [in] pszPath : The file (it must be kept until the end)          */
+void add_file(const char *pszPath) {
+  if (giNfiles >= giFilesSize) {
+    giFilesSize = (giFilesSize==0) ? 1024 : giFilesSize*2;
+    gppszFiles  = realloc(gppszFiles, sizeof(char*)*giFilesSize);
+    if (gppszFiles == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  gppszFiles[giNfiles++] = (char*)pszPath;
+}
+
+#ifndef NOTHREAD
+/*=== (Thread) Overwrite the files one after another =================
+ * [in]     pv : the compiled regexp for this thread (rx_t*)
+ * [in,out] gpJob, giNfiles, giNext : (must be defined as global vars)*/
+void *greo_worker(void *pv) {
+
+  /*--- Variables --------------------------------------------------*/
+  rx_t *pRx = (rx_t*)pv;
+  int   iStat;
+  int   i;
+
+  while (1) {
+    /*--- Take the next file ---------------------------------------*/
+    pthread_mutex_lock(&gmtx);
+    i = giNext++;
+    pthread_mutex_unlock(&gmtx);
+    if (i >= giNfiles) {break;}
+
+    /*--- Overwrite it and tell the main thread --------------------*/
+    iStat = greo_file(gpJob[i].pszPath, pRx);
+    pthread_mutex_lock(&gmtx);
+    gpJob[i].iStat = iStat;
+    gpJob[i].iDone = 1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  return NULL;
+}
+#endif
+
+/*=== Overwrite a file if it has a match =============================
+ * [in] pszPath : the file
+ *      pRx     : the compiled regexp (unused with -F)
+ * [ret]          the result (ST_*)                                 */
+int greo_file(const char *pszPath, rx_t *pRx) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  buf_t       stIn;
+  char       *pszDst, *pszTmp, *pc;
+  size_t      uOff, uDir;
+  int         iFdIn, iFdOut, iErr;
+
+  /*--- Get the whole content --------------------------------------*/
+  if ((iFdIn=open(pszPath,O_RDONLY)) < 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    return ST_UNTOUCHED;
+  }
+  if (fstat(iFdIn,&stInfo) < 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    close(iFdIn);
+    return ST_UNTOUCHED;
+  }
+  if (! S_ISREG(stInfo.st_mode)) {
+    warning("%s: Not a regular file\n", pszPath);
+    close(iFdIn);
+    return ST_UNTOUCHED;
+  }
+  if ((iErr=load_file(iFdIn, (size_t)stInfo.st_size, &stIn)) != 0) {
+    warning("%s: %s\n", pszPath, strerror(iErr));
+    close(iFdIn);
+    return ST_UNTOUCHED;
+  }
+
+  /*--- Leave it untouched if it has no match ----------------------*/
+  if (! scan_lines(stIn.p, stIn.n, pRx, &uOff)) {
+    unload_file(&stIn);
+    close(iFdIn);
+    return ST_UNTOUCHED;
+  }
+
+  /*--- Make the temporary file next to the real one ---------------*/
+  /* (It gets the same owner and group here, and the same mode and
+     extended attributes after written, since writing could clear
+     some of them. When it can't, or when the file has other hard
+     links, the file is overwritten in place instead as "greo"
+     does.)                                                         */
+  if ((pszDst=realpath(pszPath,NULL)) == NULL) {pszDst = (char*)pszPath;}
+  if ((pszTmp=malloc(strlen(pszDst)+sizeof(".greo.XXXXXX"))) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  pc = strrchr(pszDst, '/');
+  uDir = (pc==NULL) ? 0 : (size_t)(pc-pszDst)+1;
+  memcpy(pszTmp, pszDst, uDir);
+  strcpy(pszTmp+uDir, ".greo.XXXXXX");
+  iFdOut = -1;
+  if (stInfo.st_nlink == 1 && (iFdOut=mkstemp(pszTmp)) >= 0) {
+    if (fchown(iFdOut, stInfo.st_uid, stInfo.st_gid) < 0) {
+      close(iFdOut);
+      unlink(pszTmp);
+      iFdOut = -1;
+    }
+  }
+
+  /*--- Write the result and replace the file with it --------------*/
+  iErr = 0;
+  if (iFdOut >= 0) {
+    iErr = write_file(iFdOut, iFdIn, stIn.p, stIn.n, uOff, pRx);
+    if (iErr==0 && keep_attrs(iFdIn, iFdOut, &stInfo)!=0) {
+      /* (overwrite it in place instead) */
+      close(iFdOut);
+      unlink(pszTmp);
+      iFdOut = -1;
+    } else {
+      iErr = close_file(iFdOut, iErr, &stInfo);
+      if (iErr==0 && rename(pszTmp,pszDst)<0) {iErr = errno;}
+      if (iErr != 0) {unlink(pszTmp);}
+    }
+  }
+  if (iFdOut < 0) {
+    own_file(&stIn);
+    if ((iFdOut=open(pszDst,O_WRONLY|O_TRUNC)) >= 0) {
+      iErr = write_file(iFdOut, -1, stIn.p, stIn.n, uOff, pRx);
+      iErr = close_file(iFdOut, iErr, &stInfo);
+    } else {
+      iErr = errno;
+    }
+  }
+  if (iErr != 0) {warning("%s: %s\n", pszPath, strerror(iErr));}
+
+  /*--- Finish -----------------------------------------------------*/
+  if (pszDst != pszPath) {free(pszDst);}
+  free(pszTmp);
+  unload_file(&stIn);
+  close(iFdIn);
+  return (iErr == 0) ? ST_GREOED : ST_FAILED;
+}
+
+/*=== Get the whole content of a file ================================
+ * It is mapped into the memory when possible, so that only the pages
+ * which are looked at are read (and the ones copied by
+ * copy_file_range() never pass through this process). Otherwise, it
+ * is read into a buffer.
+ * [in]  iFd   : the file
+ *       uSize : the size of it
+ * [out] pb    : the content (pb->uSize is 0 when it is mapped)
+ * [ret]         0 when successful (errno when not)                 */
+int load_file(int iFd, size_t uSize, buf_t *pb) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iRead;
+#ifdef HAVE_RO_CONTENT
+  void   *pv;
+#endif
+
+  /*--- Map it -----------------------------------------------------*/
+  memset(pb, 0, sizeof(buf_t));
+#ifdef HAVE_RO_CONTENT
+  if (uSize == 0) {pb->p = (uint8_t*)""; return 0;}
+  pv = mmap(NULL, uSize, PROT_READ, MAP_PRIVATE, iFd, 0);
+  if (pv != MAP_FAILED) {
+    posix_madvise(pv, uSize, POSIX_MADV_SEQUENTIAL);
+    pb->p = (uint8_t*)pv;
+    pb->n = uSize;
+    return 0;
+  }
+#endif
+
+  /*--- Otherwise, read it -----------------------------------------*/
+  buf_add(pb, NULL, uSize+1);
+  pb->n = 0;
+  while (1) {
+    if (pb->n+1 >= pb->uSize) {buf_add(pb, NULL, 1); pb->n--;}
+    iRead = read(iFd, pb->p+pb->n, pb->uSize-1-pb->n);
+    if (iRead > 0) {pb->n += (size_t)iRead; continue;}
+    if (iRead == 0) {return 0;}
+    if (errno == EINTR) {continue;}
+    iRead = errno;
+    free(pb->p);
+    return (int)iRead;
+  }
+}
+
+/*=== Release the content got by load_file() =========================
+ * [in] pb : the content                                            */
+void unload_file(buf_t *pb) {
+  if      (pb->uSize > 0) {free(pb->p);          }
+  else if (pb->n     > 0) {munmap(pb->p, pb->n); }
+}
+
+/*=== Make the content got by load_file() independent of the file ===
+ * (It must be done before the file is truncated to be overwritten
+ * in place, or the mapping would lose the content.)
+ * [in,out] pb : the content                                        */
+void own_file(buf_t *pb) {
+  buf_t stCopy;
+
+  if (pb->uSize > 0 || pb->n == 0) {return;}
+  memset(&stCopy, 0, sizeof(stCopy));
+  buf_add(&stCopy, pb->p, pb->n);
+  munmap(pb->p, pb->n);
+  *pb = stCopy;
+}
+
+/*=== Write the substituted content into a file ======================
+ * [in] iFd     : the file to write into
+ *      iFdIn   : the original file to copy the unchanged parts from
+ *                (-1 means to write them from pu8 instead)
+ *      pu8     : the content of the original file
+ *      uLen    : the size of it
+ *      uOff    : the beginning of the first line which has a match
+ *      pRx     : the compiled regexp (unused with -F)
+ * [ret]          0 when successful (errno when not)                */
+int write_file(int iFd, int iFdIn, uint8_t *pu8, size_t uLen, size_t uOff,
+               rx_t *pRx) {
+
+  /*--- Variables --------------------------------------------------*/
+  out_t stOut;
+
+  /*--- Write it ---------------------------------------------------*/
+  memset(&stOut, 0, sizeof(stOut));
+  stOut.iFdIn   = iFdIn;
+  stOut.iFdOut  = iFd;
+  stOut.pu8Base = pu8;
+  subst_lines(pu8, uLen, uOff, pRx, &stOut);
+  out_flush(&stOut);
+  free(stOut.b.p);
+  return stOut.iErrno;
+}
+
+/*=== Close the written file =========================================
+ * [in] iFd     : the file (closed here)
+ *      iErr    : 0 when it has been written successfully
+ *      pstInfo : the status of the original file (for -t)
+ * [ret]          0 when successful (iErr or errno when not)        */
+int close_file(int iFd, int iErr, const struct stat *pstInfo) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct timespec ats[2];
+
+  /*--- Preserve the times (-t) ------------------------------------*/
+  if (giTimes && iErr == 0) {
+    #if defined(__APPLE__)
+      ats[0] = pstInfo->st_atimespec;
+      ats[1] = pstInfo->st_mtimespec;
+    #elif defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+      ats[0] = pstInfo->st_atim;
+      ats[1] = pstInfo->st_mtim;
+    #else
+      ats[0].tv_sec = pstInfo->st_atime; ats[0].tv_nsec = 0;
+      ats[1].tv_sec = pstInfo->st_mtime; ats[1].tv_nsec = 0;
+    #endif
+    if (futimens(iFd, ats) < 0) {iErr = errno;}
+  }
+
+  /*--- Close it ---------------------------------------------------*/
+  if (close(iFd) < 0 && iErr == 0) {iErr = errno;}
+  return iErr;
+}
+
+/*=== Give the new file the mode and the attributes of the original ==
+ * The extended attributes (the ACLs, the security labels, the
+ * capabilities and so on) are copied, and the ones which the new file
+ * has got by itself are removed. An attribute which has already the
+ * same value is not set again.
+ * [in] iFdIn   : the original file
+ *      iFdOut  : the new file
+ *      pstInfo : the status of the original file
+ * [ret]          0 when successful (errno when not)                */
+int keep_attrs(int iFdIn, int iFdOut, const struct stat *pstInfo) {
+
+  /*--- Variables --------------------------------------------------*/
+#ifdef HAVE_XATTR
+  buf_t       stIn, stOut, stVal, stOld;
+  const char *psz;
+  int         iErr;
+#endif
+
+  /*--- Mode -------------------------------------------------------*/
+  if (fchmod(iFdOut, pstInfo->st_mode & (mode_t)07777) < 0) {return errno;}
+
+#ifdef HAVE_XATTR
+  /*--- Extended attributes ----------------------------------------*/
+  memset(&stIn , 0, sizeof(stIn ));
+  memset(&stOut, 0, sizeof(stOut));
+  memset(&stVal, 0, sizeof(stVal));
+  memset(&stOld, 0, sizeof(stOld));
+  if ((iErr=list_xattrs(iFdIn ,&stIn ))==0 &&
+      (iErr=list_xattrs(iFdOut,&stOut))==0   ) {
+    for (psz=(char*)stOut.p; psz<(char*)stOut.p+stOut.n;
+         psz+=strlen(psz)+1                            ) {
+      if (has_name(&stIn,psz)) {continue;}
+      if (fremovexattr(iFdOut,psz) < 0) {iErr = errno; break;}
+    }
+    for (psz=(char*)stIn.p; iErr==0 && psz<(char*)stIn.p+stIn.n;
+         psz+=strlen(psz)+1                                     ) {
+      if ((iErr=get_xattr(iFdIn,psz,&stVal)) != 0) {break;}
+      if (has_name(&stOut,psz) && get_xattr(iFdOut,psz,&stOld)==0 &&
+          stOld.n==stVal.n && memcmp(stOld.p,stVal.p,stVal.n)==0  ) {
+        continue;
+      }
+      if (fsetxattr(iFdOut,psz,stVal.p,stVal.n,0) < 0) {iErr = errno;}
+    }
+  }
+  free(stIn.p); free(stOut.p); free(stVal.p); free(stOld.p);
+  return iErr;
+#else
+  return 0;
+#endif
+}
+
+#ifdef HAVE_XATTR
+/*=== Get the names of the extended attributes of a file =============
+ * [in]  iFd : the file
+ * [out] pb  : the names (each one is terminated with <0x00>)
+ * [ret]       0 when successful (errno when not)                   */
+int list_xattrs(int iFd, buf_t *pb) {
+  ssize_t iLen;
+
+  while (1) {
+    pb->n = 0;
+    if ((iLen=flistxattr(iFd, NULL, 0)) < 0) {
+      return (errno==ENOTSUP) ? 0 : errno;
+    }
+    buf_add(pb, NULL, (size_t)iLen);
+    if ((iLen=flistxattr(iFd, (char*)pb->p, (size_t)iLen+1)) >= 0) {
+      pb->n = (size_t)iLen;
+      return 0;
+    }
+    if (errno != ERANGE) {return errno;}
+  }
+}
+
+/*=== Get the value of an extended attribute of a file ===============
+ * [in]  iFd     : the file
+ *       pszName : the name of the attribute
+ * [out] pb      : the value
+ * [ret]           0 when successful (errno when not)               */
+int get_xattr(int iFd, const char *pszName, buf_t *pb) {
+  ssize_t iLen;
+
+  while (1) {
+    pb->n = 0;
+    if ((iLen=fgetxattr(iFd, pszName, NULL, 0)) < 0) {return errno;}
+    buf_add(pb, NULL, (size_t)iLen);
+    if ((iLen=fgetxattr(iFd, pszName, pb->p, (size_t)iLen+1)) >= 0) {
+      pb->n = (size_t)iLen;
+      return 0;
+    }
+    if (errno != ERANGE) {return errno;}
+  }
+}
+
+/*=== Check if a name is in the names of the extended attributes =====
+ * [in] pb      : the names (got by list_xattrs())
+ *      pszName : the name
+ * [ret]          1 when it is in them                              */
+int has_name(const buf_t *pb, const char *pszName) {
+  const char *psz;
+
+  for (psz=(char*)pb->p; psz<(char*)pb->p+pb->n; psz+=strlen(psz)+1) {
+    if (strcmp(psz, pszName) == 0) {return 1;}
+  }
+  return 0;
+}
+#endif
+
+/*=== Find the first line which has a match ==========================
+ * The lines are the ones which "grep" sees, that is, the empty part
+ * after the last <0x0A> is not a line.
+ * [in]  pu8   : the content
+ *       uLen  : the size of it
+ *       pRx   : the compiled regexp (unused with -F)
+ * [out] puOff : the beginning of the line
+ * [ret]         1 when found                                       */
+int scan_lines(uint8_t *pu8, size_t uLen, rx_t *pRx, size_t *puOff) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint8_t   *pu8End = pu8+uLen;
+  uint8_t   *pu8Line, *pu8Bol, *pu8Eol, *pu8Hit;
+  regmatch_t am[10];
+
+  /*--- Find the candidates by the string and verify them ----------*/
+  for (pu8Line=pu8; pu8Line<pu8End; pu8Line=pu8Eol+1) {
+    if (guLitLen > 0) {
+      pu8Hit = (uint8_t*)gpfFind(pu8Line,pu8End,gpu8Lit,guLitLen);
+      if (pu8Hit == NULL) {return 0;}
+      for (pu8Bol=pu8Hit; pu8Bol>pu8Line && pu8Bol[-1]!='\n'; pu8Bol--);
+    } else {
+      pu8Hit = pu8Bol = pu8Line;
+    }
+    if (giFixed) {*puOff = (size_t)(pu8Bol-pu8); return 1;}
+    pu8Eol = memchr(pu8Hit, '\n', pu8End-pu8Hit);
+    if (pu8Eol == NULL) {pu8Eol = pu8End;}
+    if (rx_exec(pRx, pu8Bol, pu8Eol-pu8Bol, pu8Hit-pu8Bol, am) == 0) {
+      *puOff = (size_t)(pu8Bol-pu8);
+      return 1;
+    }
+    if (pu8Eol == pu8End) {break;}
+  }
+  return 0;
+}
+
+/*=== Substitute the lines ===========================================
+ * The last one (it can be empty) is substituted even if it doesn't
+ * end with <0x0A>, as sed in "greo" does.
+ * [in]  pu8   : the lines
+ *       uLen  : the size of them
+ *       uOff  : the beginning of the line to begin searching at
+ *               (the lines before it are just copied)
+ *       pRx   : the compiled regexp (unused with -F)
+ * [out] pOut  : the file to write the result into                  */
+void subst_lines(uint8_t *pu8, size_t uLen, size_t uOff, rx_t *pRx,
+                 out_t *pOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint8_t       *pu8End = pu8+uLen;
+  const uint8_t *pu8Copy;  /* the bytes from here are not copied yet */
+  uint8_t       *pu8Line, *pu8Bol, *pu8Eol, *pu8Hit;
+
+  pu8Copy = pu8;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  if (giFixed) {
+    for (pu8Hit=pu8+uOff;
+         (pu8Hit=(uint8_t*)gpfFind(pu8Hit,pu8End,gpu8Lit,guLitLen))!=NULL;
+         pu8Hit+=guLitLen                                                ) {
+      out_copy(pOut, pu8Copy, pu8Hit-pu8Copy);
+      out_add(pOut, gpu8RepLit, garp[0].uLen);
+      pu8Copy = pu8Hit + guLitLen;
+    }
+
+  /*--- Regexp with the literal prefix -----------------------------*/
+  } else if (guLitLen > 0) {
+    for (pu8Line=pu8+uOff; pu8Line<pu8End; pu8Line=pu8Eol+1) {
+      pu8Hit = (uint8_t*)gpfFind(pu8Line,pu8End,gpu8Lit,guLitLen);
+      if (pu8Hit == NULL) {break;}
+      for (pu8Bol=pu8Hit; pu8Bol>pu8Line && pu8Bol[-1]!='\n'; pu8Bol--);
+      pu8Eol = memchr(pu8Hit, '\n', pu8End-pu8Hit);
+      if (pu8Eol == NULL) {pu8Eol = pu8End;}
+      subst_line(pu8Bol, pu8Eol-pu8Bol, pu8Hit-pu8Bol, pRx, &pu8Copy, pOut);
+      if (pu8Eol == pu8End) {break;}
+    }
+
+  /*--- Regexp -----------------------------------------------------*/
+  } else {
+    for (pu8Line=pu8+uOff; ; pu8Line=pu8Eol+1) {
+      pu8Eol = memchr(pu8Line, '\n', pu8End-pu8Line);
+      if (pu8Eol == NULL) {pu8Eol = pu8End;}
+      subst_line(pu8Line, pu8Eol-pu8Line, 0, pRx, &pu8Copy, pOut);
+      if (pu8Eol == pu8End) {break;}
+    }
+  }
+
+  /*--- Copy the rest ----------------------------------------------*/
+  out_copy(pOut, pu8Copy, pu8End-pu8Copy);
+}
+
+/*=== Substitute a line by the regexp ================================
+ * [in]     pu8Line  : the line (without <0x0A>)
+ *          uLen     : the length of it
+ *          uOff     : the offset to begin searching at
+ *          pRx      : the compiled regexp
+ * [in,out] ppu8Copy : the first byte which is not copied yet
+ * [out]    pOut     : the file to write the result into            */
+void subst_line(uint8_t *pu8Line, size_t uLen, size_t uOff, rx_t *pRx,
+                const uint8_t **ppu8Copy, out_t *pOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  regmatch_t am[10];
+  regoff_t   iPrevEnd;
+  int        i;
+
+  /*--- Replace every match ----------------------------------------*/
+  iPrevEnd = -1;
+  while (uOff <= uLen && rx_exec(pRx, pu8Line, uLen, uOff, am) == 0) {
+    /* an empty match just after the previous match is ignored */
+    if (am[0].rm_so==am[0].rm_eo && am[0].rm_so==iPrevEnd) {
+      uOff = (size_t)am[0].rm_so + 1;
+      continue;
+    }
+    out_copy(pOut, *ppu8Copy, pu8Line+am[0].rm_so-*ppu8Copy);
+    for (i=0; i<giNrp; i++) {
+      if (garp[i].iGrp < 0) {
+        out_add(pOut, gpu8RepLit+garp[i].uOff, garp[i].uLen);
+      } else if (am[garp[i].iGrp].rm_so >= 0) {
+        out_add(pOut, pu8Line+am[garp[i].iGrp].rm_so,
+                am[garp[i].iGrp].rm_eo-am[garp[i].iGrp].rm_so);
+      }
+    }
+    *ppu8Copy = pu8Line + am[0].rm_eo;
+    iPrevEnd  = am[0].rm_eo;
+    uOff      = (size_t)am[0].rm_eo + (am[0].rm_so==am[0].rm_eo);
+  }
+}
+
+/*=== Compile the regexp ============================================
+ * GNU sed compiles it with the GNU regex functions so that "." also
+ * matches <0x00>. They are used when available.
+ * [in]  gpszRx, giExtended : (must be defined as global vars)
+ * [out] pRx : the compiled regexp                                  */
+void rx_compile(rx_t *pRx) {
+
+  /*--- Variables --------------------------------------------------*/
+#ifdef HAVE_GNU_REGEX
+  const char *pszErr;
+#else
+  char        szErr[256];
+  int         iRet;
+#endif
+
+  memset(pRx, 0, sizeof(rx_t));
+#ifdef HAVE_GNU_REGEX
+  re_syntax_options = ((giExtended) ? RE_SYNTAX_POSIX_EXTENDED
+                                    : RE_SYNTAX_POSIX_BASIC    );
+  re_syntax_options &= ~(RE_DOT_NOT_NULL|RE_UNMATCHED_RIGHT_PAREN_ORD);
+  re_syntax_options |= RE_NO_POSIX_BACKTRACKING;
+  if ((pRx->rx.fastmap=malloc(256)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  pszErr = re_compile_pattern(gpszRx, strlen(gpszRx), &pRx->rx);
+  if (pszErr != NULL) {error_exit(1,"%s\n", pszErr);}
+  pRx->rx.regs_allocated = REGS_UNALLOCATED;
+#else
+  if ((iRet=regcomp(&pRx->rx,gpszRx,(giExtended)?REG_EXTENDED:0)) != 0) {
+    regerror(iRet, &pRx->rx, szErr, sizeof(szErr));
+    error_exit(1,"%s\n", szErr);
+  }
+#endif
+}
+
+/*=== Run the regexp on a line =======================================
+ * [in]  pRx     : the compiled regexp
+ *       pu8Line : the line (the byte after it may be overwritten
+ *                 temporarily when REG_STARTEND is not available)
+ *       uLen    : the length of it
+ *       uOff    : the offset to begin searching at
+ * [out] pm      : the matches (the offsets from pu8Line)
+ * [ret]           0 when matched                                   */
+int rx_exec(rx_t *pRx, uint8_t *pu8Line, size_t uLen, size_t uOff,
+            regmatch_t *pm) {
+#if defined(HAVE_GNU_REGEX)
+  size_t i;
+
+  if (re_search(&pRx->rx, (const char*)pu8Line, (regoff_t)uLen,
+                (regoff_t)uOff, (regoff_t)(uLen-uOff), &pRx->stRegs) < 0) {
+    return 1;
+  }
+  for (i=0; i<guNmatch; i++) {
+    pm[i].rm_so = pRx->stRegs.start[i];
+    pm[i].rm_eo = pRx->stRegs.end[i];
+  }
+  return 0;
+#elif defined(REG_STARTEND)
+  pm[0].rm_so = (regoff_t)uOff;
+  pm[0].rm_eo = (regoff_t)uLen;
+  return regexec(&pRx->rx, (const char*)pu8Line, guNmatch, pm,
+                 REG_STARTEND                              );
+#else
+  uint8_t u8 = pu8Line[uLen];
+  size_t  i;
+  int     iRet;
+
+  pu8Line[uLen] = '\0';
+  iRet = regexec(&pRx->rx, (const char*)pu8Line+uOff, guNmatch, pm,
+                 (uOff>0) ? REG_NOTBOL : 0                          );
+  pu8Line[uLen] = u8;
+  if (iRet != 0) {return iRet;}
+  for (i=0; i<guNmatch; i++) {
+    if (pm[i].rm_so >= 0) {pm[i].rm_so += uOff; pm[i].rm_eo += uOff;}
+  }
+  return 0;
+#endif
+}
+
+/*=== Copy a part of the original file into the output ===============
+ * A long part is copied by copy_file_range() between the files
+ * without passing through this process, if possible.
+ * [in,out] pOut : the output
+ * [in]     pu8  : the part (in pOut->pu8Base)
+ *          uLen : the size of it                                   */
+void out_copy(out_t *pOut, const uint8_t *pu8, size_t uLen) {
+
+#ifdef HAVE_COPY_FILE_RANGE
+  /*--- Variables --------------------------------------------------*/
+  off_t   iOff;
+  ssize_t iCopied;
+
+  /*--- Copy it between the files ----------------------------------*/
+  if (pOut->iFdIn >= 0 && uLen >= CFR_MIN) {
+    out_flush(pOut);
+    iOff = (off_t)(pu8-pOut->pu8Base);
+    while (uLen > 0 && pOut->iErrno == 0) {
+      iCopied = copy_file_range(pOut->iFdIn, &iOff, pOut->iFdOut, NULL,
+                                uLen, 0                                 );
+      if (iCopied > 0) {pu8 += iCopied; uLen -= (size_t)iCopied; continue;}
+      if (iCopied < 0 && errno == EINTR) {continue;}
+      /* (not supported on these files, or the file has been shrunk) */
+      pOut->iFdIn = -1;
+      break;
+    }
+  }
+#endif
+
+  /*--- Otherwise, write it ----------------------------------------*/
+  out_add(pOut, pu8, uLen);
+}
+
+/*=== Add bytes to the output ========================================
+ * [in,out] pOut : the output
+ * [in]     pv   : the bytes
+ *          uLen : the number of them                               */
+void out_add(out_t *pOut, const void *pv, size_t uLen) {
+  if (uLen == 0) {return;}
+  if (uLen >= OBUF) {out_flush(pOut); out_write(pOut, pv, uLen); return;}
+  buf_add(&pOut->b, pv, uLen);
+  if (pOut->b.n >= OBUF) {out_flush(pOut);}
+}
+
+/*=== Write the bytes in the output buffer ===========================
+ * [in,out] pOut : the output                                       */
+void out_flush(out_t *pOut) {
+  out_write(pOut, pOut->b.p, pOut->b.n);
+  pOut->b.n = 0;
+}
+
+/*=== Write bytes into the output file ===============================
+ * (Nothing is written any more once it has failed)
+ * [in,out] pOut : the output
+ * [in]     pu8  : the bytes
+ *          uLen : the number of them                               */
+void out_write(out_t *pOut, const uint8_t *pu8, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iWritten;
+
+  /*--- Write them -------------------------------------------------*/
+  while (uLen > 0 && pOut->iErrno == 0) {
+    iWritten = write(pOut->iFdOut, pu8, uLen);
+    if (iWritten < 0) {
+      if (errno != EINTR) {pOut->iErrno = errno;}
+      continue;
+    }
+    pu8  += iWritten;
+    uLen -= (size_t)iWritten;
+  }
+}
+
+/*=== Append bytes to a buffer =======================================
+ * [in,out] pb   : the buffer
+ * [in]     pv   : the bytes (NULL means just making the room)
+ *          uLen : the number of them                               */
+void buf_add(buf_t *pb, const void *pv, size_t uLen) {
+  if (pb->n+uLen+1 > pb->uSize) {
+    pb->uSize = (pb->uSize==0) ? 4096 : pb->uSize;
+    while (pb->n+uLen+1 > pb->uSize) {pb->uSize *= 2;}
+    if ((pb->p=realloc(pb->p, pb->uSize)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  if (pv != NULL) {memcpy(pb->p+pb->n, pv, uLen);}
+  pb->n += uLen;
+}
+
+/*=== Find a string ==================================================
+ * [in] pu8    : the beginning of the bytes to search in
+ *      pu8End : the end of them
+ *      pu8Str : the string to find
+ *      uLen   : the length of it (>0)
+ * [ret]         the first place of the string (NULL if not found)  */
+const uint8_t *find_scalar(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8Last;  /* the last place where it can begin */
+
+  /*--- Find the first byte and verify the rest --------------------*/
+  if ((size_t)(pu8End-pu8) < uLen) {return NULL;}
+  pu8Last = pu8End - uLen;
+  while (pu8 <= pu8Last) {
+    pu8 = memchr(pu8, pu8Str[0], pu8Last-pu8+1);
+    if (pu8 == NULL) {return NULL;}
+    if (uLen < 2 || (pu8[uLen-1] == pu8Str[uLen-1] &&
+                     memcmp(pu8+1, pu8Str+1, uLen-2) == 0)) {return pu8;}
+    pu8++;
+  }
+  return NULL;
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Find a string (SSE2) ===========================================
+ * The same as find_scalar() but the places where both of the first
+ * and the last byte match are found 16 bytes at a time.            */
+__attribute__((target("sse2")))
+const uint8_t *find_sse2(const uint8_t *pu8, const uint8_t *pu8End,
+                         const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  __m128i  vFirst, vLast;
+  unsigned uMask;
+
+  /*--- Find the candidates 16 places at a time --------------------*/
+  if (uLen < 2) {return find_scalar(pu8, pu8End, pu8Str, uLen);}
+  vFirst = _mm_set1_epi8((char)pu8Str[0]     );
+  vLast  = _mm_set1_epi8((char)pu8Str[uLen-1]);
+  for (; (size_t)(pu8End-pu8) >= uLen-1+16; pu8+=16) {
+    uMask = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(vFirst, _mm_loadu_si128((const __m128i*)pu8       )),
+      _mm_cmpeq_epi8(vLast , _mm_loadu_si128((const __m128i*)(pu8+uLen-1)))));
+    for (; uMask; uMask&=uMask-1) {
+      if (memcmp(pu8+__builtin_ctz(uMask)+1, pu8Str+1, uLen-2) == 0) {
+        return pu8+__builtin_ctz(uMask);
+      }
+    }
+  }
+  return find_scalar(pu8, pu8End, pu8Str, uLen);
+}
+
+/*=== Find a string (AVX2) ===========================================
+ * The same as find_sse2() but 32 bytes at a time.                  */
+__attribute__((target("avx2")))
+const uint8_t *find_avx2(const uint8_t *pu8, const uint8_t *pu8End,
+                         const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  __m256i  vFirst, vLast;
+  unsigned uMask;
+
+  /*--- Find the candidates 32 places at a time --------------------*/
+  if (uLen < 2) {return find_scalar(pu8, pu8End, pu8Str, uLen);}
+  vFirst = _mm256_set1_epi8((char)pu8Str[0]     );
+  vLast  = _mm256_set1_epi8((char)pu8Str[uLen-1]);
+  for (; (size_t)(pu8End-pu8) >= uLen-1+32; pu8+=32) {
+    uMask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(vFirst,
+                        _mm256_loadu_si256((const __m256i*)pu8         )),
+      _mm256_cmpeq_epi8(vLast ,
+                        _mm256_loadu_si256((const __m256i*)(pu8+uLen-1)))));
+    for (; uMask; uMask&=uMask-1) {
+      if (memcmp(pu8+__builtin_ctz(uMask)+1, pu8Str+1, uLen-2) == 0) {
+        return pu8+__builtin_ctz(uMask);
+      }
+    }
+  }
+  return find_scalar(pu8, pu8End, pu8Str, uLen);
+}
+#endif
@@ -0,0 +1,1198 @@
+/*####################################################################
+#
+# GRES-NATIVE - The Native Substitution Engine for "gres"
+#
+# USAGE   : gres-native [-E|-F] [-R] [--] regexp replacement [file ...]
+# Args    : regexp, replacement
+#               These are the 1st and 2nd arguments of s/1/2/g.
+#               (See the usage of "gres" for the details)
+#           file ...... Filepath to be substituted ("-" means STDIN).
+#                       The files are regarded as one stream like "cat"
+#                       does.
+# Options : -E ........ Regard "regexp" as an extended regular
+#                       expression (ERE) instead of a basic one (BRE)
+#           -F ........ Regard both of the arguments as not regexp
+#                       strings but simple strings
+#           -R, -r .... Read all files under each directory recursively
+#                       (symbolic links are not followed)
+# Retuen  : Return 0 only when all of the files were read successfully
+#
+# * This is the engine which the "gres" command in the upper directory
+#   uses when it has been compiled. So, it makes exactly the same
+#   output as "sed 's/regexp/replacement/g'" in the script does, which
+#   means
+#   - the substitution is done line by line, and an empty match just
+#     after the previous match is not replaced as GNU sed does,
+#   - "&", "\0"-"\9", "\n", "\t", "\a", "\f", "\v" and "\r" in the
+#     replacement (and the last five in the regexp) are regarded as
+#     GNU sed does. The other GNU escapes ("\L", "\U", "\x41" and so
+#     on) are not supported, and the script leaves them to sed.
+# * The -F strings are searched for by comparing the first and the
+#   last bytes of the string with 16 or 32 bytes at a time by SSE2 or
+#   AVX2 if the CPU supports them, and only the candidates are
+#   verified. When the regexp begins with a literal string, the
+#   lines which don't have the string are skipped in the same way
+#   without running the regexp. The text between the matches is
+#   copied straight from the input buffer.
+# * When two or more files are given (or found by -R), they are read
+#   and substituted by as many threads as the CPUs in parallel, and
+#   written in the order of them anyway. Only the regular files up to
+#   4MB are done so. The others are read and substituted by blocks
+#   in turn as STDIN is, to keep the memory bounded.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lpthread
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -DNOTHREAD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+#if defined(__linux) || defined(__linux__)
+  /* This definition is for the GNU regex functions on Linux */
+  #define _GNU_SOURCE
+#endif
+/*--- headers ------------------------------------------------------*/
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <regex.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+#ifndef NOTHREAD
+  #include <pthread.h>
+#endif
+#if defined(__GLIBC__) && defined(RE_DOT_NOT_NULL)
+  /* compile the regexp in the same way as GNU sed does */
+  #define HAVE_GNU_REGEX
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF        1048576 /* input buffer size (the first one)       */
+#define OBUF        1048576 /* output size to write at a time          */
+#define MAX_THREADS 64      /* max number of the threads               */
+#define JOB_MAX     4194304 /* max file size to substitute in a thread */
+#define MAX_REPS    1024    /* max number of the pieces of replacement */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {
+  uint8_t *p;        /* the bytes (1 more byte is always allocated) */
+  size_t   n;        /* the number of the bytes                     */
+  size_t   uSize;    /* the allocated size                          */
+} buf_t;
+typedef struct {
+  int    iGrp;       /* the group to put (-1 means the literal)     */
+  size_t uOff;       /* the offset of the literal in gpu8RepLit     */
+  size_t uLen;       /* the length of the literal                   */
+} rpiece_t;
+typedef struct {
+  regex_t rx;        /* the compiled regexp (one for each thread)   */
+#ifdef HAVE_GNU_REGEX
+  struct re_registers stRegs; /* the matches (by re_search())       */
+#endif
+} rx_t;
+typedef struct {
+  const char *pszPath; /* the file                                  */
+  uint8_t    *pu8In;   /* the whole content of it                   */
+  size_t      uIn;     /* the size of it                            */
+  size_t      uHead;   /* the end of the first line (with <0x0A>)   */
+  size_t      uTail;   /* the beginning of the partial last line    */
+  buf_t       stOut;   /* the substituted lines between them        */
+  size_t      uCnt;    /* the number of the substitutions in them   */
+  int         iErrno;  /* errno when failed to read (0 means not)   */
+  int         iFd;     /* the file to read by blocks instead (or -1)*/
+  int         iDone;   /* 1 when the thread has finished it         */
+} job_t;
+
+/*--- prototype functions ------------------------------------------*/
+void    parse_regexp(const char *pszPat);
+void    parse_replacement(const char *pszRep);
+void    take_path(const char *pszPath);
+void    walk_dir(const char *pszDir);
+void    add_file(const char *pszPath);
+size_t  read_input(uint8_t *pu8Buf, size_t uSize);
+void    subst_stream(void);
+int     subst_fd(int iFd, buf_t *pbIn, buf_t *pbOut);
+size_t  emit_block(buf_t *pbIn, size_t uRead, buf_t *pbOut);
+void    subst_parallel(int iNthread);
+void    read_job(job_t *pJob);
+void    emit(uint8_t *pu8, size_t uLen, int iLast, rx_t *pRx,
+             buf_t *pbOut);
+size_t  subst_lines(uint8_t *pu8, size_t uLen, int iLast, rx_t *pRx,
+                    buf_t *pbOut);
+size_t  subst_line(uint8_t *pu8Line, size_t uLen, size_t uOff, rx_t *pRx,
+                   const uint8_t **ppu8Copy, buf_t *pbOut);
+void    rx_compile(rx_t *pRx);
+int     rx_exec(rx_t *pRx, uint8_t *pu8Line, size_t uLen, size_t uOff,
+                regmatch_t *pm);
+void    buf_add(buf_t *pb, const void *pv, size_t uLen);
+void    write_all(const void *pv, size_t uLen);
+const uint8_t *find_scalar(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+#ifdef HAVE_X86SIMD
+  const uint8_t *find_sse2(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+  const uint8_t *find_avx2(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen);
+#endif
+#ifndef NOTHREAD
+  void *subst_worker(void *pv);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*     gpszCmdname;   /* The name of this command                */
+char**    gppszFiles;    /* The files to read                       */
+int       giNfiles;      /* The number of them                      */
+int       giFilesSize;   /* The allocated number of gppszFiles      */
+int       giFd;          /* The file descriptor reading now (or -1) */
+int       giRet;         /* The return code                         */
+int       giFixed;       /* 1 when -F option is set                 */
+uint8_t  *gpu8Lit;       /* -F string or the literal prefix of regexp*/
+size_t    guLitLen;      /* the length of it (0 means no prefix)    */
+char     *gpszRx;        /* the regexp to compile (without -F)      */
+int       giExtended;    /* 1 when -E option is set                 */
+size_t    guNsub;        /* the number of the groups in it          */
+rx_t     *garx;          /* the compiled ones (for each thread)     */
+size_t    guNmatch;      /* the number of the groups to get + 1     */
+rpiece_t  garp[MAX_REPS];/* the pieces of the replacement           */
+int       giNrp;         /* the number of them                      */
+uint8_t  *gpu8RepLit;    /* the literals in the replacement         */
+/* The function to find a string (chosen on the CPU)                */
+const uint8_t *(*gpfFind)(const uint8_t*, const uint8_t*,
+                          const uint8_t*, size_t) = find_scalar;
+#ifndef NOTHREAD
+  job_t          *gpJob;       /* the files to substitute             */
+  int             giNjob;      /* the number of them                  */
+  int             giNext;      /* the next job for a thread to take   */
+  int             giWritten;   /* the number of the jobs written      */
+  int             giWindow;    /* max jobs to take ahead of writing   */
+  pthread_mutex_t gmtx = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t  gcnd = PTHREAD_COND_INITIALIZER;
+#endif
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-E|-F] [-R] [--] regexp replacement [file ...]\n"
+    "Args    : regexp, replacement\n"
+    "              These are the 1st and 2nd arguments of s/1/2/g.\n"
+    "              (See the usage of \"gres\" for the details)\n"
+    "          file ...... Filepath to be substituted (\"-\" means STDIN).\n"
+    "                      The files are regarded as one stream like \"cat\"\n"
+    "                      does.\n"
+    "Options : -E ........ Regard \"regexp\" as an extended regular\n"
+    "                      expression (ERE) instead of a basic one (BRE)\n"
+    "          -F ........ Regard both of the arguments as not regexp\n"
+    "                      strings but simple strings\n"
+    "          -R, -r .... Read all files under each directory recursively\n"
+    "                      (symbolic links are not followed)\n"
+    "Retuen  : Return 0 only when all of the files were read successfully\n"
+    "Version : 2026-10-19 10:52:18 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  static char *apszStdin[] = {"-"};
+  int iRecurse;  /* 1 when -R option is set */
+  int iNrx;      /* the number of the compiled regexps */
+#ifndef NOTHREAD
+  int iNthread;  /* the number of the threads */
+#endif
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  giExtended = 0;
+  giFixed    = 0;
+  iRecurse   = 0;
+  while ((i=getopt(argc, argv, "EFRrh")) != -1) {
+    switch (i) {
+      case 'E': giExtended = 1;
+                break;
+      case 'F': giFixed    = 1;
+                break;
+      case 'R':
+      case 'r': iRecurse   = 1;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc < 2) {print_usage_and_exit();}
+  if (giExtended && giFixed) {
+    error_exit(1,"conflicting matchers specified\n");
+  }
+  if (strchr(argv[0],'\n') != NULL) {
+    error_exit(1,"<0x0A> in \"regexp\" argument is not allowed\n");
+  }
+  if (argv[0][0] == '\0') {
+    error_exit(1,"no previous regular expression\n");
+  }
+
+  /*=== Compile the arguments and choose the kernel for the CPU ====*/
+  parse_regexp(argv[0]);
+  parse_replacement(argv[1]);
+  argc -= 2;
+  argv += 2;
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if      (__builtin_cpu_supports("avx2")) {gpfFind = find_avx2;}
+  else if (__builtin_cpu_supports("sse2")) {gpfFind = find_sse2;}
+#endif
+
+  /*=== Make the file list =========================================*/
+  giFd  = -1;
+  giRet = 0;
+  if (! iRecurse) {
+    if (argc == 0) {gppszFiles = apszStdin; giNfiles = 1;   }
+    else           {gppszFiles = argv;      giNfiles = argc;}
+  } else {
+    if (argc == 0) {
+      error_exit(1,"You cannot use recursive option (-R,-r) for STDIN\n");
+    }
+    for (i=0; i<argc; i++) {take_path(argv[i]);}
+  }
+
+  /*=== Decide the number of the threads ==========================*/
+  iNrx = 1;
+#ifndef NOTHREAD
+  iNthread = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (iNthread > MAX_THREADS) {iNthread = MAX_THREADS;}
+  if (iNthread > giNfiles   ) {iNthread = giNfiles;   }
+  for (i=0; i<giNfiles; i++) {
+    if (strcmp(gppszFiles[i],"-") == 0) {iNthread = 1; break;}
+  }
+  if (iNthread > 1) {iNrx = iNthread+1;}
+#endif
+
+  /*=== Compile the regexp for every thread ========================*/
+  /* (A compiled regexp is locked while used, so each thread has its
+     own. They must be compiled here before the threads start.)     */
+  if (! giFixed) {
+    if ((garx=calloc((size_t)iNrx, sizeof(rx_t))) == NULL) {
+      error_exit(errno,"calloc(): %s\n", strerror(errno));
+    }
+    for (i=0; i<iNrx; i++) {rx_compile(&garx[i]);}
+  }
+
+  /*=== Substitute =================================================*/
+#ifndef NOTHREAD
+  if (iNthread > 1) {subst_parallel(iNthread);}
+  else
+#endif
+  subst_stream();
+
+  /*=== Finish =====================================================*/
+  return giRet;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Prepare the regexp (or the fixed string) =======================
+ * The escapes which GNU sed converts before compiling are converted,
+ * and the literal string which all the matches begin with is taken
+ * for skipping the lines quickly. The regexp is compiled here only
+ * to be checked.
+ * [in] pszPat : the regexp                                         */
+void parse_regexp(const char *pszPat) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc;
+  char       *pszRx, *pc2;
+  size_t      uLen;
+  int         iExtended = giExtended;
+  rx_t        stRx;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  uLen = strlen(pszPat);
+  if ((gpu8Lit=malloc(uLen+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  if (giFixed) {
+    memcpy(gpu8Lit, pszPat, uLen);
+    guLitLen = uLen;
+    return;
+  }
+
+  /*--- Convert the escapes ----------------------------------------*/
+  if ((pszRx=malloc(uLen+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  for (pc=pszPat, pc2=pszRx; *pc!='\0'; pc++) {
+    if (*pc != '\\' || pc[1] == '\0') {*pc2++ = *pc; continue;}
+    switch (pc[1]) {
+      case 'n': *pc2++ = '\n'; pc++; break;
+      case 't': *pc2++ = '\t'; pc++; break;
+      case 'a': *pc2++ = '\a'; pc++; break;
+      case 'f': *pc2++ = '\f'; pc++; break;
+      case 'v': *pc2++ = '\v'; pc++; break;
+      case 'r': *pc2++ = '\r'; pc++; break;
+      case 'c': case 'd': case 'o': case 'x':
+        error_exit(1,"\\%c in \"regexp\" argument is not supported\n",pc[1]);
+        break;
+      default : *pc2++ = *pc++; *pc2++ = *pc; break;
+    }
+  }
+  *pc2 = '\0';
+
+  /*--- Check it ---------------------------------------------------*/
+  gpszRx = pszRx;
+  rx_compile(&stRx);
+  guNsub = stRx.rx.re_nsub;
+  regfree(&stRx.rx);
+
+  /*--- Take the literal prefix ------------------------------------*/
+  /* (given up when there is an alternation anywhere)               */
+  guLitLen = 0;
+  if (strstr(pszRx, (iExtended)?"|":"\\|") != NULL) {return;}
+  pc = pszRx;
+  if (*pc == '^') {pc++;}
+  while (*pc != '\0') {
+    if (*pc == '\\') {
+      if (pc[1]=='\0' || strchr(".[]*^$\\/",pc[1])==NULL) {
+        if (! iExtended || pc[1]=='\0' || strchr("+?{}()|",pc[1])==NULL) {
+          break;
+        }
+      }
+      gpu8Lit[guLitLen++] = (uint8_t)pc[1];
+      pc += 2;
+    } else {
+      if (strchr((iExtended)?".[]*^$+?{}()|":".[]*^$",*pc) != NULL) {break;}
+      gpu8Lit[guLitLen++] = (uint8_t)*pc;
+      pc++;
+    }
+    /* the last one is not a must if a quantifier follows it */
+    if (*pc=='*' || (  iExtended && (*pc=='+' || *pc=='?' || *pc=='{')) ||
+        (! iExtended && pc[0]=='\\' &&
+         (pc[1]=='{' || pc[1]=='+' || pc[1]=='?')                       )) {
+      guLitLen--;
+      break;
+    }
+  }
+}
+
+/*=== Compile the replacement ========================================
+ * [in] pszRep : the replacement                                    */
+void parse_replacement(const char *pszRep) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc;
+  size_t      uLit;
+  int         iGrp;
+
+  /*--- Prepare ----------------------------------------------------*/
+  if ((gpu8RepLit=malloc(strlen(pszRep)+1)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  giNrp    = 0;
+  guNmatch = 1;
+  uLit     = 0;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  if (giFixed) {
+    uLit = strlen(pszRep);
+    memcpy(gpu8RepLit, pszRep, uLit);
+    garp[0].iGrp = -1;
+    garp[0].uOff =  0;
+    garp[0].uLen = uLit;
+    giNrp = 1;
+    return;
+  }
+
+  /*--- Split it into the literals and the groups ------------------*/
+  garp[0].iGrp = -1;
+  garp[0].uOff =  0;
+  garp[0].uLen =  0;
+  for (pc=pszRep; *pc!='\0'; pc++) {
+    iGrp = -1;
+    if        (*pc == '&' ) {
+      iGrp = 0;
+    } else if (*pc == '\n') {
+      error_exit(1,"unterminated `s' command\n");
+    } else if (*pc == '\\') {
+      pc++;
+      switch (*pc) {
+        case '\0': error_exit(1,"unterminated `s' command\n");
+                   break;
+        case 'n' : gpu8RepLit[uLit++] = '\n'; break;
+        case 't' : gpu8RepLit[uLit++] = '\t'; break;
+        case 'a' : gpu8RepLit[uLit++] = '\a'; break;
+        case 'f' : gpu8RepLit[uLit++] = '\f'; break;
+        case 'v' : gpu8RepLit[uLit++] = '\v'; break;
+        case 'r' : gpu8RepLit[uLit++] = '\r'; break;
+        case 'L' : case 'U': case 'l': case 'u': case 'E':
+        case 'c' : case 'd': case 'o': case 'x':
+          error_exit(1,"\\%c in \"replacement\" argument is not supported\n",
+                     *pc);
+          break;
+        default  : if (*pc>='0' && *pc<='9') {iGrp = *pc - '0';       }
+                   else                      {gpu8RepLit[uLit++] = *pc;}
+                   break;
+      }
+    } else {
+      gpu8RepLit[uLit++] = (uint8_t)*pc;
+    }
+    if (iGrp < 0) {continue;}
+    /*--- close the literal and add the group ----------------------*/
+    if (iGrp > (int)guNsub) {
+      error_exit(1,"invalid reference \\%d on `s' command's RHS\n",iGrp);
+    }
+    if (giNrp+2 >= MAX_REPS) {error_exit(1,"Too long replacement\n");}
+    garp[giNrp].uLen = uLit - garp[giNrp].uOff;
+    giNrp++;
+    garp[giNrp].iGrp = iGrp;
+    giNrp++;
+    garp[giNrp].iGrp = -1;
+    garp[giNrp].uOff = uLit;
+    garp[giNrp].uLen = 0;
+    if ((size_t)iGrp >= guNmatch) {guNmatch = (size_t)iGrp+1;}
+  }
+  garp[giNrp].uLen = uLit - garp[giNrp].uOff;
+  giNrp++;
+}
+
+/*=== Add a file given by the user (-R) ==============================
+ * Only the regular files are added, and the directories are walked
+ * into, in the same order as "find" does.
+ * [in] pszPath : The file                                          */
+void take_path(const char *pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+
+  /*--- Add or walk into it ----------------------------------------*/
+  if (lstat(pszPath, &stInfo) < 0) {
+    warning("%s: %s\n", pszPath, strerror(errno));
+    giRet = 1;
+    return;
+  }
+  if      (S_ISREG(stInfo.st_mode)) {add_file(pszPath);}
+  else if (S_ISDIR(stInfo.st_mode)) {walk_dir(pszPath);}
+}
+
+/*=== Add all files in a directory recursively =======================
+ * [in] pszDir : The directory                                      */
+void walk_dir(const char *pszDir) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct dirent *pde;
+  DIR           *pdir;
+  char          *pszPath;
+  size_t         uLen, uSep;
+
+  /*--- Open it ----------------------------------------------------*/
+  if ((pdir=opendir(pszDir)) == NULL) {
+    warning("%s: %s\n", pszDir, strerror(errno));
+    giRet = 1;
+    return;
+  }
+  uLen = strlen(pszDir);
+  uSep = (uLen>0 && pszDir[uLen-1]=='/') ? 0 : 1;
+
+  /*--- Add or walk into every entry -------------------------------*/
+  while (errno=0, (pde=readdir(pdir)) != NULL) {
+    if (pde->d_name[0]=='.' && (pde->d_name[1]=='\0' ||
+        (pde->d_name[1]=='.' && pde->d_name[2]=='\0'))) {continue;}
+    if ((pszPath=malloc(uLen+uSep+strlen(pde->d_name)+1)) == NULL) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+    memcpy(pszPath, pszDir, uLen);
+    if (uSep) {pszPath[uLen] = '/';}
+    strcpy(pszPath+uLen+uSep, pde->d_name);
+    #ifdef DT_DIR
+      if      (pde->d_type == DT_REG) {add_file(pszPath);             }
+      else if (pde->d_type == DT_DIR) {walk_dir(pszPath);free(pszPath);}
+      else if (pde->d_type != DT_UNKNOWN) {free(pszPath);             }
+      else
+    #endif
+    {
+      take_path(pszPath);
+      if (giNfiles==0 || gppszFiles[giNfiles-1]!=pszPath) {free(pszPath);}
+    }
+  }
+  if (errno != 0) {
+    warning("%s: %s\n", pszDir, strerror(errno));
+    giRet = 1;
+  }
+  closedir(pdir);
+}
+
+/*=== Add a file to the list =========================================
+ * [in] pszPath : The file (it must be kept until the end)          */
+void add_file(const char *pszPath) {
+  if (giNfiles >= giFilesSize) {
+    giFilesSize = (giFilesSize==0) ? 1024 : giFilesSize*2;
+    gppszFiles  = realloc(gppszFiles, sizeof(char*)*giFilesSize);
+    if (gppszFiles == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  gppszFiles[giNfiles++] = (char*)pszPath;
+}
+
+/*=== Read the next bytes from the files one after another ===========
+ * [out] pu8Buf : The buffer to store them
+ * [in]  uSize  : The size of the buffer
+ * [ret]        : The number of the bytes read (0 at the end of all)*/
+size_t read_input(uint8_t *pu8Buf, size_t uSize) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iRead;
+
+  while (1) {
+    /*--- Open the next file if no file is open --------------------*/
+    if (giFd < 0) {
+      if (giNfiles == 0) {return 0;}
+      if (strcmp(gppszFiles[0],"-") == 0) {
+        giFd = STDIN_FILENO;
+      } else if ((giFd=open(gppszFiles[0],O_RDONLY)) < 0) {
+        warning("%s: %s\n", gppszFiles[0], strerror(errno));
+        giRet = 1;
+        gppszFiles++; giNfiles--;
+        continue;
+      }
+    }
+    /*--- Read it --------------------------------------------------*/
+    iRead = read(giFd, pu8Buf, uSize);
+    if (iRead > 0) {return (size_t)iRead;}
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      warning("%s: %s\n", gppszFiles[0], strerror(errno));
+      giRet = 1;
+    }
+    /*--- Go to the next file at the end of this one ---------------*/
+    if (giFd != STDIN_FILENO) {close(giFd);}
+    giFd = -1;
+    gppszFiles++; giNfiles--;
+  }
+}
+
+/*=== Substitute the files as one stream =============================*/
+void subst_stream(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  buf_t    stIn, stOut;
+  size_t   uRead;
+
+  /*--- Prepare the buffers ----------------------------------------*/
+  memset(&stIn , 0, sizeof(stIn ));
+  memset(&stOut, 0, sizeof(stOut));
+  buf_add(&stIn, NULL, IBUF-1);
+  stIn.n = 0;
+
+  /*--- Substitute every block of the complete lines ---------------*/
+  while (1) {
+    if (stIn.n+1 >= stIn.uSize) {buf_add(&stIn, NULL, 1); stIn.n--;}
+    if ((uRead=read_input(stIn.p+stIn.n, stIn.uSize-1-stIn.n)) == 0) {break;}
+    emit_block(&stIn, uRead, &stOut);
+  }
+
+  /*--- Substitute the last line -----------------------------------*/
+  /* (It is substituted even if empty as sed in the script does.)   */
+  emit(stIn.p, stIn.n, 1, garx, &stOut);
+}
+
+/*=== Substitute a file by blocks after the carried bytes ============
+ * [in]     iFd   : the file descriptor to read
+ * [in,out] pbIn  : the bytes carried from the previous files (the
+ *                  partial last line of this file is left in it)
+ * [out]    pbOut : the buffer to write them through
+ * [ret]            0 (or errno when failed to read)                */
+int subst_fd(int iFd, buf_t *pbIn, buf_t *pbOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iRead;
+  size_t  u;
+
+  /*--- Substitute every block of the complete lines ---------------*/
+  if (pbIn->uSize < IBUF) {
+    u = pbIn->n; buf_add(pbIn, NULL, IBUF-1-u); pbIn->n = u;
+  }
+  while (1) {
+    if (pbIn->n+1 >= pbIn->uSize) {buf_add(pbIn, NULL, 1); pbIn->n--;}
+    iRead = read(iFd, pbIn->p+pbIn->n, pbIn->uSize-1-pbIn->n);
+    if (iRead == 0) {return 0;}
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      return errno;
+    }
+    emit_block(pbIn, (size_t)iRead, pbOut);
+  }
+}
+
+/*=== Substitute and write the complete lines in a buffer ============
+ * [in,out] pbIn  : the buffer (the partial last line is left in it)
+ * [in]     uRead : the number of the bytes just added to it (the
+ *                  bytes before them have no <0x0A>)
+ * [out]    pbOut : the buffer to write them through
+ * [ret]            the number of the bytes substituted and written */
+size_t emit_block(buf_t *pbIn, size_t uRead, buf_t *pbOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  size_t uLines;
+
+  /*--- Find the end of the complete lines -------------------------*/
+  pbIn->n += uRead;
+  for (uLines=pbIn->n; uLines>pbIn->n-uRead; uLines--) {
+    if (pbIn->p[uLines-1] == '\n') {break;}
+  }
+  if (uLines == pbIn->n-uRead) {return 0;}
+
+  /*--- Substitute them and leave the rest -------------------------*/
+  emit(pbIn->p, uLines, 0, garx, pbOut);
+  memmove(pbIn->p, pbIn->p+uLines, pbIn->n-uLines);
+  pbIn->n -= uLines;
+  return uLines;
+}
+
+#ifndef NOTHREAD
+/*=== Substitute the files by the threads in parallel ================
+ * A file which doesn't end with <0x0A> joins its last line to the
+ * first line of the next file as "cat" does. So, the first and the
+ * last line of every file are substituted here in order, and the
+ * lines between them by the threads.
+ * [in] iNthread : the number of the threads                        */
+void subst_parallel(int iNthread) {
+
+  /*--- Variables --------------------------------------------------*/
+  pthread_t athr[MAX_THREADS];
+  buf_t     stCarry, stOut;
+  job_t    *pJob;
+  int       i;
+
+  /*--- Start the threads ------------------------------------------*/
+  if ((gpJob=calloc((size_t)giNfiles, sizeof(job_t))) == NULL) {
+    error_exit(errno,"calloc(): %s\n", strerror(errno));
+  }
+  for (i=0; i<giNfiles; i++) {
+    gpJob[i].pszPath = gppszFiles[i];
+    gpJob[i].iFd     = -1;
+  }
+  giNjob    = giNfiles;
+  giNext    = 0;
+  giWritten = 0;
+  giWindow  = iNthread*2;
+  for (i=0; i<iNthread; i++) {
+    if ((errno=pthread_create(&athr[i],NULL,subst_worker,
+                              (giFixed)?NULL:&garx[i+1]  )) != 0) {
+      error_exit(errno,"pthread_create(): %s\n", strerror(errno));
+    }
+  }
+
+  /*--- Write the results in order as they come --------------------*/
+  memset(&stCarry, 0, sizeof(stCarry));
+  memset(&stOut  , 0, sizeof(stOut  ));
+  for (i=0; i<giNjob; i++) {
+    pJob = &gpJob[i];
+    pthread_mutex_lock(&gmtx);
+    while (! pJob->iDone) {pthread_cond_wait(&gcnd,&gmtx);}
+    pthread_mutex_unlock(&gmtx);
+    if (pJob->iErrno != 0) {
+      warning("%s: %s\n", pJob->pszPath, strerror(pJob->iErrno));
+      giRet = 1;
+    } else if (pJob->iFd >= 0) {
+      if ((errno=subst_fd(pJob->iFd, &stCarry, &stOut)) != 0) {
+        warning("%s: %s\n", pJob->pszPath, strerror(errno));
+        giRet = 1;
+      }
+      close(pJob->iFd);
+    } else {
+      buf_add(&stCarry, pJob->pu8In, pJob->uHead);
+      if (pJob->uHead>0 && pJob->pu8In[pJob->uHead-1]=='\n') {
+        emit(stCarry.p, stCarry.n, 0, garx, &stOut);
+        stCarry.n = 0;
+        if (pJob->uCnt > 0) {
+          write_all(pJob->stOut.p, pJob->stOut.n);
+        } else {
+          write_all(pJob->pu8In+pJob->uHead, pJob->uTail-pJob->uHead);
+        }
+        buf_add(&stCarry, pJob->pu8In+pJob->uTail, pJob->uIn-pJob->uTail);
+      }
+    }
+    free(pJob->pu8In);
+    free(pJob->stOut.p);
+    pthread_mutex_lock(&gmtx);
+    giWritten = i+1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  for (i=0; i<iNthread; i++) {pthread_join(athr[i],NULL);}
+
+  /*--- Substitute the last line -----------------------------------*/
+  emit(stCarry.p, stCarry.n, 1, garx, &stOut);
+}
+
+/*=== (Thread) Substitute the files one after another ================
+ * [in]     pv : the compiled regexp for this thread (rx_t*)
+ * [in,out] gpJob, giNjob, giNext, giWritten, giWindow
+ *          : (must be defined as global vars)                      */
+void *subst_worker(void *pv) {
+
+  /*--- Variables --------------------------------------------------*/
+  rx_t  *pRx = (rx_t*)pv;
+  job_t *pJob;
+  int    i;
+
+  while (1) {
+    /*--- Take the next file (not too far ahead of writing) --------*/
+    pthread_mutex_lock(&gmtx);
+    while (giNext<giNjob && giNext>=giWritten+giWindow) {
+      pthread_cond_wait(&gcnd,&gmtx);
+    }
+    i = giNext++;
+    pthread_mutex_unlock(&gmtx);
+    if (i >= giNjob) {break;}
+
+    /*--- Substitute the lines but the first and the last ----------*/
+    pJob = &gpJob[i];
+    read_job(pJob);
+    if (pJob->iErrno==0 && pJob->iFd<0) {
+      pJob->uCnt = subst_lines(pJob->pu8In+pJob->uHead,
+                               pJob->uTail-pJob->uHead, 0, pRx,
+                               &pJob->stOut                    );
+    }
+
+    /*--- Tell the main thread -------------------------------------*/
+    pthread_mutex_lock(&gmtx);
+    pJob->iDone = 1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  return NULL;
+}
+#endif
+
+/*=== Read the whole content of a file for a job =====================
+ * A file which is not regular or larger than JOB_MAX is not read but
+ * left open to be substituted by blocks in turn.
+ * [in,out] pJob : the job (pszPath in, the others out)             */
+void read_job(job_t *pJob) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stInfo;
+  buf_t       stIn;
+  ssize_t     iRead;
+  size_t      u;
+  int         iFd;
+
+  /*--- Read it ----------------------------------------------------*/
+  memset(&stIn, 0, sizeof(stIn));
+  if ((iFd=open(pJob->pszPath,O_RDONLY)) < 0) {pJob->iErrno = errno; return;}
+  if (fstat(iFd,&stInfo)<0 || ! S_ISREG(stInfo.st_mode) ||
+      stInfo.st_size > JOB_MAX                          ) {
+    pJob->iFd = iFd;
+    return;
+  }
+  buf_add(&stIn, NULL, (size_t)stInfo.st_size+1);
+  stIn.n = 0;
+  while (1) {
+    if (stIn.n+1 >= stIn.uSize) {buf_add(&stIn, NULL, 1); stIn.n--;}
+    iRead = read(iFd, stIn.p+stIn.n, stIn.uSize-1-stIn.n);
+    if (iRead > 0) {stIn.n += (size_t)iRead; continue;}
+    if (iRead == 0) {break;}
+    if (errno == EINTR) {continue;}
+    pJob->iErrno = errno;
+    break;
+  }
+  close(iFd);
+  pJob->pu8In = stIn.p;
+  pJob->uIn   = stIn.n;
+
+  /*--- Find the first and the last line ---------------------------*/
+  for (u=0; u<stIn.n && stIn.p[u]!='\n'; u++);
+  pJob->uHead = (u<stIn.n) ? u+1 : stIn.n;
+  for (u=stIn.n; u>pJob->uHead && stIn.p[u-1]!='\n'; u--);
+  pJob->uTail = u;
+}
+
+/*=== Substitute the lines and write them ============================
+ * [in] pu8   : the lines
+ *      uLen  : the size of them
+ *      iLast : 1 when the last one doesn't end with <0x0A>
+ *      pRx   : the compiled regexp
+ *      pbOut : the buffer to write them through                    */
+void emit(uint8_t *pu8, size_t uLen, int iLast, rx_t *pRx,
+          buf_t *pbOut) {
+  pbOut->n = 0;
+  if (subst_lines(pu8, uLen, iLast, pRx, pbOut) > 0) {
+    write_all(pbOut->p, pbOut->n);
+  } else {
+    write_all(pu8, uLen);
+  }
+}
+
+/*=== Substitute the lines ===========================================
+ * The result is made in the buffer only when something has been
+ * substituted, to let the caller write the input as it is otherwise.
+ * [in]  pu8   : the lines
+ *       uLen  : the size of them
+ *       iLast : 1 when the last one doesn't end with <0x0A> (it can
+ *               be empty)
+ *       pRx   : the compiled regexp (unused with -F)
+ * [out] pbOut : the buffer to append the result to
+ * [ret]         the number of the substitutions                    */
+size_t subst_lines(uint8_t *pu8, size_t uLen, int iLast, rx_t *pRx,
+                   buf_t *pbOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint8_t       *pu8End = pu8+uLen;
+  const uint8_t *pu8Copy;  /* the bytes from here are not copied yet */
+  uint8_t       *pu8Line, *pu8Bol, *pu8Eol, *pu8Hit;
+  size_t         uCnt;
+
+  pu8Copy = pu8;
+  uCnt    = 0;
+
+  /*--- Fixed string (-F) ------------------------------------------*/
+  if (giFixed) {
+    for (pu8Hit=pu8;
+         (pu8Hit=(uint8_t*)gpfFind(pu8Hit,pu8End,gpu8Lit,guLitLen))!=NULL;
+         pu8Hit+=guLitLen                                                ) {
+      buf_add(pbOut, pu8Copy, pu8Hit-pu8Copy);
+      buf_add(pbOut, gpu8RepLit, garp[0].uLen);
+      pu8Copy = pu8Hit + guLitLen;
+      uCnt++;
+    }
+
+  /*--- Regexp with the literal prefix -----------------------------*/
+  } else if (guLitLen > 0) {
+    for (pu8Line=pu8; pu8Line<pu8End; pu8Line=pu8Eol+1) {
+      pu8Hit = (uint8_t*)gpfFind(pu8Line,pu8End,gpu8Lit,guLitLen);
+      if (pu8Hit == NULL) {break;}
+      for (pu8Bol=pu8Hit; pu8Bol>pu8Line && pu8Bol[-1]!='\n'; pu8Bol--);
+      pu8Eol = memchr(pu8Hit, '\n', pu8End-pu8Hit);
+      if (pu8Eol == NULL) {pu8Eol = pu8End;}
+      uCnt += subst_line(pu8Bol, pu8Eol-pu8Bol, pu8Hit-pu8Bol, pRx,
+                         &pu8Copy, pbOut);
+      if (pu8Eol == pu8End) {break;}
+    }
+
+  /*--- Regexp -----------------------------------------------------*/
+  } else {
+    for (pu8Line=pu8; ; pu8Line=pu8Eol+1) {
+      pu8Eol = memchr(pu8Line, '\n', pu8End-pu8Line);
+      if (pu8Eol == NULL) {
+        if (! iLast) {break;}
+        pu8Eol = pu8End;
+      }
+      uCnt += subst_line(pu8Line, pu8Eol-pu8Line, 0, pRx, &pu8Copy, pbOut);
+      if (pu8Eol == pu8End) {break;}
+    }
+  }
+
+  /*--- Copy the rest ----------------------------------------------*/
+  if (uCnt > 0) {buf_add(pbOut, pu8Copy, pu8End-pu8Copy);}
+  return uCnt;
+}
+
+/*=== Substitute a line by the regexp ================================
+ * [in]     pu8Line  : the line (without <0x0A>)
+ *          uLen     : the length of it
+ *          uOff     : the offset to begin searching at
+ *          pRx      : the compiled regexp
+ * [in,out] ppu8Copy : the first byte which is not copied yet
+ * [out]    pbOut    : the buffer to append the result to
+ * [ret]               the number of the substitutions              */
+size_t subst_line(uint8_t *pu8Line, size_t uLen, size_t uOff, rx_t *pRx,
+                  const uint8_t **ppu8Copy, buf_t *pbOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  regmatch_t am[10];
+  regoff_t   iPrevEnd;
+  size_t     uCnt;
+  int        i;
+
+  /*--- Replace every match ----------------------------------------*/
+  uCnt     = 0;
+  iPrevEnd = -1;
+  while (uOff <= uLen && rx_exec(pRx, pu8Line, uLen, uOff, am) == 0) {
+    /* an empty match just after the previous match is ignored */
+    if (am[0].rm_so==am[0].rm_eo && am[0].rm_so==iPrevEnd) {
+      uOff = (size_t)am[0].rm_so + 1;
+      continue;
+    }
+    buf_add(pbOut, *ppu8Copy, pu8Line+am[0].rm_so-*ppu8Copy);
+    for (i=0; i<giNrp; i++) {
+      if (garp[i].iGrp < 0) {
+        buf_add(pbOut, gpu8RepLit+garp[i].uOff, garp[i].uLen);
+      } else if (am[garp[i].iGrp].rm_so >= 0) {
+        buf_add(pbOut, pu8Line+am[garp[i].iGrp].rm_so,
+                am[garp[i].iGrp].rm_eo-am[garp[i].iGrp].rm_so);
+      }
+    }
+    *ppu8Copy = pu8Line + am[0].rm_eo;
+    iPrevEnd  = am[0].rm_eo;
+    uOff      = (size_t)am[0].rm_eo + (am[0].rm_so==am[0].rm_eo);
+    uCnt++;
+  }
+  return uCnt;
+}
+
+/*=== Compile the regexp ============================================
+ * GNU sed compiles it with the GNU regex functions so that "." also
+ * matches <0x00>. They are used when available.
+ * [in]  gpszRx, giExtended : (must be defined as global vars)
+ * [out] pRx : the compiled regexp                                  */
+void rx_compile(rx_t *pRx) {
+
+  /*--- Variables --------------------------------------------------*/
+#ifdef HAVE_GNU_REGEX
+  const char *pszErr;
+#else
+  char        szErr[256];
+  int         iRet;
+#endif
+
+  memset(pRx, 0, sizeof(rx_t));
+#ifdef HAVE_GNU_REGEX
+  re_syntax_options = ((giExtended) ? RE_SYNTAX_POSIX_EXTENDED
+                                    : RE_SYNTAX_POSIX_BASIC    );
+  re_syntax_options &= ~(RE_DOT_NOT_NULL|RE_UNMATCHED_RIGHT_PAREN_ORD);
+  re_syntax_options |= RE_NO_POSIX_BACKTRACKING;
+  if ((pRx->rx.fastmap=malloc(256)) == NULL) {
+    error_exit(errno,"malloc(): %s\n", strerror(errno));
+  }
+  pszErr = re_compile_pattern(gpszRx, strlen(gpszRx), &pRx->rx);
+  if (pszErr != NULL) {error_exit(1,"%s\n", pszErr);}
+  pRx->rx.regs_allocated = REGS_UNALLOCATED;
+#else
+  if ((iRet=regcomp(&pRx->rx,gpszRx,(giExtended)?REG_EXTENDED:0)) != 0) {
+    regerror(iRet, &pRx->rx, szErr, sizeof(szErr));
+    error_exit(1,"%s\n", szErr);
+  }
+#endif
+}
+
+/*=== Run the regexp on a line =======================================
+ * [in]  pRx     : the compiled regexp
+ *       pu8Line : the line (the byte after it may be overwritten
+ *                 temporarily when REG_STARTEND is not available)
+ *       uLen    : the length of it
+ *       uOff    : the offset to begin searching at
+ * [out] pm      : the matches (the offsets from pu8Line)
+ * [ret]           0 when matched                                   */
+int rx_exec(rx_t *pRx, uint8_t *pu8Line, size_t uLen, size_t uOff,
+            regmatch_t *pm) {
+#if defined(HAVE_GNU_REGEX)
+  size_t i;
+
+  if (re_search(&pRx->rx, (const char*)pu8Line, (regoff_t)uLen,
+                (regoff_t)uOff, (regoff_t)(uLen-uOff), &pRx->stRegs) < 0) {
+    return 1;
+  }
+  for (i=0; i<guNmatch; i++) {
+    pm[i].rm_so = pRx->stRegs.start[i];
+    pm[i].rm_eo = pRx->stRegs.end[i];
+  }
+  return 0;
+#elif defined(REG_STARTEND)
+  pm[0].rm_so = (regoff_t)uOff;
+  pm[0].rm_eo = (regoff_t)uLen;
+  return regexec(&pRx->rx, (const char*)pu8Line, guNmatch, pm,
+                 REG_STARTEND                              );
+#else
+  uint8_t u8 = pu8Line[uLen];
+  size_t  i;
+  int     iRet;
+
+  pu8Line[uLen] = '\0';
+  iRet = regexec(&pRx->rx, (const char*)pu8Line+uOff, guNmatch, pm,
+                 (uOff>0) ? REG_NOTBOL : 0                          );
+  pu8Line[uLen] = u8;
+  if (iRet != 0) {return iRet;}
+  for (i=0; i<guNmatch; i++) {
+    if (pm[i].rm_so >= 0) {pm[i].rm_so += uOff; pm[i].rm_eo += uOff;}
+  }
+  return 0;
+#endif
+}
+
+/*=== Append bytes to a buffer =======================================
+ * [in,out] pb   : the buffer
+ * [in]     pv   : the bytes (NULL means just making the room)
+ *          uLen : the number of them                               */
+void buf_add(buf_t *pb, const void *pv, size_t uLen) {
+  if (pb->n+uLen+1 > pb->uSize) {
+    pb->uSize = (pb->uSize==0) ? 4096 : pb->uSize;
+    while (pb->n+uLen+1 > pb->uSize) {pb->uSize *= 2;}
+    if ((pb->p=realloc(pb->p, pb->uSize)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+  }
+  if (pv != NULL) {memcpy(pb->p+pb->n, pv, uLen);}
+  pb->n += uLen;
+}
+
+/*=== Write bytes to the stdout ======================================
+ * [in] pv   : the bytes
+ *      uLen : the number of them                                   */
+void write_all(const void *pv, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc = pv;
+  ssize_t     iWritten;
+
+  /*--- Write them -------------------------------------------------*/
+  while (uLen > 0) {
+    iWritten = write(STDOUT_FILENO, pc, uLen);
+    if (iWritten < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write(): %s\n", strerror(errno));
+    }
+    pc   += iWritten;
+    uLen -= (size_t)iWritten;
+  }
+}
+
+/*=== Find a string ==================================================
+ * [in] pu8    : the beginning of the bytes to search in
+ *      pu8End : the end of them
+ *      pu8Str : the string to find
+ *      uLen   : the length of it (>0)
+ * [ret]         the first place of the string (NULL if not found)  */
+const uint8_t *find_scalar(const uint8_t *pu8, const uint8_t *pu8End,
+                           const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8Last;  /* the last place where it can begin */
+
+  /*--- Find the first byte and verify the rest --------------------*/
+  if ((size_t)(pu8End-pu8) < uLen) {return NULL;}
+  pu8Last = pu8End - uLen;
+  while (pu8 <= pu8Last) {
+    pu8 = memchr(pu8, pu8Str[0], pu8Last-pu8+1);
+    if (pu8 == NULL) {return NULL;}
+    if (uLen < 2 || (pu8[uLen-1] == pu8Str[uLen-1] &&
+                     memcmp(pu8+1, pu8Str+1, uLen-2) == 0)) {return pu8;}
+    pu8++;
+  }
+  return NULL;
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Find a string (SSE2) ===========================================
+ * The same as find_scalar() but the places where both of the first
+ * and the last byte match are found 16 bytes at a time.            */
+__attribute__((target("sse2")))
+const uint8_t *find_sse2(const uint8_t *pu8, const uint8_t *pu8End,
+                         const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  __m128i  vFirst, vLast;
+  unsigned uMask;
+
+  /*--- Find the candidates 16 places at a time --------------------*/
+  if (uLen < 2) {return find_scalar(pu8, pu8End, pu8Str, uLen);}
+  vFirst = _mm_set1_epi8((char)pu8Str[0]     );
+  vLast  = _mm_set1_epi8((char)pu8Str[uLen-1]);
+  for (; (size_t)(pu8End-pu8) >= uLen-1+16; pu8+=16) {
+    uMask = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpeq_epi8(vFirst, _mm_loadu_si128((const __m128i*)pu8       )),
+      _mm_cmpeq_epi8(vLast , _mm_loadu_si128((const __m128i*)(pu8+uLen-1)))));
+    for (; uMask; uMask&=uMask-1) {
+      if (memcmp(pu8+__builtin_ctz(uMask)+1, pu8Str+1, uLen-2) == 0) {
+        return pu8+__builtin_ctz(uMask);
+      }
+    }
+  }
+  return find_scalar(pu8, pu8End, pu8Str, uLen);
+}
+
+/*=== Find a string (AVX2) ===========================================
+ * The same as find_sse2() but 32 bytes at a time.                  */
+__attribute__((target("avx2")))
+const uint8_t *find_avx2(const uint8_t *pu8, const uint8_t *pu8End,
+                         const uint8_t *pu8Str, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  __m256i  vFirst, vLast;
+  unsigned uMask;
+
+  /*--- Find the candidates 32 places at a time --------------------*/
+  if (uLen < 2) {return find_scalar(pu8, pu8End, pu8Str, uLen);}
+  vFirst = _mm256_set1_epi8((char)pu8Str[0]     );
+  vLast  = _mm256_set1_epi8((char)pu8Str[uLen-1]);
+  for (; (size_t)(pu8End-pu8) >= uLen-1+32; pu8+=32) {
+    uMask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(vFirst,
+                        _mm256_loadu_si256((const __m256i*)pu8         )),
+      _mm256_cmpeq_epi8(vLast ,
+                        _mm256_loadu_si256((const __m256i*)(pu8+uLen-1)))));
+    for (; uMask; uMask&=uMask-1) {
+      if (memcmp(pu8+__builtin_ctz(uMask)+1, pu8Str+1, uLen-2) == 0) {
+        return pu8+__builtin_ctz(uMask);
+      }
+    }
+  }
+  return find_scalar(pu8, pu8End, pu8Str, uLen);
+}
+#endif
@@ -0,0 +1,519 @@
+/*####################################################################
+#
+# GZPIPE-NATIVE - The Native Multi-Threaded Compressor for "gzpipe"
+#
+# USAGE   : gzpipe-native [-1|...|-9] [-p threads]
+# Options : -1,...,-9 . Compression level as gzip (default: 6)
+#           -p threads  Number of the threads to compress with
+#                       (default: the number of the CPUs)
+# Retuen  : Return 0 only when the whole data has been compressed
+#           and written successfully
+#
+# * This is the compressor which the "gzpipe" command in the upper
+#   directory uses instead of the "gzip" command when it has been
+#   compiled. It reads STDIN (usually the named pipe) and writes the
+#   gzipped data into STDOUT in the same way as "gzip" does.
+# * The data are read in 128KiB blocks, and each of them is deflated
+#   by one of the threads independently. Every block is deflated with
+#   the last 32KiB of the previous one as the dictionary, and closed
+#   with a sync flush so that the blocks can be joined as they are.
+#   So, the output is a single gzip member as "pigz" makes, and the
+#   compression ratio is almost the same as "gzip".
+# * The reading thread never waits for the compression as long as
+#   the number of the blocks in progress is less than twice of the
+#   threads. So, the writer of the pipe is hardly made to stall.
+# * When SIGTERM is received, the data which have been read so far
+#   are compressed, written and closed as a valid gzip data before
+#   exiting.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lz -lpthread
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOTHREAD -o __CMDNAME__ __SRCNAME__ -lz
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifndef NOTHREAD
+  #include <pthread.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define BLOCK       131072  /* size of a block to compress at a time   */
+#define DICT        32768   /* size of the dictionary (deflate window) */
+#define MAX_THREADS 64      /* max number of the threads               */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {
+  uint8_t *pu8Dict;  /* the tail of the previous block              */
+  size_t   uDict;    /* the length of it (0 for the 1st block)      */
+  uint8_t *pu8In;    /* the block to compress                       */
+  size_t   uIn;      /* the length of it                            */
+  uint8_t *pu8Out;   /* the deflated data                           */
+  size_t   uOut;     /* the length of it                            */
+  size_t   uOutSize; /* the allocated size of pu8Out                */
+  uLong    ulCrc;    /* CRC-32 of the block                         */
+  int      iDone;    /* 1 when the block has been compressed        */
+} job_t;
+
+/*--- prototype functions ------------------------------------------*/
+size_t  read_block(uint8_t *pu8, size_t uSize);
+void    fill_job(job_t *pJob, const job_t *pPrev);
+void    deflate_job(job_t *pJob, z_stream *pz);
+void    init_deflate(z_stream *pz);
+void    put_job(job_t *pJob);
+void    write_all(const void *pv, size_t uLen);
+void    write_header(void);
+void    write_trailer(void);
+void    on_sigterm(int iSig);
+#ifndef NOTHREAD
+  void *deflate_worker(void *pv);
+  void *write_worker(void *pv);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*     gpszCmdname;   /* The name of this command                */
+int       giLevel;       /* The compression level                   */
+job_t    *gpJob;         /* The ring of the blocks in progress      */
+int       giNjob;        /* The number of the slots in it           */
+uLong     gulCrc;        /* CRC-32 of the whole data written        */
+uint64_t  gu64Total;     /* The size of the whole data written      */
+volatile sig_atomic_t giStop; /* 1 when SIGTERM has been received   */
+#ifndef NOTHREAD
+  long            glRead;      /* the number of the blocks read       */
+  long            glNext;      /* the next block for a thread to take */
+  long            glWritten;   /* the number of the blocks written    */
+  int             giEof;       /* 1 when no more block will be read   */
+  pthread_mutex_t gmtx = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t  gcnd = PTHREAD_COND_INITIALIZER;
+#endif
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-1|...|-9] [-p threads]\n"
+    "Options : -1,...,-9 . Compression level as gzip (default: 6)\n"
+    "          -p threads  Number of the threads to compress with\n"
+    "                      (default: the number of the CPUs)\n"
+    "Retuen  : Return 0 only when the whole data has been compressed\n"
+    "          and written successfully\n"
+    "Version : 2026-10-19 17:26:03 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  struct sigaction sa;
+  int      iNthread;  /* the number of the threads */
+  z_stream z;         /* the deflater (without the threads) */
+#ifndef NOTHREAD
+  pthread_t athr[MAX_THREADS+1];
+  sigset_t  ss;
+  long      l;
+#endif
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  giLevel  = Z_DEFAULT_COMPRESSION;
+  iNthread = 0;
+  while ((i=getopt(argc, argv, "123456789p:h")) != -1) {
+    switch (i) {
+      case '1': case '2': case '3': case '4': case '5':
+      case '6': case '7': case '8': case '9':
+                giLevel  = i - '0';
+                break;
+      case 'p': if (sscanf(optarg,"%d",&iNthread) != 1 || iNthread < 1) {
+                  print_usage_and_exit();
+                }
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc > 0) {print_usage_and_exit();}
+
+  /*=== Decide the number of the threads ==========================*/
+#ifndef NOTHREAD
+  if (iNthread == 0) {iNthread = (int)sysconf(_SC_NPROCESSORS_ONLN);}
+  if (iNthread > MAX_THREADS) {iNthread = MAX_THREADS;}
+#endif
+  if (iNthread < 1) {iNthread = 1;}
+
+  /*=== Prepare the slots for the blocks ===========================*/
+  /* (Twice as many as the threads are prepared so that the next
+     blocks can be read while the threads are compressing.)         */
+  giNjob = (iNthread > 1) ? iNthread*2 : 1;
+  if ((gpJob=calloc((size_t)giNjob, sizeof(job_t))) == NULL) {
+    error_exit(errno,"calloc(): %s\n", strerror(errno));
+  }
+  for (i=0; i<giNjob; i++) {
+    gpJob[i].pu8Dict  = malloc(DICT );
+    gpJob[i].pu8In    = malloc(BLOCK);
+    gpJob[i].uOutSize = BLOCK + BLOCK/8 + 1024;
+    gpJob[i].pu8Out   = malloc(gpJob[i].uOutSize);
+    if (!gpJob[i].pu8Dict || !gpJob[i].pu8In || !gpJob[i].pu8Out) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+  }
+
+  /*=== Finish the data read so far when SIGTERM comes =============*/
+  /* (SA_RESTART is not set so as to interrupt the read() waiting.) */
+  giStop = 0;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_sigterm;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGTERM, &sa, NULL) != 0) {
+    error_exit(errno,"sigaction(): %s\n", strerror(errno));
+  }
+
+  /*=== Start ======================================================*/
+  gulCrc    = crc32(0L, Z_NULL, 0);
+  gu64Total = 0;
+  write_header();
+
+  /*=== Compress the blocks one after another (without threads) ====*/
+#ifndef NOTHREAD
+  if (iNthread == 1) {
+#endif
+    init_deflate(&z);
+    gpJob[0].uDict = 0;
+    while (1) {
+      fill_job(&gpJob[0], &gpJob[0]);
+      if (gpJob[0].uIn == 0) {break;}
+      deflate_job(&gpJob[0], &z);
+      put_job(&gpJob[0]);
+      if (gpJob[0].uIn < BLOCK) {break;}
+    }
+    deflateEnd(&z);
+#ifndef NOTHREAD
+  } else {
+
+  /*=== Compress the blocks by the threads =========================*/
+    /*--- Start the threads (SIGTERM is only for this thread) ------*/
+    sigemptyset(&ss);
+    sigaddset(&ss, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &ss, NULL);
+    glRead = glNext = glWritten = 0;
+    giEof  = 0;
+    for (i=0; i<=iNthread; i++) {
+      if ((errno=pthread_create(&athr[i],NULL,
+                                (i<iNthread)?deflate_worker:write_worker,
+                                NULL                                 )) != 0) {
+        error_exit(errno,"pthread_create(): %s\n", strerror(errno));
+      }
+    }
+    pthread_sigmask(SIG_UNBLOCK, &ss, NULL);
+
+    /*--- Read the blocks into the free slots ----------------------*/
+    for (l=0; ; l++) {
+      pthread_mutex_lock(&gmtx);
+      while (l-glWritten >= giNjob) {pthread_cond_wait(&gcnd,&gmtx);}
+      pthread_mutex_unlock(&gmtx);
+      fill_job(&gpJob[l%giNjob], (l==0) ? NULL : &gpJob[(l-1)%giNjob]);
+      if (gpJob[l%giNjob].uIn == 0) {break;}
+      pthread_mutex_lock(&gmtx);
+      gpJob[l%giNjob].iDone = 0;
+      glRead = l+1;
+      pthread_cond_broadcast(&gcnd);
+      pthread_mutex_unlock(&gmtx);
+      if (gpJob[l%giNjob].uIn < BLOCK) {break;}
+    }
+
+    /*--- Wait for the threads to finish ---------------------------*/
+    pthread_mutex_lock(&gmtx);
+    giEof = 1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+    for (i=0; i<=iNthread; i++) {pthread_join(athr[i],NULL);}
+  }
+#endif
+
+  /*=== Finish =====================================================*/
+  write_trailer();
+  return 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Read a block from STDIN ========================================
+ * It returns a short one only at the end of the data (or when SIGTERM
+ * has been received).
+ * [in] pu8   : the buffer to read into
+ *      uSize : the size of it
+ * [ret] the number of the bytes read                               */
+size_t read_block(uint8_t *pu8, size_t uSize) {
+  size_t  uLen;
+  ssize_t siz;
+
+  uLen = 0;
+  while (uLen < uSize && ! giStop) {
+    siz = read(STDIN_FILENO, pu8+uLen, uSize-uLen);
+    if (siz == 0) {break;}
+    if (siz <  0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"read(): %s\n", strerror(errno));
+    }
+    uLen += (size_t)siz;
+  }
+  return uLen;
+}
+
+/*=== Read the next block into a slot ================================
+ * [in]  pPrev : the slot of the previous block (NULL for the 1st one)
+ * [out] pJob  : the slot to fill                                   */
+void fill_job(job_t *pJob, const job_t *pPrev) {
+
+  /*--- Keep the tail of the previous block as the dictionary ------*/
+  /* (It must be copied now because the slot of the previous block
+     can be reused before this block is compressed.)                */
+  if (pPrev != NULL && pPrev->uIn > 0) {
+    pJob->uDict = (pPrev->uIn < DICT) ? pPrev->uIn : DICT;
+    memmove(pJob->pu8Dict, pPrev->pu8In+pPrev->uIn-pJob->uDict,
+            pJob->uDict                                       );
+  } else {
+    pJob->uDict = 0;
+  }
+
+  /*--- Read the block ---------------------------------------------*/
+  pJob->uIn = read_block(pJob->pu8In, BLOCK);
+}
+
+/*=== Deflate a block ================================================
+ * The block is deflated as a raw deflate data which is closed with a
+ * sync flush, so the ones are valid after being joined in order.
+ * [in]     pz   : the deflater (initialized by init_deflate())
+ * [in,out] pJob : the slot of the block                            */
+void deflate_job(job_t *pJob, z_stream *pz) {
+  int iRet;
+
+  /*--- Prepare ----------------------------------------------------*/
+  if (deflateReset(pz) != Z_OK) {
+    error_exit(1,"deflateReset(): %s\n", (pz->msg)?pz->msg:"error");
+  }
+  if (pJob->uDict > 0) {
+    if (deflateSetDictionary(pz,pJob->pu8Dict,(uInt)pJob->uDict)!=Z_OK) {
+      error_exit(1,"deflateSetDictionary(): %s\n",
+                 (pz->msg)?pz->msg:"error"        );
+    }
+  }
+  pJob->ulCrc = crc32(crc32(0L,Z_NULL,0), pJob->pu8In, (uInt)pJob->uIn);
+
+  /*--- Deflate (enlarging the buffer if it is not enough) ---------*/
+  pz->next_in  = pJob->pu8In;
+  pz->avail_in = (uInt)pJob->uIn;
+  pz->next_out  = pJob->pu8Out;
+  pz->avail_out = (uInt)pJob->uOutSize;
+  while (1) {
+    iRet = deflate(pz, Z_SYNC_FLUSH);
+    if (iRet != Z_OK && iRet != Z_BUF_ERROR) {
+      error_exit(1,"deflate(): %s\n", (pz->msg)?pz->msg:"error");
+    }
+    if (pz->avail_out > 0) {break;}
+    pJob->uOutSize *= 2;
+    if ((pJob->pu8Out=realloc(pJob->pu8Out,pJob->uOutSize)) == NULL) {
+      error_exit(errno,"realloc(): %s\n", strerror(errno));
+    }
+    pz->next_out  = pJob->pu8Out + pz->total_out;
+    pz->avail_out = (uInt)(pJob->uOutSize - pz->total_out);
+  }
+  pJob->uOut = (size_t)pz->total_out;
+}
+
+/*=== Initialize a deflater ==========================================
+ * [out] pz : the deflater for raw deflate data                     */
+void init_deflate(z_stream *pz) {
+  memset(pz, 0, sizeof(z_stream));
+  if (deflateInit2(pz, giLevel, Z_DEFLATED, -15, 8,
+                   Z_DEFAULT_STRATEGY               ) != Z_OK) {
+    error_exit(1,"deflateInit2(): %s\n", (pz->msg)?pz->msg:"error");
+  }
+}
+
+/*=== Write a compressed block =======================================
+ * [in]     pJob      : the slot of the block
+ * [in,out] gulCrc, gu64Total : (must be defined as global vars)     */
+void put_job(job_t *pJob) {
+  write_all(pJob->pu8Out, pJob->uOut);
+  gulCrc     = crc32_combine(gulCrc, pJob->ulCrc, (z_off_t)pJob->uIn);
+  gu64Total += pJob->uIn;
+}
+
+/*=== Write the whole bytes into STDOUT ==============================
+ * [in] pv   : the bytes
+ *      uLen : the length of them                                   */
+void write_all(const void *pv, size_t uLen) {
+  const uint8_t *pu8 = (const uint8_t*)pv;
+  ssize_t        siz;
+
+  while (uLen > 0) {
+    siz = write(STDOUT_FILENO, pu8, uLen);
+    if (siz < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write(): %s\n", strerror(errno));
+    }
+    pu8  += siz;
+    uLen -= (size_t)siz;
+  }
+}
+
+/*=== Write the gzip header ========================================*/
+void write_header(void) {
+  uint8_t au8[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+
+  /* (XFL: 2 means the maximum compression, 4 means the fastest) */
+  if      (giLevel == 9) {au8[8] = 2;}
+  else if (giLevel == 1) {au8[8] = 4;}
+  write_all(au8, sizeof(au8));
+}
+
+/*=== Close the deflate data and write the gzip trailer ==============
+ * [in] gulCrc, gu64Total : (must be defined as global vars)        */
+void write_trailer(void) {
+  uint8_t au8[10];
+  int     i;
+
+  /*--- The last block (empty, fixed Huffman, BFINAL=1) ------------*/
+  au8[0] = 0x03;
+  au8[1] = 0x00;
+  /*--- CRC-32 and ISIZE (little endian) ---------------------------*/
+  for (i=0; i<4; i++) {
+    au8[2+i] = (uint8_t)((gulCrc    >> (8*i)) & 0xff);
+    au8[6+i] = (uint8_t)((gu64Total >> (8*i)) & 0xff);
+  }
+  write_all(au8, sizeof(au8));
+}
+
+/*=== Signal handler for SIGTERM ===================================*/
+void on_sigterm(int iSig) {
+  (void)iSig;
+  giStop = 1;
+}
+
+#ifndef NOTHREAD
+/*=== (Thread) Compress the blocks one after another =================
+ * [in,out] gpJob, glRead, glNext, giEof : (must be defined as global
+ *                                          vars)                   */
+void *deflate_worker(void *pv) {
+
+  /*--- Variables --------------------------------------------------*/
+  z_stream z;
+  job_t   *pJob;
+
+  (void)pv;
+  init_deflate(&z);
+  while (1) {
+    /*--- Take the next block --------------------------------------*/
+    pthread_mutex_lock(&gmtx);
+    while (glNext >= glRead && ! giEof) {pthread_cond_wait(&gcnd,&gmtx);}
+    if (glNext >= glRead) {pthread_mutex_unlock(&gmtx); break;}
+    pJob = &gpJob[(glNext++)%giNjob];
+    pthread_mutex_unlock(&gmtx);
+
+    /*--- Compress it and tell the others --------------------------*/
+    deflate_job(pJob, &z);
+    pthread_mutex_lock(&gmtx);
+    pJob->iDone = 1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  deflateEnd(&z);
+  return NULL;
+}
+
+/*=== (Thread) Write the compressed blocks in order ==================
+ * [in,out] gpJob, glRead, glWritten, giEof : (must be defined as
+ *                                             global vars)         */
+void *write_worker(void *pv) {
+  job_t *pJob;
+  long   l;
+
+  (void)pv;
+  for (l=0; ; l++) {
+    /*--- Wait for the next block to be compressed -----------------*/
+    pthread_mutex_lock(&gmtx);
+    while (! (l < glRead && gpJob[l%giNjob].iDone) &&
+           ! (l >= glRead && giEof)                ) {
+      pthread_cond_wait(&gcnd,&gmtx);
+    }
+    if (l >= glRead) {pthread_mutex_unlock(&gmtx); break;}
+    pJob = &gpJob[l%giNjob];
+    pthread_mutex_unlock(&gmtx);
+
+    /*--- Write it and free the slot -------------------------------*/
+    put_job(pJob);
+    pthread_mutex_lock(&gmtx);
+    glWritten = l+1;
+    pthread_cond_broadcast(&gcnd);
+    pthread_mutex_unlock(&gmtx);
+  }
+  return NULL;
+}
+#endif
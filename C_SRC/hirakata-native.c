@@ -0,0 +1,634 @@
+/*####################################################################
+#
+# HIRAKATA-NATIVE - The Native Kana Converter for "hira2kata" and
+#                   "kata2hira"
+#
+# USAGE   : hirakata-native -K|-H [+<n>h] <f1> <f2> ... <file>
+#           hirakata-native -K|-H -d <f1> <f2> ... <string>
+# Args    : <fn> ...... Field number you want to convert. "NF", "NF-n"
+#                       and "a/b" (from field a to b) are also available.
+#                       All of the fields are converted if none or "0" is
+#                       given.
+#           <file> .... Text file which contains some fields to convert
+#           <string> .. It will be explained in -d option
+# Options : -K ........ Convert from Hiragana into Katakana
+#           -H ........ Convert from Katakana into Hiragana
+#           -d ........ Direct Mode :
+#                       It make this command regard the last argument
+#                       (<string>) as a field formatted string instead
+#                       of <file>
+#           +<n>h ..... Regards the top <n> lines as comment and Print
+#                       without converting
+# Retuen  : Return 0 only when finished successfully
+#
+# * This is the engine which the "hira2kata" and "kata2hira" commands
+#   in the upper directory use when it has been compiled. So, it makes
+#   exactly the same output as their AWK versions do, which means
+#   - the lines which have at least one selected field are rebuilt
+#     with single spaces like AWK does after assigning a field, and
+#     the fields over NF are added as empty ones in that case,
+#   - the other lines are printed as they are, and
+#   - "ぁ"-"ゖ", "ゝ" and "ゞ" are converted into "ァ"-"ヶ", "ヽ" and
+#     "ヾ" (or vice versa) by adding (or subtracting) the fixed
+#     offsets to the 3-byte UTF-8 sequences.
+# * The field selection is compiled once before reading. It needs to
+#   be evaluated every line only for the fields relative to NF.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#define _XOPEN_SOURCE 700 /* for getline() */
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*--- macros -------------------------------------------------------*/
+#define CELL_NUM 0  /* a cell of a selection entry is "n"            */
+#define CELL_NF  1  /* a cell of a selection entry is "NF"           */
+#define CELL_NFK 2  /* a cell of a selection entry is "NF-n"         */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {    /* a cell (field number) of a selection entry   */
+  int  iKind;       /* CELL_NUM, CELL_NF or CELL_NFK                */
+  long lNum;        /* n (of "n" or "NF-n")                         */
+} cell;
+typedef struct {    /* a selection entry                            */
+  int  iType;       /* 1 if it's "n" or "n/NF", otherwise 0         */
+  cell c1;          /* the field number (or the beginning of range) */
+  cell c2;          /* the end of the range ("NF" or "NF-n")        */
+  int  iRange;      /* 1 if c2 is valid                             */
+} entry;
+
+/*--- prototype functions ------------------------------------------*/
+int    parse_cell(const char *psz, cell *pc);
+int    parse_fldspec(const char *psz, cell *pc1, cell *pc2, int *piRange);
+void   add_entry(int iType, cell c1, int iRange, cell c2);
+void   compile_entries(void);
+int    compare_entries(const void *pv1, const void *pv2);
+void   entry_to_str(const entry *pe, char *psz, size_t uSiz);
+void   init_conv_table(int iToKata);
+void   mark_field(long lFld);
+void   process_line(const char *pcLine, size_t uLen);
+void   conv_span(const char *pcBeg, size_t uLen);
+void   put_out(const void *pv, size_t uLen);
+
+/*--- global variables ---------------------------------------------*/
+char*    gpszCmdname;     /* The name of this command               */
+int      giAllFields;     /* 1 when all of the fields are converted */
+entry*   gpEnt;           /* the selection entries                  */
+int      giNent;          /* the number of them                     */
+int      giEntAlloc;      /* the allocated number of them           */
+int      giPathA;         /* 1 when the entries are "n"s and "n/NF" */
+long     glMax;           /* the max n of them (for giPathA)        */
+uint8_t* gpu8Given;       /* 1 for the given "n"s (for giPathA)     */
+uint8_t* gpu8Mark;        /* marks for the current line             */
+long     glMarkAlloc;     /* the allocated size of gpu8Mark         */
+const char** gppcFld;     /* the beginnings of the fields           */
+size_t*  gpuFldLen;       /* the lengths of them                    */
+long     glFldAlloc;      /* the allocated number of them           */
+char*    gpcOut;          /* the output line buffer                 */
+size_t   guOut;           /* the length of the data in it           */
+size_t   guOutAlloc;      /* the allocated size of it               */
+uint16_t gau16Conv[192];  /* the last two bytes to replace
+                             "\343\201\200"-"\343\203\277" with (or 0) */
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s -K|-H [+<n>h] <f1> <f2> ... <file>\n"
+    "          %s -K|-H -d <f1> <f2> ... <string>\n"
+    "Args    : <fn> ...... Field number you want to convert. \"NF\", \"NF-n\"\n"
+    "                      and \"a/b\" (from field a to b) are also available.\n"
+    "                      All of the fields are converted if none or \"0\" is\n"
+    "                      given.\n"
+    "          <file> .... Text file which contains some fields to convert\n"
+    "          <string> .. It will be explained in -d option\n"
+    "Options : -K ........ Convert from Hiragana into Katakana\n"
+    "          -H ........ Convert from Katakana into Hiragana\n"
+    "          -d ........ Direct Mode :\n"
+    "                      It make this command regard the last argument\n"
+    "                      (<string>) as a field formatted string instead\n"
+    "                      of <file>\n"
+    "          +<n>h ..... Regards the top <n> lines as comment and Print\n"
+    "                      without converting\n"
+    "Retuen  : Return 0 only when finished successfully\n"
+    "Version : 2026-10-19 15:36:20 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  FILE   *fp;
+  char   *pszFile;    /* the file to read                           */
+  char   *pszDirect;  /* the string in direct mode (or NULL)        */
+  char   *pcLine;     /* the line read                              */
+  char   *pc;
+  size_t  uLineAlloc;
+  ssize_t iLen;
+  long    lHdr;       /* the number of the header lines (+<n>h)     */
+  long    l, lA, lB;
+  int     iToKata;    /* 1 for -K, 0 for -H                         */
+  int     iDirect;    /* 1 when -d option is set                    */
+  int     iOptPart;   /* 1 while reading the options                */
+  int     iNspec;     /* the number of the field specifications     */
+  int     iRange;
+  cell    c1, c2, cNf, c;
+  int     i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+
+  /*=== Parse arguments ============================================*/
+  /*--- the direction ----------------------------------------------*/
+  if      (argc>1 && strcmp(argv[1],"-K")==0) {iToKata = 1;}
+  else if (argc>1 && strcmp(argv[1],"-H")==0) {iToKata = 0;}
+  else                                        {print_usage_and_exit();}
+  /*--- the others (in the same way as the AWK versions) -----------*/
+  lHdr        = 0;
+  iDirect     = 0;
+  iOptPart    = 1;
+  iNspec      = 0;
+  pszFile     = "-";
+  pszDirect   = NULL;
+  giAllFields = 0;
+  cNf.iKind   = CELL_NF;
+  cNf.lNum    = 0;
+  for (i=2; i<argc; i++) {
+    if (iOptPart && strcmp(argv[i],"-d")==0) {iDirect=1; continue;}
+    if (iOptPart && argv[i][0]=='+') {
+      for (pc=argv[i]+1; *pc>='0' && *pc<='9'; pc++);
+      if (strcmp(pc,"h")!=0) {print_usage_and_exit();}
+      lHdr = (pc==argv[i]+1) ? 1 : atol(argv[i]+1);
+      continue;
+    }
+    iOptPart = 0;
+    if (iDirect && i==argc-1) {pszDirect = argv[i]; break;}
+    if (! parse_fldspec(argv[i], &c1, &c2, &iRange)) {
+      if (i==argc-1) {pszFile = argv[i]; continue;}
+      print_usage_and_exit();
+    }
+    iNspec++;
+    if (strcmp(argv[i],"0")==0 || strncmp(argv[i],"0/",2)==0 ||
+        strcmp(strrchr(argv[i],'/')?strrchr(argv[i],'/'):"","/0")==0) {
+      giAllFields = 1;
+    }
+    /*--- compile it into the selection entries --------------------*/
+    if (! iRange) {                                          /* n,NF-n */
+      add_entry((c1.iKind==CELL_NUM) ? 1 : 0, c1, 0, c2);
+    }
+    else if (c1.iKind==CELL_NUM && c2.iKind==CELL_NUM) {     /* a/b    */
+      lA = (c1.lNum<c2.lNum) ? c1.lNum : c2.lNum;
+      lB = (c1.lNum<c2.lNum) ? c2.lNum : c1.lNum;
+      for (l=lA; l<=lB; l++) {c1.lNum=l; add_entry(1, c1, 0, c2);}
+    }
+    else if (c1.iKind==CELL_NUM || c2.iKind==CELL_NUM) {     /* n/NF-k */
+      if (c1.iKind != CELL_NUM) {c=c1; c1=c2; c2=c;}
+      add_entry((c2.iKind==CELL_NF) ? 1 : 0, c1, 1, c2);
+    }
+    else if (c1.iKind==CELL_NFK && c2.iKind==CELL_NFK) {     /* NF-x/NF-y */
+      lA = (c1.lNum<c2.lNum) ? c1.lNum : c2.lNum;
+      lB = (c1.lNum<c2.lNum) ? c2.lNum : c1.lNum;
+      for (l=lA; l<=lB; l++) {c1.lNum=l; add_entry(0, c1, 0, c2);}
+    }
+    else {                                                   /* NF/NF-k */
+      add_entry(0, cNf, 0, c2);
+      c1.iKind = CELL_NFK;
+      lB = (c2.iKind==CELL_NFK) ? c2.lNum : c1.lNum;
+      for (l=1; l<=lB; l++) {c1.lNum=l; add_entry(0, c1, 0, c2);}
+    }
+  }
+  if (iDirect && (pszDirect==NULL || *pszDirect=='\0')) {
+    print_usage_and_exit();
+  }
+  if (iNspec == 0) {giAllFields = 1;}
+  if (! giAllFields) {compile_entries();}
+  init_conv_table(iToKata);
+
+  /*=== Convert ====================================================*/
+  if (iDirect) {
+    /*--- the string in direct mode --------------------------------*/
+    for (pc=pszDirect; *pc!='\0'; pc+=iLen+(pc[iLen]=='\n')) {
+      iLen = (ssize_t)strcspn(pc, "\n");
+      if (lHdr > 0) {
+        lHdr--;
+        put_out(pc, (size_t)iLen); put_out("\n", 1);
+        fwrite(gpcOut, 1, guOut, stdout); guOut = 0;
+        continue;
+      }
+      process_line(pc, (size_t)iLen);
+    }
+  } else {
+    /*--- the file -------------------------------------------------*/
+    if (strcmp(pszFile,"-")==0) {
+      fp = stdin;
+    } else if ((fp=fopen(pszFile,"r")) == NULL) {
+      error_exit(1,"Cannot open the file: %s\n", pszFile);
+    }
+    pcLine     = NULL;
+    uLineAlloc = 0;
+    while ((iLen=getline(&pcLine, &uLineAlloc, fp)) >= 0) {
+      if (iLen>0 && pcLine[iLen-1]=='\n') {iLen--;}
+      if (lHdr > 0) {
+        lHdr--;
+        put_out(pcLine, (size_t)iLen); put_out("\n", 1);
+        fwrite(gpcOut, 1, guOut, stdout); guOut = 0;
+        continue;
+      }
+      process_line(pcLine, (size_t)iLen);
+    }
+    if (ferror(fp)) {error_exit(errno,"getline(): %s\n",strerror(errno));}
+  }
+
+  /*=== Finish =====================================================*/
+  if (fflush(stdout) != 0) {
+    error_exit(errno,"fflush(): %s\n",strerror(errno));
+  }
+  return 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Parse a cell of a field specification ==========================
+ * [in]  psz : The string ("n", "NF" or "NF-n")
+ * [out] pc  : The parsed cell
+ * [ret]     : 1 if valid, 0 if not                                 */
+int parse_cell(const char *psz, cell *pc) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *p;
+
+  /*--- Parse it ---------------------------------------------------*/
+  pc->iKind = CELL_NUM;
+  pc->lNum  = 0;
+  if (strncmp(psz,"NF",2) == 0) {
+    pc->iKind = CELL_NF;
+    if (psz[2] == '\0') {return 1;}
+    if (psz[2] != '-' ) {return 0;}
+    pc->iKind = CELL_NFK;
+    psz += 3;
+  }
+  if (*psz == '\0') {return 0;}
+  for (p=psz; *p!='\0'; p++) {if (*p<'0' || *p>'9') {return 0;}}
+  pc->lNum = atol(psz);
+  return 1;
+}
+
+/*=== Parse a field specification ====================================
+ * [in]  psz     : The string ("c" or "c/c", "c" is a cell)
+ * [out] pc1     : The parsed first cell
+ *       pc2     : The parsed second cell (if "c/c")
+ *       piRange : 1 if "c/c" (except "NF/NF"), 0 if not
+ * [ret]         : 1 if valid, 0 if not                             */
+int parse_fldspec(const char *psz, cell *pc1, cell *pc2, int *piRange) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pcSl;
+  char        sz[64];
+
+  /*--- Parse it ---------------------------------------------------*/
+  *piRange = 0;
+  pcSl = strchr(psz, '/');
+  if (pcSl == NULL || pcSl == psz || pcSl[1] == '\0' ||
+      strchr(pcSl+1,'/') != NULL                       ) {
+    return parse_cell(psz, pc1);
+  }
+  if ((size_t)(pcSl-psz) >= sizeof(sz)) {return 0;}
+  memcpy(sz, psz, pcSl-psz);
+  sz[pcSl-psz] = '\0';
+  if (! parse_cell(sz    , pc1)) {return 0;}
+  if (! parse_cell(pcSl+1, pc2)) {return 0;}
+  *piRange = (pc1->iKind==CELL_NF && pc2->iKind==CELL_NF) ? 0 : 1;
+  return 1;
+}
+
+/*=== Add a selection entry ==========================================
+ * [in] iType  : 1 if it's "n" or "n/NF", otherwise 0
+ *      c1     : The field number (or the beginning of the range)
+ *      iRange : 1 if it's a range
+ *      c2     : The end of the range ("NF" or "NF-n")              */
+void add_entry(int iType, cell c1, int iRange, cell c2) {
+  if (giNent >= giEntAlloc) {
+    giEntAlloc = (giEntAlloc==0) ? 16 : giEntAlloc*2;
+    gpEnt = realloc(gpEnt, sizeof(entry)*giEntAlloc);
+    if (gpEnt == NULL) {error_exit(errno,"realloc(): %s\n",strerror(errno));}
+  }
+  gpEnt[giNent].iType  = iType;
+  gpEnt[giNent].c1     = c1;
+  gpEnt[giNent].iRange = iRange;
+  gpEnt[giNent].c2     = c2;
+  giNent++;
+}
+
+/*=== Compile the selection entries ==================================
+ * It sorts and uniqs them, drops the ones after the first "n/NF",
+ * and decides the way to mark the fields as the AWK versions do.   */
+void compile_entries(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  int i, j;
+
+  /*--- Sort, uniq and cut them ------------------------------------*/
+  qsort(gpEnt, giNent, sizeof(entry), compare_entries);
+  for (i=j=0; i<giNent; i++) {
+    if (j>0 && compare_entries(&gpEnt[j-1], &gpEnt[i])==0) {continue;}
+    gpEnt[j++] = gpEnt[i];
+  }
+  giNent = j;
+  for (i=0; i<giNent; i++) {
+    if (gpEnt[i].iType==1 && gpEnt[i].iRange) {giNent=i+1; break;}
+  }
+
+  /*--- Decide the way to mark -------------------------------------*/
+  /* When they are only "n"s and "n/NF" (path A), the fields from
+   * the max n to NF and the given "n"s in them are marked. Otherwise,
+   * every entry marks the fields by itself.                        */
+  giPathA = (gpEnt[giNent-1].iType==1 && gpEnt[giNent-1].iRange);
+  for (i=0; i<giNent; i++) {
+    if (gpEnt[i].iType != 1) {giPathA = 0;}
+  }
+  if (! giPathA) {return;}
+  glMax = gpEnt[giNent-1].c1.lNum;
+  if ((gpu8Given=calloc(glMax+1, 1)) == NULL) {
+    error_exit(errno,"calloc(): %s\n",strerror(errno));
+  }
+  for (i=0; i<giNent; i++) {gpu8Given[gpEnt[i].c1.lNum] = 1;}
+}
+
+/*=== Compare two entries as "sort -k1,1 -k2n,2 -k3n,3" does =========
+ * The entries are regarded as the lines "1 n", "1 n NF", "0 NF",
+ * "0 NF-k" and "0 n NF-k", and "NF" and "NF-k" are 0 as numbers.   */
+int compare_entries(const void *pv1, const void *pv2) {
+
+  /*--- Variables --------------------------------------------------*/
+  const entry *p1 = pv1, *p2 = pv2;
+  long  l1, l2;
+  char  sz1[64], sz2[64];
+
+  /*--- Compare the keys -------------------------------------------*/
+  if (p1->iType != p2->iType) {return p1->iType - p2->iType;}
+  l1 = (p1->c1.iKind==CELL_NUM) ? p1->c1.lNum : 0;
+  l2 = (p2->c1.iKind==CELL_NUM) ? p2->c1.lNum : 0;
+  if (l1 != l2) {return (l1<l2) ? -1 : 1;}
+
+  /*--- Compare them as the lines at last --------------------------*/
+  entry_to_str(p1, sz1, sizeof(sz1));
+  entry_to_str(p2, sz2, sizeof(sz2));
+  return strcmp(sz1, sz2);
+}
+
+/*=== Make the string of an entry except the first column ============
+ * [in]  pe  : The entry
+ * [out] psz : The string ("n", "n NF", "NF", "NF-k" or "n NF-k")
+ *       uSiz: The size of the buffer                               */
+void entry_to_str(const entry *pe, char *psz, size_t uSiz) {
+  switch (pe->c1.iKind) {
+    case CELL_NUM: snprintf(psz,uSiz,"%ld"   ,pe->c1.lNum); break;
+    case CELL_NF : snprintf(psz,uSiz,"NF"                ); break;
+    default      : snprintf(psz,uSiz,"NF-%ld",pe->c1.lNum); break;
+  }
+  if (! pe->iRange) {return;}
+  uSiz -= strlen(psz);
+  psz  += strlen(psz);
+  if (pe->c2.iKind==CELL_NF) {snprintf(psz,uSiz," NF"                );}
+  else                       {snprintf(psz,uSiz," NF-%ld",pe->c2.lNum);}
+}
+
+/*=== Make the conversion table ======================================
+ * The ranges and the offsets are the same as the AWK versions' ones.
+ * [in] iToKata : 1 for Hiragana to Katakana, 0 for the reverse    */
+void init_conv_table(int iToKata) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const long alRange[][3] = {
+    {0xE38181, 0xE3819F, 0x120}, /* "ぁ"-"た" <-> "ァ"-"タ" */
+    {0xE381A0, 0xE381BF, 0x1E0}, /* "だ"-"み" <-> "ダ"-"ミ" */
+    {0xE38280, 0xE38296, 0x120}, /* "む"-"ゖ" <-> "ム"-"ヶ" */
+    {0xE3829D, 0xE3829E, 0x120}  /* "ゝ"-"ゞ" <-> "ヽ"-"ヾ" */
+  };
+  long l, lFrom, lTo;
+  int  i;
+
+  /*--- Make it ----------------------------------------------------*/
+  memset(gau16Conv, 0, sizeof(gau16Conv));
+  for (i=0; i<4; i++) {
+    for (l=alRange[i][0]; l<=alRange[i][1]; l++) {
+      lFrom = (iToKata) ? l : l+alRange[i][2];
+      lTo   = (iToKata) ? l+alRange[i][2] : l;
+      gau16Conv[(((lFrom>>8)&0xFF)-0x81)*64 + ((lFrom&0xFF)-0x80)]
+        = (uint16_t)(lTo & 0xFFFF);
+    }
+  }
+}
+
+/*=== Mark a field of the current line ===============================
+ * [in] lFld : The field number (AWK stops when it's negative)      */
+void mark_field(long lFld) {
+
+  /*--- Variables --------------------------------------------------*/
+  long l;
+
+  /*--- Mark it (with extending the buffer) ------------------------*/
+  if (lFld < 0) {error_exit(2,"negative field index $%ld\n", lFld);}
+  if (lFld >= glMarkAlloc) {
+    for (l=(glMarkAlloc==0)?64:glMarkAlloc; l<=lFld; l*=2);
+    if ((gpu8Mark=realloc(gpu8Mark, l)) == NULL) {
+      error_exit(errno,"realloc(): %s\n",strerror(errno));
+    }
+    memset(gpu8Mark+glMarkAlloc, 0, l-glMarkAlloc);
+    glMarkAlloc = l;
+  }
+  gpu8Mark[lFld] = 1;
+}
+
+/*=== Convert a line and print it ====================================
+ * [in] pcLine : The line (without <0x0A>)
+ *      uLen   : The length of it                                   */
+void process_line(const char *pcLine, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc, *pcEnd;
+  const entry *pe;
+  long  lNf;     /* NF of the line                                  */
+  long  lLast;   /* the last field to print                         */
+  long  lA, lB, l;
+  int   iAll;    /* 1 when $0 is also marked                        */
+  int   i;
+
+  /*--- Convert all of it if no field is selected ------------------*/
+  guOut = 0;
+  if (giAllFields) {
+    conv_span(pcLine, uLen);
+    put_out("\n", 1);
+    fwrite(gpcOut, 1, guOut, stdout);
+    return;
+  }
+
+  /*--- Split it into fields (by " " and <0x09> like AWK does) -----*/
+  pcEnd = pcLine + uLen;
+  lNf   = 0;
+  for (pc=pcLine; ; ) {
+    while (pc<pcEnd && (*pc==' ' || *pc=='\t')) {pc++;}
+    if (pc >= pcEnd) {break;}
+    if (++lNf >= glFldAlloc) {
+      glFldAlloc = (glFldAlloc==0) ? 64 : glFldAlloc*2;
+      gppcFld    = realloc(gppcFld  , sizeof(char*)  * glFldAlloc);
+      gpuFldLen  = realloc(gpuFldLen, sizeof(size_t) * glFldAlloc);
+      if (gppcFld==NULL || gpuFldLen==NULL) {
+        error_exit(errno,"realloc(): %s\n",strerror(errno));
+      }
+    }
+    gppcFld[lNf] = pc;
+    while (pc<pcEnd && *pc!=' ' && *pc!='\t') {pc++;}
+    gpuFldLen[lNf] = pc - gppcFld[lNf];
+  }
+
+  /*--- Mark the fields to be converted ----------------------------*/
+  if (glMarkAlloc > 0) {memset(gpu8Mark, 0, glMarkAlloc);}
+  if (giPathA) {
+    for (l=1; l<=lNf; l++) {
+      if (l>=glMax || gpu8Given[l]) {mark_field(l);}
+    }
+  } else {
+    for (i=0, pe=gpEnt; i<giNent; i++, pe++) {
+      lA = (pe->c1.iKind==CELL_NUM) ? pe->c1.lNum : lNf-pe->c1.lNum;
+      if (! pe->iRange) {
+        if (pe->c1.iKind!=CELL_NFK || lA>0) {mark_field(lA);}
+        continue;
+      }
+      lB = lNf - pe->c2.lNum;
+      if (lA > lB) {l=lA; lA=lB; lB=l;}
+      for (l=lA; l<=lB; l++) {mark_field(l);}
+    }
+  }
+  lLast = 0;
+  for (l=glMarkAlloc-1; l>=1; l--) {if (gpu8Mark[l]) {lLast=l; break;}}
+  iAll  = (glMarkAlloc>0 && gpu8Mark[0]);
+
+  /*--- Print it as it is if no field is marked --------------------*/
+  if (lLast == 0) {
+    if (iAll) {conv_span(pcLine, uLen);}
+    else      {put_out  (pcLine, uLen);}
+    put_out("\n", 1);
+    fwrite(gpcOut, 1, guOut, stdout);
+    return;
+  }
+
+  /*--- Rebuild it with the converted fields -----------------------*/
+  /* (When $0 is also marked, all of the fields are converted.)    */
+  if (lLast < lNf) {lLast = lNf;}
+  for (l=1; l<=lLast; l++) {
+    if (l > 1  ) {put_out(" ", 1);}
+    if (l > lNf) {continue;}
+    if (iAll || gpu8Mark[l]) {conv_span(gppcFld[l], gpuFldLen[l]);}
+    else                     {put_out  (gppcFld[l], gpuFldLen[l]);}
+  }
+  put_out("\n", 1);
+  fwrite(gpcOut, 1, guOut, stdout);
+}
+
+/*=== Convert the kana in a span and put it to the output buffer =====
+ * The bytes following a lead byte are skipped blindly in the same way
+ * as the AWK versions do.
+ * [in] pcBeg : The beginning of the span
+ *      uLen  : The length of it                                    */
+void conv_span(const char *pcBeg, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8    = (const uint8_t*)pcBeg;
+  const uint8_t *pu8End = pu8 + uLen;
+  const uint8_t *pu8Run;  /* the beginning of the bytes to copy     */
+  uint16_t       u16;
+  uint8_t        au8[3];
+  size_t         uSkip;
+
+  /*--- Convert it -------------------------------------------------*/
+  for (pu8Run=pu8; pu8<pu8End; ) {
+    if (*pu8 < 0xC0) {pu8++; continue;}
+    if (*pu8==0xE3 && pu8End-pu8>=3                   &&
+        pu8[1]>=0x81 && pu8[1]<=0x83                  &&
+        pu8[2]>=0x80 && pu8[2]<=0xBF                  &&
+        (u16=gau16Conv[(pu8[1]-0x81)*64+(pu8[2]-0x80)])  ) {
+      put_out(pu8Run, pu8-pu8Run);
+      au8[0] = 0xE3;
+      au8[1] = (uint8_t)(u16 >> 8);
+      au8[2] = (uint8_t)(u16     );
+      put_out(au8, 3);
+      pu8   += 3;
+      pu8Run = pu8;
+      continue;
+    }
+    if      (*pu8 < 0xE0) {uSkip = 2;}
+    else if (*pu8 < 0xF0) {uSkip = 3;}
+    else if (*pu8 < 0xF8) {uSkip = 4;}
+    else if (*pu8 < 0xFC) {uSkip = 5;}
+    else if (*pu8 < 0xFE) {uSkip = 6;}
+    else                  {uSkip = 1;}
+    pu8 += ((size_t)(pu8End-pu8)<uSkip) ? (size_t)(pu8End-pu8) : uSkip;
+  }
+  put_out(pu8Run, pu8-pu8Run);
+}
+
+/*=== Put bytes to the output line buffer ============================
+ * [in] pv   : The bytes
+ *      uLen : The number of them                                   */
+void put_out(const void *pv, size_t uLen) {
+  if (guOut+uLen > guOutAlloc) {
+    for (guOutAlloc=(guOutAlloc==0)?4096:guOutAlloc;
+         guOut+uLen>guOutAlloc; guOutAlloc*=2);
+    if ((gpcOut=realloc(gpcOut, guOutAlloc)) == NULL) {
+      error_exit(errno,"realloc(): %s\n",strerror(errno));
+    }
+  }
+  memcpy(gpcOut+guOut, pv, uLen);
+  guOut += uLen;
+}
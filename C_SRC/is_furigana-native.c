@@ -0,0 +1,392 @@
+/*####################################################################
+#
+# IS_FURIGANA-NATIVE - The Native Validator for "is_furigana"
+#
+# USAGE   : is_furigana-native [option] [file]
+# Args    : file ...... A file to validate ("-" means STDIN)
+# Options : --hira .... Accept only Hiragana
+#           --kata .... Accept only Katagana (both Zenkaku and Hankaku)
+#           --hankata . Accept only Hankaku-Katagana
+#           --zenkata . Accept only Zenkaku-Katagana
+# Retuen  : 0 will be returned only when all of the given letters are
+#           furigana
+#
+# * This is the engine which the "is_furigana" command in the upper
+#   directory uses when it has been compiled. So, it returns exactly
+#   the same values as the AWK version does, which means
+#   - 0 when the first line has only furigana and no line follows it
+#     (the <0x0A> at the end of it is allowed),
+#   - 1 when another line follows it,
+#   - 2 when the input is empty,
+#   - 11-16 when the first line has a byte which isn't the lead byte
+#     of 3-byte characters, and the value depends on the byte,
+#   - 21-28 when it has a 3-byte character out of the furigana, and
+#     the value depends on the range which the character is in, and
+#   - 31-34 when it has a furigana which isn't allowed in the mode.
+# * It exits as soon as it finds the first invalid letter. The letters
+#   are checked 16 at a time by SSSE3 if the CPU supports it.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF     65536 /* input buffer size                         */
+#define CLS_HIRA 1     /* "ぁ"-"み", "む"-"ゖ", "ゝ" and "ゞ"       */
+#define CLS_MARK 2     /* "゛" and "゜" (U+309A-U+309C)             */
+#define CLS_KATA 3     /* "ァ"-"タ", "ダ"-"ヺ", "ヽ" and "ヾ"       */
+#define CLS_DOT  4     /* "・" and "ー"                             */
+#define CLS_HAN  5     /* "･"-"ｿ" and "ﾀ"-"ﾟ"                       */
+#define MAXRNG   8     /* the max number of the ranges for a mode   */
+
+/*--- prototype functions ------------------------------------------*/
+void   init_tables(void);
+int    validate(const uint8_t *pu8Beg, const uint8_t *pu8End, int iFinal,
+                size_t *puDone);
+size_t valid_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End);
+#ifdef HAVE_X86SIMD
+  size_t valid_ssse3(const uint8_t *pu8Beg, const uint8_t *pu8End);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*    gpszCmdname; /* The name of this command                   */
+int      giMode;      /* 0:default 1:hira 2:kata 3:zenkata 4:hankata*/
+/* The ranges of the 3-byte characters (the code at the beginning of
+ * the next range, and the class or the return value in the range),
+ * which are the same as the AWK version's ones                     */
+const struct {uint32_t u32Next; int iCls;} gaRange[] = {
+  {0xE38181, 21      }, {0xE381C0, CLS_HIRA}, {0xE38280, 22      },
+  {0xE38297, CLS_HIRA}, {0xE3829A, 23      }, {0xE3829D, CLS_MARK},
+  {0xE3829F, CLS_HIRA}, {0xE382A1, 24      }, {0xE382C0, CLS_KATA},
+  {0xE38380, 25      }, {0xE383BB, CLS_KATA}, {0xE383BD, CLS_DOT },
+  {0xE383BF, CLS_KATA}, {0xEFBDA5, 26      }, {0xEFBDC0, CLS_HAN },
+  {0xEFBE80, 27      }, {0xEFBEA0, CLS_HAN }, {0xFFFFFF, 28      }
+};
+/* The classes allowed in every mode (as bits)                      */
+const int gaiAllow[5] = {
+  (1<<CLS_HIRA)|(1<<CLS_MARK)|(1<<CLS_KATA)|(1<<CLS_DOT)|(1<<CLS_HAN),
+  (1<<CLS_HIRA)|(1<<CLS_MARK)|(1<<CLS_DOT),
+               (1<<CLS_MARK)|(1<<CLS_KATA)|(1<<CLS_DOT)|(1<<CLS_HAN),
+               (1<<CLS_MARK)|(1<<CLS_KATA)|(1<<CLS_DOT),
+                                                        (1<<CLS_HAN)
+};
+/* The allowed ranges in the current mode (from and to, inclusive)  */
+uint32_t gau32RngFrom[MAXRNG];
+uint32_t gau32RngTo  [MAXRNG];
+int      giRng;
+/* The function to count the leading valid bytes (chosen on the CPU)*/
+size_t (*gpfValid)(const uint8_t*, const uint8_t*) = valid_scalar;
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [option] [file]\n"
+    "Args    : file ...... A file to validate (\"-\" means STDIN)\n"
+    "Options : --hira .... Accept only Hiragana\n"
+    "          --kata .... Accept only Katagana (both Zenkaku and Hankaku)\n"
+    "          --hankata . Accept only Hankaku-Katagana\n"
+    "          --zenkata . Accept only Zenkaku-Katagana\n"
+    "Retuen  : 0 will be returned only when all of the given letters are\n"
+    "          furigana\n"
+    "Version : 2026-10-19 18:02:37 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname);
+  exit(1);
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  static uint8_t au8Buf[IBUF];
+  const char *pszFile;
+  uint8_t    *pu8Nl;  /* the <0x0A> at the end of the first line     */
+  int     iFd;
+  size_t  uHave;      /* bytes in au8Buf                            */
+  size_t  uDone;      /* bytes validated                            */
+  ssize_t iRead;
+  int     iAny;       /* 1 when the input has one byte at least     */
+  int     iRet;
+  int     i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+
+  /*=== Parse arguments (in the same way as the AWK version) =======*/
+  giMode = 0;
+  if (argc>1 && strncmp(argv[1],"--",2)==0) {
+    if      (strcmp(argv[1]+2,"hira"   )==0) {giMode = 1;}
+    else if (strcmp(argv[1]+2,"kata"   )==0) {giMode = 2;}
+    else if (strcmp(argv[1]+2,"zenkata")==0) {giMode = 3;}
+    else if (strcmp(argv[1]+2,"hankata")==0) {giMode = 4;}
+    else                                     {print_usage_and_exit();}
+    argc--;
+    argv++;
+  }
+  switch (argc) {
+    case 1 : pszFile = "-";     break;
+    case 2 : pszFile = argv[1]; break;
+    default: print_usage_and_exit();
+  }
+
+  /*=== Open the file ==============================================*/
+  if (strcmp(pszFile,"-") == 0) {
+    iFd = STDIN_FILENO;
+  } else if ((iFd=open(pszFile,O_RDONLY)) < 0) {
+    error_exit(1,"Cannot open the file: %s\n", pszFile);
+  }
+
+  /*=== Validate the first line ====================================*/
+  /* (A few bytes at the end of the buffer are left until the next
+   *  reading when they may be a part of a 3-byte character)        */
+  init_tables();
+  uHave = 0;
+  iAny  = 0;
+  pu8Nl = NULL;
+  while (1) {
+    iRead = read(iFd, au8Buf+uHave, IBUF-uHave);
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(1,"Cannot read the file: %s\n", pszFile);
+    }
+    if (iRead == 0) {break;}
+    iAny   = 1;
+    pu8Nl  = memchr(au8Buf+uHave, '\n', (size_t)iRead);
+    uHave += (size_t)iRead;
+    if (pu8Nl != NULL) {break;}
+    iRet   = validate(au8Buf, au8Buf+uHave, 0, &uDone);
+    if (iRet != 0) {return iRet;}
+    memmove(au8Buf, au8Buf+uDone, uHave-uDone);
+    uHave -= uDone;
+  }
+  if (! iAny) {return 2;}
+  iRet = validate(au8Buf, (pu8Nl!=NULL) ? pu8Nl : au8Buf+uHave, 1, &uDone);
+  if (iRet != 0) {return iRet;}
+
+  /*=== Make sure that no line follows it ==========================*/
+  if (pu8Nl == NULL              ) {return 0;}
+  if (pu8Nl+1 <  au8Buf+uHave    ) {return 1;}
+  while ((iRead=read(iFd, au8Buf, 1)) < 0 && errno == EINTR);
+  return (iRead > 0) ? 1 : 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Make the tables and choose the validator for the CPU ===========*/
+void init_tables(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint32_t u32From;
+  int      i;
+
+  /*--- Make the allowed ranges in the mode ------------------------*/
+  /* (The adjoining ranges are merged)                              */
+  giRng   = 0;
+  u32From = 0;
+  for (i=0; i<(int)(sizeof(gaRange)/sizeof(gaRange[0])); i++) {
+    if (gaRange[i].iCls<10 && (gaiAllow[giMode]&(1<<gaRange[i].iCls))) {
+      if (giRng>0 && gau32RngTo[giRng-1]+1==u32From) {
+        gau32RngTo[giRng-1] = gaRange[i].u32Next - 1;
+      } else {
+        gau32RngFrom[giRng] = u32From;
+        gau32RngTo  [giRng] = gaRange[i].u32Next - 1;
+        giRng++;
+      }
+    }
+    u32From = gaRange[i].u32Next;
+  }
+
+  /*--- Choose the validator ---------------------------------------*/
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {gpfValid = valid_ssse3;}
+#endif
+}
+
+/*=== Validate bytes in the first line ===============================
+ * [in]  pu8Beg : The beginning of the bytes
+ *       pu8End : The end of them (the <0x0A> or the end of the input
+ *                when iFinal is 1)
+ *       iFinal : 1 when no byte of the line follows them
+ * [out] puDone : The number of the bytes validated (the rest are a
+ *                part of a 3-byte character which can't be checked
+ *                until the next reading)
+ * [ret]        : 0 if they are valid, or the value to return       */
+int validate(const uint8_t *pu8Beg, const uint8_t *pu8End, int iFinal,
+             size_t *puDone) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  uint32_t u32;
+  int      i;
+
+  /*--- Validate them ----------------------------------------------*/
+  while (pu8 < pu8End) {
+    pu8 += gpfValid(pu8, pu8End);
+    if (pu8 >= pu8End) {break;}
+    if (*pu8 < 0xC0) {return 11;}
+    if (*pu8 < 0xE0) {return 12;}
+    if (*pu8 < 0xF0) {
+      if (pu8End-pu8 < 3 && ! iFinal) {break;}
+      /* (Missing bytes are regarded as 0 as AWK does)             */
+      u32 = ((uint32_t)pu8[0]                    << 16) |
+            ((uint32_t)((pu8End-pu8>1)?pu8[1]:0) <<  8) |
+            ((uint32_t)((pu8End-pu8>2)?pu8[2]:0)      );
+      for (i=0; u32>=gaRange[i].u32Next; i++);
+      if (gaRange[i].iCls >= 10) {return gaRange[i].iCls;}
+      return 30 + giMode; /* it must be a furigana but not allowed  */
+    }
+    if (*pu8 < 0xF8) {return 13;}
+    if (*pu8 < 0xFC) {return 14;}
+    if (*pu8 < 0xFE) {return 15;}
+    return 16;
+  }
+  *puDone = (size_t)(pu8 - pu8Beg);
+  return 0;
+}
+
+/*=== Count the leading valid bytes (scalar version) =================
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ * [ret]       : The number of the bytes which are valid 3-byte
+ *               characters in the mode                             */
+size_t valid_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8;
+  uint32_t u32;
+  int      i;
+
+  /*--- Count them -------------------------------------------------*/
+  for (pu8=pu8Beg; pu8End-pu8>=3; pu8+=3) {
+    u32 = ((uint32_t)pu8[0]<<16) | ((uint32_t)pu8[1]<<8) | pu8[2];
+    for (i=0; i<giRng; i++) {
+      if (u32>=gau32RngFrom[i] && u32<=gau32RngTo[i]) {break;}
+    }
+    if (i >= giRng) {break;}
+  }
+  return (size_t)(pu8 - pu8Beg);
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Count the leading valid bytes (SSSE3 version) ==================
+ * Every 48 bytes are regarded as 16 3-byte characters, and they are
+ * split by PSHUFB into the first bytes and the following two bytes,
+ * which are compared with the allowed ranges 8 characters at a time.
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ * [ret]       : The number of the bytes which are valid 3-byte
+ *               characters in the mode                             */
+__attribute__((target("ssse3")))
+size_t valid_ssse3(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  /* the shuffles which make the 16-bit lanes of the first bytes (L)
+   * and the following two bytes (T) of 8 characters from 24 bytes
+   * in 2 registers (0 and 1)                                       */
+  #define Z -128
+  const __m128i xL0 = _mm_setr_epi8( 0,Z, 3,Z, 6,Z, 9,Z,12,Z,15,Z, Z,Z, Z,Z);
+  const __m128i xL1 = _mm_setr_epi8( Z,Z, Z,Z, Z,Z, Z,Z, Z,Z, Z,Z, 2,Z, 5,Z);
+  const __m128i xT0 = _mm_setr_epi8( 2,1, 5,4, 8,7,11,10,14,13,Z,Z, Z,Z, Z,Z);
+  const __m128i xT1 = _mm_setr_epi8( Z,Z, Z,Z, Z,Z, Z,Z, Z,Z, 1,0, 4,3, 7,6);
+  /* the same for the 8 characters from the 8th byte of register 1 */
+  const __m128i xL2 = _mm_setr_epi8( 8,Z,11,Z,14,Z, Z,Z, Z,Z, Z,Z, Z,Z, Z,Z);
+  const __m128i xL3 = _mm_setr_epi8( Z,Z, Z,Z, Z,Z, 1,Z, 4,Z, 7,Z,10,Z,13,Z);
+  const __m128i xT2 = _mm_setr_epi8(10,9,13,12,Z,15, Z,Z, Z,Z, Z,Z, Z,Z, Z,Z);
+  const __m128i xT3 = _mm_setr_epi8( Z,Z, Z,Z, 0,Z, 3,2, 6,5, 9,8,12,11,15,14);
+  #undef Z
+  const uint8_t *pu8;
+  __m128i x0, x1, x2, xL, xT, xOk, xIn;
+  int     iHalf, i;
+
+  /*--- Count them -------------------------------------------------*/
+  for (pu8=pu8Beg; pu8End-pu8>=48; pu8+=48) {
+    x0 = _mm_loadu_si128((const __m128i*)(pu8   ));
+    x1 = _mm_loadu_si128((const __m128i*)(pu8+16));
+    x2 = _mm_loadu_si128((const __m128i*)(pu8+32));
+    for (iHalf=0; iHalf<2; iHalf++) {
+      if (iHalf == 0) {
+        xL = _mm_or_si128(_mm_shuffle_epi8(x0,xL0),_mm_shuffle_epi8(x1,xL1));
+        xT = _mm_or_si128(_mm_shuffle_epi8(x0,xT0),_mm_shuffle_epi8(x1,xT1));
+      } else {
+        xL = _mm_or_si128(_mm_shuffle_epi8(x1,xL2),_mm_shuffle_epi8(x2,xL3));
+        xT = _mm_or_si128(_mm_shuffle_epi8(x1,xT2),_mm_shuffle_epi8(x2,xT3));
+      }
+      /* (A lane is valid when the first byte equals and the
+       *  following two bytes minus the start are within the width) */
+      xOk = _mm_setzero_si128();
+      for (i=0; i<giRng; i++) {
+        xIn = _mm_subs_epu16(
+                _mm_sub_epi16(xT,_mm_set1_epi16((short)gau32RngFrom[i])),
+                _mm_set1_epi16((short)(gau32RngTo[i]-gau32RngFrom[i])));
+        xIn = _mm_and_si128(
+                _mm_cmpeq_epi16(xIn, _mm_setzero_si128()),
+                _mm_cmpeq_epi16(xL , _mm_set1_epi16(
+                                       (short)(gau32RngFrom[i]>>16))));
+        xOk = _mm_or_si128(xOk, xIn);
+      }
+      if (_mm_movemask_epi8(xOk) != 0xFFFF) {
+        return (size_t)(pu8-pu8Beg) + valid_scalar(pu8, pu8End);
+      }
+    }
+  }
+  return (size_t)(pu8-pu8Beg) + valid_scalar(pu8, pu8End);
+}
+#endif
@@ -0,0 +1,689 @@
+/*####################################################################
+#
+# KANANORM - Normalize Kana and Letter Widths in the Selected Fields
+#
+# USAGE   : kananorm [-f folding[,...]] [+<n>h] <f1> <f2> ... <file>
+#           kananorm [-f folding[,...]] -d [+<n>h] <f1> <f2> ... <string>
+# Args    : <fn> ...... Field number you want to normalize. "NF", "NF-n"
+#                       and "a/b" (from field a to b) are also available.
+#                       The whole of every line is normalized if none or
+#                       "0" is given.
+#           <file> .... Text file which contains some fields to
+#                       normalize ("-" means STDIN)
+#           <string> .. It will be explained in -d option
+# Options : -f ........ Foldings to apply, separated by ",". The
+#                       default is "han2zen,hira2kata,zen2ascii".
+#                         han2zen ..... Hankaku-Katakana into Zenkaku
+#                                       ("ｶﾞ" is composed into "ガ")
+#                         zen2han ..... Zenkaku-Katakana into Hankaku
+#                                       ("ガ" is decomposed into "ｶﾞ")
+#                         hira2kata ... Hiragana into Katakana
+#                         kata2hira ... Katakana into Hiragana
+#                         zen2ascii ... Zenkaku alphanumerics into ASCII
+#                         ascii2zen ... ASCII alphanumerics into Zenkaku
+#           -d ........ Direct Mode :
+#                       It make this command regard the last argument
+#                       (<string>) as a field formatted string instead
+#                       of <file>
+#           +<n>h ..... Regards the top <n> lines as comment and Print
+#                       without normalizing
+# Retuen  : Return 0 only when finished successfully
+#
+# * All of the given foldings are applied in one pass. A character (or
+#   a Hankaku-Katakana with a voiced sound mark) is converted by each
+#   folding in the order "han2zen", "hira2kata"/"kata2hira", "zen2han"
+#   and "zen2ascii"/"ascii2zen" before reading, and the results are
+#   compiled into a byte trie. So, for instance, "ｶﾞ" becomes "が" with
+#   "han2zen,kata2hira", and "が" becomes "ｶﾞ" with "hira2kata,zen2han".
+# * The Hiragana and Katakana are the same as "hira2kata" and
+#   "kata2hira" convert ("ぁ"-"ゖ", "ゝ" and "ゞ").
+# * Fields are separated by " " and <0x09> like AWK does, but unlike
+#   "hira2kata," the separators are kept as they are.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#define _XOPEN_SOURCE 700 /* for getline() */
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*--- macros -------------------------------------------------------*/
+#define F_HAN2ZEN   0x01  /* foldings                               */
+#define F_ZEN2HAN   0x02
+#define F_HIRA2KATA 0x04
+#define F_KATA2HIRA 0x08
+#define F_ZEN2ASCII 0x10
+#define F_ASCII2ZEN 0x20
+#define CELL_NUM    0     /* a cell of a field specification is "n" */
+#define CELL_NF     1     /* a cell of a field specification is
+                             "NF" or "NF-n"                         */
+
+/*--- structures ---------------------------------------------------*/
+typedef struct {    /* a node of the trie (0 is the root)           */
+  int16_t  ai16Next[256];/* the next nodes by the byte (0 if none)  */
+  uint16_t u16Out;       /* the output string (offset in the pool)  */
+  uint8_t  u8OutLen;     /* the length of it (0 if no token ends)   */
+} node;
+typedef struct {    /* a field specification ("a" or "a/b")         */
+  int  iKind1, iKind2;   /* CELL_NUM or CELL_NF                     */
+  long lNum1 , lNum2;    /* n (of "n" or "NF-n")                    */
+} fldspec;
+
+/*--- prototype functions ------------------------------------------*/
+int    parse_cell(const char *psz, int *piKind, long *plNum);
+int    parse_fldspec(const char *psz, fldspec *pfs);
+void   build_trie(int iFold);
+int    fold_token(int iFold, const uint32_t *pu32In, int iIn,
+                  uint32_t *pu32Out);
+uint32_t compose(uint32_t u32Kana, uint32_t u32Mark);
+int    put_utf8(uint32_t u32, char *pc);
+void   insert_token(const char *pcIn, int iIn, const char *pcOut, int iOut);
+void   process_line(const char *pcLine, size_t uLen);
+void   fold_span(const char *pcBeg, size_t uLen);
+void   put_out(const void *pv, size_t uLen);
+
+/*--- global variables ---------------------------------------------*/
+char*    gpszCmdname;       /* The name of this command             */
+node*    gpNode;            /* the trie nodes                       */
+int      giNode;            /* the number of them                   */
+int      giNodeAlloc;       /* the allocated number of them         */
+char*    gpcPool;           /* the output strings                   */
+int      giPool;            /* the size of them                     */
+int      giPoolAlloc;       /* the allocated size of them           */
+fldspec* gpFs;              /* the field specifications             */
+int      giNfs;             /* the number of them                   */
+int      giAllFields;       /* 1 when the whole lines are normalized*/
+uint8_t* gpu8Mark;          /* marks for the fields of a line       */
+long     glMarkAlloc;       /* the allocated size of gpu8Mark       */
+char*    gpcOut;            /* the output line buffer               */
+size_t   guOut;             /* the length of the data in it         */
+size_t   guOutAlloc;        /* the allocated size of it             */
+/* Zenkaku for Hankaku-Katakana (U+FF61-U+FF9F)                     */
+const uint16_t gau16Han2Zen[63] = {
+          0x3002,0x300C,0x300D,0x3001,0x30FB,0x30F2,0x30A1, /* ｡-ｧ */
+  0x30A3,0x30A5,0x30A7,0x30A9,0x30E3,0x30E5,0x30E7,0x30C3, /* ｨ-ｯ */
+  0x30FC,0x30A2,0x30A4,0x30A6,0x30A8,0x30AA,0x30AB,0x30AD, /* ｰ-ｷ */
+  0x30AF,0x30B1,0x30B3,0x30B5,0x30B7,0x30B9,0x30BB,0x30BD, /* ｸ-ｿ */
+  0x30BF,0x30C1,0x30C4,0x30C6,0x30C8,0x30CA,0x30CB,0x30CC, /* ﾀ-ﾇ */
+  0x30CD,0x30CE,0x30CF,0x30D2,0x30D5,0x30D8,0x30DB,0x30DE, /* ﾈ-ﾏ */
+  0x30DF,0x30E0,0x30E1,0x30E2,0x30E4,0x30E6,0x30E8,0x30E9, /* ﾐ-ﾗ */
+  0x30EA,0x30EB,0x30EC,0x30ED,0x30EF,0x30F3,0x309B,0x309C  /* ﾘ-ﾟ */
+};
+/* Hankaku for Zenkaku-Katakana and the marks (U+3000-U+30FF, the
+ * second one is 0 or a voiced sound mark)                          */
+uint16_t gau16Zen2Han[256][2];
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-f folding[,...]] [+<n>h] <f1> <f2> ... <file>\n"
+    "          %s [-f folding[,...]] -d [+<n>h] <f1> <f2> ... <string>\n"
+    "Args    : <fn> ...... Field number you want to normalize. \"NF\", \"NF-n\"\n"
+    "                      and \"a/b\" (from field a to b) are also available.\n"
+    "                      The whole of every line is normalized if none or\n"
+    "                      \"0\" is given.\n"
+    "          <file> .... Text file which contains some fields to\n"
+    "                      normalize (\"-\" means STDIN)\n"
+    "          <string> .. It will be explained in -d option\n"
+    "Options : -f ........ Foldings to apply, separated by \",\". The\n"
+    "                      default is \"han2zen,hira2kata,zen2ascii\".\n"
+    "                        han2zen ..... Hankaku-Katakana into Zenkaku\n"
+    "                                      (\"ｶﾞ\" is composed into \"ガ\")\n"
+    "                        zen2han ..... Zenkaku-Katakana into Hankaku\n"
+    "                                      (\"ガ\" is decomposed into \"ｶﾞ\")\n"
+    "                        hira2kata ... Hiragana into Katakana\n"
+    "                        kata2hira ... Katakana into Hiragana\n"
+    "                        zen2ascii ... Zenkaku alphanumerics into ASCII\n"
+    "                        ascii2zen ... ASCII alphanumerics into Zenkaku\n"
+    "          -d ........ Direct Mode :\n"
+    "                      It make this command regard the last argument\n"
+    "                      (<string>) as a field formatted string instead\n"
+    "                      of <file>\n"
+    "          +<n>h ..... Regards the top <n> lines as comment and Print\n"
+    "                      without normalizing\n"
+    "Retuen  : Return 0 only when finished successfully\n"
+    "Version : 2026-10-19 21:14:05 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  FILE   *fp;
+  char   *pszFile;    /* the file to read                           */
+  char   *pszDirect;  /* the string in direct mode (or NULL)        */
+  char   *pszFold;    /* the foldings given by -f                   */
+  char   *pcLine;     /* the line read                              */
+  char   *pc, *pc2;
+  size_t  uLineAlloc;
+  ssize_t iLen;
+  long    lHdr;       /* the number of the header lines (+<n>h)     */
+  int     iDirect;    /* 1 when -d option is set                    */
+  int     iFold;      /* the foldings (F_*)                         */
+  int     i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  pszFold = "han2zen,hira2kata,zen2ascii";
+  iDirect = 0;
+  while ((i=getopt(argc, argv, "df:h")) != -1) {
+    switch (i) {
+      case 'd': iDirect = 1;
+                break;
+      case 'f': pszFold = optarg;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  /*--- the header lines -------------------------------------------*/
+  lHdr = 0;
+  if (argc>0 && argv[0][0]=='+') {
+    for (pc=argv[0]+1; *pc>='0' && *pc<='9'; pc++);
+    if (strcmp(pc,"h")!=0) {print_usage_and_exit();}
+    lHdr = (pc==argv[0]+1) ? 1 : atol(argv[0]+1);
+    argc--;
+    argv++;
+  }
+  /*--- the foldings -----------------------------------------------*/
+  iFold = 0;
+  for (pc=pszFold; *pc!='\0'; pc=(*pc2==',') ? pc2+1 : pc2) {
+    pc2 = pc + strcspn(pc, ",");
+    if      ((pc2-pc)==7 && strncmp(pc,"han2zen"  ,7)==0) {iFold|=F_HAN2ZEN  ;}
+    else if ((pc2-pc)==7 && strncmp(pc,"zen2han"  ,7)==0) {iFold|=F_ZEN2HAN  ;}
+    else if ((pc2-pc)==9 && strncmp(pc,"hira2kata",9)==0) {iFold|=F_HIRA2KATA;}
+    else if ((pc2-pc)==9 && strncmp(pc,"kata2hira",9)==0) {iFold|=F_KATA2HIRA;}
+    else if ((pc2-pc)==9 && strncmp(pc,"zen2ascii",9)==0) {iFold|=F_ZEN2ASCII;}
+    else if ((pc2-pc)==9 && strncmp(pc,"ascii2zen",9)==0) {iFold|=F_ASCII2ZEN;}
+    else {error_exit(1,"%.*s: Unknown folding\n", (int)(pc2-pc), pc);}
+  }
+  if (((iFold&F_HAN2ZEN  ) && (iFold&F_ZEN2HAN  )) ||
+      ((iFold&F_HIRA2KATA) && (iFold&F_KATA2HIRA)) ||
+      ((iFold&F_ZEN2ASCII) && (iFold&F_ASCII2ZEN))  ) {
+    error_exit(1,"%s: Opposite foldings can't be applied together\n",
+               pszFold);
+  }
+
+  /*=== Parse arguments ============================================*/
+  pszFile     = "-";
+  pszDirect   = NULL;
+  giAllFields = 0;
+  if ((gpFs=malloc(sizeof(fldspec)*(argc+1))) == NULL) {
+    error_exit(errno,"malloc(): %s\n",strerror(errno));
+  }
+  for (i=0; i<argc; i++) {
+    if (iDirect && i==argc-1) {pszDirect = argv[i]; break;}
+    if (parse_fldspec(argv[i], &gpFs[giNfs])) {
+      if ((gpFs[giNfs].iKind1==CELL_NUM && gpFs[giNfs].lNum1==0) ||
+          (gpFs[giNfs].iKind2==CELL_NUM && gpFs[giNfs].lNum2==0)  ) {
+        giAllFields = 1;
+      }
+      giNfs++;
+      continue;
+    }
+    if (i==argc-1) {pszFile = argv[i]; continue;}
+    print_usage_and_exit();
+  }
+  if (iDirect && pszDirect==NULL) {print_usage_and_exit();}
+  if (giNfs == 0                ) {giAllFields = 1;     }
+  build_trie(iFold);
+
+  /*=== Normalize ==================================================*/
+  if (iDirect) {
+    /*--- the string in direct mode --------------------------------*/
+    for (pc=pszDirect; *pc!='\0'; pc+=iLen+(pc[iLen]=='\n')) {
+      iLen = (ssize_t)strcspn(pc, "\n");
+      if (lHdr > 0) {
+        lHdr--;
+        put_out(pc, (size_t)iLen); put_out("\n", 1);
+        fwrite(gpcOut, 1, guOut, stdout); guOut = 0;
+        continue;
+      }
+      process_line(pc, (size_t)iLen);
+    }
+  } else {
+    /*--- the file -------------------------------------------------*/
+    if (strcmp(pszFile,"-")==0) {
+      fp = stdin;
+    } else if ((fp=fopen(pszFile,"r")) == NULL) {
+      error_exit(1,"Cannot open the file: %s\n", pszFile);
+    }
+    pcLine     = NULL;
+    uLineAlloc = 0;
+    while ((iLen=getline(&pcLine, &uLineAlloc, fp)) >= 0) {
+      if (iLen>0 && pcLine[iLen-1]=='\n') {iLen--;}
+      if (lHdr > 0) {
+        lHdr--;
+        put_out(pcLine, (size_t)iLen); put_out("\n", 1);
+        fwrite(gpcOut, 1, guOut, stdout); guOut = 0;
+        continue;
+      }
+      process_line(pcLine, (size_t)iLen);
+    }
+    if (ferror(fp)) {error_exit(errno,"getline(): %s\n",strerror(errno));}
+  }
+
+  /*=== Finish =====================================================*/
+  if (fflush(stdout) != 0) {
+    error_exit(errno,"fflush(): %s\n",strerror(errno));
+  }
+  return 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Parse a cell of a field specification ==========================
+ * [in]  psz    : The string ("n", "NF" or "NF-n")
+ * [out] piKind : CELL_NUM or CELL_NF
+ *       plNum  : n
+ * [ret]        : 1 if valid, 0 if not                              */
+int parse_cell(const char *psz, int *piKind, long *plNum) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *p;
+
+  /*--- Parse it ---------------------------------------------------*/
+  *piKind = CELL_NUM;
+  *plNum  = 0;
+  if (strncmp(psz,"NF",2) == 0) {
+    *piKind = CELL_NF;
+    if (psz[2] == '\0') {return 1;}
+    if (psz[2] != '-' ) {return 0;}
+    psz += 3;
+  }
+  if (*psz == '\0') {return 0;}
+  for (p=psz; *p!='\0'; p++) {if (*p<'0' || *p>'9') {return 0;}}
+  *plNum = atol(psz);
+  return 1;
+}
+
+/*=== Parse a field specification ====================================
+ * [in]  psz : The string ("c" or "c/c", "c" is a cell)
+ * [out] pfs : The parsed specification ("c" is regarded as "c/c")
+ * [ret]     : 1 if valid, 0 if not                                 */
+int parse_fldspec(const char *psz, fldspec *pfs) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pcSl;
+  char        sz[64];
+
+  /*--- Parse it ---------------------------------------------------*/
+  pcSl = strchr(psz, '/');
+  if (pcSl == NULL) {
+    if (! parse_cell(psz, &pfs->iKind1, &pfs->lNum1)) {return 0;}
+    pfs->iKind2 = pfs->iKind1;
+    pfs->lNum2  = pfs->lNum1;
+    return 1;
+  }
+  if ((size_t)(pcSl-psz) >= sizeof(sz)) {return 0;}
+  memcpy(sz, psz, pcSl-psz);
+  sz[pcSl-psz] = '\0';
+  if (! parse_cell(sz    , &pfs->iKind1, &pfs->lNum1)) {return 0;}
+  if (! parse_cell(pcSl+1, &pfs->iKind2, &pfs->lNum2)) {return 0;}
+  return 1;
+}
+
+/*=== Compile the foldings into the trie =============================
+ * Every character which may be changed (and every Hankaku-Katakana
+ * with a voiced sound mark) is folded and registered as a token.
+ * [in] iFold : The foldings (F_*)                                  */
+void build_trie(int iFold) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const uint32_t au32Blk[][2] = {
+    {0x0030,0x007A}, {0x3000,0x30FF}, {0xFF00,0xFF9F}
+  };
+  uint32_t au32In[2], au32Out[8], u32, u32Mark, u32Kana;
+  char     acIn[8], acOut[32];
+  int      iIn, iOut, iOutN, i, j, k;
+
+  /*--- Make the Zenkaku-to-Hankaku table --------------------------*/
+  memset(gau16Zen2Han, 0, sizeof(gau16Zen2Han));
+  for (u32=0xFF61; u32<=0xFF9F; u32++) {
+    u32Kana = gau16Han2Zen[u32-0xFF61];
+    gau16Zen2Han[u32Kana-0x3000][0] = (uint16_t)u32;
+    for (u32Mark=0xFF9E; u32Mark<=0xFF9F; u32Mark++) {
+      if ((i=(int)compose(u32Kana, u32Mark)) == 0) {continue;}
+      gau16Zen2Han[i-0x3000][0] = (uint16_t)u32;
+      gau16Zen2Han[i-0x3000][1] = (uint16_t)u32Mark;
+    }
+  }
+
+  /*--- Register the characters ------------------------------------*/
+  giNode = 0;
+  giPool = 0;
+  insert_token("", 0, "", 0); /* the root */
+  for (i=0; i<3; i++) {
+    for (u32=au32Blk[i][0]; u32<=au32Blk[i][1]; u32++) {
+      au32In[0] = u32;
+      iOutN = fold_token(iFold, au32In, 1, au32Out);
+      if (iOutN==1 && au32Out[0]==u32) {continue;}
+      iIn = put_utf8(u32, acIn);
+      for (iOut=j=0; j<iOutN; j++) {iOut += put_utf8(au32Out[j], acOut+iOut);}
+      insert_token(acIn, iIn, acOut, iOut);
+    }
+  }
+
+  /*--- Register the Hankaku-Katakana with voiced sound marks ------*/
+  if (! (iFold & F_HAN2ZEN)) {return;}
+  for (u32=0xFF66; u32<=0xFF9D; u32++) {
+    for (u32Mark=0xFF9E; u32Mark<=0xFF9F; u32Mark++) {
+      if (compose(gau16Han2Zen[u32-0xFF61], u32Mark) == 0) {continue;}
+      au32In[0] = u32;
+      au32In[1] = u32Mark;
+      iOutN = fold_token(iFold, au32In, 2, au32Out);
+      iIn   = put_utf8(u32, acIn);
+      iIn  += put_utf8(u32Mark, acIn+iIn);
+      for (iOut=k=0; k<iOutN; k++) {iOut += put_utf8(au32Out[k], acOut+iOut);}
+      insert_token(acIn, iIn, acOut, iOut);
+    }
+  }
+}
+
+/*=== Fold a token ===================================================
+ * [in]  iFold   : The foldings (F_*)
+ *       pu32In  : The token (a character, or a Hankaku-Katakana and a
+ *                 voiced sound mark which can be composed)
+ *       iIn     : The number of the characters of it
+ * [out] pu32Out : The folded characters
+ * [ret]         : The number of them                               */
+int fold_token(int iFold, const uint32_t *pu32In, int iIn,
+               uint32_t *pu32Out) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint32_t au32[4];
+  int      iN, i, j;
+
+  /*--- Hankaku-Katakana into Zenkaku ------------------------------*/
+  for (i=0; i<iIn; i++) {au32[i] = pu32In[i];}
+  iN = iIn;
+  if (iFold & F_HAN2ZEN) {
+    for (i=0; i<iN; i++) {
+      if (au32[i]>=0xFF61 && au32[i]<=0xFF9F) {
+        au32[i] = gau16Han2Zen[au32[i]-0xFF61];
+      }
+    }
+    if (iN == 2) {au32[0]=compose(au32[0], pu32In[1]); iN=1;}
+  }
+
+  /*--- Hiragana and Katakana --------------------------------------*/
+  for (i=0; i<iN; i++) {
+    if ((iFold & F_HIRA2KATA) &&
+        ((au32[i]>=0x3041 && au32[i]<=0x3096) ||
+         (au32[i]>=0x309D && au32[i]<=0x309E)   )) {au32[i] += 0x60;}
+    if ((iFold & F_KATA2HIRA) &&
+        ((au32[i]>=0x30A1 && au32[i]<=0x30F6) ||
+         (au32[i]>=0x30FD && au32[i]<=0x30FE)   )) {au32[i] -= 0x60;}
+  }
+
+  /*--- Zenkaku-Katakana into Hankaku, and alphanumerics -----------*/
+  for (i=j=0; i<iN; i++) {
+    if ((iFold & F_ZEN2HAN) && au32[i]>=0x3000 && au32[i]<=0x30FF &&
+        gau16Zen2Han[au32[i]-0x3000][0]!=0                          ) {
+      pu32Out[j++] = gau16Zen2Han[au32[i]-0x3000][0];
+      if (gau16Zen2Han[au32[i]-0x3000][1]) {
+        pu32Out[j++] = gau16Zen2Han[au32[i]-0x3000][1];
+      }
+      continue;
+    }
+    if ((iFold & F_ZEN2ASCII) &&
+        ((au32[i]>=0xFF10 && au32[i]<=0xFF19) ||
+         (au32[i]>=0xFF21 && au32[i]<=0xFF3A) ||
+         (au32[i]>=0xFF41 && au32[i]<=0xFF5A)   )) {au32[i] -= 0xFEE0;}
+    else if ((iFold & F_ASCII2ZEN) &&
+        ((au32[i]>=0x0030 && au32[i]<=0x0039) ||
+         (au32[i]>=0x0041 && au32[i]<=0x005A) ||
+         (au32[i]>=0x0061 && au32[i]<=0x007A)   )) {au32[i] += 0xFEE0;}
+    pu32Out[j++] = au32[i];
+  }
+  return j;
+}
+
+/*=== Compose a Zenkaku-Katakana and a voiced sound mark =============
+ * [in] u32Kana : The Zenkaku-Katakana
+ *      u32Mark : The Hankaku voiced sound mark ("ﾞ" or "ﾟ")
+ * [ret]        : The composed Katakana, or 0 if it can't be        */
+uint32_t compose(uint32_t u32Kana, uint32_t u32Mark) {
+  if (u32Mark == 0xFF9E) {                                    /* "ﾞ" */
+    if ((u32Kana>=0x30AB && u32Kana<=0x30C1 && (u32Kana-0x30AB)%2==0) ||
+        u32Kana==0x30C4 || u32Kana==0x30C6 || u32Kana==0x30C8         ||
+        (u32Kana>=0x30CF && u32Kana<=0x30DB && (u32Kana-0x30CF)%3==0)  ) {
+      return u32Kana + 1;                              /* "ガ"-"ボ" */
+    }
+    if (u32Kana == 0x30A6) {return 0x30F4;}           /* "ヴ"      */
+    if (u32Kana == 0x30EF) {return 0x30F7;}           /* "ヷ"      */
+    if (u32Kana == 0x30F2) {return 0x30FA;}           /* "ヺ"      */
+  } else if (u32Mark == 0xFF9F) {                             /* "ﾟ" */
+    if (u32Kana>=0x30CF && u32Kana<=0x30DB && (u32Kana-0x30CF)%3==0) {
+      return u32Kana + 2;                              /* "パ"-"ポ" */
+    }
+  }
+  return 0;
+}
+
+/*=== Encode a character into UTF-8 ==================================
+ * [in]  u32 : The character (up to U+FFFF)
+ * [out] pc  : The encoded bytes
+ * [ret]     : The number of them                                   */
+int put_utf8(uint32_t u32, char *pc) {
+  if (u32 < 0x80 ) {pc[0]=(char)u32; return 1;}
+  if (u32 < 0x800) {
+    pc[0] = (char)(0xC0 | (u32>>6)   );
+    pc[1] = (char)(0x80 | (u32&0x3F) );
+    return 2;
+  }
+  pc[0] = (char)(0xE0 |  (u32>>12)      );
+  pc[1] = (char)(0x80 | ((u32>> 6)&0x3F));
+  pc[2] = (char)(0x80 |  (u32     &0x3F));
+  return 3;
+}
+
+/*=== Register a token to the trie ===================================
+ * [in] pcIn  : The bytes of the token
+ *      iIn   : The number of them
+ *      pcOut : The bytes to output instead of it
+ *      iOut  : The number of them                                  */
+void insert_token(const char *pcIn, int iIn, const char *pcOut, int iOut) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = (const uint8_t*)pcIn;
+  int      iNode, i;
+
+  /*--- Follow (or make) the nodes (the root is made at first) -----*/
+  iNode = 0;
+  for (i=(giNode==0)?-1:0; i<iIn; i++) {
+    if (i>=0 && gpNode[iNode].ai16Next[pu8[i]]!=0) {
+      iNode = gpNode[iNode].ai16Next[pu8[i]];
+      continue;
+    }
+    if (giNode >= giNodeAlloc) {
+      giNodeAlloc = (giNodeAlloc==0) ? 512 : giNodeAlloc*2;
+      if ((gpNode=realloc(gpNode, sizeof(node)*giNodeAlloc)) == NULL) {
+        error_exit(errno,"realloc(): %s\n",strerror(errno));
+      }
+    }
+    memset(&gpNode[giNode], 0, sizeof(node));
+    if (i >= 0) {gpNode[iNode].ai16Next[pu8[i]] = (int16_t)giNode;}
+    iNode = giNode++;
+  }
+
+  /*--- Set the output ---------------------------------------------*/
+  if (giPool+iOut > giPoolAlloc) {
+    giPoolAlloc = (giPoolAlloc==0) ? 4096 : giPoolAlloc*2;
+    if ((gpcPool=realloc(gpcPool, giPoolAlloc)) == NULL) {
+      error_exit(errno,"realloc(): %s\n",strerror(errno));
+    }
+  }
+  memcpy(gpcPool+giPool, pcOut, iOut);
+  gpNode[iNode].u16Out   = (uint16_t)giPool;
+  gpNode[iNode].u8OutLen = (uint8_t)iOut;
+  giPool += iOut;
+}
+
+/*=== Normalize a line and print it ==================================
+ * [in] pcLine : The line (without <0x0A>)
+ *      uLen   : The length of it                                   */
+void process_line(const char *pcLine, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc, *pcEnd, *pcFld;
+  long  lNf, lA, lB, l;
+  int   i;
+
+  /*--- Normalize all of it if no field is selected ----------------*/
+  guOut = 0;
+  if (giAllFields) {
+    fold_span(pcLine, uLen);
+    put_out("\n", 1);
+    fwrite(gpcOut, 1, guOut, stdout);
+    return;
+  }
+
+  /*--- Count the fields -------------------------------------------*/
+  pcEnd = pcLine + uLen;
+  lNf   = 0;
+  for (pc=pcLine; ; ) {
+    while (pc<pcEnd && (*pc==' ' || *pc=='\t')) {pc++;}
+    if (pc >= pcEnd) {break;}
+    lNf++;
+    while (pc<pcEnd && *pc!=' ' && *pc!='\t') {pc++;}
+  }
+
+  /*--- Mark the fields to be normalized ---------------------------*/
+  if (lNf+1 > glMarkAlloc) {
+    for (l=(glMarkAlloc==0)?64:glMarkAlloc; l<lNf+1; l*=2);
+    if ((gpu8Mark=realloc(gpu8Mark, l)) == NULL) {
+      error_exit(errno,"realloc(): %s\n",strerror(errno));
+    }
+    glMarkAlloc = l;
+  }
+  memset(gpu8Mark, 0, lNf+1);
+  for (i=0; i<giNfs; i++) {
+    lA = (gpFs[i].iKind1==CELL_NUM) ? gpFs[i].lNum1 : lNf-gpFs[i].lNum1;
+    lB = (gpFs[i].iKind2==CELL_NUM) ? gpFs[i].lNum2 : lNf-gpFs[i].lNum2;
+    if (lA > lB) {l=lA; lA=lB; lB=l;}
+    if (lA < 1  ) {lA = 1;  }
+    if (lB > lNf) {lB = lNf;}
+    for (l=lA; l<=lB; l++) {gpu8Mark[l] = 1;}
+  }
+
+  /*--- Normalize the marked fields --------------------------------*/
+  l = 0;
+  for (pc=pcLine; pc<pcEnd; ) {
+    for (pcFld=pc; pc<pcEnd && (*pc==' ' || *pc=='\t'); pc++);
+    put_out(pcFld, pc-pcFld);
+    if (pc >= pcEnd) {break;}
+    for (pcFld=pc; pc<pcEnd && *pc!=' ' && *pc!='\t'; pc++);
+    if (gpu8Mark[++l]) {fold_span(pcFld, pc-pcFld);}
+    else               {put_out  (pcFld, pc-pcFld);}
+  }
+  put_out("\n", 1);
+  fwrite(gpcOut, 1, guOut, stdout);
+}
+
+/*=== Fold the characters in a span and put it to the output buffer ==
+ * The longest token in the trie is replaced at every position.
+ * [in] pcBeg : The beginning of the span
+ *      uLen  : The length of it                                    */
+void fold_span(const char *pcBeg, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8    = (const uint8_t*)pcBeg;
+  const uint8_t *pu8End = pu8 + uLen;
+  const uint8_t *pu8Run;  /* the beginning of the bytes to copy     */
+  const uint8_t *pu8Tok;  /* the end of the longest token           */
+  const uint8_t *pu8Tmp;
+  const node    *pn, *pnTok;
+  int            iNode;
+
+  /*--- Fold them --------------------------------------------------*/
+  for (pu8Run=pu8; pu8<pu8End; ) {
+    if ((iNode=gpNode[0].ai16Next[*pu8]) == 0) {pu8++; continue;}
+    pnTok  = NULL;
+    pu8Tok = NULL;
+    for (pu8Tmp=pu8+1; ; pu8Tmp++) {
+      pn = &gpNode[iNode];
+      if (pn->u8OutLen > 0                             ) {pnTok =pn    ;
+                                                          pu8Tok=pu8Tmp;}
+      if (pu8Tmp >= pu8End                             ) {break;}
+      if ((iNode=pn->ai16Next[*pu8Tmp]) == 0           ) {break;}
+    }
+    if (pnTok == NULL) {pu8++; continue;}
+    put_out(pu8Run, pu8-pu8Run);
+    put_out(gpcPool+pnTok->u16Out, pnTok->u8OutLen);
+    pu8 = pu8Run = pu8Tok;
+  }
+  put_out(pu8Run, pu8-pu8Run);
+}
+
+/*=== Put bytes to the output line buffer ============================
+ * [in] pv   : The bytes
+ *      uLen : The number of them                                   */
+void put_out(const void *pv, size_t uLen) {
+  if (guOut+uLen > guOutAlloc) {
+    for (guOutAlloc=(guOutAlloc==0)?4096:guOutAlloc;
+         guOut+uLen>guOutAlloc; guOutAlloc*=2);
+    if ((gpcOut=realloc(gpcOut, guOutAlloc)) == NULL) {
+      error_exit(errno,"realloc(): %s\n",strerror(errno));
+    }
+  }
+  memcpy(gpcOut+guOut, pv, uLen);
+  guOut += uLen;
+}
@@ -7,7 +7,10 @@
 #          current time" means the instant when this command starts
 #          writing the line which has been read.
 #
-# USAGE   : linets [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du] [file ...]
+# USAGE   : linets [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du] [-k clksrc]
+#                  [-s|-S] [-i interval] [file ...]
+#           linets [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du]
+#                  [-s|-S] [-i interval] -U sockpath
 # Args    : file ...... Filepath to be attached the current timestamp
 #                       ("-" means STDIN)
 # Options : -0,-3,-6,-9 Specify resolution unit of the time. For instance,
@@ -40,6 +43,44 @@
 #                       be attatched when using this option.
 #           -u ........ Set the date in UTC when -c option is set
 #                       (same as that of date command)
+#           -s ........ Statistics mode. Print only the summary of the
+#                       inter-arrival time of the lines to STDOUT instead
+#                       of the timestamped lines.
+#           -S ........ Same as -s, but pass the timestamped lines through
+#                       to STDOUT and print the summary to STDERR.
+#           -i interval Also print the summary of every "interval" seconds
+#                       in -s/-S mode. The summary is printed when the
+#                       first line after the interval comes. (default: 0,
+#                       which means printing only the total on exit)
+#                       The summary has the following 9 fields.
+#                         <"interval"|"total"> <period> <lines> <lines/s>
+#                         <maxgap> <p50gap> <p90gap> <p99gap> <p99.9gap>
+#                       All the times are in seconds with the resolution
+#                       of -0/-3/-6/-9. The percentiles are the upper
+#                       bounds of the histogram bins (error <= 12.5%).
+#           -U sockpath Bind a Unix-domain datagram socket on "sockpath"
+#                       and read the datagrams from it instead of files.
+#                       Each line is stamped with the time the kernel
+#                       received the datagram (SO_TIMESTAMPNS). A line
+#                       feed is added to a datagram not ending with it.
+#                       The socket file is removed on SIGINT/SIGTERM.
+#                       (Linux only)
+#           [The following option is for professional]
+#           -k clksrc . Clock source to get the current time from
+#                         real ..... CLOCK_REALTIME (default)
+#                         coarse ... CLOCK_REALTIME_COARSE (Linux only).
+#                                    Cheaper, but only as precise as
+#                                    the kernel tick.
+#                         tsc ...... CPU time stamp counter calibrated
+#                                    against CLOCK_MONOTONIC and
+#                                    re-synced with CLOCK_REALTIME
+#                                    every second (x86 with invariant
+#                                    TSC only)
+#                         auto ..... "coarse" if its resolution is fine
+#                                    enough for -0/-3/-6/-9, otherwise
+#                                    "real"
+#                       The unavailable ones fall back to "real". The
+#                       chosen source is reported with -v option.
 # Retuen  : Return 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
@@ -67,6 +108,10 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  /* This definition is for recvmmsg() on Linux */
+  #define _GNU_SOURCE
+#endif
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -75,6 +120,19 @@
 #include <unistd.h>
 #include <time.h>
 #include <fcntl.h>
+#include <stdint.h>
+#include <signal.h>
+#if defined(__linux__)
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #if defined(SO_TIMESTAMPNS) && defined(MSG_WAITFORONE)
+    #define HAVE_DGRAM_TS
+  #endif
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <cpuid.h>
+  #define HAVE_TSC
+#endif
 
 /*--- macro constants ----------------------------------------------*/
 /* Buffer size for a timestamp string */
@@ -82,9 +140,33 @@
 #ifndef CLOCK_MONOTONIC
   #define CLOCK_MONOTONIC CLOCK_REALTIME /* for HP-UX */
 #endif
+/* Clock source types (for -k option) */
+#define CLKSRC_AUTO      0
+#define CLKSRC_REAL      1
+#define CLKSRC_COARSE    2
+#define CLKSRC_TSC       3
+/* The number of datagrams and the buffer size of each for -U option */
+#define DGRAM_BATCH      64
+#define DGRAM_BUF        65536
+/* The number of histogram bins for the statistics mode
+ * (8 bins for each power of 2 of nanoseconds)                      */
+#define HIST_BINS        496
+/* Calibration time and re-sync interval for the TSC clock source */
+#define TSC_CALIB_NSEC   20000000
+#define TSC_RESYNC_SEC   1
+/* Max relative change of the tick rate accepted at a re-sync, and max
+ * backward correction to hide at a re-sync (larger one is a clock step) */
+#define TSC_RATE_TOL     0.001
+#define TSC_BACK_NSEC    1000000
 
 /*--- data type definitions ----------------------------------------*/
 typedef struct timespec tmsp;
+typedef struct {
+  uint64_t u8Lines         ; /* the number of lines came              */
+  uint64_t u8MaxGap        ; /* the maximum inter-arrival time (nsec) */
+  uint64_t au8Hist[HIST_BINS]; /* histogram of inter-arrival time     */
+  tmsp     tsStart         ; /* the time the period started           */
+} lnstat;
 
 /*--- prototype functions ------------------------------------------*/
 int read_1line(FILE *fp);
@@ -92,6 +174,24 @@ int read_c1st_1line(FILE *fp);
 int read_e1st_1line(FILE *fp);
 int read_Z1st_1line(FILE *fp);
 void print_cur_timestamp(void);
+void print_timestamp(tmsp *ptsNow);
+#ifdef HAVE_DGRAM_TS
+  int  receive_dgrams(char *pszSockpath, int iFirstline);
+  void write_dgram_lines(char *pszBuf, int iLen, tmsp *ptsRecv, int *piFirst);
+#endif
+void init_clock_source(void);
+int  get_cur_time(tmsp *ptsNow);
+void record_stats(tmsp *ptsNow);
+int  read_stats_1line(FILE *fp);
+void print_stats(FILE *fpOut, const char *pszLabel, lnstat *pst, tmsp *ptsEnd);
+void print_secs(FILE *fpOut, uint64_t u8Ns);
+int  hist_bin(uint64_t u8Ns);
+uint64_t hist_bin_upper(int iBin);
+void request_exit(int iSig);
+#ifdef HAVE_TSC
+  uint64_t read_tsc(void);
+  int  calibrate_tsc(void);
+#endif
 
 /*--- global variables ---------------------------------------------*/
 char* gpszCmdname      ; /* The name of this command                      */
@@ -106,13 +206,32 @@ tmsp  gtsZero     = {0}; /* Time this command booted                      */
 tmsp  gtsPrev     = {0}; /* Time the previous line has come (-gtsZero)    */
 int   giHold      =  0 ; /* for read_1line(): 1 if next character exists  */
 int   giNextchar       ; /* for read_1line(): the next character          */
+int   giClkSrc    = CLKSRC_REAL; /* clock source (CLKSRC_*)                */
+int   giStatMode  =  0 ; /* 0:off 1:stats only (-s) 2:stats and pass (-S) */
+int64_t gi8StatItvl=  0 ; /* interval of the summary in nsec (0:only total)*/
+lnstat gstStTotal      ; /* statistics for the whole run                  */
+lnstat gstStItvl       ; /* statistics for the current interval           */
+tmsp  gtsStPrev   = {0}; /* Time the previous line has come (for stats)   */
+tmsp  gtsStNext   = {0}; /* Time to print the next interval summary       */
+volatile sig_atomic_t giExitReq = 0; /* set 1 by SIGINT/SIGTERM           */
+#ifdef HAVE_TSC
+uint64_t gu8TscBase  =  0 ; /* TSC value at the last sync                 */
+tmsp     gtsTscBase  = {0}; /* CLOCK_REALTIME at the last sync            */
+tmsp     gtsTscMono  = {0}; /* CLOCK_MONOTONIC at the last sync           */
+tmsp     gtsTscLast  = {0}; /* the latest time returned by TSC source     */
+double   gdNsPerTick =  0 ; /* nanoseconds per TSC tick                   */
+uint64_t gu8TscResync=  0 ; /* TSC ticks between re-syncs                 */
+#endif
 
 /*=== Define the functions for printing usage and error ============*/
 
 /*--- exit with usage ----------------------------------------------*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    "USAGE   : %s [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du] [file ...]\n"
+    "USAGE   : %s [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du] [-k clksrc]\n"
+    "                 [-s|-S] [-i interval] [file ...]\n"
+    "          %s [-0|-3|-6|-9] [-c|-e|-z|-Z] [-du]\n"
+    "                 [-s|-S] [-i interval] -U sockpath\n"
     "Args    : file ...... Filepath to be attached the current timestamp\n"
     "                      (\"-\" means STDIN)\n"
     "Options : -0,-3,-6,-9 Specify resolution unit of the time. For instance,\n"
@@ -145,8 +264,46 @@ void print_usage_and_exit(void) {
     "                      be attatched when using this option.\n"
     "          -u ........ Set the date in UTC when -c option is set\n"
     "                      (same as that of date command)\n"
+    "          -s ........ Statistics mode. Print only the summary of the\n"
+    "                      inter-arrival time of the lines to STDOUT instead\n"
+    "                      of the timestamped lines.\n"
+    "          -S ........ Same as -s, but pass the timestamped lines through\n"
+    "                      to STDOUT and print the summary to STDERR.\n"
+    "          -i interval Also print the summary of every \"interval\" seconds\n"
+    "                      in -s/-S mode. The summary is printed when the\n"
+    "                      first line after the interval comes. (default: 0,\n"
+    "                      which means printing only the total on exit)\n"
+    "                      The summary has the following 9 fields.\n"
+    "                        <\"interval\"|\"total\"> <period> <lines> <lines/s>\n"
+    "                        <maxgap> <p50gap> <p90gap> <p99gap> <p99.9gap>\n"
+    "                      All the times are in seconds with the resolution\n"
+    "                      of -0/-3/-6/-9. The percentiles are the upper\n"
+    "                      bounds of the histogram bins (error <= 12.5%%).\n"
+    "          -U sockpath Bind a Unix-domain datagram socket on \"sockpath\"\n"
+    "                      and read the datagrams from it instead of files.\n"
+    "                      Each line is stamped with the time the kernel\n"
+    "                      received the datagram (SO_TIMESTAMPNS). A line\n"
+    "                      feed is added to a datagram not ending with it.\n"
+    "                      The socket file is removed on SIGINT/SIGTERM.\n"
+    "                      (Linux only)\n"
+    "          [The following option is for professional]\n"
+    "          -k clksrc . Clock source to get the current time from\n"
+    "                        real ..... CLOCK_REALTIME (default)\n"
+    "                        coarse ... CLOCK_REALTIME_COARSE (Linux only).\n"
+    "                                   Cheaper, but only as precise as\n"
+    "                                   the kernel tick.\n"
+    "                        tsc ...... CPU time stamp counter calibrated\n"
+    "                                   against CLOCK_MONOTONIC and\n"
+    "                                   re-synced with CLOCK_REALTIME\n"
+    "                                   every second (x86 with invariant\n"
+    "                                   TSC only)\n"
+    "                        auto ..... \"coarse\" if its resolution is fine\n"
+    "                                   enough for -0/-3/-6/-9, otherwise\n"
+    "                                   \"real\"\n"
+    "                      The unavailable ones fall back to \"real\". The\n"
+    "                      chosen source is reported with -v option.\n"
     "Retuen  : Return 0 only when finished successfully\n"
-    "Version : 2020-05-06 22:42:19 JST\n"
+    "Version : 2026-10-19 16:20:51 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -154,7 +311,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/misc-tools\n"
-    ,gpszCmdname);
+    ,gpszCmdname,gpszCmdname);
   exit(1);
 }
 
@@ -194,7 +351,11 @@ char    *pszFilename;     /* filepath (for message)                */
 int      iFileno;         /* file# of filepath                     */
 int      iFd;             /* file descriptor                       */
 FILE    *fp;              /* file handle                           */
+tmsp     tsNow;           /* the time at exit (for stats)          */
 int      iFirstline='c';  /* >0 when x-opt and no line come yet    */
+double   dItvl;           /* -i option value                       */
+char    *pszSockpath=NULL;/* -U option value                       */
+struct sigaction saExit;  /* for printing the stats on SIGINT/TERM */
 int      i;               /* all-purpose int                       */
 
 /*--- Initialize ---------------------------------------------------*/
@@ -212,7 +373,7 @@ if (setenv("POSIXLY_CORRECT","1",1) < 0) {
 /*=== Parse arguments ==============================================*/
 
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "0369cezZduvh")) != -1) {
+while ((i=getopt(argc, argv, "0369cezZdusSi:k:U:vh")) != -1) {
   switch (i) {
     case '0': giTimeResol =  0 ;                 break;
     case '3': giTimeResol =  3 ;                 break;
@@ -224,6 +385,19 @@ while ((i=getopt(argc, argv, "0369cezZduvh")) != -1) {
     case 'z': giFmtType   = 'z'; iFirstline= 0 ; break;
     case 'd': giDeltaMode =  1 ;                 break;
     case 'u': (void)setenv("TZ", "UTC0", 1);     break;
+    case 's': giStatMode  =  1 ;                 break;
+    case 'S': giStatMode  =  2 ;                 break;
+    case 'i': if (sscanf(optarg,"%lf",&dItvl) != 1) {print_usage_and_exit();}
+              if (dItvl < 0 || dItvl > 86400*365  ) {print_usage_and_exit();}
+              gi8StatItvl = (int64_t)(dItvl*1000000000);
+              break;
+    case 'U': pszSockpath = optarg;              break;
+    case 'k': if      (strcmp(optarg,"auto"  )==0) {giClkSrc=CLKSRC_AUTO  ;}
+              else if (strcmp(optarg,"real"  )==0) {giClkSrc=CLKSRC_REAL  ;}
+              else if (strcmp(optarg,"coarse")==0) {giClkSrc=CLKSRC_COARSE;}
+              else if (strcmp(optarg,"tsc"   )==0) {giClkSrc=CLKSRC_TSC   ;}
+              else                                 {print_usage_and_exit();}
+              break;
     case 'v': giVerbose++      ;                 break;
     case 'h': print_usage_and_exit();
     default : print_usage_and_exit();
@@ -232,18 +406,56 @@ while ((i=getopt(argc, argv, "0369cezZduvh")) != -1) {
 argc -= optind-1;
 argv += optind  ;
 if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
+if (pszSockpath != NULL && argc > 1) {print_usage_and_exit();}
+
+/*=== Decide the clock source ======================================*/
+init_clock_source();
+
+/*=== Prepare the statistics mode ==================================*/
+if (giStatMode || pszSockpath != NULL) {
+  if (get_cur_time(&gstStTotal.tsStart) != 0) {
+    error_exit(errno,"clock_gettime() for stats: %s\n",strerror(errno));
+  }
+  gstStItvl.tsStart = gstStTotal.tsStart;
+  gtsStNext.tv_sec  = gstStTotal.tsStart.tv_sec
+                    + (time_t)(gi8StatItvl/1000000000);
+  gtsStNext.tv_nsec = gstStTotal.tsStart.tv_nsec
+                    + (long  )(gi8StatItvl%1000000000);
+  if (gtsStNext.tv_nsec >= 1000000000) {
+    gtsStNext.tv_sec++; gtsStNext.tv_nsec -= 1000000000;
+  }
+  /* Interrupt the reading to finish on SIGINT/SIGTERM */
+  memset(&saExit, 0, sizeof(saExit));
+  saExit.sa_handler = request_exit;
+  if (sigaction(SIGINT ,&saExit,NULL) != 0) {
+    error_exit(errno,"sigaction(SIGINT): %s\n" ,strerror(errno));
+  }
+  if (sigaction(SIGTERM,&saExit,NULL) != 0) {
+    error_exit(errno,"sigaction(SIGTERM): %s\n",strerror(errno));
+  }
+}
 
 /*=== Switch buffer mode ===========================================*/
 if (setvbuf(stdout,NULL,_IOLBF,0)!=0) {
   error_exit(255,"Failed to switch to line-buffered mode\n");
 }
 
-/*=== Each file loop ===============================================*/
+/*=== Receive datagrams instead of reading files if -U is given ====*/
 iRet     =  0;
+if (pszSockpath != NULL) {
+  #ifdef HAVE_DGRAM_TS
+    iRet = receive_dgrams(pszSockpath, iFirstline);
+  #else
+    error_exit(1,"-U option is not supported on this host\n");
+  #endif
+}
+
+/*=== Each file loop ===============================================*/
 iFileno  =  0;
 iFd      = -1;
 iRet_r1l =  0;
-while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
+while ((pszPath = argv[iFileno]) != NULL ||
+       (iFileno == 0 && pszSockpath == NULL)   ) {
 
   /*--- Open one of the input files --------------------------------*/
   if (pszPath == NULL || strcmp(pszPath, "-") == 0) {
@@ -268,7 +480,9 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
   }
 
   /*--- Reading and writing loop -----------------------------------*/
-  if (! feof(fp)) {
+  if (giStatMode == 1) {
+    while (read_stats_1line(fp)==0) {;}
+  } else if (! feof(fp)) {
     switch(iFirstline) {
       case 'c': iRet_r1l=read_c1st_1line(fp); iFirstline=0;               break;
       case 'e': iRet_r1l=read_e1st_1line(fp); iFirstline=0;               break;
@@ -282,10 +496,21 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
   if (fp != stdin) {fclose(fp);}
 
   /*--- End loop ---------------------------------------------------*/
-  if (pszPath == NULL) {break;}
+  if (pszPath == NULL || giExitReq) {break;}
   iFileno++;
 }
 
+/*=== Print the summary for the statistics mode ====================*/
+if (giStatMode) {
+  if (get_cur_time(&tsNow) != 0) {
+    error_exit(errno,"clock_gettime() for stats: %s\n",strerror(errno));
+  }
+  fp = (giStatMode==1) ? stdout : stderr;
+  if (gi8StatItvl > 0) {print_stats(fp,"interval",&gstStItvl,&tsNow);}
+  print_stats(fp,"total",&gstStTotal,&tsNow);
+  if (giExitReq && pszSockpath == NULL) {iRet = 130;}
+}
+
 /*=== Finish normally ==============================================*/
 return(iRet);}
 
@@ -355,10 +580,11 @@ int read_c1st_1line(FILE *fp) {
   /*--- Reading and writing a line (1st letter of the line) --------*/
   if (giHold) {iChar=giNextchar; giHold=0;} else {iChar=getc(fp);}
   if (iChar == EOF) {return(EOF);}
-  if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
+  if (get_cur_time(&tsNow) != 0) {
     error_exit(errno,"read_c1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giStatMode) {record_stats(&tsNow);}
   if ((ptm=localtime(&tsNow.tv_sec)) == NULL) {
     error_exit(255,"read_c1st_1line(): localtime(): returned NULL\n");
   }
@@ -421,10 +647,11 @@ int read_e1st_1line(FILE *fp) {
   /*--- Reading and writing a line (1st letter of the line) --------*/
   if (giHold) {iChar=giNextchar; giHold=0;} else {iChar=getc(fp);}
   if (iChar == EOF) {return(EOF);}
-  if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
+  if (get_cur_time(&tsNow) != 0) {
     error_exit(errno,"read_e1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giStatMode) {record_stats(&tsNow);}
   if ((ptm=localtime(&tsNow.tv_sec)) == NULL) {
     error_exit(255,"read_e1st_1line(): localtime(): returned NULL\n");
   }
@@ -483,10 +710,11 @@ int read_Z1st_1line(FILE *fp) {
   /*--- Reading and writing a line (1st letter of the line) --------*/
   if (giHold) {iChar=giNextchar; giHold=0;} else {iChar=getc(fp);}
   if (iChar == EOF) {return(EOF);}
-  if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+  if (get_cur_time(&gtsZero) != 0) {
     error_exit(errno,"read_Z1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giStatMode) {record_stats(&gtsZero);}
   if (giDeltaMode) {printf("0 0 ");} else {printf("0 ");}
   while (putchar(iChar)==EOF) {
     if (errno == EINTR) {continue;}
@@ -523,16 +751,37 @@ int read_Z1st_1line(FILE *fp) {
  *      gtsPrev     : (must be defined as a global variable) */
 void print_cur_timestamp(void) {
 
+  /*--- Variables --------------------------------------------------*/
+  tmsp        tsNow          ;
+
+  /*--- Get the current time ---------------------------------------*/
+  if (get_cur_time(&tsNow) != 0) {
+    error_exit(errno,"clock_gettime()#1: %s\n",strerror(errno));
+  }
+  if (giStatMode) {record_stats(&tsNow);}
+
+  /*--- Print it ---------------------------------------------------*/
+  print_timestamp(&tsNow);
+}
+
+
+/*=== Write the given timestamp to stdout ============================
+ * [in] ptsTime     : The time to print (the same epoch as
+ *                    CLOCK_REALTIME)
+ *      giFmtType   : (must be defined as a global variable)
+ *      giTimeResol : (must be defined as a global variable)
+ *      giDeltaMode : (must be defined as a global variable)
+ *      gtsZero     : (must be defined as a global variable)
+ *      gtsPrev     : (must be defined as a global variable) */
+void print_timestamp(tmsp *ptsTime) {
+
   /*--- Variables --------------------------------------------------*/
   tmsp        tsNow          ; /* Current time but substructed by gtsZero */
   tmsp        tsDiff         ;
   struct tm  *ptm            ;
   char        szBuf[LINE_BUF];
 
-  /*--- Get the current time ---------------------------------------*/
-  if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
-    error_exit(errno,"clock_gettime()#1: %s\n",strerror(errno));
-  }
+  tsNow = *ptsTime;
 
   /*--- Print the current timestamp ("YYYYMMDDhhmmss" part) --------*/
   switch (giFmtType) {
@@ -560,7 +809,7 @@ void print_cur_timestamp(void) {
               strftime(szBuf, LINE_BUF, "%s", ptm);
               printf("%s", szBuf);
               break;
-    default : error_exit(255,"print_cur_timestamp(): Unknown format\n");
+    default : error_exit(255,"print_timestamp(): Unknown format\n");
   }
 
   /*--- Print the current timestamp (".n" part) --------------------*/
@@ -569,7 +818,7 @@ void print_cur_timestamp(void) {
     case 3 : printf(".%03d " , (int)(tsNow.tv_nsec+500000)/1000000); break;
     case 6 : printf(".%06d " , (int)(tsNow.tv_nsec+   500)/   1000); break;
     case 9 : printf(".%09ld ",       tsNow.tv_nsec                ); break;
-    default: error_exit(255,"print_cur_timestamp(): Unknown resolution\n");
+    default: error_exit(255,"print_timestamp(): Unknown resolution\n");
   }
 
   /*--- Print the delta-t if required ------------------------------*/
@@ -600,3 +849,470 @@ void print_cur_timestamp(void) {
   /*--- Finish -----------------------------------------------------*/
   return;
 }
+
+
+/*=== Read only one line and record its arrival time (-s mode) =======
+ * [ret] 0   : Finished reading due to '\n'
+ *       EOF : Finished reading due to EOF (or an interrupting signal) */
+int read_stats_1line(FILE *fp) {
+
+  /*--- Variables --------------------------------------------------*/
+  tmsp       tsNow;
+  int        iChar;
+
+  /*--- Record the time when the 1st letter of the line comes ------*/
+  if ((iChar=getc(fp)) == EOF) {return(EOF);}
+  if (get_cur_time(&tsNow) != 0) {
+    error_exit(errno,"read_stats_1line(): clock_gettime(): %s\n",
+                     strerror(errno)                             );
+  }
+  record_stats(&tsNow);
+
+  /*--- Read away the rest of the line -----------------------------*/
+  while (iChar != '\n') {
+    if ((iChar=getc(fp)) == EOF) {return(EOF);}
+  }
+  return 0;
+}
+
+
+/*=== Record the arrival time of a line into the statistics ==========
+ * [in] ptsNow      : The time the line came
+ *      gstStTotal, gstStItvl, gtsStPrev, gtsStNext, gi8StatItvl
+ *                  : (must be defined as global variables)     */
+void record_stats(tmsp *ptsNow) {
+
+  /*--- Variables --------------------------------------------------*/
+  int64_t  i8Gap;
+  uint64_t u8Gap;
+  int      iBin ;
+
+  /*--- Print the summary of the last interval if it has passed ----*/
+  if (gi8StatItvl > 0) {
+    if ( ptsNow->tv_sec >  gtsStNext.tv_sec                      ||
+        (ptsNow->tv_sec == gtsStNext.tv_sec  &&
+         ptsNow->tv_nsec>= gtsStNext.tv_nsec)                     ) {
+      print_stats((giStatMode==1)?stdout:stderr,"interval",&gstStItvl,ptsNow);
+      memset(&gstStItvl, 0, sizeof(gstStItvl));
+      gstStItvl.tsStart = *ptsNow;
+      gtsStNext.tv_sec  = ptsNow->tv_sec  + (time_t)(gi8StatItvl/1000000000);
+      gtsStNext.tv_nsec = ptsNow->tv_nsec + (long  )(gi8StatItvl%1000000000);
+      if (gtsStNext.tv_nsec >= 1000000000) {
+        gtsStNext.tv_sec++; gtsStNext.tv_nsec -= 1000000000;
+      }
+    }
+  }
+
+  /*--- Count the line and its gap since the previous line ---------*/
+  /* (The gap is negative when the clock has been stepped back, e.g.
+   *  by NTP on the "real" clock, so it is regarded as 0.)          */
+  if (gstStTotal.u8Lines > 0) {
+    i8Gap = (int64_t)(ptsNow->tv_sec -gtsStPrev.tv_sec )*1000000000
+          +          (ptsNow->tv_nsec-gtsStPrev.tv_nsec)           ;
+    u8Gap = (i8Gap > 0) ? (uint64_t)i8Gap : 0;
+    iBin  = hist_bin(u8Gap);
+    gstStTotal.au8Hist[iBin]++;
+    gstStItvl.au8Hist[iBin]++;
+    if (u8Gap > gstStTotal.u8MaxGap) {gstStTotal.u8MaxGap = u8Gap;}
+    if (u8Gap > gstStItvl.u8MaxGap ) {gstStItvl.u8MaxGap  = u8Gap;}
+  }
+  gstStTotal.u8Lines++;
+  gstStItvl.u8Lines++;
+  gtsStPrev = *ptsNow;
+}
+
+
+/*=== Print a summary of the statistics ==============================
+ * [in] fpOut    : Stream to print to
+ *      pszLabel : The 1st field ("interval" or "total")
+ *      pst      : The statistics
+ *      ptsEnd   : The time the period ends                         */
+void print_stats(FILE *fpOut, const char *pszLabel, lnstat *pst, tmsp *ptsEnd){
+
+  /*--- Variables --------------------------------------------------*/
+  static const int aiPermil[4] = {500, 900, 990, 999};
+  int64_t  i8Period;
+  uint64_t u8Period, u8Gaps, u8Want, u8Sum, u8Ns;
+  int      i, iBin;
+
+  /*--- Print the period, the number of lines and the rate ---------*/
+  /* (It is 0 when the clock has been stepped back before the start) */
+  i8Period = (int64_t)(ptsEnd->tv_sec -pst->tsStart.tv_sec )*1000000000
+           +          (ptsEnd->tv_nsec-pst->tsStart.tv_nsec)           ;
+  u8Period = (i8Period > 0) ? (uint64_t)i8Period : 0;
+  fprintf(fpOut, "%s ", pszLabel);
+  print_secs(fpOut, u8Period);
+  fprintf(fpOut, " %llu %.3f ", (unsigned long long)pst->u8Lines,
+          (u8Period>0) ? (double)pst->u8Lines*1e9/(double)u8Period : 0.0);
+
+  /*--- Print the maximum gap and the percentiles ------------------*/
+  print_secs(fpOut, pst->u8MaxGap);
+  for (u8Gaps=0, iBin=0; iBin<HIST_BINS; iBin++) {u8Gaps+=pst->au8Hist[iBin];}
+  for (i=0; i<4; i++) {
+    if (u8Gaps == 0) {fputs(" -",fpOut); continue;}
+    u8Want = (u8Gaps*aiPermil[i]+999)/1000;
+    for (u8Sum=0, iBin=0; iBin<HIST_BINS-1; iBin++) {
+      u8Sum += pst->au8Hist[iBin];
+      if (u8Sum >= u8Want) {break;}
+    }
+    u8Ns = hist_bin_upper(iBin);
+    if (u8Ns > pst->u8MaxGap) {u8Ns = pst->u8MaxGap;}
+    fputc(' ', fpOut);
+    print_secs(fpOut, u8Ns);
+  }
+  fputc('\n', fpOut);
+  fflush(fpOut);
+}
+
+
+/*=== Print nanoseconds as seconds in the resolution of -0/-3/-6/-9 =*/
+void print_secs(FILE *fpOut, uint64_t u8Ns) {
+  unsigned long long ullSec = (unsigned long long)(u8Ns/1000000000);
+  long               lNsec  = (long)(u8Ns%1000000000);
+  switch (giTimeResol) {
+    case 0 : fprintf(fpOut,"%llu"      , ullSec+(lNsec>=500000000)); break;
+    case 3 : lNsec = (lNsec+500000)/1000000;
+             if (lNsec>=1000   ) {ullSec++; lNsec-=1000   ;}
+             fprintf(fpOut,"%llu.%03ld", ullSec, lNsec);            break;
+    case 6 : lNsec = (lNsec+   500)/   1000;
+             if (lNsec>=1000000) {ullSec++; lNsec-=1000000;}
+             fprintf(fpOut,"%llu.%06ld", ullSec, lNsec);            break;
+    default: fprintf(fpOut,"%llu.%09ld", ullSec, lNsec);            break;
+  }
+}
+
+
+/*=== Get the histogram bin number for a gap =========================
+ * (Bins 0-7 are for 0-7 nsec, and the others divide each power of 2
+ *  into 8 bins)                                                    */
+int hist_bin(uint64_t u8Ns) {
+  int iExp;
+  if (u8Ns < 8) {return (int)u8Ns;}
+  #if defined(__GNUC__)
+    iExp = 63 - __builtin_clzll((unsigned long long)u8Ns);
+  #else
+    for (iExp=3; (u8Ns>>(iExp+1)) != 0; iExp++) {;}
+  #endif
+  return (iExp-2)*8 + (int)((u8Ns >> (iExp-3)) & 7);
+}
+
+
+/*=== Get the upper bound (nsec) of a histogram bin ==================*/
+uint64_t hist_bin_upper(int iBin) {
+  int iExp;
+  if (iBin < 8) {return (uint64_t)iBin;}
+  iExp = iBin/8 + 2;
+  return ((uint64_t)(8 + iBin%8 + 1) << (iExp-3)) - 1;
+}
+
+
+/*=== SIGNALTRAP : Stop reading to finish (print the summary) =======*/
+void request_exit(int iSig) {
+  giExitReq = 1;
+}
+
+
+/*=== Decide the clock source and prepare it =========================
+ * [in]  giClkSrc    : (must be defined as a global variable)
+ *       giTimeResol : (must be defined as a global variable)
+ * [out] giClkSrc    : The clock source which has been chosen actually
+ *       gtsZero     : Retaken by the chosen source if it is "coarse"
+ *                     not to make the first "-z" time negative     */
+void init_clock_source(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  tmsp       tsRes ;
+  long       lUnit ; /* nanoseconds of the resolution unit (-0,-3,...) */
+  const char *psz  ;
+
+  /*--- Choose "coarse" or "real" automatically --------------------*/
+  if (giClkSrc == CLKSRC_AUTO) {
+    giClkSrc = CLKSRC_REAL;
+    #ifdef CLOCK_REALTIME_COARSE
+      switch (giTimeResol) {
+        case 0 : lUnit = 1000000000; break;
+        case 3 : lUnit =    1000000; break;
+        case 6 : lUnit =       1000; break;
+        default: lUnit =          1; break;
+      }
+      if (clock_getres(CLOCK_REALTIME_COARSE,&tsRes) == 0 &&
+          tsRes.tv_sec == 0 && tsRes.tv_nsec <= lUnit       ) {
+        giClkSrc = CLKSRC_COARSE;
+      }
+    #endif
+  }
+
+  /*--- Make sure that the chosen source is available --------------*/
+  switch (giClkSrc) {
+    case CLKSRC_COARSE:
+      #ifdef CLOCK_REALTIME_COARSE
+        if (clock_gettime(CLOCK_REALTIME_COARSE,&gtsZero) != 0) {
+          warning("CLOCK_REALTIME_COARSE: %s\n",strerror(errno));
+          giClkSrc = CLKSRC_REAL;
+        }
+      #else
+        warning("CLOCK_REALTIME_COARSE is not supported on this host\n");
+        giClkSrc = CLKSRC_REAL;
+      #endif
+      break;
+    case CLKSRC_TSC:
+      #ifdef HAVE_TSC
+        if (calibrate_tsc() != 0) {
+          warning("TSC is not usable as a clock on this host\n");
+          giClkSrc = CLKSRC_REAL;
+        }
+      #else
+        warning("TSC is not supported on this host\n");
+        giClkSrc = CLKSRC_REAL;
+      #endif
+      break;
+  }
+
+  /*--- Report the chosen source -----------------------------------*/
+  if (giVerbose > 0) {
+    switch (giClkSrc) {
+      case CLKSRC_COARSE: psz = "coarse (CLOCK_REALTIME_COARSE)"; break;
+      case CLKSRC_TSC   : psz = "tsc (calibrated TSC)"          ; break;
+      default           : psz = "real (CLOCK_REALTIME)"         ; break;
+    }
+    warning("clock source: %s\n", psz);
+  }
+}
+
+
+/*=== Get the current time from the chosen clock source ==============
+ * [in]  giClkSrc : (must be defined as a global variable)
+ * [out] ptsNow   : The current time (the same epoch as CLOCK_REALTIME)
+ * [ret] 0        : Success
+ *       -1       : Error (errno is set)                            */
+int get_cur_time(tmsp *ptsNow) {
+
+  #ifdef HAVE_TSC
+    /*--- Variables ------------------------------------------------*/
+    uint64_t u8Tick, u8Diff, u8Ns;
+    int64_t  i8Ns;
+    double   dRate;
+    tmsp     tsSync, tsMono;
+  #endif
+
+  switch (giClkSrc) {
+    #ifdef CLOCK_REALTIME_COARSE
+      case CLKSRC_COARSE: return clock_gettime(CLOCK_REALTIME_COARSE,ptsNow);
+    #endif
+    #ifdef HAVE_TSC
+      case CLKSRC_TSC:
+        u8Tick = read_tsc();
+        u8Diff = u8Tick - gu8TscBase;
+        if (u8Diff >= gu8TscResync) {
+          /* Re-sync the offset with CLOCK_REALTIME, and re-estimate the
+           * tick rate against CLOCK_MONOTONIC, which never steps even
+           * when the wall clock is set. A rate too far from the current
+           * one is ignored as an outlier.                              */
+          if (clock_gettime(CLOCK_MONOTONIC,&tsMono) != 0) {return -1;}
+          if (clock_gettime(CLOCK_REALTIME ,&tsSync) != 0) {return -1;}
+          i8Ns = (int64_t)(tsMono.tv_sec -gtsTscMono.tv_sec )*1000000000
+               +          (tsMono.tv_nsec-gtsTscMono.tv_nsec)           ;
+          if (u8Diff > 0 && i8Ns > 0) {
+            dRate = (double)i8Ns / (double)u8Diff;
+            if (dRate > gdNsPerTick*(1.0-TSC_RATE_TOL) &&
+                dRate < gdNsPerTick*(1.0+TSC_RATE_TOL)   ) {
+              gdNsPerTick = dRate;
+            }
+          }
+          gu8TscBase = u8Tick;
+          gtsTscBase = tsSync;
+          gtsTscMono = tsMono;
+          *ptsNow    = tsSync;
+        } else {
+          u8Ns = (uint64_t)((double)u8Diff * gdNsPerTick) + gtsTscBase.tv_nsec;
+          ptsNow->tv_sec  = gtsTscBase.tv_sec + (time_t)(u8Ns/1000000000);
+          ptsNow->tv_nsec = (long)(u8Ns%1000000000);
+        }
+        /* Never go back by a small correction of the re-sync, but
+         * follow a step of the wall clock as the "real" source does */
+        i8Ns = (int64_t)(gtsTscLast.tv_sec -ptsNow->tv_sec )*1000000000
+             +          (gtsTscLast.tv_nsec-ptsNow->tv_nsec)           ;
+        if (i8Ns > 0 && i8Ns < TSC_BACK_NSEC) {*ptsNow = gtsTscLast;}
+        gtsTscLast = *ptsNow;
+        return 0;
+    #endif
+    default: return clock_gettime(CLOCK_REALTIME,ptsNow);
+  }
+}
+
+
+#ifdef HAVE_TSC
+/*=== Read the CPU time stamp counter ================================
+ * [ret] The current TSC value                                      */
+uint64_t read_tsc(void) {
+  uint32_t u4Lo, u4Hi;
+  __asm__ __volatile__ ("rdtsc" : "=a"(u4Lo), "=d"(u4Hi));
+  return ((uint64_t)u4Hi << 32) | u4Lo;
+}
+
+/*=== Calibrate the TSC against CLOCK_MONOTONIC ======================
+ * [out] gu8TscBase, gtsTscBase, gtsTscMono, gdNsPerTick, gu8TscResync
+ * [ret] 0  : Success
+ *       -1 : The TSC is not invariant, or failed to calibrate      */
+int calibrate_tsc(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  unsigned int ui4a, ui4b, ui4c, ui4d;
+  tmsp         ts0, ts1, tsSleep, tsReal;
+  uint64_t     u8T0, u8T1, u8Ns;
+
+  /*--- Require the invariant TSC (CPUID.80000007H:EDX[8]) ---------*/
+  if (! __get_cpuid(0x80000007, &ui4a, &ui4b, &ui4c, &ui4d)) {return -1;}
+  if (! (ui4d & (1 << 8))                                   ) {return -1;}
+
+  /*--- Measure the tick rate --------------------------------------*/
+  if (clock_gettime(CLOCK_MONOTONIC,&ts0) != 0) {return -1;}
+  u8T0 = read_tsc();
+  tsSleep.tv_sec  = 0;
+  tsSleep.tv_nsec = TSC_CALIB_NSEC;
+  while (nanosleep(&tsSleep,&tsSleep) != 0) {
+    if (errno != EINTR) {return -1;}
+  }
+  if (clock_gettime(CLOCK_MONOTONIC,&ts1   ) != 0) {return -1;}
+  if (clock_gettime(CLOCK_REALTIME ,&tsReal) != 0) {return -1;}
+  u8T1 = read_tsc();
+  if (u8T1 <= u8T0) {return -1;}
+  u8Ns = (uint64_t)(ts1.tv_sec -ts0.tv_sec )*1000000000
+       +           (ts1.tv_nsec-ts0.tv_nsec)           ;
+  gdNsPerTick  = (double)u8Ns / (double)(u8T1-u8T0);
+  if (gdNsPerTick <= 0) {return -1;}
+
+  /*--- Set the base point -----------------------------------------*/
+  gu8TscBase   = u8T1;
+  gtsTscBase   = tsReal;
+  gtsTscMono   = ts1;
+  gu8TscResync = (uint64_t)((double)TSC_RESYNC_SEC*1000000000/gdNsPerTick);
+  if (giVerbose > 1) {warning("TSC: %.6f ns/tick\n",gdNsPerTick);}
+
+  return 0;
+}
+#endif
+
+
+#ifdef HAVE_DGRAM_TS
+/*=== Receive datagrams and write them with the kernel timestamps ====
+ * [in]  pszSockpath : Path to bind the Unix-domain datagram socket on
+ *       iFirstline  : The same as that in main()
+ *       giExitReq   : (must be defined as a global variable)
+ * [ret] 0           : Finished by SIGINT/SIGTERM
+ *       (otherwise, it exits with an error message)                */
+int receive_dgrams(char *pszSockpath, int iFirstline) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char        acBuf[DGRAM_BATCH][DGRAM_BUF];
+  static char        acCtl[DGRAM_BATCH][CMSG_SPACE(sizeof(tmsp))];
+  struct mmsghdr     amh[DGRAM_BATCH];
+  struct iovec       aiov[DGRAM_BATCH];
+  struct sockaddr_un saUn;
+  struct cmsghdr    *pcm;
+  tmsp               tsRecv;
+  int                iSock, iNmsg, iOn, i;
+
+  /*--- Make the socket --------------------------------------------*/
+  if (strlen(pszSockpath) >= sizeof(saUn.sun_path)) {
+    error_exit(1,"%s: Too long socket path\n",pszSockpath);
+  }
+  if ((iSock=socket(AF_UNIX,SOCK_DGRAM,0)) < 0) {
+    error_exit(errno,"socket(): %s\n",strerror(errno));
+  }
+  iOn = 1;
+  if (setsockopt(iSock,SOL_SOCKET,SO_TIMESTAMPNS,&iOn,sizeof(iOn)) < 0) {
+    error_exit(errno,"setsockopt(SO_TIMESTAMPNS): %s\n",strerror(errno));
+  }
+  memset(&saUn, 0, sizeof(saUn));
+  saUn.sun_family = AF_UNIX;
+  strcpy(saUn.sun_path, pszSockpath);
+  if (bind(iSock,(struct sockaddr *)&saUn,sizeof(saUn)) < 0) {
+    error_exit(errno,"bind(%s): %s\n",pszSockpath,strerror(errno));
+  }
+
+  /*--- Use full buffering and flush once a batch ------------------*/
+  if (setvbuf(stdout,NULL,_IOFBF,DGRAM_BUF)!=0) {
+    error_exit(255,"Failed to switch to full-buffered mode\n");
+  }
+
+  /*--- Receiving loop ---------------------------------------------*/
+  while (! giExitReq) {
+    for (i=0; i<DGRAM_BATCH; i++) {
+      aiov[i].iov_base                = acBuf[i];
+      aiov[i].iov_len                 = DGRAM_BUF;
+      memset(&amh[i], 0, sizeof(amh[i]));
+      amh[i].msg_hdr.msg_iov          = &aiov[i];
+      amh[i].msg_hdr.msg_iovlen       = 1;
+      amh[i].msg_hdr.msg_control      = acCtl[i];
+      amh[i].msg_hdr.msg_controllen   = sizeof(acCtl[i]);
+    }
+    if ((iNmsg=recvmmsg(iSock,amh,DGRAM_BATCH,MSG_WAITFORONE,NULL)) < 0) {
+      if (errno == EINTR) {continue;}
+      unlink(pszSockpath);
+      error_exit(errno,"recvmmsg(): %s\n",strerror(errno));
+    }
+    for (i=0; i<iNmsg; i++) {
+      /* Get the kernel timestamp (or the current time if missing) */
+      tsRecv.tv_sec = -1;
+      for (pcm=CMSG_FIRSTHDR(&amh[i].msg_hdr); pcm!=NULL;
+           pcm=CMSG_NXTHDR(&amh[i].msg_hdr,pcm)                 ) {
+        if (pcm->cmsg_level==SOL_SOCKET && pcm->cmsg_type==SCM_TIMESTAMPNS) {
+          memcpy(&tsRecv, CMSG_DATA(pcm), sizeof(tsRecv));
+        }
+      }
+      if (tsRecv.tv_sec < 0 && clock_gettime(CLOCK_REALTIME,&tsRecv) != 0) {
+        error_exit(errno,"clock_gettime() for -U: %s\n",strerror(errno));
+      }
+      if (amh[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        warning("A datagram was truncated to %d bytes\n",DGRAM_BUF);
+      }
+      write_dgram_lines(acBuf[i], (int)amh[i].msg_len, &tsRecv, &iFirstline);
+    }
+    if (fflush(stdout) == EOF) {
+      unlink(pszSockpath);
+      error_exit(errno,"fflush(): %s\n",strerror(errno));
+    }
+  }
+
+  /*--- Finish -----------------------------------------------------*/
+  close(iSock);
+  unlink(pszSockpath);
+  return 0;
+}
+
+
+/*=== Write lines in a datagram with the given timestamp =============
+ * [in]     pszBuf  : The datagram
+ *          iLen    : The length of the datagram
+ *          ptsRecv : The time the datagram was received
+ * [in/out] piFirst : The same as iFirstline in main(). It will be
+ *                    set to 0 after the first line has written.    */
+void write_dgram_lines(char *pszBuf, int iLen, tmsp *ptsRecv, int *piFirst) {
+
+  /*--- Variables --------------------------------------------------*/
+  char *pszEnd = pszBuf + iLen;
+  char *psz;
+
+  /*--- Write each line --------------------------------------------*/
+  while (pszBuf < pszEnd) {
+    if ((psz=memchr(pszBuf,'\n',pszEnd-pszBuf)) == NULL) {psz=pszEnd;}
+    if (giStatMode) {record_stats(ptsRecv);}
+    if (giStatMode != 1) {
+      switch (*piFirst) {
+        case 'Z': gtsZero = *ptsRecv; giFmtType = 'z';
+                  fputs((giDeltaMode) ? "0 0 " : "0 ", stdout);
+                  break;
+        case 'c':
+        case 'e': gtsPrev = *ptsRecv; /* to make the first delta-t "0" */
+        default : print_timestamp(ptsRecv);
+                  break;
+      }
+      fwrite(pszBuf, 1, psz-pszBuf, stdout);
+      putchar('\n');
+    }
+    *piFirst = 0;
+    pszBuf = psz + 1;
+  }
+}
+#endif
@@ -2,12 +2,51 @@
 #
 # PTW - Pseudo Terminal Wrapper
 #
-# USAGE   : ptw [-f] command [argument ...]
+# USAGE   : ptw [-f] [-c] [-t usec] [-b bytes] command [argument ...]
+#           ptw -m [-j n] [-T] [cmdlistfile]
+#           ptw -S sockpath [-P n] [-c] [-t usec] [-b bytes]
+#           ptw -C sockpath [-f] command [argument ...]
 # Options : -f ... Forcibly wrap the command in a PTY even though the
 #                  command is placed at the end of the pipeline.
 #                  Originally, it isn't necessary to use a PTY because
 #                  the command placed at the end has a TTY-connected
 #                  STDOUT.
+#           -c ... Coalesce the output of the command instead of
+#                  writing every piece immediately. Complete lines are
+#                  written when the command pauses, and an incomplete
+#                  line is held until a newline comes, the buffer is
+#                  full, or the timeout by -t passes.
+#           -t usec  Timeout for an incomplete line in -c mode in
+#                  microseconds (default: 50000, rounded up to
+#                  milliseconds). This implies -c.
+#           -b bytes Buffer size for -c mode (default: 65536). The
+#                  buffer is written when it becomes full. This
+#                  implies -c.
+#           -m ... Multiplex mode. Run each line of "cmdlistfile" ("-"
+#                  or none means STDIN) as a command by "sh -c", each on
+#                  its own PTY, under this one process. Empty lines and
+#                  lines starting with '#' are ignored. Every output line
+#                  is tagged with the line number of its command as the
+#                  first field (lines longer than 8191 bytes are split).
+#                  STDIN of the commands is /dev/null. The return value
+#                  is the largest one of the commands.
+#           -j n   The maximum number of commands running at a time in
+#                  -m mode (default: the number of online processors)
+#           -T ... Don't tag the output lines in -m mode
+#           -S sockpath  Server mode. Keep a pool of PTY pairs ready and
+#                  serve the requests from "ptw -C" through the Unix-
+#                  domain socket "sockpath". The socket file is made
+#                  with mode 0600, and only the clients of the same user
+#                  are served. The socket file is removed on SIGINT/
+#                  SIGTERM. (*BSD, macOS and Linux only)
+#           -P n   The number of PTY pairs to keep ready in -S mode
+#                  (default: 8)
+#           -C sockpath  Client mode. Hand STDIN/STDOUT/STDERR and the
+#                  current directory over to the server on "sockpath",
+#                  and let it run the command on one of the ready PTYs.
+#                  The output comes to STDOUT directly from the server,
+#                  and the return value is the command's one. Note that
+#                  the environment variables of the server are used.
 # Retuen  : The return value will be decided by the wrapped command
 #           when PTY wrapping has succeed. However, return a non-zero
 #           number by this wrapper when failed.
@@ -34,11 +73,25 @@
 
 /*=== Initial Setting ==============================================*/
 /*--- macro constants ----------------------------------------------*/
-#define BUFSIZE 8192
+#define BUFSIZE 65536
+/* Default timeout (usec) and buffer size for the coalescing mode */
+#define COAL_USEC_DEF 50000
+#define COAL_BUF_DEF  65536
+/* Buffer sizes for a line of a command and for a command line in -m mode */
+#define MUX_LINE_BUF  8192
+#define MUX_CMD_BUF   8192
+/* The maximum number of events to get at once in -m mode */
+#define MUX_EVENTS    64
+/* Default pool size and the maximum request size for -S/-C mode */
+#define POOL_NUM_DEF  8
+#define POOL_REQ_BUF  65536
+/* Time limit (sec) for a client to send its request in -S mode */
+#define POOL_REQ_SEC  5
 /*#define RAWMODE_FOR_MASTER*//*set raw mode for master (probably unnecessary)*/
 /*--- headers ------------------------------------------------------*/
 #ifdef __linux__
   #define _XOPEN_SOURCE 600
+  #define _GNU_SOURCE /* for struct ucred (SO_PEERCRED) */
 #endif
 #include <errno.h>
 #include <stdio.h>
@@ -51,6 +104,14 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <stdint.h>
+#include <limits.h>
+#include <poll.h>
+#include <time.h>
+#ifdef __linux__
+  #include <sys/epoll.h>
+  #define USE_EPOLL
+#endif
 #if (defined(__unix__) || defined(unix)) && !defined(USG)
   #include <sys/param.h> /* get OS identification macro */
 #endif
@@ -62,31 +123,115 @@
 #if !defined(TABDLY) && defined(OXTABS)
   #define TABDLY OXTABS /* for classiic BSD */
 #endif
+#if defined(BSD) || defined(__APPLE__) || defined(__linux__)
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <sys/stat.h>
+  #include <sys/time.h>
+  #if defined(TIOCSCTTY) && defined(SCM_RIGHTS)
+    #define HAVE_PTY_POOL
+  #endif
+#endif
+/*--- data type definitions ----------------------------------------*/
+typedef struct {
+  pid_t  pid;                 /* PID of the command (0: the slot is free) */
+  int    iFd;                 /* PTY master for the command               */
+  long   lNum;                /* line number of the command in the list   */
+  int    iLen;                /* the number of bytes held in acBuf        */
+  char   acBuf[MUX_LINE_BUF]; /* incomplete line of the command           */
+} muxjob;
 /*--- prototype functions ------------------------------------------*/
 #ifdef RAWMODE_FOR_MASTER
   void restore_master_termios(void);
 #endif
+int  open_pty_master(void);
+void exec_on_pty_slave(char *argv[], int iStdinIsATTY, struct winsize *pstWsizem);
+void transceive_coalesced(void);
+int  run_multiplexed(FILE *fpCmds, int iStdinIsATTY, struct winsize *pstWsizem);
+int  mux_read(muxjob *pjob);
+void mux_emit(long lNum, char *pszLine, int iLen);
+void mux_flush(void);
+#ifdef HAVE_PTY_POOL
+  int  run_pool_server(char *pszSock);
+  void open_pooled_pty(int *piFdm, int *piFds);
+  int  check_pool_peer(int iConn);
+  int  recv_pool_request(int iConn, char *pszReq, int *piFds);
+  void run_pool_session(int iConn, int iFdm, int iFds, int *piFds,
+                        char *pszReq, int iLen                     );
+  int  run_pool_client(char *pszSock, char *argv[]);
+  void remove_pool_sock(int iSig);
+#endif
+void write_out(char *pszBuf, int iLen);
 /*--- global variables ---------------------------------------------*/
 char*    gpszCmdname;     /* The name of this command                        */
 int      giVerbose;       /* speaks more verbosely by the greater number     */
 int      giForciblepty;   /* set 1 or more to use PTY forcibly               */
 int      giFd1m, giFd1s;  /* PTY file descriptors                            */
+int      giCoalesce;      /* set 1 or more to coalesce the output (-c)       */
+long     glCoalUsec = COAL_USEC_DEF; /* timeout for an incomplete line (-t)  */
+int      giCoalBytes= COAL_BUF_DEF;  /* buffer size for -c mode (-b)         */
+int      giMultiplex;     /* set 1 or more to run commands in a list (-m)    */
+int      giMuxJobs;       /* maximum number of running commands (-j)         */
+int      giMuxNotag;      /* set 1 or more not to tag the output lines (-T)  */
+char     gacMuxOut[BUFSIZE]; /* output buffer for -m mode                    */
+int      giMuxOutLen;     /* the number of bytes in gacMuxOut                */
+char*    gpszPoolSock;    /* socket path of the server (-S) to remove        */
+int      giPoolNum = POOL_NUM_DEF; /* the number of pooled PTY pairs (-P)    */
 struct termios gstTermm;  /* stdin terimios for master                       */
 
 /*=== Define the functions for printing usage and error ============*/
 /*--- exit with usage ----------------------------------------------*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    "USAGE   : %s [-f] command [argument ...]\n"
+    "USAGE   : %s [-f] [-c] [-t usec] [-b bytes] command [argument ...]\n"
+    "          %s -m [-j n] [-T] [cmdlistfile]\n"
+    "          %s -S sockpath [-P n] [-c] [-t usec] [-b bytes]\n"
+    "          %s -C sockpath [-f] command [argument ...]\n"
     "Options : -f ... Forcibly wrap the command in a PTY even though the\n"
     "                 command is placed at the end of the pipeline.\n"
     "                 Originally, it isn't necessary to use a PTY because\n"
     "                 the command placed at the end has a TTY-connected\n"
     "                 STDOUT.\n"
+    "          -c ... Coalesce the output of the command instead of\n"
+    "                 writing every piece immediately. Complete lines are\n"
+    "                 written when the command pauses, and an incomplete\n"
+    "                 line is held until a newline comes, the buffer is\n"
+    "                 full, or the timeout by -t passes.\n"
+    "          -t usec  Timeout for an incomplete line in -c mode in\n"
+    "                 microseconds (default: 50000, rounded up to\n"
+    "                 milliseconds). This implies -c.\n"
+    "          -b bytes Buffer size for -c mode (default: 65536). The\n"
+    "                 buffer is written when it becomes full. This\n"
+    "                 implies -c.\n"
+    "          -m ... Multiplex mode. Run each line of \"cmdlistfile\" (\"-\"\n"
+    "                 or none means STDIN) as a command by \"sh -c\", each on\n"
+    "                 its own PTY, under this one process. Empty lines and\n"
+    "                 lines starting with '#' are ignored. Every output line\n"
+    "                 is tagged with the line number of its command as the\n"
+    "                 first field (lines longer than 8191 bytes are split).\n"
+    "                 STDIN of the commands is /dev/null. The return value\n"
+    "                 is the largest one of the commands.\n"
+    "          -j n   The maximum number of commands running at a time in\n"
+    "                 -m mode (default: the number of online processors)\n"
+    "          -T ... Don't tag the output lines in -m mode\n"
+    "          -S sockpath  Server mode. Keep a pool of PTY pairs ready and\n"
+    "                 serve the requests from \"ptw -C\" through the Unix-\n"
+    "                 domain socket \"sockpath\". The socket file is made\n"
+    "                 with mode 0600, and only the clients of the same user\n"
+    "                 are served. The socket file is removed on SIGINT/\n"
+    "                 SIGTERM. (*BSD, macOS and Linux only)\n"
+    "          -P n   The number of PTY pairs to keep ready in -S mode\n"
+    "                 (default: 8)\n"
+    "          -C sockpath  Client mode. Hand STDIN/STDOUT/STDERR and the\n"
+    "                 current directory over to the server on \"sockpath\",\n"
+    "                 and let it run the command on one of the ready PTYs.\n"
+    "                 The output comes to STDOUT directly from the server,\n"
+    "                 and the return value is the command's one. Note that\n"
+    "                 the environment variables of the server are used.\n"
     "Retuen  : The return value will be decided by the wrapped command\n"
     "          when PTY wrapping has succeed. However, return a non-zero\n"
     "          number by this wrapper when failed.\n"
-    "Version : 2020-03-19 12:18:14 JST\n"
+    "Version : 2026-10-19 01:14:09 JST\n"
     "          (POSIX C language with \"POSIX centric\" programming)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -94,7 +239,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/misc-tools\n"
-    ,gpszCmdname);
+    ,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname);
   exit(1);
 }
 /*--- print warning message ----------------------------------------*/
@@ -129,16 +274,14 @@ int main(int argc, char *argv[]) {
 /*--- Variables ----------------------------------------------------*/
 int    iRet;              /* exit status for me                     */
 int    iStdinIsATTY;      /* 1 if stdin is a TTY                    */
-struct termios stTerms;   /* PTY slave terimios                     */
 struct winsize stWsizem;  /* stdin window size for master           */
 pid_t    pidMS;           /* PID (master or slave)                  */
 char   szTran[BUFSIZE];   /* for master-slave transceiver           */
 int    i, j, k, l;        /* all-purpose int                        */
 char*  psz;               /* all-purpose char*                      */
-#ifdef __OpenBSD__
-  struct sigaction saIgnr;  /* for ignoring SIGHUP during preparation */
-  struct sigaction saOrig;  /* for backing up signal action           */
-#endif
+FILE*  fp;                /* command list for -m mode               */
+char*  pszPoolSrv=NULL;   /* socket path for -S mode                */
+char*  pszPoolCli=NULL;   /* socket path for -C mode                */
 /*--- Initialize ---------------------------------------------------*/
 gpszCmdname = argv[0];
 for (i=0; *(gpszCmdname+i)!='\0'; i++) {
@@ -148,14 +291,31 @@ giFd1m=-1;
 giFd1s=-1;
 /*=== Parse arguments ==============================================*/
 #if !defined(__linux__)
-while ((i=getopt(argc, argv,  "fvh")) != -1) {
+while ((i=getopt(argc, argv,  "fct:b:mj:TS:P:C:vh")) != -1) {
 #else
 /* To make Linux complieant POSIX, "+" is required at the head of
    optstring on getopt() for only Linux                            */
-while ((i=getopt(argc, argv, "+fvh")) != -1) {
+while ((i=getopt(argc, argv, "+fct:b:mj:TS:P:C:vh")) != -1) {
 #endif
   switch (i) {
     case 'f': giForciblepty=1; break;
+    case 'c': giCoalesce=1;    break;
+    case 't': if (sscanf(optarg,"%ld",&glCoalUsec) != 1) {print_usage_and_exit();}
+              if (glCoalUsec < 0                     ) {print_usage_and_exit();}
+              giCoalesce=1;    break;
+    case 'b': if (sscanf(optarg,"%d",&giCoalBytes) != 1) {print_usage_and_exit();}
+              if (giCoalBytes < 1                    ) {print_usage_and_exit();}
+              giCoalesce=1;    break;
+    case 'm': giMultiplex=1;   break;
+    case 'j': if (sscanf(optarg,"%d",&giMuxJobs) != 1) {print_usage_and_exit();}
+              if (giMuxJobs < 1                    ) {print_usage_and_exit();}
+              break;
+    case 'T': giMuxNotag=1;    break;
+    case 'S': pszPoolSrv=optarg; break;
+    case 'P': if (sscanf(optarg,"%d",&giPoolNum) != 1) {print_usage_and_exit();}
+              if (giPoolNum < 0                    ) {print_usage_and_exit();}
+              break;
+    case 'C': pszPoolCli=optarg; break;
     case 'v': giVerbose++;     break;
     case 'h': print_usage_and_exit();
     default : print_usage_and_exit();
@@ -163,11 +323,22 @@ while ((i=getopt(argc, argv, "+fvh")) != -1) {
 }
 argc -= optind-1;
 argv += optind  ;
-if (argc<2) {print_usage_and_exit();}
+if      (pszPoolSrv ) {if (argc>1) {print_usage_and_exit();}}
+else if (giMultiplex) {if (argc>2) {print_usage_and_exit();}}
+else                  {if (argc<2) {print_usage_and_exit();}}
 if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
 
+/*=== Serve the PTY pool if -S is given ============================*/
+if (pszPoolSrv != NULL) {
+  #ifdef HAVE_PTY_POOL
+    return run_pool_server(pszPoolSrv);
+  #else
+    error_exit(1,"-S option is not supported on this host\n");
+  #endif
+}
+
 /*=== Just exec() immediately if connected a tty ===================*/
-if (isatty(STDOUT_FILENO) == 1) {
+if (isatty(STDOUT_FILENO) == 1 && !giMultiplex) {
   if (giVerbose > 0) {warning("STDOUT is already connected to a TTY.\n", psz);}
   if (!giForciblepty) {
     if (giVerbose > 0) {warning("So, I'll do exec() without PTY.\n", psz);}
@@ -179,6 +350,15 @@ if (isatty(STDOUT_FILENO) == 1) {
   }
 }
 
+/*=== Let the server run it if -C is given ========================*/
+if (pszPoolCli != NULL) {
+  #ifdef HAVE_PTY_POOL
+    return run_pool_client(pszPoolCli, &argv[0]);
+  #else
+    error_exit(1,"-C option is not supported on this host\n");
+  #endif
+}
+
 /*=== Save parameters "termios"/"winsize" of STDIN =================*/
 iStdinIsATTY = isatty(STDIN_FILENO);
 if (iStdinIsATTY == 1) {
@@ -190,20 +370,166 @@ if (iStdinIsATTY == 1) {
   }
 }
 
+/*=== Run the commands in the list if -m is given ==================*/
+if (giMultiplex) {
+  if (argc < 2 || strcmp(argv[0],"-") == 0) {
+    fp = stdin;
+  } else if ((fp=fopen(argv[0],"r")) == NULL) {
+    error_exit(errno,"%s: %s\n", argv[0], strerror(errno));
+  } else {
+    (void)fcntl(fileno(fp), F_SETFD, FD_CLOEXEC); /* not for commands */
+  }
+  return run_multiplexed(fp, iStdinIsATTY, &stWsizem);
+}
+
 /*=== Make a PTY pair exectute the wrapping program ================*/
 /*--- Make PTY master (parent) -------------------------------------*/
-if ((giFd1m=posix_openpt(O_RDWR))<0) {
-  error_exit(errno,"posix_openpt(): %s\n", strerror(errno));
+giFd1m = open_pty_master();
+/*--- Make PTY slave and exectute the wrapping program (child) -----*/
+if ((pidMS=fork()) < 0) {error_exit(errno,"fork() #1: %s\n", strerror(errno));}
+if (pidMS == 0) {exec_on_pty_slave(&argv[0], iStdinIsATTY, &stWsizem);}
+
+/*=== Turn into raw mode for master STDIN ==========================*/
+#ifdef RAWMODE_FOR_MASTER
+if (isatty(STDOUT_FILENO) == 1) {
+  /*--- Set flags and parameters for raw mode ----------------------*/
+  gstTermm.c_iflag &= ~( BRKINT | ICRNL  | INLCR  | IGNCR  |
+                         INPCK  | ISTRIP | IXON   | PARMRK );
+  gstTermm.c_iflag |=  ( IGNBRK                            );
+  gstTermm.c_oflag &= ~( OPOST                             );
+  gstTermm.c_lflag &= ~( ECHO   | ICANON | IEXTEN | ISIG   );
+  gstTermm.c_cflag &= ~( PARENB | CSIZE                    );
+  gstTermm.c_cflag |=  ( CS8                               );
+  gstTermm.c_cc[VMIN ] = 1;
+  gstTermm.c_cc[VTIME] = 0;
+  /*--- Turn into raw mode gracefully ------------------------------*/
+  if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &gstTermm) < 0) {
+    error_exit(errno,"tcsetattr() on master: %s\n", strerror(errno));
+  }
+  /*--- Set flags and parameters for raw mode ----------------------*/
+  atexit(restore_master_termios);
+  /*--- Make sure that all the flags and parameters have been set --*/
+  if (tcgetattr(STDIN_FILENO, &gstTermm) < 0) {
+    error_exit(errno,"tcgetattr() on master (verifying): %s\n",strerror(errno));
+  }
+  if ((gstTermm.c_iflag & ( BRKINT | ICRNL  | INLCR  | IGNCR  |
+                            INPCK  | ISTRIP | IXON   | PARMRK |
+                            IGNBRK                            ))!= IGNBRK ||
+      (gstTermm.c_oflag & ( OPOST                             ))          ||
+      (gstTermm.c_lflag & ( ECHO   | ICANON | IEXTEN | ISIG   ))          ||
+      (gstTermm.c_cflag & ( CSIZE  | PARENB | CS8             ))!= CS8    ||
+      (gstTermm.c_cc[VMIN]  != 1                               )          ||
+      (gstTermm.c_cc[VTIME] != 0                               )           )
+  {
+    error_exit(255,"tcgetattr() on master (verifying): verify error\n");
+  }
 }
-if (grantpt (giFd1m)             <0) {
-  error_exit(errno,"grantpt(): %s\n"     , strerror(errno));
+#endif
+
+/*=== Transceive data from/to the PTY ==============================*/
+/*--- Transceive (coalescing mode) ---------------------------------*/
+iRet = 0;
+#ifdef __OpenBSD__
+  /* The PTY on OpenBSD needs the special EOF handling below */
+  if (giCoalesce) {warning("-c is not supported on OpenBSD\n"); giCoalesce=0;}
+#endif
+if (giCoalesce) {transceive_coalesced();}
+/*--- Transceive (immediate mode) ----------------------------------*/
+while (! giCoalesce) {
+  j = (int)read(giFd1m, szTran, BUFSIZE);
+  if (j <0) {
+    if (errno != EIO) {
+      error_exit(errno,"read() on mono RX: %s\n", strerror(errno));
+    }
+    /* EIO suggests, in this case, that the child is already dead and
+       it's no problem. However, I will print a message just in case
+       if -v option is given.                                         */
+    if (giVerbose > 0) {warning("read() on mono RX: EIO occured\n");}
+    j = 0;
+  }
+  if (j==0) {
+    #ifndef __OpenBSD__
+      break;
+    #else
+      /* On OpenBSD (at least <=6.5), it seems that it has some strange
+         behaviors on PTY.
+           - read() for PTY seems to work in non-blocking mode forcibly.
+           - waitpid() can return 0 even though its children are still alive.
+         Thus I give the following codes only to OpenBSD.                     */
+      if (waitpid(-1,&j,WNOHANG) >= 0) {
+        iRet = (WIFEXITED(j)  ) ? WEXITSTATUS(j)  :
+               (WIFSIGNALED(j)) ? WTERMSIG(i)+127 :
+                                  254             ;
+        continue;
+      }
+      if (errno!=ECHILD) {error_exit(errno,"waitpid(): %s\n", strerror(errno));}
+      if (giVerbose > 0) {warning("waitpid(): ECHILD occured\n");}
+      close(giFd1m); giFd1m=-1;
+      return iRet;
+    #endif
+  }
+  k = j;
+  while (k > 0) {
+    l = (int)write(STDOUT_FILENO, szTran+j-k, k);
+    if (l < 0) {error_exit(errno,"write() on mono RX: %s\n",strerror(errno));}
+    k -= l;
+  }
 }
-if (unlockpt(giFd1m)             <0) {
-  error_exit(errno,"unlockpt(): %s\n"    , strerror(errno));
+/*--- Close the PTY ------------------------------------------------*/
+close(giFd1m); giFd1m=-1;
+
+/*=== Wait for the child to exit ===================================*/
+if (wait(&i) < 0) {error_exit(errno,"wait(): %s\n", strerror(errno));}
+iRet = (WIFEXITED(i)  ) ? WEXITSTATUS(i)  :
+       (WIFSIGNALED(i)) ? WTERMSIG(i)+127 :
+                          254             ;
+
+/*=== Finish with exit status the child returned basically =========*/
+return iRet;}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Make a PTY master =============================================
+ * [ret] File descriptor of the PTY master (exits on error)         */
+int open_pty_master(void) {
+  int iFd;
+  if ((iFd=posix_openpt(O_RDWR))<0) {
+    error_exit(errno,"posix_openpt(): %s\n", strerror(errno));
+  }
+  if (grantpt (iFd)             <0) {
+    error_exit(errno,"grantpt(): %s\n"     , strerror(errno));
+  }
+  if (unlockpt(iFd)             <0) {
+    error_exit(errno,"unlockpt(): %s\n"    , strerror(errno));
+  }
+  return iFd;
 }
-/*--- Make PTY slave and exectute the wrapping program (child) -----*/
-if ((pidMS=fork()) < 0) {error_exit(errno,"fork() #1: %s\n", strerror(errno));}
-if (pidMS == 0) {
+
+/*=== (Child) Open the PTY slave and exec the wrapped program ========
+ * [in] giFd1m       : PTY master (must be defined as a global variable)
+ *      argv         : The command and its arguments
+ *      iStdinIsATTY : 1 if the termios/winsize of STDIN have been saved
+ *                     into gstTermm and pstWsizem
+ *      pstWsizem    : stdin window size for master
+ * It never returns.                                                */
+void exec_on_pty_slave(char *argv[], int iStdinIsATTY,
+                       struct winsize *pstWsizem                ) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct termios stTerms;   /* PTY slave terimios                     */
+  char*  psz;               /* all-purpose char*                      */
+  #if !defined(BSD) && !defined(__APPLE__) && !defined(__linux__)
+    int  i;                 /* all-purpose int                        */
+  #endif
+  #ifdef __OpenBSD__
+    struct sigaction saIgnr;  /* for ignoring SIGHUP during preparation */
+    struct sigaction saOrig;  /* for backing up signal action           */
+  #endif
+
   if (setsid() <0) {error_exit(errno,"setsid(): %s\n",strerror(errno));}
                        /* to be independent of the parent's session */
   if ((psz=ptsname(giFd1m)) == NULL) {error_exit(255,"Failed to ptsname()\n");}
@@ -262,7 +588,7 @@ if (pidMS == 0) {
     if (tcsetattr(giFd1s, TCSANOW, &gstTermm)    < 0) {
       error_exit(errno,"tcsetattr() on slave #1: %s\n", strerror(errno));
     }
-    if (ioctl(giFd1s, TIOCSWINSZ, &stWsizem)     < 0) {
+    if (ioctl(giFd1s, TIOCSWINSZ, pstWsizem)      < 0) {
       error_exit(errno,"ioctl(TIOCSWINSZ): %s\n"      , strerror(errno));
     }
   }
@@ -287,103 +613,738 @@ if (pidMS == 0) {
   error_exit(errno,"%s: %s\n", argv[0], strerror(errno));
 }
 
-/*=== Turn into raw mode for master STDIN ==========================*/
-#ifdef RAWMODE_FOR_MASTER
-if (isatty(STDOUT_FILENO) == 1) {
-  /*--- Set flags and parameters for raw mode ----------------------*/
-  gstTermm.c_iflag &= ~( BRKINT | ICRNL  | INLCR  | IGNCR  |
-                         INPCK  | ISTRIP | IXON   | PARMRK );
-  gstTermm.c_iflag |=  ( IGNBRK                            );
-  gstTermm.c_oflag &= ~( OPOST                             );
-  gstTermm.c_lflag &= ~( ECHO   | ICANON | IEXTEN | ISIG   );
-  gstTermm.c_cflag &= ~( PARENB | CSIZE                    );
-  gstTermm.c_cflag |=  ( CS8                               );
-  gstTermm.c_cc[VMIN ] = 1;
-  gstTermm.c_cc[VTIME] = 0;
-  /*--- Turn into raw mode gracefully ------------------------------*/
-  if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &gstTermm) < 0) {
-    error_exit(errno,"tcsetattr() on master: %s\n", strerror(errno));
+/*=== Run the commands in a list on their own PTYs (-m mode) ========
+ * [in] fpCmds       : The command list
+ *      iStdinIsATTY : The same as exec_on_pty_slave()
+ *      pstWsizem    : The same as exec_on_pty_slave()
+ *      giMuxJobs    : The maximum number of running commands
+ * [ret] The largest exit status of the commands                    */
+int run_multiplexed(FILE *fpCmds, int iStdinIsATTY, struct winsize *pstWsizem){
+
+  /*--- Variables --------------------------------------------------*/
+  muxjob *pjobs  ;           /* job slots                              */
+  char    szCmd[MUX_CMD_BUF];/* a command line in the list             */
+  char   *apszArg[4];        /* arguments to exec the command          */
+  long    lLineno;           /* line number in the list                */
+  int     iRunning;          /* the number of running commands         */
+  int     iEof;              /* 1 when the list has been read up       */
+  int     iRet, iStat;
+  int     i, j, k, iFdNull;
+  #ifdef USE_EPOLL
+    int                iEpfd;
+    struct epoll_event evs[MUX_EVENTS];
+  #else
+    struct pollfd     *pfds;
+  #endif
+
+  /*--- Initialize -------------------------------------------------*/
+  if (giMuxJobs < 1) {
+    #ifdef _SC_NPROCESSORS_ONLN
+      giMuxJobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
+    if (giMuxJobs < 1) {giMuxJobs = 1;}
   }
-  /*--- Set flags and parameters for raw mode ----------------------*/
-  atexit(restore_master_termios);
-  /*--- Make sure that all the flags and parameters have been set --*/
-  if (tcgetattr(STDIN_FILENO, &gstTermm) < 0) {
-    error_exit(errno,"tcgetattr() on master (verifying): %s\n",strerror(errno));
+  if ((pjobs=calloc(giMuxJobs,sizeof(muxjob))) == NULL) {
+    error_exit(errno,"calloc() for -m: %s\n", strerror(errno));
   }
-  if ((gstTermm.c_iflag & ( BRKINT | ICRNL  | INLCR  | IGNCR  |
-                            INPCK  | ISTRIP | IXON   | PARMRK |
-                            IGNBRK                            ))!= IGNBRK ||
-      (gstTermm.c_oflag & ( OPOST                             ))          ||
-      (gstTermm.c_lflag & ( ECHO   | ICANON | IEXTEN | ISIG   ))          ||
-      (gstTermm.c_cflag & ( CSIZE  | PARENB | CS8             ))!= CS8    ||
-      (gstTermm.c_cc[VMIN]  != 1                               )          ||
-      (gstTermm.c_cc[VTIME] != 0                               )           )
-  {
-    error_exit(255,"tcgetattr() on master (verifying): verify error\n");
+  #ifdef USE_EPOLL
+    if ((iEpfd=epoll_create1(EPOLL_CLOEXEC)) < 0) {
+      error_exit(errno,"epoll_create1(): %s\n", strerror(errno));
+    }
+  #else
+    if ((pfds=calloc(giMuxJobs,sizeof(struct pollfd))) == NULL) {
+      error_exit(errno,"calloc() for -m: %s\n", strerror(errno));
+    }
+  #endif
+  apszArg[0] = "sh";
+  apszArg[1] = "-c";
+  apszArg[2] = szCmd;
+  apszArg[3] = NULL;
+  lLineno  = 0;
+  iRunning = 0;
+  iEof     = 0;
+  iRet     = 0;
+
+  while (1) {
+
+    /*--- Start commands as long as free slots exist ---------------*/
+    while (!iEof && iRunning < giMuxJobs) {
+      if (fgets(szCmd, MUX_CMD_BUF, fpCmds) == NULL) {
+        if (ferror(fpCmds)) {error_exit(errno,"fgets(): %s\n",strerror(errno));}
+        iEof = 1;
+        break;
+      }
+      lLineno++;
+      i = strlen(szCmd);
+      if (i > 0 && szCmd[i-1] == '\n') {
+        szCmd[--i] = '\0';
+      } else if (! feof(fpCmds)) {
+        error_exit(1,"Line %ld in the list is too long\n", lLineno);
+      }
+      if (i == 0 || szCmd[0] == '#') {continue;}
+      for (j=0; pjobs[j].pid!=0; j++) {;}
+      pjobs[j].iFd  = open_pty_master();
+      pjobs[j].lNum = lLineno;
+      pjobs[j].iLen = 0;
+      (void)fcntl(pjobs[j].iFd, F_SETFD, FD_CLOEXEC); /* for other commands */
+      if ((pjobs[j].pid=fork()) < 0) {
+        error_exit(errno,"fork() #M1: %s\n", strerror(errno));
+      }
+      if (pjobs[j].pid == 0) {
+        giFd1m = pjobs[j].iFd;
+        if ((iFdNull=open("/dev/null",O_RDONLY)) < 0) {
+          error_exit(errno,"open(/dev/null): %s\n", strerror(errno));
+        }
+        if (dup2(iFdNull, STDIN_FILENO) != STDIN_FILENO) {
+          error_exit(errno,"dup2(null,stdin): %s\n", strerror(errno));
+        }
+        if (iFdNull != STDIN_FILENO) {close(iFdNull);}
+        exec_on_pty_slave(apszArg, iStdinIsATTY, pstWsizem);
+      }
+      if (giVerbose > 0) {
+        warning("#%ld started (PID %ld)\n",lLineno,(long)pjobs[j].pid);
+      }
+      #ifdef USE_EPOLL
+        evs[0].events   = EPOLLIN;
+        evs[0].data.u32 = (uint32_t)j;
+        if (epoll_ctl(iEpfd, EPOLL_CTL_ADD, pjobs[j].iFd, &evs[0]) < 0) {
+          error_exit(errno,"epoll_ctl(): %s\n", strerror(errno));
+        }
+      #endif
+      iRunning++;
+    }
+    if (iRunning == 0) {break;}
+
+    /*--- Wait for output from any of the commands -----------------*/
+    #ifdef USE_EPOLL
+      if ((i=epoll_wait(iEpfd, evs, MUX_EVENTS, -1)) < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(errno,"epoll_wait(): %s\n", strerror(errno));
+      }
+      for (j=0; j<i; j++) {
+        k = (int)evs[j].data.u32;
+        if (pjobs[k].iFd < 0 || mux_read(&pjobs[k]) == 0) {continue;}
+        /* Remove it explicitly because children which haven't exec()ed
+           yet may still share the PTY master                          */
+        (void)epoll_ctl(iEpfd, EPOLL_CTL_DEL, pjobs[k].iFd, &evs[j]);
+        close(pjobs[k].iFd);
+        pjobs[k].iFd = -1;
+      }
+    #else
+      for (i=0, j=0; j<giMuxJobs; j++) {
+        if (pjobs[j].pid == 0) {continue;}
+        pfds[i].fd      = pjobs[j].iFd;
+        pfds[i].events  = POLLIN;
+        pfds[i].revents = 0;
+        i++;
+      }
+      if (poll(pfds, i, -1) < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(errno,"poll(): %s\n", strerror(errno));
+      }
+      for (i=0, j=0; j<giMuxJobs; j++) {
+        if (pjobs[j].pid == 0) {continue;}
+        if (pfds[i++].revents && mux_read(&pjobs[j]) != 0) {
+          close(pjobs[j].iFd);
+          pjobs[j].iFd = -1;
+        }
+      }
+    #endif
+    mux_flush();
+
+    /*--- Collect the exit status of the finished commands ---------*/
+    for (j=0; j<giMuxJobs; j++) {
+      if (pjobs[j].pid == 0 || pjobs[j].iFd >= 0) {continue;}
+      while (waitpid(pjobs[j].pid,&iStat,0) < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(errno,"waitpid(): %s\n", strerror(errno));
+      }
+      i = (WIFEXITED(iStat)  ) ? WEXITSTATUS(iStat)  :
+          (WIFSIGNALED(iStat)) ? WTERMSIG(iStat)+127 :
+                                 254                 ;
+      if (giVerbose > 0) {warning("#%ld exited with %d\n",pjobs[j].lNum,i);}
+      if (i > iRet) {iRet = i;}
+      pjobs[j].pid = 0;
+      iRunning--;
+    }
   }
+
+  /*--- Finish -----------------------------------------------------*/
+  if (fpCmds != stdin) {fclose(fpCmds);}
+  free(pjobs);
+  #ifdef USE_EPOLL
+    close(iEpfd);
+  #else
+    free(pfds);
+  #endif
+  return iRet;
 }
-#endif
 
-/*=== Transceive data from/to the PTY ==============================*/
-/*--- Transceive ---------------------------------------------------*/
-iRet = 0;
-while (1) {
-  j = (int)read(giFd1m, szTran, BUFSIZE);
-  if (j <0) {
+/*=== Read the output of a command and emit the complete lines (-m) ==
+ * [in/out] pjob : The job slot
+ * [ret]    0    : Read some data (or nothing to read yet)
+ *          1    : The PTY has reached EOF (the caller closes it)   */
+int mux_read(muxjob *pjob) {
+
+  /*--- Variables --------------------------------------------------*/
+  char *psz, *pszEnd;
+  int   i;
+
+  /*--- Read into the rest of the line buffer directly -------------*/
+  i = (int)read(pjob->iFd, pjob->acBuf+pjob->iLen, MUX_LINE_BUF-pjob->iLen);
+  if (i < 0) {
+    if (errno == EINTR || errno == EAGAIN) {return 0;}
     if (errno != EIO) {
-      error_exit(errno,"read() on mono RX: %s\n", strerror(errno));
+      error_exit(errno,"read() on #%ld: %s\n", pjob->lNum, strerror(errno));
     }
-    /* EIO suggests, in this case, that the child is already dead and
-       it's no problem. However, I will print a message just in case
-       if -v option is given.                                         */
-    if (giVerbose > 0) {warning("read() on mono RX: EIO occured\n");}
-    j = 0;
+    i = 0; /* EIO means that the command has exited (see main()) */
   }
-  if (j==0) {
-    #ifndef __OpenBSD__
-      break;
-    #else
-      /* On OpenBSD (at least <=6.5), it seems that it has some strange
-         behaviors on PTY.
-           - read() for PTY seems to work in non-blocking mode forcibly.
-           - waitpid() can return 0 even though its children are still alive.
-         Thus I give the following codes only to OpenBSD.                     */
-      if (waitpid(-1,&j,WNOHANG) >= 0) {
-        iRet = (WIFEXITED(j)  ) ? WEXITSTATUS(j)  :
-               (WIFSIGNALED(j)) ? WTERMSIG(i)+127 :
-                                  254             ;
-        continue;
+  if (i == 0) {
+    if (pjob->iLen > 0) {mux_emit(pjob->lNum, pjob->acBuf, pjob->iLen);}
+    pjob->iLen = 0;
+    return 1;
+  }
+
+  /*--- Emit the complete lines ------------------------------------*/
+  psz    = pjob->acBuf;
+  pszEnd = pjob->acBuf + pjob->iLen + i;
+  for (i=pjob->iLen; psz+i<pszEnd; i++) {
+    if (psz[i] != '\n') {continue;}
+    mux_emit(pjob->lNum, psz, i);
+    psz += i+1;
+    i    = -1;
+  }
+  pjob->iLen = (int)(pszEnd-psz);
+  if (pjob->iLen == MUX_LINE_BUF) {
+    /* Split the line if it is too long */
+    mux_emit(pjob->lNum, psz, pjob->iLen);
+    pjob->iLen = 0;
+  } else if (psz != pjob->acBuf) {
+    memmove(pjob->acBuf, psz, pjob->iLen);
+  }
+  return 0;
+}
+
+/*=== Put a tagged line into the output buffer (-m mode) =============
+ * [in] lNum    : The tag (line number of the command)
+ *      pszLine : The line (without '\n')
+ *      iLen    : The length of the line                            */
+void mux_emit(long lNum, char *pszLine, int iLen) {
+  if (giMuxOutLen + iLen + 24 > BUFSIZE) {mux_flush();}
+  if (! giMuxNotag) {
+    giMuxOutLen += sprintf(gacMuxOut+giMuxOutLen, "%ld ", lNum);
+  }
+  memcpy(gacMuxOut+giMuxOutLen, pszLine, iLen);
+  giMuxOutLen += iLen;
+  gacMuxOut[giMuxOutLen++] = '\n';
+}
+
+/*=== Write the output buffer of -m mode out =========================*/
+void mux_flush(void) {
+  write_out(gacMuxOut, giMuxOutLen);
+  giMuxOutLen = 0;
+}
+
+#ifdef HAVE_PTY_POOL
+/*=== Serve commands on the pooled PTYs (-S mode) ====================
+ * [in] pszSock  : Path to bind the Unix-domain stream socket on
+ *      giPoolNum: The number of PTY pairs to keep ready
+ * It never returns normally (it exits on SIGINT/SIGTERM).          */
+int run_pool_server(char *pszSock) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct sockaddr_un saUn;
+  struct sigaction   sa;
+  struct timeval     tvReq;   /* time limit to receive a request      */
+  mode_t modeUmask;
+  char   acReq[POOL_REQ_BUF]; /* request: "cwd\0arg0\0arg1\0..."     */
+  int    aiFds[3];            /* stdin/out/err of the client          */
+  int   *piPoolm, *piPools;   /* the pool of PTY pairs                */
+  int    iPooled;             /* the number of pairs in the pool      */
+  int    iSock, iConn, iLen;
+  int    iFdm, iFds;
+  pid_t  pid;
+  int    i;
+
+  /*--- Make the socket --------------------------------------------*/
+  if (strlen(pszSock) >= sizeof(saUn.sun_path)) {
+    error_exit(1,"%s: Too long socket path\n",pszSock);
+  }
+  if ((iSock=socket(AF_UNIX,SOCK_STREAM,0)) < 0) {
+    error_exit(errno,"socket(): %s\n",strerror(errno));
+  }
+  memset(&saUn, 0, sizeof(saUn));
+  saUn.sun_family = AF_UNIX;
+  strcpy(saUn.sun_path, pszSock);
+  modeUmask = umask(0177); /* make the socket file with mode 0600 */
+  if (bind(iSock,(struct sockaddr *)&saUn,sizeof(saUn)) < 0) {
+    error_exit(errno,"bind(%s): %s\n",pszSock,strerror(errno));
+  }
+  (void)umask(modeUmask);
+  gpszPoolSock = pszSock;
+  if (listen(iSock,SOMAXCONN) < 0) {
+    error_exit(errno,"listen(): %s\n",strerror(errno));
+  }
+  (void)fcntl(iSock, F_SETFD, FD_CLOEXEC);
+
+  /*--- Set the signal traps ---------------------------------------*/
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = remove_pool_sock;
+  if (sigaction(SIGINT ,&sa,NULL)!=0 || sigaction(SIGTERM,&sa,NULL)!=0) {
+    error_exit(errno,"sigaction() for -S: %s\n",strerror(errno));
+  }
+  sa.sa_handler = SIG_IGN; /* to reap the session processes automatically */
+  if (sigaction(SIGCHLD,&sa,NULL)!=0 || sigaction(SIGPIPE,&sa,NULL)!=0) {
+    error_exit(errno,"sigaction() for -S: %s\n",strerror(errno));
+  }
+
+  /*--- Fill the pool ----------------------------------------------*/
+  if ((piPoolm=malloc(sizeof(int)*giPoolNum*2)) == NULL) {
+    error_exit(errno,"malloc() for -S: %s\n",strerror(errno));
+  }
+  piPools = piPoolm + giPoolNum;
+  for (iPooled=0; iPooled<giPoolNum; iPooled++) {
+    open_pooled_pty(&piPoolm[iPooled], &piPools[iPooled]);
+  }
+  if (giVerbose > 0) {warning("%d PTY pairs are ready\n",iPooled);}
+
+  /*--- Serving loop -----------------------------------------------*/
+  while (1) {
+
+    /* Accept a client and receive its request */
+    if ((iConn=accept(iSock,NULL,NULL)) < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {continue;}
+      error_exit(errno,"accept(): %s\n",strerror(errno));
+    }
+    if (check_pool_peer(iConn) < 0) {
+      warning("Rejected a client of another user\n");
+      close(iConn);
+      continue;
+    }
+    tvReq.tv_sec  = POOL_REQ_SEC; /* not to be stalled by a silent client */
+    tvReq.tv_usec = 0;
+    (void)setsockopt(iConn, SOL_SOCKET, SO_RCVTIMEO, &tvReq, sizeof(tvReq));
+    if ((iLen=recv_pool_request(iConn, acReq, aiFds)) < 0) {
+      warning("Received an invalid request\n");
+      close(iConn);
+      continue;
+    }
+
+    /* Take a PTY pair from the pool (or make one if it's empty) */
+    if (iPooled > 0) {iPooled--; iFdm=piPoolm[iPooled]; iFds=piPools[iPooled];}
+    else             {open_pooled_pty(&iFdm, &iFds);}
+
+    /* Hand them over to a session process */
+    if ((pid=fork()) < 0) {
+      warning("fork() #S1: %s\n", strerror(errno));
+    } else if (pid == 0) {
+      sa.sa_handler = SIG_DFL;
+      (void)sigaction(SIGCHLD,&sa,NULL);
+      (void)sigaction(SIGPIPE,&sa,NULL);
+      (void)sigaction(SIGINT ,&sa,NULL);
+      (void)sigaction(SIGTERM,&sa,NULL);
+      gpszPoolSock = NULL;
+      close(iSock);
+      for (i=0; i<iPooled; i++) {close(piPoolm[i]); close(piPools[i]);}
+      run_pool_session(iConn, iFdm, iFds, aiFds, acReq, iLen);
+    }
+    close(iConn); close(iFdm); close(iFds);
+    for (i=0; i<3; i++) {close(aiFds[i]);}
+
+    /* Refill the pool after the hand-over */
+    while (iPooled < giPoolNum) {
+      open_pooled_pty(&piPoolm[iPooled], &piPools[iPooled]);
+      iPooled++;
+    }
+  }
+}
+
+/*=== Make a PTY pair ready to run a command in (-S mode) ============
+ * [out] piFdm : PTY master
+ *       piFds : PTY slave (opened without being the controlling TTY) */
+void open_pooled_pty(int *piFdm, int *piFds) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct termios stTerms;
+  char  *psz;
+
+  /*--- Open the pair ----------------------------------------------*/
+  *piFdm = open_pty_master();
+  if ((psz=ptsname(*piFdm)) == NULL) {error_exit(255,"Failed to ptsname()\n");}
+  if ((*piFds=open(psz,O_RDWR|O_NOCTTY)) < 0) {
+    error_exit(errno,"open(%s): %s\n", psz, strerror(errno));
+  }
+  (void)fcntl(*piFdm, F_SETFD, FD_CLOEXEC);
+  (void)fcntl(*piFds, F_SETFD, FD_CLOEXEC);
+
+  /*--- Turn off echo for the PTY slave (the same as main()) -------*/
+  if (tcgetattr(*piFds, &stTerms) < 0) {
+    error_exit(errno,"tcgetattr() on slave: %s\n"   , strerror(errno));
+  }
+  stTerms.c_lflag &= ~( ECHO  | ECHOE  | ECHOK | ECHONL );
+  stTerms.c_oflag &= ~( ONLCR | TABDLY                  );
+  if (tcsetattr(*piFds, TCSANOW, &stTerms)     < 0) {
+    error_exit(errno,"tcsetattr() on slave #2: %s\n", strerror(errno));
+  }
+}
+
+/*=== Make sure that the client is run by the same user (-S mode) ====
+ * [in]  iConn  : The connection
+ * [ret] 0      : The same user as this server
+ *       -1     : Another user, or failed to know it                */
+int check_pool_peer(int iConn) {
+
+  /*--- Variables --------------------------------------------------*/
+#ifdef __linux__
+  struct ucred stCred;
+  socklen_t    iSize;
+#else
+  uid_t        uid;
+  gid_t        gid;
+#endif
+
+  /*--- Get the user of the peer -----------------------------------*/
+#ifdef __linux__
+  iSize = sizeof(stCred);
+  if (getsockopt(iConn,SOL_SOCKET,SO_PEERCRED,&stCred,&iSize) < 0) {
+    return -1;
+  }
+  return (stCred.uid == geteuid()) ? 0 : -1;
+#else
+  if (getpeereid(iConn, &uid, &gid) < 0) {return -1;}
+  return (uid == geteuid()) ? 0 : -1;
+#endif
+}
+
+/*=== Receive a request from a client (-S mode) ======================
+ * [in]  iConn  : The connection
+ * [out] pszReq : The request ("cwd\0arg0\0arg1\0..."; POOL_REQ_BUF)
+ *       piFds  : stdin/stdout/stderr of the client
+ * [ret] >0     : The length of the request
+ *       -1     : Invalid request                                   */
+int recv_pool_request(int iConn, char *pszReq, int *piFds) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct msghdr   mh;
+  struct iovec    iov;
+  struct cmsghdr *pcm;
+  char            acCtl[CMSG_SPACE(sizeof(int)*3)];
+  uint32_t        u4Len;
+  int             i, iGot;
+
+  /*--- Receive the length of the request with the descriptors -----*/
+  memset(&mh, 0, sizeof(mh));
+  iov.iov_base       = &u4Len;
+  iov.iov_len        = sizeof(u4Len);
+  mh.msg_iov         = &iov;
+  mh.msg_iovlen      = 1;
+  mh.msg_control     = acCtl;
+  mh.msg_controllen  = sizeof(acCtl);
+  if (recvmsg(iConn, &mh, MSG_WAITALL) != sizeof(u4Len)) {return -1;}
+  pcm = CMSG_FIRSTHDR(&mh);
+  if (pcm == NULL || pcm->cmsg_level != SOL_SOCKET  ||
+      pcm->cmsg_type  != SCM_RIGHTS                 ||
+      pcm->cmsg_len   != CMSG_LEN(sizeof(int)*3)      ) {return -1;}
+  memcpy(piFds, CMSG_DATA(pcm), sizeof(int)*3);
+  for (i=0; i<3; i++) {(void)fcntl(piFds[i], F_SETFD, FD_CLOEXEC);}
+
+  /*--- Receive the request ----------------------------------------*/
+  if (u4Len < 2 || u4Len > POOL_REQ_BUF) {
+    for (i=0; i<3; i++) {close(piFds[i]);}
+    return -1;
+  }
+  for (iGot=0; iGot<(int)u4Len; iGot+=i) {
+    if ((i=(int)read(iConn, pszReq+iGot, u4Len-iGot)) <= 0) {
+      if (i < 0 && errno == EINTR) {i=0; continue;}
+      for (i=0; i<3; i++) {close(piFds[i]);}
+      return -1;
+    }
+  }
+  if (pszReq[u4Len-1] != '\0') {
+    for (i=0; i<3; i++) {close(piFds[i]);}
+    return -1;
+  }
+  return (int)u4Len;
+}
+
+/*=== (Session process) Run a requested command on a pooled PTY ======
+ * [in] iConn   : The connection to send the exit status back to
+ *      iFdm    : PTY master
+ *      iFds    : PTY slave
+ *      piFds   : stdin/stdout/stderr of the client
+ *      pszReq  : The request ("cwd\0arg0\0arg1\0...")
+ *      iLen    : The length of the request
+ * It never returns.                                                */
+void run_pool_session(int iConn, int iFdm, int iFds, int *piFds,
+                      char *pszReq, int iLen                     ) {
+
+  /*--- Variables --------------------------------------------------*/
+  char  **ppszArg;
+  char    szTran[BUFSIZE];
+  pid_t   pid;
+  int32_t i4Ret;
+  int     iArgc, i, j;
+
+  /*--- Split the request into the cwd and the arguments -----------*/
+  for (iArgc=0, i=0; i<iLen; i++) {if (pszReq[i]=='\0') {iArgc++;}}
+  if (iArgc < 2) {_exit(255);} /* no command */
+  if ((ppszArg=malloc(sizeof(char*)*iArgc)) == NULL) {_exit(255);}
+  for (j=0, i=strlen(pszReq)+1; i<iLen; i+=strlen(pszReq+i)+1) {
+    ppszArg[j++] = pszReq+i;
+  }
+  ppszArg[j] = NULL;
+
+  /*--- Exec the command on the slave (grandchild) -----------------*/
+  if ((pid=fork()) < 0) {_exit(255);}
+  if (pid == 0) {
+    giFd1m = -1;
+    if (setsid() < 0) {error_exit(errno,"setsid(): %s\n",strerror(errno));}
+    if (ioctl(iFds,TIOCSCTTY,(char*)0) < 0) {
+      error_exit(errno,"ioctl(TIOCSCTTY): %s\n",strerror(errno));
+    }
+    if (dup2(piFds[0],STDIN_FILENO )!=STDIN_FILENO  ||
+        dup2(iFds    ,STDOUT_FILENO)!=STDOUT_FILENO ||
+        dup2(piFds[2],STDERR_FILENO)!=STDERR_FILENO   ) {
+      error_exit(errno,"dup2() for the session: %s\n",strerror(errno));
+    }
+    if (chdir(pszReq) < 0) {
+      error_exit(errno,"chdir(%s): %s\n",pszReq,strerror(errno));
+    }
+    execvp(ppszArg[0],&ppszArg[0]);
+    error_exit(errno,"%s: %s\n", ppszArg[0], strerror(errno));
+  }
+  close(iFds);
+
+  /*--- Transceive from the master to the stdout of the client -----*/
+  if (dup2(piFds[1],STDOUT_FILENO) != STDOUT_FILENO) {_exit(255);}
+  giFd1m = iFdm;
+  if (giCoalesce) {
+    transceive_coalesced();
+  } else {
+    while ((j=(int)read(iFdm, szTran, BUFSIZE)) != 0) {
+      if (j < 0) {
+        if (errno == EINTR) {continue;}
+        break; /* EIO means that the command has exited (see main()) */
       }
-      if (errno!=ECHILD) {error_exit(errno,"waitpid(): %s\n", strerror(errno));}
-      if (giVerbose > 0) {warning("waitpid(): ECHILD occured\n");}
-      close(giFd1m); giFd1m=-1;
-      return iRet;
-    #endif
+      write_out(szTran, j);
+    }
   }
-  k = j;
-  while (k > 0) {
-    l = (int)write(STDOUT_FILENO, szTran+j-k, k);
-    if (l < 0) {error_exit(errno,"write() on mono RX: %s\n",strerror(errno));}
-    k -= l;
+  close(iFdm); giFd1m=-1;
+
+  /*--- Send the exit status back ----------------------------------*/
+  while (waitpid(pid,&i,0) < 0) {if (errno != EINTR) {_exit(255);}}
+  i4Ret = (WIFEXITED(i)  ) ? WEXITSTATUS(i)  :
+          (WIFSIGNALED(i)) ? WTERMSIG(i)+127 :
+                             254             ;
+  (void)write(iConn, &i4Ret, sizeof(i4Ret));
+  _exit(0);
+}
+
+/*=== Ask the server to run a command on a pooled PTY (-C mode) ======
+ * [in] pszSock : Path of the socket of the server
+ *      argv    : The command and its arguments
+ * [ret] The exit status of the command                             */
+int run_pool_client(char *pszSock, char *argv[]) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct sockaddr_un saUn;
+  struct msghdr      mh;
+  struct iovec       iov;
+  struct cmsghdr    *pcm;
+  char               acCtl[CMSG_SPACE(sizeof(int)*3)];
+  char               acReq[POOL_REQ_BUF];
+  int                aiFds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+  uint32_t           u4Len;
+  int32_t            i4Ret;
+  int                iSock, i, j;
+
+  /*--- Make the request "cwd\0arg0\0arg1\0..." --------------------*/
+  if (getcwd(acReq, POOL_REQ_BUF) == NULL) {
+    error_exit(errno,"getcwd(): %s\n",strerror(errno));
+  }
+  u4Len = strlen(acReq) + 1;
+  for (i=0; argv[i]!=NULL; i++) {
+    if ((j=strlen(argv[i])+1) > POOL_REQ_BUF-(int)u4Len) {
+      error_exit(1,"Too long arguments for -C\n");
+    }
+    memcpy(acReq+u4Len, argv[i], j);
+    u4Len += j;
+  }
+
+  /*--- Connect to the server --------------------------------------*/
+  if (strlen(pszSock) >= sizeof(saUn.sun_path)) {
+    error_exit(1,"%s: Too long socket path\n",pszSock);
+  }
+  if ((iSock=socket(AF_UNIX,SOCK_STREAM,0)) < 0) {
+    error_exit(errno,"socket(): %s\n",strerror(errno));
   }
+  memset(&saUn, 0, sizeof(saUn));
+  saUn.sun_family = AF_UNIX;
+  strcpy(saUn.sun_path, pszSock);
+  if (connect(iSock,(struct sockaddr *)&saUn,sizeof(saUn)) < 0) {
+    error_exit(errno,"connect(%s): %s\n",pszSock,strerror(errno));
+  }
+
+  /*--- Send the length with my stdin/stdout/stderr, then the request */
+  memset(&mh, 0, sizeof(mh));
+  memset(acCtl, 0, sizeof(acCtl));
+  iov.iov_base          = &u4Len;
+  iov.iov_len           = sizeof(u4Len);
+  mh.msg_iov            = &iov;
+  mh.msg_iovlen         = 1;
+  mh.msg_control        = acCtl;
+  mh.msg_controllen     = sizeof(acCtl);
+  pcm                   = CMSG_FIRSTHDR(&mh);
+  pcm->cmsg_level       = SOL_SOCKET;
+  pcm->cmsg_type        = SCM_RIGHTS;
+  pcm->cmsg_len         = CMSG_LEN(sizeof(int)*3);
+  memcpy(CMSG_DATA(pcm), aiFds, sizeof(int)*3);
+  if (sendmsg(iSock, &mh, 0) != sizeof(u4Len)) {
+    error_exit(errno,"sendmsg(): %s\n",strerror(errno));
+  }
+  for (j=0; j<(int)u4Len; j+=i) {
+    if ((i=(int)write(iSock, acReq+j, u4Len-j)) < 0) {
+      if (errno == EINTR) {i=0; continue;}
+      error_exit(errno,"write() for -C: %s\n",strerror(errno));
+    }
+  }
+
+  /*--- Wait for the exit status -----------------------------------*/
+  for (j=0; j<(int)sizeof(i4Ret); j+=i) {
+    if ((i=(int)read(iSock, (char*)&i4Ret+j, sizeof(i4Ret)-j)) <= 0) {
+      if (i < 0 && errno == EINTR) {i=0; continue;}
+      error_exit(255,"The server has closed the connection\n");
+    }
+  }
+  close(iSock);
+  return (int)i4Ret;
 }
-/*--- Close the PTY ------------------------------------------------*/
-close(giFd1m); giFd1m=-1;
 
-/*=== Wait for the child to exit ===================================*/
-if (wait(&i) < 0) {error_exit(errno,"wait(): %s\n", strerror(errno));}
-iRet = (WIFEXITED(i)  ) ? WEXITSTATUS(i)  :
-       (WIFSIGNALED(i)) ? WTERMSIG(i)+127 :
-                          254             ;
+/*=== SIGNALTRAP : Remove the socket of the server and exit (-S) =====*/
+void remove_pool_sock(int iSig) {
+  if (gpszPoolSock != NULL) {unlink(gpszPoolSock);}
+  _exit(0);
+}
+#endif
 
-/*=== Finish with exit status the child returned basically =========*/
-return iRet;}
+/*=== Transceive data from the PTY with coalescing ===================
+ * [in] giFd1m      : PTY master (must be defined as a global variable)
+ *      glCoalUsec  : Timeout for an incomplete line
+ *      giCoalBytes : Buffer size
+ * It returns when the PTY has reached EOF.                         */
+void transceive_coalesced(void) {
 
+  /*--- Variables --------------------------------------------------*/
+  char          *pszBuf ;  /* coalescing buffer                        */
+  int            iLen   ;  /* the number of bytes in the buffer        */
+  int            iNlEnd ;  /* the length up to the last '\n' in it     */
+  struct pollfd  pfd    ;
+  struct timespec tsNow, tsDue; /* tsDue: deadline of the oldest byte   */
+  struct timespec tsRead;  /* deadline of the bytes just read         */
+  struct timespec tsPart;  /* deadline of the oldest byte after the
+                              last '\n' (the incomplete line)          */
+  int64_t        i8Ms   ;
+  int            iWait, i, j;
 
+  /*--- Initialize -------------------------------------------------*/
+  if ((pszBuf=malloc(giCoalBytes)) == NULL) {
+    error_exit(errno,"malloc() for -c: %s\n", strerror(errno));
+  }
+  iLen   = 0;
+  iNlEnd = 0;
+  memset(&tsDue , 0, sizeof(tsDue ));
+  memset(&tsPart, 0, sizeof(tsPart));
+  pfd.fd     = giFd1m;
+  pfd.events = POLLIN;
 
-/*####################################################################
-# Functions
-####################################################################*/
+  while (1) {
+
+    /*--- Decide how long to wait for the next data ----------------*/
+    if        (iLen == 0) {
+      iWait = -1; i8Ms = 1;            /* nothing to flush           */
+    } else {
+      if (clock_gettime(CLOCK_MONOTONIC,&tsNow) != 0) {
+        error_exit(errno,"clock_gettime(): %s\n", strerror(errno));
+      }
+      i8Ms = ((int64_t)(tsDue.tv_sec -tsNow.tv_sec )*1000000000
+             +         (tsDue.tv_nsec-tsNow.tv_nsec)+999999   )/1000000;
+      if      (i8Ms <= 0) {iWait = 0;} /* the deadline has passed     */
+      else if (iNlEnd >0) {iWait = 0;} /* lines are ready to write    */
+      else                {iWait = (i8Ms>INT_MAX) ? INT_MAX : (int)i8Ms;}
+    }
+
+    /*--- Wait for the data ----------------------------------------*/
+    if ((i=poll(&pfd,1,iWait)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"poll() on mono RX: %s\n", strerror(errno));
+    }
+    if (i == 0) {
+      /* The command pauses: write the complete lines if the deadline
+         hasn't come yet, or everything otherwise                    */
+      if (iNlEnd > 0 && i8Ms > 0) {
+        write_out(pszBuf, iNlEnd);
+        memmove(pszBuf, pszBuf+iNlEnd, iLen-iNlEnd);
+        iLen  -= iNlEnd;
+        iNlEnd = 0;
+        tsDue  = tsPart; /* the rest is only the incomplete line */
+      } else {
+        write_out(pszBuf, iLen);
+        iLen   = 0;
+        iNlEnd = 0;
+      }
+      continue;
+    }
+
+    /*--- Read the data into the buffer directly -------------------*/
+    j = (int)read(giFd1m, pszBuf+iLen, giCoalBytes-iLen);
+    if (j < 0) {
+      if (errno == EINTR) {continue;}
+      if (errno != EIO  ) {
+        error_exit(errno,"read() on mono RX: %s\n", strerror(errno));
+      }
+      /* EIO suggests that the child is already dead (see main()) */
+      if (giVerbose > 0) {warning("read() on mono RX: EIO occured\n");}
+      j = 0;
+    }
+    if (j == 0) {break;}
+    if (clock_gettime(CLOCK_MONOTONIC,&tsRead) != 0) {
+      error_exit(errno,"clock_gettime(): %s\n", strerror(errno));
+    }
+    tsRead.tv_sec  += glCoalUsec/1000000;
+    tsRead.tv_nsec += (glCoalUsec%1000000)*1000;
+    if (tsRead.tv_nsec >= 1000000000) {tsRead.tv_sec++; tsRead.tv_nsec-=1000000000;}
+    if (iLen == 0     ) {tsDue  = tsRead;}
+    if (iLen == iNlEnd) {tsPart = tsRead;} /* an incomplete line starts */
+    for (i=iLen+j-1; i>=iLen; i--) {
+      if (pszBuf[i] == '\n') {iNlEnd = i+1; tsPart = tsRead; break;}
+    }
+    iLen += j;
+
+    /*--- Write everything if the buffer is full -------------------*/
+    if (iLen >= giCoalBytes) {
+      write_out(pszBuf, iLen);
+      iLen   = 0;
+      iNlEnd = 0;
+    }
+  }
+
+  /*--- Write the rest ---------------------------------------------*/
+  write_out(pszBuf, iLen);
+  free(pszBuf);
+}
+
+/*=== Write all the data to STDOUT ===================================*/
+void write_out(char *pszBuf, int iLen) {
+  int i;
+  while (iLen > 0) {
+    if ((i=(int)write(STDOUT_FILENO, pszBuf, iLen)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write() on mono RX: %s\n",strerror(errno));
+    }
+    pszBuf += i;
+    iLen   -= i;
+  }
+}
 
 #ifdef RAWMODE_FOR_MASTER
   /*=== (Exit trap) Restore the termios parameters for master ========*/
@@ -0,0 +1,1746 @@
+/*####################################################################
+#
+# SIGAMP-NATIVE - The Native Formula Engine for "sigamp"
+#
+# USAGE   : sigamp-native [-a rules] formula#1 [formula#2 [...]] [file]
+#           sigamp-native -b type[:type] [-c channels] formula#1 [...] [file]
+# Args    : file .... Filepath for data source
+#           formula . Amplifying rule for the field #n ($n)
+#                     (See the usage of "sigamp" for the details)
+# Options : -a ...... The number rules of the AWK to follow, which
+#                     "sigamp" gives after asking the AWK on the host.
+#                     "32", "64" or "0" means that an integral number
+#                     is printed as an integer when it is within the
+#                     32-bit int, the 64-bit int or always, and "x"
+#                     after it means that hexadecimal strings such as
+#                     "0x10" are read as numbers. ("32x" by default,
+#                     which are the rules of mawk on glibc)
+#           -b ...... Binary mode : Read the interleaved samples of the
+#                     type and write them in the type after ":" (the
+#                     same type if omitted). The types are "s16",
+#                     "s32" and "f32", followed by "le" or "be"
+#                     for the byte order (the host's one if omitted).
+#           -c ...... The number of the channels in the binary mode
+#                     (the number of the formulas by default). The
+#                     formula #n is for the channel #n, and the
+#                     channels without formulas are output as they
+#                     are.
+# Retuen  : Return 0 only when finished successfully
+#
+# * This is the engine which the "sigamp" command in the upper
+#   directory uses when it has been compiled. It parses the formulas
+#   by the same grammar once into a chain of operations per output
+#   field instead of generating an AWK program, and makes exactly the
+#   same output as AWK does, which means
+#   - every constant in a formula is rounded off to the 6 significant
+#     digits as AWK prints it into the generated program,
+#   - the operations are done on "double" in the same order as the
+#     generated expression does,
+#   - a field which is output as it is ("=", "+0", "*1" and so on)
+#     keeps its original string, and the comparisons in the rounding
+#     and constraining functions follow the rules for the strings
+#     and "strnum"s of AWK,
+#   - a number is printed as an integer when it is an integral value
+#     within the range which -a gives (the 32-bit int for mawk, the
+#     64-bit int for BWK awk and BusyBox, any for gawk), otherwise by
+#     "%.6g", and a field such as "0x10" is read as a hexadecimal
+#     number only when -a has "x" (mawk on glibc, old BWK awk).
+#     (The infinities and NaNs are read and printed by the C library
+#     as mawk does, which some AWKs spell otherwise.)
+# * The numbers in the fields are parsed by the exact fast path
+#   (Clinger's) when they are plain decimals within 19 significant
+#   digits, and printed by an exact fast "%.6g" when they are not
+#   close to a tie. The others are left to strtod() and printf().
+# * In the binary mode, the samples in every 4096 frames are split
+#   into a plane of "double" per channel, and each operation and
+#   function of the formula is applied to the whole plane at a time,
+#   4 samples at a time by AVX2 if the CPU supports it. The results
+#   are the same as the text mode's. The integer types are rounded
+#   off as "r0" does and saturated into their range (NaN into 0)
+#   while the plane is stored. The channels which are output as they
+#   are ("=" or no formula) are copied without planes when the input
+#   and the output types are the same.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lm
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -o __CMDNAME__ __SRCNAME__ -lm
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF      1048576 /* initial size of the input buffer        */
+#define OBUF      1048576 /* size of the output buffer               */
+#define OBUF_MARG 4096    /* flush the output when less room than it */
+#define MAX_INT   2147483647.0 /* "Max_Int" of mawk (32-bit int)     */
+#define MAX_LL    9223372036854775808.0 /* 2^63 (64-bit int)         */
+#define NUMBUF    320     /* size of a buffer for a formatted number */
+#define BFRAMES   4096    /* frames in a block in the binary mode    */
+/* the kinds of the base of a formula */
+#define BASE_RAW   0   /* $n itself (printed as it is)              */
+#define BASE_NUM   1   /* the number of $n with operations          */
+#define BASE_CONST 2   /* a constant                                */
+#define BASE_NONE  3   /* nothing (the uninitialized AWK variable)  */
+/* the operations and the functions applied to the base */
+#define OP_ADD     0
+#define OP_MUL     1
+#define OP_DIV     2
+#define FN_ROUND   0   /* r(), f() or c() with the scale            */
+#define FN_LIMIT   1   /* m() with the lower/upper limits           */
+/* the types of the AWK values */
+#define AV_NUM     0
+#define AV_STR     1
+#define AV_STRNUM  2
+#define AV_UNINIT  3
+/* the results of parsing an argument */
+#define PARSE_OK   0
+#define PARSE_END  1   /* it is not a formula (maybe a file)        */
+#define PARSE_INV -1   /* it is an invalid formula                  */
+/* the sample types in the binary mode */
+#define TY_S16     0
+#define TY_S32     1
+#define TY_F32     2
+
+/*--- data structures ----------------------------------------------*/
+typedef struct {
+  int    iOp;    /* OP_ADD, OP_MUL or OP_DIV                        */
+  double d;      /* the operand                                     */
+} oper_t;
+typedef struct {
+  int    iFn;    /* FN_ROUND or FN_LIMIT                            */
+  char   cKind;  /* 'r', 'f' or 'c' for FN_ROUND                    */
+  double dScale; /* the scale for FN_ROUND (1 means no scaling)     */
+  int    iHasMin, iHasMax; /* 1 when the limit is given for FN_LIMIT */
+  double dMin, dMax;       /* the limits for FN_LIMIT               */
+} func_t;
+typedef struct {
+  int     iBase;  /* BASE_RAW, BASE_NUM, BASE_CONST or BASE_NONE    */
+  int     iField; /* the field number of the base (0 means $0)      */
+  double  dConst; /* the constant for BASE_CONST                    */
+  int     iNops;  /* the number of the operations                   */
+  oper_t  aOp[4]; /* the operations applied to the base in order    */
+  int     iNfns;  /* the number of the functions                    */
+  func_t *pFn;    /* the functions applied after them in order      */
+} formula_t;
+typedef struct {
+  int         iType; /* AV_NUM, AV_STR, AV_STRNUM or AV_UNINIT      */
+  double      d;     /* the value as a number                       */
+  const char *p;     /* the string (for AV_STR and AV_STRNUM)       */
+  size_t      n;     /* the length of it                            */
+} aval_t;
+typedef struct {
+  int iType;         /* TY_S16, TY_S32 or TY_F32                    */
+  int iSize;         /* the size of a sample in bytes               */
+  int iBig;          /* 1 when it is big-endian                     */
+} stype_t;
+
+/*--- prototype functions ------------------------------------------*/
+int    parse_formula(const char *pszArg, int iNr, formula_t *pF);
+int    parse_1st_field(char *psz1, formula_t *pF, const formula_t *pLast);
+int    add_functions(const char *psz, formula_t *pF);
+size_t match_an(const char *psz);
+size_t match_rn(const char *psz);
+double str2num(const char *p, size_t n);
+double awkconst(double d);
+int    is_hex(const char *p, size_t n);
+int    is_strnum(const char *p, size_t n);
+size_t fmtnum(double d, char *pszBuf);
+size_t fmt_g6(double d, char *pszBuf);
+int    awkcmp(const aval_t *pA, const aval_t *pB);
+double awkint(double d);
+void   eval_formula(const formula_t *pF, char *const *ppcFld,
+                    const size_t *puLen, int iNf, aval_t *pV);
+void   amplify(int iFd);
+size_t parse_stype(const char *psz, stype_t *pT);
+double round1(int iKind, double d);
+double limit1(const func_t *pFn, double d);
+void   amplify_binary(int iFd, const stype_t *pIn, const stype_t *pOut,
+                      int iNch);
+void   apply_formula(const formula_t *pF, double *pd, size_t n);
+void   copy_plane(const uint8_t *pu8In, size_t uStepIn, uint8_t *pu8Out,
+                  size_t uStepOut, size_t n, int iSize);
+void   load_plane(const uint8_t *pu8, size_t uStep, size_t n,
+                  const stype_t *pT, double *pd);
+void   store_plane(uint8_t *pu8, size_t uStep, size_t n,
+                   const stype_t *pT, const double *pd);
+void   init_kernels(void);
+void   op_scalar(double *pd, size_t n, int iOp, double dC);
+void   round_scalar(double *pd, size_t n, int iKind, double dScale);
+void   limit_scalar(double *pd, size_t n, const func_t *pFn);
+#ifdef HAVE_X86SIMD
+  void op_avx2(double *pd, size_t n, int iOp, double dC);
+  void round_avx2(double *pd, size_t n, int iKind, double dScale);
+  void limit_avx2(double *pd, size_t n, const func_t *pFn);
+  void load_plane_avx2(const uint8_t *pu8, size_t uStep, size_t n,
+                       const stype_t *pT, double *pd);
+  void store_plane_avx2(uint8_t *pu8, size_t uStep, size_t n,
+                        const stype_t *pT, const double *pd);
+#endif
+void   out_bytes(const char *p, size_t n);
+void   out_flush(void);
+
+/*--- global variables ---------------------------------------------*/
+char*      gpszCmdname;   /* The name of this command               */
+formula_t* gaFml;         /* The formulas                           */
+int        giNfml;        /* The number of them                     */
+int        giMaxFld;      /* The largest field number referred to   */
+char       gacOut[OBUF];  /* The output buffer                      */
+size_t     guOut;         /* The length of the data in it           */
+int        giIntBits = 32;/* Integers are printed within it (0: all)*/
+int        giHex     = 1; /* 1 when hexadecimal strings are numbers  */
+/* The powers of 10 which are exact in "double"                     */
+static const double gadP10[23] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+/* The kernels for the binary mode (chosen on the CPU)              */
+void (*gpfOp   )(double*, size_t, int, double) = op_scalar;
+void (*gpfRound)(double*, size_t, int, double) = round_scalar;
+void (*gpfLimit)(double*, size_t, const func_t*) = limit_scalar;
+void (*gpfLoad )(const uint8_t*, size_t, size_t, const stype_t*, double*)
+                 = load_plane;
+void (*gpfStore)(uint8_t*, size_t, size_t, const stype_t*, const double*)
+                 = store_plane;
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-a rules] formula#1 [formula#2 [...]] [file]\n"
+    "          %s -b type[:type] [-c channels] formula#1 [...] [file]\n"
+    "Args    : file .... Filepath for data source\n"
+    "          formula . Amplifying rule for the field #n ($n)\n"
+    "                    (See the usage of \"sigamp\" for the details)\n"
+    "Options : -a ...... The number rules of the AWK to follow, which\n"
+    "                    \"sigamp\" gives after asking the AWK on the host.\n"
+    "                    \"32\", \"64\" or \"0\" means that an integral number\n"
+    "                    is printed as an integer when it is within the\n"
+    "                    32-bit int, the 64-bit int or always, and \"x\"\n"
+    "                    after it means that hexadecimal strings such as\n"
+    "                    \"0x10\" are read as numbers. (\"32x\" by default,\n"
+    "                    which are the rules of mawk on glibc)\n"
+    "          -b ...... Binary mode : Read the interleaved samples of the\n"
+    "                    type and write them in the type after \":\" (the\n"
+    "                    same type if omitted). The types are \"s16\",\n"
+    "                    \"s32\" and \"f32\", followed by \"le\" or \"be\"\n"
+    "                    for the byte order (the host's one if omitted).\n"
+    "          -c ...... The number of the channels in the binary mode\n"
+    "                    (the number of the formulas by default). The\n"
+    "                    formula #n is for the channel #n, and the\n"
+    "                    channels without formulas are output as they\n"
+    "                    are.\n"
+    "Retuen  : Return 0 only when finished successfully\n"
+    "Version : 2026-10-19 01:27:36 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  const char  *pszFile, *psz;
+  struct stat  stFile;
+  stype_t      stIn, stOut;
+  size_t       u;
+  int          iBinary; /* 1 when -b option is set */
+  int          iNch;    /* the number of the channels (-c) */
+  int          iFd, iRet, i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  argc--;
+  argv++;
+
+  /*=== Parse options ==============================================*/
+  /* (getopt() is not used because a formula can begin with "-")    */
+  iBinary = 0;
+  iNch    = 0;
+  while (argc > 0) {
+    if      (strncmp(argv[0],"-a",2)==0) {i = 'a';}
+    else if (strncmp(argv[0],"-b",2)==0) {i = 'b';}
+    else if (strncmp(argv[0],"-c",2)==0) {i = 'c';}
+    else                                 {break;  }
+    if      (argv[0][2] != '\0') {psz = argv[0]+2;               }
+    else if (argc > 1          ) {psz = argv[1]; argc--; argv++;}
+    else                         {print_usage_and_exit();        }
+    argc--;
+    argv++;
+    switch (i) {
+      case 'a': if      (strncmp(psz,"32",2)==0) {giIntBits=32; psz+=2;}
+                else if (strncmp(psz,"64",2)==0) {giIntBits=64; psz+=2;}
+                else if (psz[0]=='0'           ) {giIntBits= 0; psz++;  }
+                else                             {print_usage_and_exit();}
+                giHex = (psz[0]=='x');
+                if (psz[giHex] != '\0') {print_usage_and_exit();}
+                break;
+      case 'b': if ((u=parse_stype(psz,&stIn)) == 0) {print_usage_and_exit();}
+                stOut = stIn;
+                if (psz[u] == ':') {
+                  psz += u+1;
+                  if ((u=parse_stype(psz,&stOut)) == 0) {
+                    print_usage_and_exit();
+                  }
+                }
+                if (psz[u] != '\0') {print_usage_and_exit();}
+                iBinary = 1;
+                break;
+      default : if (strspn(psz,"0123456789")!=strlen(psz) ||
+                    (iNch=atoi(psz)) < 1                     ) {
+                  print_usage_and_exit();
+                }
+                break;
+    }
+  }
+  if (iNch>0 && ! iBinary) {print_usage_and_exit();}
+
+  /*=== Parse the formulas =========================================*/
+  /* (No option is accepted because a formula can begin with "-".)  */
+  if ((gaFml=(formula_t*)calloc((argc>0)?argc:1,sizeof(formula_t)))==NULL){
+    error_exit(errno,"calloc() #1: %s\n",strerror(errno));
+  }
+  giNfml   = 0;
+  giMaxFld = 0;
+  do {
+    iRet = parse_formula((argc>0)?argv[giNfml]:"",giNfml+1,&gaFml[giNfml]);
+    if (iRet == PARSE_INV) {error_exit(1,"Invalid formula\n");}
+    if (iRet == PARSE_END) {break;                             }
+    giNfml++;
+  } while (giNfml < argc);
+  if (giNfml == 0) {print_usage_and_exit();}
+  for (i=0; i<giNfml; i++) {
+    if (gaFml[i].iField > giMaxFld) {giMaxFld = gaFml[i].iField;}
+  }
+  argc -= giNfml;
+  argv += giNfml;
+
+  /*=== Parse the source file path =================================*/
+  switch (argc) {
+    case 0 : pszFile = "-";     break;
+    case 1 : pszFile = argv[0]; break;
+    default: print_usage_and_exit();
+  }
+  if (strcmp(pszFile,""               )==0 ||
+      strcmp(pszFile,"-"              )==0 ||
+      strcmp(pszFile,"/dev/stdin"     )==0 ||
+      strcmp(pszFile,"/dev/fd/0"      )==0 ||
+      strcmp(pszFile,"/proc/self/fd/0")==0  ) {
+    iFd = STDIN_FILENO;
+  } else {
+    if (stat(pszFile,&stFile) < 0) {print_usage_and_exit();}
+    if (! S_ISREG(stFile.st_mode) && ! S_ISCHR(stFile.st_mode) &&
+        ! S_ISFIFO(stFile.st_mode)                              ) {
+      print_usage_and_exit();
+    }
+    if ((iFd=open(pszFile,O_RDONLY)) < 0) {
+      error_exit(1,"Cannot open the file: %s\n",pszFile);
+    }
+  }
+
+  /*=== Validate the expressions ===================================*/
+  for (i=0; i<giNfml; i++) {
+    if (gaFml[i].iBase==BASE_NONE && gaFml[i].iNfns==0 && giNfml==1) {
+      /* The generated program is "print" (of the whole line) */
+      gaFml[i].iBase  = BASE_RAW;
+      gaFml[i].iField = 0;
+    }
+    if (gaFml[i].iBase==BASE_NONE && (gaFml[i].iNfns==0          ||
+                                      gaFml[i].pFn[0].iFn!=FN_ROUND ||
+                                      gaFml[i].pFn[0].dScale!=1     )) {
+      /* AWK rejects the generated program because only "r()",
+       * "f()" and "c()" are valid with the empty expression        */
+      error_exit(2,"The formula #%d makes no expression\n",i+1);
+    }
+  }
+
+  /*=== Amplify ====================================================*/
+  if (! iBinary) {
+    amplify(iFd);
+  } else {
+    if (iNch == 0     ) {iNch = giNfml;}
+    if (iNch < giNfml ) {error_exit(1,"There are more formulas than -c\n");}
+    init_kernels();
+    amplify_binary(iFd, &stIn, &stOut, iNch);
+  }
+
+  /*=== Finish =====================================================*/
+  return 0;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Parse an argument into a formula ===============================
+ * It follows the "sed"s and the AWK code generator in "sigamp".
+ * [in]  pszArg : the argument
+ *       iNr    : the field number for it (1-)
+ * [out] pF     : the parsed formula
+ * [ret] PARSE_OK, PARSE_END (not a formula) or PARSE_INV (invalid)  */
+int parse_formula(const char *pszArg, int iNr, formula_t *pF) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char *pszLine = NULL;
+  static size_t uSize  = 0;
+  static const formula_t *pLast = NULL; /* the last one setting "f" */
+  char   *psz0, *psz1, *psz2;
+  char   *pszSep;
+  size_t  uLen, u, v;
+  int     iRet;
+
+  /*--- Insert "+0/" if the arg has only additional operations -----*/
+  uLen = strlen(pszArg);
+  if (uSize < uLen+5) {
+    uSize = uLen+5;
+    if ((pszLine=(char*)realloc(pszLine,uSize))==NULL) {
+      error_exit(errno,"realloc() in parse_formula(): %s\n",strerror(errno));
+    }
+  }
+  psz0 = pszLine;
+  u    = strspn(pszArg,"0123456789");
+  if (pszArg[0]!='\0' && strchr("RrFfCc,",pszArg[0])!=NULL) {
+    /* "^[RrFfCc,]" */
+    strcpy(psz0,"+0/"); psz0 += 3;
+  } else if (u>0 && (pszArg[u]=='\0' || pszArg[u]=='/')) {
+    /* "^[0-9]+$" or "^[0-9]+/" */
+    strcpy(psz0,"+0/"); psz0 += 3;
+  } else {
+    /* "^[+-]?[0-9.]+,([+-]?[0-9.]+)?$" or the one ending with "/" */
+    u  = (pszArg[0]=='+' || pszArg[0]=='-') ? 1 : 0;
+    v  = strspn(pszArg+u,"0123456789.");
+    if (v>0 && pszArg[u+v]==',') {
+      u += v+1;
+      v  = (pszArg[u]=='+' || pszArg[u]=='-') ? 1 : 0;
+      if (v==0 || strspn(pszArg+u+v,"0123456789.")>0) {
+        u += v+strspn(pszArg+u+v,"0123456789.");
+        if (pszArg[u]=='\0' || pszArg[u]=='/') {
+          strcpy(psz0,"+0/"); psz0 += 3;
+        }
+      }
+    }
+  }
+  /* (The "sed"s removing the padded "0"s are omitted because they
+   *  change no value at all.)                                      */
+
+  /*--- Separate additional operating signs from the 1st field -----*/
+  /* (A " " is inserted before the first "/" which is not at the
+   *  head, and the line is split into $1 and $2 by blanks as AWK.) */
+  strcpy(psz0, pszArg);
+  if (pszLine[0]!='\0' && (pszSep=strchr(pszLine+1,'/'))!=NULL) {
+    memmove(pszSep+1, pszSep, strlen(pszSep)+1);
+    *pszSep = ' ';
+  }
+  memset(pF, 0, sizeof(formula_t));
+  pF->iField = iNr;
+
+  /*--- "=" : no-operation -----------------------------------------*/
+  if (strcmp(pszLine,"=")==0) {
+    pF->iBase = BASE_RAW;
+    return PARSE_OK;
+  }
+  psz1 = pszLine + strspn(pszLine," \t\n");
+  psz2 = psz1    + strcspn(psz1  ," \t\n");
+  if (*psz2 != '\0') {*psz2++ = '\0';}
+  psz2 = psz2    + strspn(psz2  ," \t\n");
+  psz2[strcspn(psz2," \t\n")] = '\0';
+
+  /*--- Parse $1 and then $2 ---------------------------------------*/
+  iRet = parse_1st_field(psz1, pF, pLast);
+  if (iRet == PARSE_OK) {iRet = add_functions(psz2, pF);}
+  if (iRet == PARSE_OK) {pLast = pF;                    }
+  return iRet;
+}
+
+/*=== Parse the 1st field of an argument =============================
+ * [in]  psz1  : the 1st field
+ *       pLast : the last formula which set the expression (or NULL).
+ *               The code generator leaves the expression untouched
+ *               for "*0" and "*0+b" and it remains the last one.
+ * [out] pF    : the parsed formula (iField must be set)
+ * [ret] PARSE_OK, PARSE_END (not a formula) or PARSE_INV (invalid)  */
+int parse_1st_field(char *psz1, formula_t *pF, const formula_t *pLast) {
+
+  /*--- Variables --------------------------------------------------*/
+  char   *pszColon, *pszComma;
+  size_t  u, uLen;
+  double  dXa, dXb, dYa, dYb, dXc, dYc, dI, dJ;
+  char    cOp;
+
+  /*--- "+b" : y=x+b -----------------------------------------------*/
+  if ((psz1[0]=='+' || psz1[0]=='-') &&
+      (u=match_an(psz1+1))>0 && psz1[1+u]=='\0') {
+    dJ = str2num(psz1, strlen(psz1));
+    if (dJ != 0) {
+      pF->iBase     = BASE_NUM;
+      pF->iNops     = 1;
+      pF->aOp[0].iOp = OP_ADD;
+      pF->aOp[0].d   = dJ;
+    } else {
+      pF->iBase     = BASE_RAW;
+    }
+    return PARSE_OK;
+  }
+
+  /*--- "*a+b" : y=ax+b --------------------------------------------*/
+  if (psz1[0]=='x' || psz1[0]=='*' || psz1[0]=='/') {
+    cOp = (psz1[0]=='/') ? '/' : '*';
+    if ((u=match_rn(psz1+1)) > 0) {
+      uLen = u;
+      if (psz1[1+u]=='\0') {
+        dJ = 0;
+      } else if ((psz1[1+u]=='+' || psz1[1+u]=='-') &&
+                 (uLen=match_an(psz1+2+u))>0 && psz1[2+u+uLen]=='\0') {
+        dJ = str2num(psz1+1+u, uLen+1);
+      } else {
+        uLen = 0;
+      }
+      if (uLen > 0) {
+        dI = str2num(psz1+1, u);
+        if (cOp=='/' && dI==0) {return PARSE_INV;}
+        if (dI==1 && dJ==0) {
+          pF->iBase = BASE_RAW;
+        } else if (dI==1) {
+          pF->iBase = BASE_NUM;
+          pF->aOp[pF->iNops  ].iOp = OP_ADD;
+          pF->aOp[pF->iNops++].d   = awkconst(dJ);
+        } else if (dI!=0) {
+          pF->iBase = BASE_NUM;
+          pF->aOp[pF->iNops  ].iOp = (cOp=='/') ? OP_DIV : OP_MUL;
+          pF->aOp[pF->iNops++].d   = awkconst(dI);
+          if (dJ != 0) {
+            pF->aOp[pF->iNops  ].iOp = OP_ADD;
+            pF->aOp[pF->iNops++].d   = awkconst(dJ);
+          }
+        } else if (pLast != NULL) {
+          /* "*0" and "*0+b" leave the last expression as it is */
+          *pF = *pLast;
+          if (pLast->iNfns > 0) {
+            if ((pF->pFn=(func_t*)malloc(pLast->iNfns*sizeof(func_t)))
+                ==NULL                                                ) {
+              error_exit(errno,"malloc() in parse_1st_field(): %s\n",
+                         strerror(errno));
+            }
+            memcpy(pF->pFn, pLast->pFn, pLast->iNfns*sizeof(func_t));
+          }
+        } else {
+          pF->iBase = BASE_NONE;
+        }
+        return PARSE_OK;
+      }
+    }
+  }
+
+  /*--- "s,t:u,v" : y=(v-u)/(t-s)*(x-s)+u --------------------------*/
+  if ((pszColon=strchr(psz1,':')) != NULL) {
+    *pszColon = '\0';
+    pszComma  = strchr(psz1,',');
+    if (pszComma == NULL) {
+      if ((u=match_rn(psz1))==0 || psz1[u]!='\0')  {return PARSE_END;}
+      dXa = 0;
+      dXb = str2num(psz1, u);
+    } else {
+      if ((u=match_rn(psz1))==0 || psz1+u!=pszComma) {return PARSE_END;}
+      dXa = str2num(psz1, u);
+      if ((u=match_rn(pszComma+1))==0 || pszComma[1+u]!='\0') {
+        return PARSE_END;
+      }
+      dXb = str2num(pszComma+1, u);
+    }
+    psz1     = pszColon + 1;
+    pszComma = strchr(psz1,',');
+    if (pszComma == NULL) {
+      if ((u=match_rn(psz1))==0 || psz1[u]!='\0')  {return PARSE_END;}
+      dYa = 0;
+      dYb = str2num(psz1, u);
+    } else {
+      if ((u=match_rn(psz1))==0 || psz1+u!=pszComma) {return PARSE_END;}
+      dYa = str2num(psz1, u);
+      if ((u=match_rn(pszComma+1))==0 || pszComma[1+u]!='\0') {
+        return PARSE_END;
+      }
+      dYb = str2num(pszComma+1, u);
+    }
+    dXc = dXb - dXa;
+    dYc = dYb - dYa;
+    if (dXc == 0) {return PARSE_INV;}
+    if (dYc == 0) {
+      pF->iBase  = BASE_CONST;
+      pF->dConst = awkconst(dYa);
+    } else {
+      if (dXc<0 && dYc<0) {dXc = -dXc; dYc = -dYc;}
+      pF->iBase  = BASE_NUM;
+      pF->iNops  = 4;
+      pF->aOp[0].iOp = OP_ADD; pF->aOp[0].d = -awkconst(dXa);
+      pF->aOp[1].iOp = OP_MUL; pF->aOp[1].d =  awkconst(dYc);
+      pF->aOp[2].iOp = OP_DIV; pF->aOp[2].d =  awkconst(dXc);
+      pF->aOp[3].iOp = OP_ADD; pF->aOp[3].d =  awkconst(dYa);
+    }
+    return PARSE_OK;
+  }
+
+  /*--- Otherwise, it is not a formula -----------------------------*/
+  return PARSE_END;
+}
+
+/*=== Add the rounding and the range limiting functions ==============
+ * [in]     psz : the string of the additional operations ("/...")
+ * [in,out] pF  : the formula to add them to
+ * [ret]    PARSE_OK or PARSE_END (when an invalid one is found)     */
+int add_functions(const char *psz, formula_t *pF) {
+
+  /*--- Variables --------------------------------------------------*/
+  func_t      stFn;
+  const char *pszTok, *pszComma;
+  size_t      uLen, u;
+  double      d;
+
+  /*--- Parse every "/..." -----------------------------------------*/
+  while (psz[0]=='/' && psz[1]!='/' && psz[1]!='\0') {
+    pszTok = psz + 1;
+    uLen   = strcspn(pszTok,"/");
+    psz    = pszTok + uLen;
+    memset(&stFn, 0, sizeof(stFn));
+    /* (a) rounding function */
+    u = (strchr("RrCcFf",pszTok[0])!=NULL) ? 1 : 0;
+    if (uLen>u && strspn(pszTok+u,"0123456789")==uLen-u) {
+      stFn.iFn   = FN_ROUND;
+      stFn.cKind = (u==0) ? 'r' : (char)(pszTok[0] | 0x20);
+      d = pow(10, str2num(pszTok+u, uLen-u));
+      /* the scale is printed into the program by "%d" of AWK, which
+       * is saturated into the 32-bit int by mawk */
+      stFn.dScale = (d==1 || giIntBits!=32) ? d
+                  : (d >= MAX_INT         ) ? MAX_INT : (double)(int)d;
+    } else {
+      /* (b) range limiting function */
+      u = (strchr("CcRr",pszTok[0])!=NULL) ? 1 : 0;
+      pszComma = memchr(pszTok+u, ',', uLen-u);
+      if (pszComma == NULL) {return PARSE_END;}
+      stFn.iFn = FN_LIMIT;
+      if (pszComma > pszTok+u) {
+        if (match_rn(pszTok+u) != (size_t)(pszComma-pszTok-u)) {
+          return PARSE_END;
+        }
+        stFn.iHasMin = 1;
+        stFn.dMin    = awkconst(str2num(pszTok+u, pszComma-pszTok-u));
+      }
+      if (pszComma+1 < pszTok+uLen) {
+        if (match_rn(pszComma+1) != (size_t)(pszTok+uLen-pszComma-1)) {
+          return PARSE_END;
+        }
+        stFn.iHasMax = 1;
+        stFn.dMax    = awkconst(str2num(pszComma+1, pszTok+uLen-pszComma-1));
+      }
+    }
+    if ((pF->pFn=(func_t*)realloc(pF->pFn,(pF->iNfns+1)*sizeof(func_t)))
+        ==NULL                                                         ) {
+      error_exit(errno,"realloc() in add_functions(): %s\n",
+                 strerror(errno));
+    }
+    pF->pFn[pF->iNfns++] = stFn;
+  }
+
+  return PARSE_OK;
+}
+
+/*=== Match "[0-9]+(\.[0-9]+)?" at the head ==========================
+ * [in] psz : the string
+ * [ret]      the length of the longest match (0 if unmatched)      */
+size_t match_an(const char *psz) {
+  size_t u, u2;
+
+  if ((u=strspn(psz,"0123456789")) == 0) {return 0;}
+  if (psz[u]=='.' && (u2=strspn(psz+u+1,"0123456789"))>0) {u += 1+u2;}
+  return u;
+}
+
+/*=== Match "[+-]?[0-9]+(\.[0-9]+)?" at the head =====================
+ * [in] psz : the string
+ * [ret]      the length of the longest match (0 if unmatched)      */
+size_t match_rn(const char *psz) {
+  size_t u;
+
+  u = (psz[0]=='+' || psz[0]=='-') ? 1 : 0;
+  return (match_an(psz+u)>0) ? u+match_an(psz+u) : 0;
+}
+
+/*=== Convert a string into a number as AWK does =====================
+ * The plain decimals within 19 significant digits and the exponent
+ * which 10^n is exact for are converted by the exact fast path, and
+ * the others are by strtod() as AWK does, except that a hexadecimal
+ * string is 0 unless the AWK reads it (giHex).
+ * [in] p, n : the string and the length of it
+ * [ret]       the number                                           */
+double str2num(const char *p, size_t n) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char *pszTmp = NULL;
+  static size_t uTmp  = 0;
+  const char *pEnd = p + n;
+  const char *q;
+  uint64_t    u64W;
+  int         iNeg, iSig, iDigits, iExp, iExpNeg, iE10;
+  double      d;
+
+  /*--- Try the fast path ------------------------------------------*/
+  do {
+    q    = p;
+    iNeg = 0;
+    if (q<pEnd && (*q=='+' || *q=='-')) {iNeg = (*q=='-'); q++;}
+    u64W = 0; iSig = 0; iDigits = 0; iE10 = 0;
+    for (; q<pEnd && *q>='0' && *q<='9'; q++) {
+      iDigits++;
+      if (u64W==0 && *q=='0') {continue;}
+      if (++iSig > 19) {break;}
+      u64W = u64W*10 + (uint64_t)(*q-'0');
+    }
+    if (iSig > 19) {break;}
+    if (q<pEnd && *q=='.') {
+      for (q++; q<pEnd && *q>='0' && *q<='9'; q++) {
+        iDigits++;
+        iE10--;
+        if (u64W==0 && *q=='0') {continue;}
+        if (++iSig > 19) {break;}
+        u64W = u64W*10 + (uint64_t)(*q-'0');
+      }
+      if (iSig > 19) {break;}
+    }
+    if (iDigits == 0) {break;}
+    if (q<pEnd && (*q=='e' || *q=='E')) {
+      q++;
+      iExpNeg = 0;
+      if (q<pEnd && (*q=='+' || *q=='-')) {iExpNeg = (*q=='-'); q++;}
+      if (q>=pEnd || *q<'0' || *q>'9') {break;}
+      for (iExp=0; q<pEnd && *q>='0' && *q<='9' && iExp<10000; q++) {
+        iExp = iExp*10 + (*q-'0');
+      }
+      iE10 += iExpNeg ? -iExp : iExp;
+    }
+    if (q != pEnd) {break;}
+    if (u64W == 0) {return iNeg ? -0.0 : 0.0;}
+    if (u64W > ((uint64_t)1<<53) || iE10 < -22 || iE10 > 22) {break;}
+    d = (double)u64W;
+    d = (iE10 >= 0) ? d*gadP10[iE10] : d/gadP10[-iE10];
+    return iNeg ? -d : d;
+  } while (0);
+
+  /*--- Otherwise, use strtod() ------------------------------------*/
+  if (uTmp < n+1) {
+    uTmp = n+1;
+    if ((pszTmp=(char*)realloc(pszTmp,uTmp))==NULL) {
+      error_exit(errno,"realloc() in str2num(): %s\n",strerror(errno));
+    }
+  }
+  if (! giHex && is_hex(p, n)) {return 0;}
+  memcpy(pszTmp, p, n);
+  pszTmp[n] = '\0';
+  return strtod(pszTmp, NULL);
+}
+
+/*=== Test whether a string begins with a hexadecimal prefix =========
+ * [in] p, n : the string and the length of it
+ * [ret]       1 if it is "0x" or "0X" after spaces and a sign, or 0 */
+int is_hex(const char *p, size_t n) {
+  const char *q = p + n;
+
+  while (p<q && (*p==' ' || *p=='\t' || *p=='\n')) {p++;}
+  if    (p<q && (*p=='+' || *p=='-')             ) {p++;}
+  return (q-p >= 2 && p[0]=='0' && (p[1]=='x' || p[1]=='X')) ? 1 : 0;
+}
+
+/*=== Round off a constant to what AWK prints into the program =======
+ * [in] d : the constant
+ * [ret]    the number which the printed string means               */
+double awkconst(double d) {
+  char szBuf[NUMBUF];
+  size_t u;
+
+  u = fmtnum(d, szBuf);
+  return str2num(szBuf, u);
+}
+
+/*=== Test whether a field string looks numeric ("strnum") ===========
+ * [in] p, n : the string and the length of it
+ * [ret]       1 if it is a "strnum", or 0                          */
+int is_strnum(const char *p, size_t n) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char *pszTmp = NULL;
+  static size_t uTmp  = 0;
+  const char *q;
+  char *pszEnd;
+
+  /*--- Trim the spaces and check the head and the tail ------------*/
+  q = p + n;
+  while (p<q && (*p  ==' ' || *p  =='\t' || *p  =='\n')) {p++;}
+  while (p<q && (q[-1]==' ' || q[-1]=='\t' || q[-1]=='\n')) {q--;}
+  if (p == q) {return 0;}
+  if ((q[-1]<'0' || q[-1]>'9') && q[-1]!='.') {return 0;}
+  if ((*p<'0' || *p>'9') && *p!='+' && *p!='-' && *p!='.') {return 0;}
+
+  /*--- The whole of it must be a number without overflow ----------*/
+  n = (size_t)(q-p);
+  if (! giHex && is_hex(p, n)) {return 0;}
+  if (uTmp < n+1) {
+    uTmp = n+1;
+    if ((pszTmp=(char*)realloc(pszTmp,uTmp))==NULL) {
+      error_exit(errno,"realloc() in is_strnum(): %s\n",strerror(errno));
+    }
+  }
+  memcpy(pszTmp, p, n);
+  pszTmp[n] = '\0';
+  errno = 0;
+  strtod(pszTmp, &pszEnd);
+  return (pszEnd==pszTmp+n && errno!=ERANGE) ? 1 : 0;
+}
+
+/*=== Format a number as AWK prints it (by OFMT/CONVFMT "%.6g") ======
+ * An integral number is printed as an integer when it is within the
+ * range of giIntBits (any range if 0).
+ * [in]  d      : the number
+ * [out] pszBuf : the string (needs NUMBUF bytes)
+ * [ret]          the length of it                                  */
+size_t fmtnum(double d, char *pszBuf) {
+  char     acTmp[24];
+  size_t   u, uLen;
+  uint64_t u64;
+
+  if (((giIntBits==32) ? (d >= -MAX_INT && d <= MAX_INT)
+                       : (d >= -MAX_LL  && d <  MAX_LL )) && floor(d) == d) {
+    uLen = 0;
+    if (d < 0) {pszBuf[uLen++] = '-'; u64 = (uint64_t)(-d);}
+    else       {                      u64 = (uint64_t)( d);}
+    u = 0;
+    do {acTmp[u++] = (char)('0' + u64%10); u64 /= 10;} while (u64 > 0);
+    while (u > 0) {pszBuf[uLen++] = acTmp[--u];}
+    pszBuf[uLen] = '\0';
+    return uLen;
+  }
+  if (giIntBits == 0 && floor(d) == d && ! isinf(d)) {
+    return (size_t)snprintf(pszBuf, NUMBUF, "%.0f", d);
+  }
+  return fmt_g6(d, pszBuf);
+}
+
+/*=== Format a number by "%.6g" ======================================
+ * The 6 significant digits are made by one exact multiplication or
+ * division by a power of 10, which is enough unless it is close to a
+ * tie. The other cases are left to snprintf().
+ * [in]  d      : the number
+ * [out] pszBuf : the string (needs 32 bytes at least)
+ * [ret]          the length of it                                  */
+size_t fmt_g6(double d, char *pszBuf) {
+
+  /*--- Variables --------------------------------------------------*/
+  char    acDig[6];
+  double  dAbs, dScaled, dFloor, dFrac;
+  size_t  uLen;
+  int     iExp, iBin, iTry, iNdig, i;
+  long    lDig;
+
+  /*--- Make the 6 digits and the exponent -------------------------*/
+  dAbs = fabs(d);
+  if (! (dAbs >= 1e-17 && dAbs < 1e22)) {goto FALLBACK;}
+  frexp(dAbs, &iBin);
+  iExp = (int)floor((iBin-1) * 0.30102999566398119521);
+  for (iTry=0; iTry<3; iTry++) {
+    if (iExp<-17 || iExp>27) {goto FALLBACK;}
+    dScaled = (iExp<=5) ? dAbs*gadP10[5-iExp] : dAbs/gadP10[iExp-5];
+    if      (dScaled <  100000.0) {iExp--;}
+    else if (dScaled >= 1000000.0) {iExp++;}
+    else                          {break;  }
+  }
+  if (iTry >= 3) {goto FALLBACK;}
+  dFloor = floor(dScaled);
+  dFrac  = dScaled - dFloor;
+  if (fabs(dFrac-0.5) < 1e-9) {goto FALLBACK;}
+  lDig = (long)dFloor + ((dFrac > 0.5) ? 1 : 0);
+  if (lDig >= 1000000) {lDig = 100000; iExp++;}
+  for (i=5; i>=0; i--) {acDig[i] = (char)('0' + lDig%10); lDig /= 10;}
+  for (iNdig=6; iNdig>1 && acDig[iNdig-1]=='0'; iNdig--);
+
+  /*--- Print them in the fixed or the exponential style -----------*/
+  uLen = 0;
+  if (d < 0) {pszBuf[uLen++] = '-';}
+  if (iExp < -4 || iExp >= 6) {
+    pszBuf[uLen++] = acDig[0];
+    if (iNdig > 1) {
+      pszBuf[uLen++] = '.';
+      for (i=1; i<iNdig; i++) {pszBuf[uLen++] = acDig[i];}
+    }
+    pszBuf[uLen++] = 'e';
+    pszBuf[uLen++] = (iExp < 0) ? '-' : '+';
+    if (iExp < 0) {iExp = -iExp;}
+    if (iExp >= 100) {pszBuf[uLen++] = (char)('0' + iExp/100);}
+    pszBuf[uLen++] = (char)('0' + iExp/10%10);
+    pszBuf[uLen++] = (char)('0' + iExp%10);
+  } else if (iExp >= 0) {
+    for (i=0; i<=iExp; i++) {pszBuf[uLen++] = acDig[i];}
+    if (iNdig > iExp+1) {
+      pszBuf[uLen++] = '.';
+      for (; i<iNdig; i++) {pszBuf[uLen++] = acDig[i];}
+    }
+  } else {
+    pszBuf[uLen++] = '0';
+    pszBuf[uLen++] = '.';
+    for (i=-1; i>iExp; i--) {pszBuf[uLen++] = '0';}
+    for (i=0; i<iNdig; i++) {pszBuf[uLen++] = acDig[i];}
+  }
+  pszBuf[uLen] = '\0';
+  return uLen;
+
+FALLBACK:
+  return (size_t)snprintf(pszBuf, 32, "%.6g", d);
+}
+
+/*=== Compare two values as AWK does =================================
+ * Numbers (and "strnum"s) are compared as numbers, in which NaN is
+ * equal to anything as AWK regards, and the others are compared as
+ * strings.
+ * [in] pA, pB : the values
+ * [ret]         <0, 0 or >0                                        */
+int awkcmp(const aval_t *pA, const aval_t *pB) {
+  char        szA[NUMBUF], szB[NUMBUF];
+  const char *pa, *pb;
+  size_t      uA, uB;
+  int         i;
+
+  if (pA->iType!=AV_STR && pB->iType!=AV_STR) {
+    return (pA->d > pB->d) ? 1 : (pA->d < pB->d) ? -1 : 0;
+  }
+  switch (pA->iType) {
+    case AV_NUM   : uA = fmtnum(pA->d, szA); pa = szA;   break;
+    case AV_UNINIT: uA = 0;                  pa = "";    break;
+    default       : uA = pA->n;              pa = pA->p; break;
+  }
+  switch (pB->iType) {
+    case AV_NUM   : uB = fmtnum(pB->d, szB); pb = szB;   break;
+    case AV_UNINIT: uB = 0;                  pb = "";    break;
+    default       : uB = pB->n;              pb = pB->p; break;
+  }
+  i = memcmp(pa, pb, (uA<uB) ? uA : uB);
+  if (i != 0) {return i;}
+  return (uA<uB) ? -1 : (uA>uB) ? 1 : 0;
+}
+
+/*=== int() of AWK ===================================================*/
+double awkint(double d) {
+  return (d >= 0) ? floor(d) : ceil(d);
+}
+
+/*=== Evaluate a formula for a line ==================================
+ * [in]  pF    : the formula
+ *       ppcFld: the heads of the fields ([0] is the whole line)
+ *       puLen : the lengths of them
+ *       iNf   : the number of the fields
+ * [out] pV    : the value                                          */
+void eval_formula(const formula_t *pF, char *const *ppcFld,
+                  const size_t *puLen, int iNf, aval_t *pV) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const aval_t stZero  = {AV_NUM, 0.0, NULL, 0};
+  static const aval_t stHalfM = {AV_NUM,-0.5, NULL, 0};
+  const func_t *pFn;
+  aval_t stA, stB;
+  double d, dInt;
+  int    i;
+
+  /*--- Make the base value and operate it -------------------------*/
+  switch (pF->iBase) {
+    case BASE_RAW:
+    case BASE_NUM:
+      if (pF->iField <= iNf) {
+        pV->p = ppcFld[pF->iField];
+        pV->n = puLen[pF->iField];
+      } else {
+        pV->p = "";
+        pV->n = 0;
+      }
+      if (pF->iBase==BASE_RAW && pF->iNfns==0) {
+        pV->iType = AV_STR;
+        return;
+      }
+      pV->d = str2num(pV->p, pV->n);
+      if (pF->iBase == BASE_NUM) {
+        d = pV->d;
+        for (i=0; i<pF->iNops; i++) {
+          switch (pF->aOp[i].iOp) {
+            case OP_ADD: d = d + pF->aOp[i].d; break;
+            case OP_MUL: d = d * pF->aOp[i].d; break;
+            default    : d = d / pF->aOp[i].d; break;
+          }
+        }
+        pV->iType = AV_NUM;
+        pV->d     = d;
+      } else {
+        pV->iType = (pF->iNfns>0 && is_strnum(pV->p,pV->n)) ? AV_STRNUM
+                                                            : AV_STR;
+      }
+      break;
+    case BASE_CONST:
+      pV->iType = AV_NUM;
+      pV->d     = pF->dConst;
+      break;
+    default:
+      pV->iType = AV_UNINIT;
+      pV->d     = 0;
+      break;
+  }
+
+  /*--- Apply the functions ----------------------------------------*/
+  for (pFn=pF->pFn; pFn<pF->pFn+pF->iNfns; pFn++) {
+    if (pFn->iFn == FN_ROUND) {
+      if (pFn->dScale != 1) {pV->d = pV->d * pFn->dScale; pV->iType = AV_NUM;}
+      d    = pV->d;
+      dInt = awkint(d);
+      stA.iType = AV_NUM;
+      switch ((pV->iType!=AV_STR) ? 'n' : pFn->cKind) {
+        case 'n':
+          /* a number (not a string) is rounded as the binary mode */
+          d = round1(pFn->cKind, d);
+          break;
+        case 'r':
+          /* (n>=0)?int(n+0.5):(n-int(n)>=-0.5)?int(n):int(n)-1 */
+          if (awkcmp(pV,&stZero) >= 0) {d = awkint(d+0.5);}
+          else {
+            stA.d = d - dInt;
+            d = (awkcmp(&stA,&stHalfM) >= 0) ? dInt : dInt-1;
+          }
+          break;
+        case 'f':
+          /* (int(n)==n)?n*1:(n>=0)?int(n):int(n)-1 */
+          stA.d = dInt;
+          if      (awkcmp(&stA,pV  ) == 0) {d = d*1;   }
+          else if (awkcmp(pV,&stZero) >= 0) {d = dInt;  }
+          else                              {d = dInt-1;}
+          break;
+        default:
+          /* (int(n)==n)?n*1:(n>=0)?int(n)+1:int(n) */
+          stA.d = dInt;
+          if      (awkcmp(&stA,pV  ) == 0) {d = d*1;   }
+          else if (awkcmp(pV,&stZero) >= 0) {d = dInt+1;}
+          else                              {d = dInt;  }
+          break;
+      }
+      if (pFn->dScale != 1) {d = d / pFn->dScale;}
+      pV->iType = AV_NUM;
+      pV->d     = d;
+    } else {
+      stA.iType = AV_NUM; stA.d = pFn->dMin;
+      stB.iType = AV_NUM; stB.d = pFn->dMax;
+      if (! pFn->iHasMin) {
+        if (pFn->iHasMax && awkcmp(pV,&stB)>0) {*pV = stB;}
+      } else if (! pFn->iHasMax) {
+        if (awkcmp(pV,&stA) < 0) {*pV = stA;}
+      } else if (! (stA.d > stB.d)) {
+        if      (awkcmp(pV,&stA) < 0) {*pV = stA;}
+        else if (awkcmp(pV,&stB) > 0) {*pV = stB;}
+      } else {
+        if      (awkcmp(pV,&stB) < 0) {*pV = stB;}
+        else if (awkcmp(pV,&stA) > 0) {*pV = stA;}
+      }
+    }
+  }
+}
+
+/*=== Amplify the fields of every line ===============================
+ * [in] iFd : the file descriptor to read                           */
+void amplify(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  char    *pcBuf, *pcLine, *pcEnd, *pcNl, *p;
+  char   **ppcFld;
+  size_t  *puLen;
+  size_t   uSize, uData, uLen;
+  ssize_t  sLen;
+  aval_t   stV;
+  char     szNum[NUMBUF];
+  int      iEof, iNf, i;
+
+  /*--- Allocate the buffers ---------------------------------------*/
+  uSize = IBUF;
+  if ((pcBuf=(char*)malloc(uSize))==NULL) {
+    error_exit(errno,"malloc() #1 in amplify(): %s\n",strerror(errno));
+  }
+  if ((ppcFld=(char**)malloc((giMaxFld+1)*sizeof(char*)))==NULL ||
+      (puLen=(size_t*)malloc((giMaxFld+1)*sizeof(size_t)))==NULL ) {
+    error_exit(errno,"malloc() #2 in amplify(): %s\n",strerror(errno));
+  }
+
+  /*--- Read and amplify every line --------------------------------*/
+  uData = 0;
+  iEof  = 0;
+  guOut = 0;
+  while (! iEof || uData > 0) {
+    /* read the data as much as possible */
+    if (! iEof) {
+      if (uData == uSize) {
+        uSize *= 2;
+        if ((pcBuf=(char*)realloc(pcBuf,uSize))==NULL) {
+          error_exit(errno,"realloc() in amplify(): %s\n",strerror(errno));
+        }
+      }
+      sLen = read(iFd, pcBuf+uData, uSize-uData);
+      if (sLen < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(1,"read() in amplify(): %s\n",strerror(errno));
+      }
+      if (sLen == 0) {iEof = 1;}
+      uData += (size_t)sLen;
+    }
+    /* process the complete lines (and the last one at EOF) */
+    pcLine = pcBuf;
+    pcEnd  = pcBuf + uData;
+    while (pcLine < pcEnd) {
+      pcNl = memchr(pcLine, '\n', (size_t)(pcEnd-pcLine));
+      if (pcNl == NULL) {
+        if (! iEof) {break;}
+        pcNl = pcEnd;
+      }
+      /* split the line into the fields which are needed */
+      ppcFld[0] = pcLine;
+      puLen[0]  = (size_t)(pcNl-pcLine);
+      iNf = 0;
+      p   = pcLine;
+      while (iNf < giMaxFld) {
+        while (p<pcNl && (*p==' ' || *p=='\t')) {p++;}
+        if (p >= pcNl) {break;}
+        ppcFld[++iNf] = p;
+        while (p<pcNl && *p!=' ' && *p!='\t') {p++;}
+        puLen[iNf] = (size_t)(p-ppcFld[iNf]);
+      }
+      /* evaluate the formulas and print them */
+      for (i=0; i<giNfml; i++) {
+        if (i > 0) {gacOut[guOut++] = ' ';}
+        eval_formula(&gaFml[i], ppcFld, puLen, iNf, &stV);
+        switch (stV.iType) {
+          case AV_NUM:
+            uLen = fmtnum(stV.d, szNum);
+            memcpy(gacOut+guOut, szNum, uLen);
+            guOut += uLen;
+            break;
+          case AV_UNINIT:
+            break;
+          default:
+            out_bytes(stV.p, stV.n);
+            break;
+        }
+        if (guOut > OBUF-OBUF_MARG) {out_flush();}
+      }
+      gacOut[guOut++] = '\n';
+      if (guOut > OBUF-OBUF_MARG) {out_flush();}
+      pcLine = pcNl + 1;
+    }
+    /* keep the incomplete line */
+    if (pcLine >= pcEnd) {
+      uData = 0;
+    } else {
+      uData = (size_t)(pcEnd-pcLine);
+      memmove(pcBuf, pcLine, uData);
+    }
+  }
+  out_flush();
+}
+
+/*=== Append bytes to the output buffer ==============================*/
+void out_bytes(const char *p, size_t n) {
+  if (guOut+n > OBUF-OBUF_MARG) {
+    out_flush();
+    if (n > OBUF-OBUF_MARG) {
+      if (fwrite(p, 1, n, stdout) < n) {
+        error_exit(1,"fwrite() in out_bytes(): %s\n",strerror(errno));
+      }
+      return;
+    }
+  }
+  memcpy(gacOut+guOut, p, n);
+  guOut += n;
+}
+
+/*=== Flush the output buffer ========================================*/
+void out_flush(void) {
+  if (guOut == 0) {return;}
+  if (fwrite(gacOut, 1, guOut, stdout) < guOut || fflush(stdout) != 0) {
+    error_exit(1,"fwrite() in out_flush(): %s\n",strerror(errno));
+  }
+  guOut = 0;
+}
+
+
+
+/*####################################################################
+# Functions for the Binary Mode
+####################################################################*/
+
+/*=== Parse a sample type ============================================
+ * [in]  psz : the string ("s16", "s32le", "f32be" and so on)
+ * [out] pT  : the sample type
+ * [ret]       the length of the parsed string (0 if invalid)       */
+size_t parse_stype(const char *psz, stype_t *pT) {
+  uint16_t u16 = 0x0102;
+
+  if      (strncmp(psz,"s16",3)==0) {pT->iType = TY_S16; pT->iSize = 2;}
+  else if (strncmp(psz,"s32",3)==0) {pT->iType = TY_S32; pT->iSize = 4;}
+  else if (strncmp(psz,"f32",3)==0) {pT->iType = TY_F32; pT->iSize = 4;}
+  else                              {return 0;                          }
+  if (strncmp(psz+3,"le",2)==0) {pT->iBig = 0; return 5;}
+  if (strncmp(psz+3,"be",2)==0) {pT->iBig = 1; return 5;}
+  pT->iBig = (*(uint8_t*)&u16 == 0x01) ? 1 : 0;
+  return 3;
+}
+
+/*=== Round a number as r(), f() and c() do ==========================
+ * (Comparisons with NaN are regarded as "equal" as AWK does.)
+ * [in] iKind : 'r', 'f' or 'c'
+ *      d     : the number
+ * [ret]        the rounded number                                  */
+double round1(int iKind, double d) {
+  double dInt = awkint(d);
+
+  switch (iKind) {
+    case 'r': if (! (d < 0)) {return awkint(d+0.5);}
+              return (! (d-dInt < -0.5)) ? dInt : dInt-1;
+    case 'f': if (! (dInt < d) && ! (dInt > d)) {return d*1;}
+              return (! (d < 0)) ? dInt : dInt-1;
+    default : if (! (dInt < d) && ! (dInt > d)) {return d*1;}
+              return (! (d < 0)) ? dInt+1 : dInt;
+  }
+}
+
+/*=== Constrain a number as m() does =================================
+ * [in] pFn : the range limiting function
+ *      d   : the number
+ * [ret]      the constrained number                                */
+double limit1(const func_t *pFn, double d) {
+  if (! pFn->iHasMin) {return (pFn->iHasMax && d>pFn->dMax) ? pFn->dMax : d;}
+  if (! pFn->iHasMax) {return (d<pFn->dMin) ? pFn->dMin : d;               }
+  if (! (pFn->dMin > pFn->dMax)) {
+    return (d<pFn->dMin) ? pFn->dMin : (d>pFn->dMax) ? pFn->dMax : d;
+  } else {
+    return (d<pFn->dMax) ? pFn->dMax : (d>pFn->dMin) ? pFn->dMin : d;
+  }
+}
+
+/*=== Amplify the interleaved binary samples =========================
+ * [in] iFd  : the file descriptor to read
+ *      pIn  : the input sample type
+ *      pOut : the output sample type
+ *      iNch : the number of the channels                           */
+void amplify_binary(int iFd, const stype_t *pIn, const stype_t *pOut,
+                    int iNch) {
+
+  /*--- Variables --------------------------------------------------*/
+  const formula_t *pF;
+  uint8_t *pu8In, *pu8Out;
+  double  *pdPlane;
+  size_t   uFrmIn, uFrmOut, uData, uFrames;
+  ssize_t  sLen;
+  int      iEof, iCh, iSrc, iSame;
+
+  /*--- Allocate the buffers ---------------------------------------*/
+  uFrmIn  = (size_t)iNch * pIn->iSize;
+  uFrmOut = (size_t)iNch * pOut->iSize;
+  iSame   = (pIn->iType==pOut->iType && pIn->iBig==pOut->iBig) ? 1 : 0;
+  if ((pu8In  =(uint8_t*)malloc(BFRAMES*uFrmIn ))==NULL ||
+      (pu8Out =(uint8_t*)malloc(BFRAMES*uFrmOut))==NULL ||
+      (pdPlane=(double *)malloc(BFRAMES*sizeof(double)))==NULL) {
+    error_exit(errno,"malloc() in amplify_binary(): %s\n",strerror(errno));
+  }
+
+  /*--- Amplify every block of the frames --------------------------*/
+  iEof = 0;
+  while (! iEof) {
+    /* read a block */
+    uData = 0;
+    while (uData < BFRAMES*uFrmIn) {
+      sLen = read(iFd, pu8In+uData, BFRAMES*uFrmIn-uData);
+      if (sLen < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(1,"read() in amplify_binary(): %s\n",strerror(errno));
+      }
+      if (sLen == 0) {iEof = 1; break;}
+      uData += (size_t)sLen;
+    }
+    uFrames = uData / uFrmIn;
+    /* amplify every channel on a plane */
+    for (iCh=0; iCh<iNch; iCh++) {
+      pF   = (iCh < giNfml) ? &gaFml[iCh] : NULL;
+      iSrc = (pF!=NULL && pF->iField>0) ? pF->iField-1 : iCh;
+      if (iSame && (pF==NULL || (pF->iBase==BASE_RAW && pF->iNfns==0))) {
+        copy_plane(pu8In +iSrc*pIn ->iSize, uFrmIn ,
+                   pu8Out+iCh *pOut->iSize, uFrmOut, uFrames, pIn->iSize);
+        continue;
+      }
+      gpfLoad(pu8In+iSrc*pIn->iSize, uFrmIn, uFrames, pIn, pdPlane);
+      if (pF != NULL) {apply_formula(pF, pdPlane, uFrames);}
+      gpfStore(pu8Out+iCh*pOut->iSize, uFrmOut, uFrames, pOut, pdPlane);
+    }
+    if (fwrite(pu8Out, uFrmOut, uFrames, stdout) < uFrames) {
+      error_exit(1,"fwrite() in amplify_binary(): %s\n",strerror(errno));
+    }
+    if (uData % uFrmIn) {
+      fflush(stdout);
+      error_exit(1,"The input ended in the middle of a frame\n");
+    }
+  }
+  if (fflush(stdout) != 0) {
+    error_exit(1,"fflush() in amplify_binary(): %s\n",strerror(errno));
+  }
+}
+
+/*=== Apply a formula to a plane of the samples ======================
+ * [in]     pF : the formula
+ * [in,out] pd : the plane
+ *          n  : the number of the samples in it                    */
+void apply_formula(const formula_t *pF, double *pd, size_t n) {
+  size_t i;
+  int    j;
+
+  switch (pF->iBase) {
+    case BASE_CONST: for (i=0; i<n; i++) {pd[i] = pF->dConst;} break;
+    case BASE_NONE : for (i=0; i<n; i++) {pd[i] = 0;         } break;
+    case BASE_NUM  : for (j=0; j<pF->iNops; j++) {
+                       gpfOp(pd, n, pF->aOp[j].iOp, pF->aOp[j].d);
+                     }
+                     break;
+    default        : break;
+  }
+  for (j=0; j<pF->iNfns; j++) {
+    if (pF->pFn[j].iFn == FN_ROUND) {
+      gpfRound(pd, n, pF->pFn[j].cKind, pF->pFn[j].dScale);
+    } else {
+      gpfLimit(pd, n, &pF->pFn[j]);
+    }
+  }
+}
+
+/*=== Copy the samples of a channel as they are ======================
+ * [in]  pu8In    : the first sample of the channel to read
+ *       uStepIn  : the size of an input frame
+ * [out] pu8Out   : the first sample of the channel to write
+ * [in]  uStepOut : the size of an output frame
+ *       n        : the number of the frames
+ *       iSize    : the size of a sample                            */
+void copy_plane(const uint8_t *pu8In, size_t uStepIn, uint8_t *pu8Out,
+                size_t uStepOut, size_t n, int iSize) {
+  size_t i;
+
+  if (uStepIn==(size_t)iSize && uStepOut==(size_t)iSize) {
+    memcpy(pu8Out, pu8In, n*iSize);
+  } else if (iSize == 2) {
+    for (i=0; i<n; i++, pu8In+=uStepIn, pu8Out+=uStepOut) {
+      memcpy(pu8Out, pu8In, 2);
+    }
+  } else {
+    for (i=0; i<n; i++, pu8In+=uStepIn, pu8Out+=uStepOut) {
+      memcpy(pu8Out, pu8In, 4);
+    }
+  }
+}
+
+/*=== Load the samples of a channel into a plane =====================
+ * [in]  pu8   : the first sample of the channel
+ *       uStep : the size of a frame
+ *       n     : the number of the frames
+ *       pT    : the sample type
+ * [out] pd    : the plane                                          */
+#define SWAP16(u) ((uint16_t)((u)>>8 | (u)<<8))
+#define SWAP32(u) ((u)>>24 | ((u)>>8 & 0xFF00) | ((u)<<8 & 0xFF0000) | (u)<<24)
+void load_plane(const uint8_t *pu8, size_t uStep, size_t n,
+                const stype_t *pT, double *pd) {
+  size_t   i;
+  uint32_t u32;
+  float    f;
+  uint16_t u16 = 0x0102;
+  int      iSwap = (pT->iBig != (*(uint8_t*)&u16 == 0x01)) ? 1 : 0;
+
+  switch (pT->iType) {
+    case TY_S16: for (i=0; i<n; i++, pu8+=uStep) {
+                   memcpy(&u16, pu8, 2); if (iSwap) {u16 = SWAP16(u16);}
+                   pd[i] = (int16_t)u16;
+                 }
+                 break;
+    case TY_S32: for (i=0; i<n; i++, pu8+=uStep) {
+                   memcpy(&u32, pu8, 4); if (iSwap) {u32 = SWAP32(u32);}
+                   pd[i] = (int32_t)u32;
+                 }
+                 break;
+    default    : for (i=0; i<n; i++, pu8+=uStep) {
+                   memcpy(&u32, pu8, 4); if (iSwap) {u32 = SWAP32(u32);}
+                   memcpy(&f, &u32, 4); pd[i] = f;
+                 }
+                 break;
+  }
+}
+
+/*=== Store a plane into the samples of a channel ====================
+ * The integer types are rounded off as "r0" does and saturated into
+ * their range (NaN into 0).
+ * [out] pu8   : the first sample of the channel
+ * [in]  uStep : the size of a frame
+ *       n     : the number of the frames
+ *       pT    : the sample type
+ *       pd    : the plane                                          */
+void store_plane(uint8_t *pu8, size_t uStep, size_t n,
+                 const stype_t *pT, const double *pd) {
+  size_t   i;
+  uint32_t u32;
+  double   d;
+  float    f;
+  uint16_t u16 = 0x0102;
+  int      iSwap = (pT->iBig != (*(uint8_t*)&u16 == 0x01)) ? 1 : 0;
+
+  switch (pT->iType) {
+    case TY_S16: for (i=0; i<n; i++, pu8+=uStep) {
+                   d   = round1('r', pd[i]);
+                   u16 = (d != d     ) ? 0                   :
+                         (d < -32768.0) ? (uint16_t)0x8000   :
+                         (d >  32767.0) ? (uint16_t)0x7FFF   :
+                                          (uint16_t)(int16_t)d;
+                   if (iSwap) {u16 = SWAP16(u16);}
+                   memcpy(pu8, &u16, 2);
+                 }
+                 break;
+    case TY_S32: for (i=0; i<n; i++, pu8+=uStep) {
+                   d   = round1('r', pd[i]);
+                   u32 = (d != d          ) ? 0                   :
+                         (d < -2147483648.0) ? (uint32_t)0x80000000 :
+                         (d >  2147483647.0) ? (uint32_t)0x7FFFFFFF :
+                                               (uint32_t)(int32_t)d;
+                   if (iSwap) {u32 = SWAP32(u32);}
+                   memcpy(pu8, &u32, 4);
+                 }
+                 break;
+    default    : for (i=0; i<n; i++, pu8+=uStep) {
+                   f = (float)pd[i];
+                   memcpy(&u32, &f, 4); if (iSwap) {u32 = SWAP32(u32);}
+                   memcpy(pu8, &u32, 4);
+                 }
+                 break;
+  }
+}
+
+/*=== Choose the kernels for the CPU =================================*/
+void init_kernels(void) {
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    gpfOp    = op_avx2;
+    gpfRound = round_avx2;
+    gpfLimit = limit_avx2;
+    gpfLoad  = load_plane_avx2;
+    gpfStore = store_plane_avx2;
+  }
+#endif
+}
+
+/*=== Apply an operation to a plane ==================================
+ * [in,out] pd  : the plane
+ *          n   : the number of the samples in it
+ * [in]     iOp : OP_ADD, OP_MUL or OP_DIV
+ *          dC  : the operand                                       */
+void op_scalar(double *pd, size_t n, int iOp, double dC) {
+  size_t i;
+
+  switch (iOp) {
+    case OP_ADD: for (i=0; i<n; i++) {pd[i] = pd[i] + dC;} break;
+    case OP_MUL: for (i=0; i<n; i++) {pd[i] = pd[i] * dC;} break;
+    default    : for (i=0; i<n; i++) {pd[i] = pd[i] / dC;} break;
+  }
+}
+
+/*=== Apply a rounding function to a plane ===========================
+ * [in,out] pd     : the plane
+ *          n      : the number of the samples in it
+ * [in]     iKind  : 'r', 'f' or 'c'
+ *          dScale : the scale (1 means no scaling)                 */
+void round_scalar(double *pd, size_t n, int iKind, double dScale) {
+  size_t i;
+
+  if (dScale == 1) {
+    for (i=0; i<n; i++) {pd[i] = round1(iKind, pd[i]);                }
+  } else {
+    for (i=0; i<n; i++) {pd[i] = round1(iKind, pd[i]*dScale) / dScale;}
+  }
+}
+
+/*=== Apply a range limiting function to a plane =====================
+ * [in,out] pd  : the plane
+ *          n   : the number of the samples in it
+ * [in]     pFn : the function                                      */
+void limit_scalar(double *pd, size_t n, const func_t *pFn) {
+  size_t i;
+
+  for (i=0; i<n; i++) {pd[i] = limit1(pFn, pd[i]);}
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Apply an operation to a plane (AVX2) ===========================
+ * The same as op_scalar() but 4 samples at a time.                 */
+__attribute__((target("avx2")))
+void op_avx2(double *pd, size_t n, int iOp, double dC) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m256d vC = _mm256_set1_pd(dC);
+  size_t i = 0;
+
+  /*--- Operate them 4 samples at a time ---------------------------*/
+  switch (iOp) {
+    case OP_ADD:
+      for (; i+4<=n; i+=4) {
+        _mm256_storeu_pd(pd+i, _mm256_add_pd(_mm256_loadu_pd(pd+i), vC));
+      }
+      break;
+    case OP_MUL:
+      for (; i+4<=n; i+=4) {
+        _mm256_storeu_pd(pd+i, _mm256_mul_pd(_mm256_loadu_pd(pd+i), vC));
+      }
+      break;
+    default:
+      for (; i+4<=n; i+=4) {
+        _mm256_storeu_pd(pd+i, _mm256_div_pd(_mm256_loadu_pd(pd+i), vC));
+      }
+      break;
+  }
+  op_scalar(pd+i, n-i, iOp, dC);
+}
+
+/*=== Apply a rounding function to a plane (AVX2) ====================
+ * The same as round_scalar() but 4 samples at a time. The compares
+ * are unordered ones to regard NaN as "equal" as round1() does.    */
+#define TRUNC256(v) _mm256_round_pd((v), _MM_FROUND_TO_ZERO|_MM_FROUND_NO_EXC)
+/* "r0" on 4 samples (shared with store_plane_avx2())              */
+__attribute__((target("avx2")))
+static inline __m256d round_r_avx2(__m256d v) {
+  const __m256d vZero  = _mm256_setzero_pd();
+  const __m256d vOne   = _mm256_set1_pd( 1.0);
+  const __m256d vHalf  = _mm256_set1_pd( 0.5);
+  const __m256d vHalfM = _mm256_set1_pd(-0.5);
+  __m256d vInt = TRUNC256(v), vR;
+
+  vR = _mm256_blendv_pd(_mm256_sub_pd(vInt, vOne), vInt,
+                        _mm256_cmp_pd(_mm256_sub_pd(v, vInt), vHalfM,
+                                      _CMP_NLT_UQ));
+  return _mm256_blendv_pd(vR, TRUNC256(_mm256_add_pd(v, vHalf)),
+                          _mm256_cmp_pd(v, vZero, _CMP_NLT_UQ));
+}
+__attribute__((target("avx2")))
+void round_avx2(double *pd, size_t n, int iKind, double dScale) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m256d vZero  = _mm256_setzero_pd();
+  const __m256d vOne   = _mm256_set1_pd( 1.0);
+  const __m256d vScale = _mm256_set1_pd(dScale);
+  __m256d v, vInt, vGe0, vEq, vR;
+  size_t  i;
+
+  /*--- Round them 4 samples at a time -----------------------------*/
+  for (i=0; i+4<=n; i+=4) {
+    v = _mm256_loadu_pd(pd+i);
+    if (dScale != 1) {v = _mm256_mul_pd(v, vScale);}
+    vInt = TRUNC256(v);
+    vGe0 = _mm256_cmp_pd(v, vZero, _CMP_NLT_UQ);              /* n>=0 */
+    switch (iKind) {
+      case 'r':
+        vR = round_r_avx2(v);
+        break;
+      case 'f':
+        vEq = _mm256_cmp_pd(vInt, v, _CMP_EQ_UQ);
+        vR  = _mm256_blendv_pd(_mm256_sub_pd(vInt, vOne), vInt, vGe0);
+        vR  = _mm256_blendv_pd(vR, _mm256_mul_pd(v, vOne), vEq);
+        break;
+      default:
+        vEq = _mm256_cmp_pd(vInt, v, _CMP_EQ_UQ);
+        vR  = _mm256_blendv_pd(vInt, _mm256_add_pd(vInt, vOne), vGe0);
+        vR  = _mm256_blendv_pd(vR, _mm256_mul_pd(v, vOne), vEq);
+        break;
+    }
+    if (dScale != 1) {vR = _mm256_div_pd(vR, vScale);}
+    _mm256_storeu_pd(pd+i, vR);
+  }
+  round_scalar(pd+i, n-i, iKind, dScale);
+}
+
+/*=== Apply a range limiting function to a plane (AVX2) ==============
+ * The same as limit_scalar() but 4 samples at a time.              */
+__attribute__((target("avx2")))
+void limit_avx2(double *pd, size_t n, const func_t *pFn) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m256d vMin = _mm256_set1_pd(pFn->dMin);
+  const __m256d vMax = _mm256_set1_pd(pFn->dMax);
+  __m256d v;
+  size_t  i;
+
+  /*--- Constrain them 4 samples at a time -------------------------*/
+  if (! pFn->iHasMin && ! pFn->iHasMax) {return;}
+  for (i=0; i+4<=n; i+=4) {
+    v = _mm256_loadu_pd(pd+i);
+    if (! pFn->iHasMin) {
+      v = _mm256_blendv_pd(v, vMax, _mm256_cmp_pd(v, vMax, _CMP_GT_OQ));
+    } else if (! pFn->iHasMax) {
+      v = _mm256_blendv_pd(v, vMin, _mm256_cmp_pd(v, vMin, _CMP_LT_OQ));
+    } else if (! (pFn->dMin > pFn->dMax)) {
+      v = _mm256_blendv_pd(
+            _mm256_blendv_pd(v, vMax, _mm256_cmp_pd(v, vMax, _CMP_GT_OQ)),
+            vMin, _mm256_cmp_pd(v, vMin, _CMP_LT_OQ));
+    } else {
+      v = _mm256_blendv_pd(
+            _mm256_blendv_pd(v, vMin, _mm256_cmp_pd(v, vMin, _CMP_GT_OQ)),
+            vMax, _mm256_cmp_pd(v, vMax, _CMP_LT_OQ));
+    }
+    _mm256_storeu_pd(pd+i, v);
+  }
+  limit_scalar(pd+i, n-i, pFn);
+}
+
+/*=== Load the samples of a channel into a plane (AVX2) ==============
+ * The same as load_plane() but 4 samples at a time. The samples are
+ * gathered into 32-bit lanes (the 16-bit ones zero-extended), byte-
+ * swapped by a shuffle when they are big-endian, and converted.    */
+__attribute__((target("avx2")))
+void load_plane_avx2(const uint8_t *pu8, size_t uStep, size_t n,
+                     const stype_t *pT, double *pd) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m128i vSw16 = _mm_setr_epi8(1,0,-1,-1,5,4,-1,-1,
+                                      9,8,-1,-1,13,12,-1,-1);
+  const __m128i vSw32 = _mm_setr_epi8(3,2,1,0,7,6,5,4,
+                                      11,10,9,8,15,14,13,12);
+  const int     iCont = (uStep == (size_t)pT->iSize) ? 1 : 0;
+  uint32_t au32[4];
+  uint16_t u16;
+  __m128i  v;
+  size_t   i;
+  int      k;
+
+  /*--- Convert them 4 samples at a time ---------------------------*/
+  for (i=0; i+4<=n; i+=4, pu8+=4*uStep) {
+    if (pT->iSize == 2) {
+      if (iCont) {
+        v = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)pu8));
+      } else {
+        for (k=0; k<4; k++) {memcpy(&u16, pu8+k*uStep, 2); au32[k] = u16;}
+        v = _mm_loadu_si128((const __m128i*)au32);
+      }
+      if (pT->iBig) {v = _mm_shuffle_epi8(v, vSw16);}
+      v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    } else {
+      if (iCont) {
+        v = _mm_loadu_si128((const __m128i*)pu8);
+      } else {
+        for (k=0; k<4; k++) {memcpy(&au32[k], pu8+k*uStep, 4);}
+        v = _mm_loadu_si128((const __m128i*)au32);
+      }
+      if (pT->iBig) {v = _mm_shuffle_epi8(v, vSw32);}
+    }
+    if (pT->iType == TY_F32) {
+      _mm256_storeu_pd(pd+i, _mm256_cvtps_pd(_mm_castsi128_ps(v)));
+    } else {
+      _mm256_storeu_pd(pd+i, _mm256_cvtepi32_pd(v));
+    }
+  }
+  load_plane(pu8, uStep, n-i, pT, pd+i);
+}
+
+/*=== Store a plane into the samples of a channel (AVX2) =============
+ * The same as store_plane() but 4 samples at a time. The integer
+ * types are clamped into the int32 range and converted, and the
+ * 16-bit ones are saturated by the pack.                           */
+__attribute__((target("avx2")))
+void store_plane_avx2(uint8_t *pu8, size_t uStep, size_t n,
+                      const stype_t *pT, const double *pd) {
+
+  /*--- Variables --------------------------------------------------*/
+  const __m128i vSw16 = _mm_setr_epi8(1,0,3,2,5,4,7,6,
+                                      9,8,11,10,13,12,15,14);
+  const __m128i vSw32 = _mm_setr_epi8(3,2,1,0,7,6,5,4,
+                                      11,10,9,8,15,14,13,12);
+  const __m256d vLo   = _mm256_set1_pd(-2147483648.0);
+  const __m256d vHi   = _mm256_set1_pd( 2147483647.0);
+  const int     iCont = (uStep == (size_t)pT->iSize) ? 1 : 0;
+  uint8_t  au8[16];
+  __m256d  v;
+  __m128i  w;
+  size_t   i;
+  int      k;
+
+  /*--- Convert them 4 samples at a time ---------------------------*/
+  for (i=0; i+4<=n; i+=4, pu8+=4*uStep) {
+    v = _mm256_loadu_pd(pd+i);
+    if (pT->iType == TY_F32) {
+      w = _mm_castps_si128(_mm256_cvtpd_ps(v));
+    } else {
+      v = round_r_avx2(v);
+      v = _mm256_and_pd(v, _mm256_cmp_pd(v, v, _CMP_ORD_Q)); /* NaN->0 */
+      v = _mm256_min_pd(_mm256_max_pd(v, vLo), vHi);
+      w = _mm256_cvtpd_epi32(v);
+      if (pT->iType == TY_S16) {w = _mm_packs_epi32(w, w);}
+    }
+    if (pT->iBig) {w = _mm_shuffle_epi8(w, (pT->iSize==2) ? vSw16 : vSw32);}
+    if (pT->iSize == 2) {
+      if (iCont) {_mm_storel_epi64((__m128i*)pu8, w); continue;}
+      _mm_storeu_si128((__m128i*)au8, w);
+      for (k=0; k<4; k++) {memcpy(pu8+k*uStep, au8+k*2, 2);}
+    } else {
+      if (iCont) {_mm_storeu_si128((__m128i*)pu8, w); continue;}
+      _mm_storeu_si128((__m128i*)au8, w);
+      for (k=0; k<4; k++) {memcpy(pu8+k*uStep, au8+k*4, 4);}
+    }
+  }
+  store_plane(pu8, uStep, n-i, pT, pd+i);
+}
+#endif
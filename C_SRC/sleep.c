@@ -2,13 +2,35 @@
 #
 # SLEEP - Sleep Command Which Supported Non-Integer Numbers
 #
-# USAGE   : sleep seconds
+# USAGE   : sleep [-a] [-s usec] seconds
+#           sleep [-s usec] -u time
+#           sleep [-a] [-s usec] -t [-c count] seconds
 # Args    : seconds ... The number of second to sleep for. You can
 #                       give not only an integer number but also a
 #                       non-integer number here.
+# Options : -a ........ Sleep until the next time which is a multiple of
+#                       the seconds since the UNIX epoch instead. For
+#                       instance, "sleep -a 60" wakes up at the top of
+#                       the next minute.
+#           -u time ... Sleep until the time instead. The format is
+#                       "YYYYMMDDhhmmss[.n]" in your timezone or
+#                       "@n[.n]" in UNIX time. With -t, the first tick
+#                       happens at the time.
+#           -t ........ Tick mode. Wake up every the seconds and write
+#                       the tick number (1, 2, ...) as a line on each
+#                       wake-up until killed. Since the wake-up times
+#                       are calculated from the first one, they never
+#                       drift. When a tick has been missed because of
+#                       the heavy load, it is skipped.
+#           -c count .. Finish after the number of ticks (for -t)
+#           -s usec ... Not sleep but spin for the last usec micro-
+#                       seconds of every sleep to wake up more precisely.
+#                       (It consumes CPU time instead)
 # Retuen  : Return 0 only when succeeded to sleep
 #
 # How to compile : cc -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -o __CMDNAME__ __SRCNAME__ -lrt
 #
 # Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2020-03-19
 #
@@ -28,23 +50,59 @@
 ####################################################################*/
 
 /*=== Initial Setting ==============================================*/
+#include <errno.h>
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdarg.h>
+#include <unistd.h>
 #include <time.h>
 
-char* gpszCmdname;
+#if defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0
+  #define CLOCK_FOR_INTERVAL CLOCK_MONOTONIC
+#else
+  #define CLOCK_FOR_INTERVAL CLOCK_REALTIME
+#endif
+
+char*   gpszCmdname;
+int64_t gi8Spin;     /* -s option value in nanoseconds */
+
+int     parse_seconds(char *pszArg, int64_t *pi8Nsec);
+int     parse_time(char *pszArg, int64_t *pi8Nsec);
+int64_t get_time(clockid_t clk);
+void    sleep_until(clockid_t clk, int64_t i8To);
 
 /*=== Define the functions for printing usage and error ============*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    "USAGE   : %s seconds\n"
+    "USAGE   : %s [-a] [-s usec] seconds\n"
+    "          %s [-s usec] -u time\n"
+    "          %s [-a] [-s usec] -t [-c count] seconds\n"
     "Args    : seconds ... The number of second to sleep for. You can\n"
     "                      give not only an integer number but also a\n"
     "                      non-integer number here.\n"
+    "Options : -a ........ Sleep until the next time which is a multiple of\n"
+    "                      the seconds since the UNIX epoch instead. For\n"
+    "                      instance, \"sleep -a 60\" wakes up at the top of\n"
+    "                      the next minute.\n"
+    "          -u time ... Sleep until the time instead. The format is\n"
+    "                      \"YYYYMMDDhhmmss[.n]\" in your timezone or\n"
+    "                      \"@n[.n]\" in UNIX time. With -t, the first tick\n"
+    "                      happens at the time.\n"
+    "          -t ........ Tick mode. Wake up every the seconds and write\n"
+    "                      the tick number (1, 2, ...) as a line on each\n"
+    "                      wake-up until killed. Since the wake-up times\n"
+    "                      are calculated from the first one, they never\n"
+    "                      drift. When a tick has been missed because of\n"
+    "                      the heavy load, it is skipped.\n"
+    "          -c count .. Finish after the number of ticks (for -t)\n"
+    "          -s usec ... Not sleep but spin for the last usec micro-\n"
+    "                      seconds of every sleep to wake up more precisely.\n"
+    "                      (It consumes CPU time instead)\n"
     "Retuen  : Return 0 only when succeeded to sleep\n"
-    "Version : 2020-03-19 12:18:14 JST\n"
+    "Version : 2026-10-19 21:15:03 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -52,7 +110,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/misc-tools\n"
-    ,gpszCmdname);
+    ,gpszCmdname,gpszCmdname,gpszCmdname);
   exit(1);
 }
 void error_exit(int iErrno, const char* szFormat, ...) {
@@ -72,28 +130,273 @@ void error_exit(int iErrno, const char* szFormat, ...) {
 int main(int argc, char *argv[]) {
 
   /*=== Initial Setting ============================================*/
-  struct timespec tspcSleeping_time;
-  double dNum;
-  int    i,iRet;
+  clockid_t clk;       /* The clock to sleep by                        */
+  int64_t   i8Period;  /* The seconds argument in nanoseconds          */
+  int64_t   i8Until;   /* -u option value in nanoseconds               */
+  int64_t   i8Next;    /* The time to wake up next                     */
+  int64_t   i8Now;
+  long long llCount;   /* -c option value (0 means infinity)           */
+  long long llTick;    /* The current tick number                      */
+  int       iAlign;    /* 1 when -a option is set                      */
+  int       iTick;     /* 1 when -t option is set                      */
+  int       iUntil;    /* 1 when -u option is set                      */
+  int       iNeg;      /* 1 when the seconds is a negative number      */
+  double    dNum;
+  int       i;
 
   gpszCmdname = argv[0];
   for (i=0; *(gpszCmdname+i)!='\0'; i++) {
     if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
   }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
 
   /*=== Parse options ==============================================*/
-  if (argc != 2                         ) {print_usage_and_exit();}
-  if (sscanf(argv[1], "%lf", &dNum) != 1) {print_usage_and_exit();}
-  if (dNum > INT_MAX                    ) {print_usage_and_exit();}
+  iAlign  = 0;
+  iTick   = 0;
+  iUntil  = 0;
+  llCount = 0;
+  gi8Spin = 0;
+  i8Until = 0;
+  /* A negative number (e.g. "-1") is not an option but the seconds,
+   * which makes this command exit at once as ever                 */
+  iNeg    = (argc==2 && argv[1][0]=='-' &&
+             (('0'<=argv[1][1] && argv[1][1]<='9') || argv[1][1]=='.'));
+  while (!iNeg && (i=getopt(argc, argv, "ac:s:tu:h")) != -1) {
+    switch (i) {
+      case 'a': iAlign = 1;
+                break;
+      case 'c': if (sscanf(optarg,"%lld",&llCount) != 1) {
+                  print_usage_and_exit();
+                }
+                if (llCount < 1) {print_usage_and_exit();}
+                break;
+      case 's': if (sscanf(optarg,"%lf",&dNum) != 1) {print_usage_and_exit();}
+                if (dNum < 0 || dNum > INT_MAX     ) {print_usage_and_exit();}
+                gi8Spin = (int64_t)(dNum*1000);
+                break;
+      case 't': iTick  = 1;
+                break;
+      case 'u': if (! parse_time(optarg,&i8Until)) {print_usage_and_exit();}
+                iUntil = 1;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (iUntil && !iTick) {
+    if (argc != 0 || iAlign                ) {print_usage_and_exit();}
+  } else {
+    if (argc != 1                          ) {print_usage_and_exit();}
+    if (! parse_seconds(argv[0],&i8Period) ) {print_usage_and_exit();}
+    if (iTick && i8Period <= 0             ) {print_usage_and_exit();}
+    if (iUntil && iAlign                   ) {print_usage_and_exit();}
+  }
+  if (llCount > 0 && !iTick) {print_usage_and_exit();}
 
-  /*=== Sleep ======================================================*/
-  if (dNum <= 0                                   ) {exit(0);               }
-  tspcSleeping_time.tv_sec  = (time_t)dNum;
-  tspcSleeping_time.tv_nsec = (dNum - tspcSleeping_time.tv_sec) * 1000000000;
+  /*=== Decide the first time to wake up ===========================*/
+  if        (iUntil) {
+    clk    = CLOCK_REALTIME;
+    i8Next = i8Until;
+  } else if (iAlign) {
+    if (i8Period <= 0) {return 0;}
+    clk    = CLOCK_REALTIME;
+    i8Next = (get_time(clk)/i8Period + 1) * i8Period;
+  } else             {
+    if (i8Period <= 0) {return 0;}
+    clk    = CLOCK_FOR_INTERVAL;
+    i8Next = get_time(clk) + i8Period;
+  }
 
-  iRet = nanosleep(&tspcSleeping_time, NULL);
-  if (iRet != 0) {error_exit(iRet,"Error happend while nanosleeping\n");}
+  /*=== Sleep (in the normal mode) =================================*/
+  if (! iTick) {
+    sleep_until(clk, i8Next);
+    return 0;
+  }
+
+  /*=== Tick (in the tick mode) ====================================*/
+  /* The n-th wake-up time is always calculated as (the 1st one) +
+   * (n-1) * period not to accumulate any errors.                   */
+  for (llTick=1; llCount==0 || llTick<=llCount; llTick++) {
+    sleep_until(clk, i8Next);
+    printf("%lld\n", llTick);
+    if (fflush(stdout) != 0) {
+      error_exit(errno,"fflush(): %s\n", strerror(errno));
+    }
+    i8Next += i8Period;
+    i8Now   = get_time(clk);
+    if (i8Now >= i8Next) {
+      /* Skip the ticks which have been missed already */
+      i8Next += ((i8Now-i8Next)/i8Period + 1) * i8Period;
+    }
+  }
 
   /*=== Finish =====================================================*/
   return 0;
 }
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Parse the "seconds" argument ===================================
+ * [in]  pszArg  : The string ("n[.n]" is parsed exactly, and the
+ *                 other formats sscanf() accepts are also accepted
+ *                 for compatibility)
+ * [out] pi8Nsec : The seconds in nanoseconds (<=0 if not positive)
+ * [ret] 1:success 0:failure                                        */
+int parse_seconds(char *pszArg, int64_t *pi8Nsec) {
+
+  /*--- Variables --------------------------------------------------*/
+  int64_t i8Sec, i8Nsec, i8Digit;
+  double  dNum;
+  char   *psz;
+
+  /*--- Parse "n[.n]" exactly --------------------------------------*/
+  i8Sec = 0;
+  for (psz=pszArg; '0'<=*psz && *psz<='9'; psz++) {
+    i8Sec = i8Sec*10 + (*psz-'0');
+    if (i8Sec > INT_MAX) {return 0;}
+  }
+  i8Nsec = 0;
+  if (psz>pszArg && *psz=='.') {
+    psz++;
+    for (i8Digit=100000000; '0'<=*psz && *psz<='9'; psz++) {
+      i8Nsec  += (*psz-'0') * i8Digit;
+      i8Digit /= 10;
+    }
+  }
+  if (psz>pszArg && *psz=='\0') {
+    *pi8Nsec = i8Sec*1000000000 + i8Nsec;
+    return 1;
+  }
+
+  /*--- Parse the other formats by sscanf() ------------------------*/
+  if (sscanf(pszArg, "%lf", &dNum) != 1) {return 0;}
+  if (dNum > INT_MAX                   ) {return 0;}
+  *pi8Nsec = (dNum > 0) ? (int64_t)(dNum*1000000000) : 0;
+  return 1;
+}
+
+/*=== Parse the -u option value ======================================
+ * [in]  pszArg  : The string ("YYYYMMDDhhmmss[.n]" or "@n[.n]")
+ * [out] pi8Nsec : The time in nanoseconds since the UNIX epoch
+ * [ret] 1:success 0:failure                                        */
+int parse_time(char *pszArg, int64_t *pi8Nsec) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct tm tmDate;
+  int64_t   i8Sec, i8Nsec, i8Digit;
+  time_t    tSec;
+  char     *psz;
+  int       iLen;
+  int       aiPart[5]; /* month, day, hour, minute, second */
+  int       i;
+
+  /*--- UNIX time --------------------------------------------------*/
+  if (pszArg[0] == '@') {
+    i8Sec = 0;
+    for (psz=pszArg+1; '0'<=*psz && *psz<='9'; psz++) {
+      i8Sec = i8Sec*10 + (*psz-'0');
+      if (i8Sec > INT64_MAX/1000000000-1) {return 0;}
+    }
+    if (psz == pszArg+1) {return 0;}
+  } else {
+
+  /*--- Calendar time ----------------------------------------------*/
+    for (psz=pszArg; '0'<=*psz && *psz<='9'; psz++);
+    iLen = psz-pszArg;
+    if (iLen<14 || iLen>18) {return 0;}
+    memset(&tmDate, 0, sizeof(tmDate));
+    for (i=0,psz=pszArg; i<iLen-10; i++,psz++) {
+      tmDate.tm_year = tmDate.tm_year*10 + (*psz-'0');
+    }
+    for (i=0; i<5; i++,psz+=2) {aiPart[i] = (psz[0]-'0')*10 + (psz[1]-'0');}
+    if (aiPart[0]<1 || aiPart[0]>12 || aiPart[1]<1 || aiPart[1]>31 ||
+        aiPart[2]>23 || aiPart[3]>59 || aiPart[4]>60                 ) {
+      return 0;
+    }
+    tmDate.tm_year -= 1900;
+    tmDate.tm_mon   = aiPart[0]-1;
+    tmDate.tm_mday  = aiPart[1];
+    tmDate.tm_hour  = aiPart[2];
+    tmDate.tm_min   = aiPart[3];
+    tmDate.tm_sec   = aiPart[4];
+    tmDate.tm_isdst = -1;
+    if ((tSec=mktime(&tmDate)) == (time_t)-1) {return 0;}
+    i8Sec = (int64_t)tSec;
+  }
+
+  /*--- Decimal part -----------------------------------------------*/
+  i8Nsec = 0;
+  if (*psz == '.') {
+    psz++;
+    for (i8Digit=100000000; '0'<=*psz && *psz<='9'; psz++) {
+      i8Nsec  += (*psz-'0') * i8Digit;
+      i8Digit /= 10;
+    }
+  }
+  if (*psz != '\0') {return 0;}
+
+  *pi8Nsec = i8Sec*1000000000 + i8Nsec;
+  return 1;
+}
+
+/*=== Get the current time ===========================================
+ * [in] clk : The clock
+ * [ret]    : The time in nanoseconds                               */
+int64_t get_time(clockid_t clk) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct timespec ts;
+
+  if (clock_gettime(clk,&ts) != 0) {
+    error_exit(errno,"clock_gettime(): %s\n", strerror(errno));
+  }
+  return (int64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+/*=== Sleep until the time ===========================================
+ * It sleeps by the absolute time not to be affected by the time
+ * spent before, resumes after interrupted by signals, and spins for
+ * the last gi8Spin nanoseconds if required.
+ * [in] clk  : The clock which i8To is based on
+ *      i8To : The time to wake up in nanoseconds                   */
+void sleep_until(clockid_t clk, int64_t i8To) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct timespec ts;
+  int64_t         i8Sleep;
+  int             iRet;
+
+  /*--- Sleep ------------------------------------------------------*/
+  i8Sleep    = i8To - gi8Spin;
+  ts.tv_sec  = (time_t)(i8Sleep / 1000000000);
+  ts.tv_nsec = (long  )(i8Sleep % 1000000000);
+  if (ts.tv_nsec < 0) {ts.tv_sec--; ts.tv_nsec+=1000000000;}
+#if defined(_POSIX_CLOCK_SELECTION) && _POSIX_CLOCK_SELECTION >= 0
+  while ((iRet=clock_nanosleep(clk,TIMER_ABSTIME,&ts,NULL)) != 0) {
+    if (iRet == EINTR) {continue;}
+    error_exit(iRet,"clock_nanosleep(): %s\n", strerror(iRet));
+  }
+#else
+  /* Emulate it by nanosleep() where clock_nanosleep() is unavailable */
+  while ((i8Sleep=i8To-gi8Spin-get_time(clk)) > 0) {
+    ts.tv_sec  = (time_t)(i8Sleep / 1000000000);
+    ts.tv_nsec = (long  )(i8Sleep % 1000000000);
+    if ((iRet=nanosleep(&ts,NULL)) != 0 && errno != EINTR) {
+      error_exit(errno,"nanosleep(): %s\n", strerror(errno));
+    }
+  }
+#endif
+
+  /*--- Spin -------------------------------------------------------*/
+  if (gi8Spin > 0) {
+    while (get_time(clk) < i8To);
+  }
+}
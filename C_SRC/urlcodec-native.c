@@ -0,0 +1,499 @@
+/*####################################################################
+#
+# URLCODEC-NATIVE - The Native URL Codec for "urlencode"/"urldecode"
+#
+# USAGE   : urlcodec-native [-r] [file ...]
+#           urlcodec-native -d [file ...]
+# Args    : file ...... Filepath to be encoded or decoded ("-" means
+#                       STDIN). The files are regarded as one stream
+#                       like "cat" does.
+# Options : -d ........ Decode instead of encode
+#           -r ........ RAW MODE : " " will not be encoded into "+" but
+#                       "%20"
+# Retuen  : Return 0 only when all of the files were read successfully
+#
+# * This is the engine which the "urlencode" and "urldecode" commands
+#   in the upper directory use when it has been compiled. So, it makes
+#   exactly the same output as their POSIX versions do, which means
+#   - <0x0A>s are neither encoded nor decoded, and
+#   - the unreserved characters in RFC 3986 (A-Z, a-z, 0-9, "-", ".",
+#     "_" and "~") are not encoded, and the others are encoded into
+#     "%XX" (uppercase) but " " is into "+" (or "%20" with -r),
+#   - "+" is decoded into " ", "%XX" and "%xx" are decoded into the
+#     byte, and the other characters are left as they are.
+# * The runs of the characters which need no conversion are copied 16
+#   or 32 bytes at a time by SSE2 or AVX2 if the CPU supports them.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF 65536     /* input buffer size                         */
+#define OBUF (3*IBUF)  /* output buffer size (enough for encoding)  */
+
+/*--- prototype functions ------------------------------------------*/
+void   init_tables(int iRaw);
+size_t read_input(uint8_t *pu8Buf, size_t uSize);
+void   encode(void);
+void   decode(void);
+size_t enc_run_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End);
+size_t dec_run_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End);
+void   write_all(const void *pv, size_t uLen);
+#ifdef HAVE_X86SIMD
+  size_t enc_run_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+  size_t enc_run_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+  size_t dec_run_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+  size_t dec_run_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname;     /* The name of this command                */
+char**  gppszFiles;      /* The files to read                       */
+int     giNfiles;        /* The number of them                      */
+int     giFd;            /* The file descriptor reading now (or -1) */
+int     giRet;           /* The return code                         */
+char    gac4Enc[256][4]; /* a byte to the encoded string            */
+uint8_t gau8EncLen[256]; /* the length of the string (1 or 3)       */
+int8_t  gai8Hex[256];    /* a hex digit to the value (-1 if not)    */
+/* The functions to count the leading characters which need no
+ * conversion (chosen on the CPU)                                   */
+size_t (*gpfEncRun)(const uint8_t*, const uint8_t*) = enc_run_scalar;
+size_t (*gpfDecRun)(const uint8_t*, const uint8_t*) = dec_run_scalar;
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-r] [file ...]\n"
+    "          %s -d [file ...]\n"
+    "Args    : file ...... Filepath to be encoded or decoded (\"-\" means\n"
+    "                      STDIN). The files are regarded as one stream\n"
+    "                      like \"cat\" does.\n"
+    "Options : -d ........ Decode instead of encode\n"
+    "          -r ........ RAW MODE : \" \" will not be encoded into \"+\" but\n"
+    "                      \"%%20\"\n"
+    "Retuen  : Return 0 only when all of the files were read successfully\n"
+    "Version : 2026-10-19 10:17:42 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  static char *apszStdin[] = {"-"};
+  int iDecode; /* 1 when -d option is set */
+  int iRaw;    /* 1 when -r option is set */
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  iDecode = 0;
+  iRaw    = 0;
+  while ((i=getopt(argc, argv, "drh")) != -1) {
+    switch (i) {
+      case 'd': iDecode = 1;
+                break;
+      case 'r': iRaw    = 1;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc == 0) {gppszFiles = apszStdin; giNfiles = 1;   }
+  else           {gppszFiles = argv;      giNfiles = argc;}
+
+  /*=== Encode or decode ===========================================*/
+  giFd  = -1;
+  giRet = 0;
+  init_tables(iRaw);
+  if (iDecode) {decode();}
+  else         {encode();}
+
+  /*=== Finish =====================================================*/
+  return giRet;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Make the tables and choose the kernels for the CPU =============
+ * [in] iRaw : 1 when " " must be encoded into "%20"                */
+void init_tables(int iRaw) {
+
+  /*--- Variables --------------------------------------------------*/
+  static const char szUnreserved[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~\n";
+  static const char szHex[] = "0123456789ABCDEF";
+  const char *pc;
+  int i;
+
+  /*--- Make the encoding table ------------------------------------*/
+  for (i=0; i<256; i++) {
+    gac4Enc[i][0] = '%';
+    gac4Enc[i][1] = szHex[i >> 4];
+    gac4Enc[i][2] = szHex[i & 15];
+    gau8EncLen[i] = 3;
+  }
+  for (pc=szUnreserved; *pc!='\0'; pc++) {
+    gac4Enc[(uint8_t)*pc][0] = *pc;
+    gau8EncLen[(uint8_t)*pc] = 1;
+  }
+  if (! iRaw) {gac4Enc[' '][0] = '+'; gau8EncLen[' '] = 1;}
+
+  /*--- Make the decoding table ------------------------------------*/
+  memset(gai8Hex, -1, sizeof(gai8Hex));
+  for (i=0; i<10; i++) {gai8Hex['0'+i] = (int8_t)i;}
+  for (i=0; i< 6; i++) {gai8Hex['A'+i] = gai8Hex['a'+i] = (int8_t)(10+i);}
+
+  /*--- Choose the kernels -----------------------------------------*/
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if        (__builtin_cpu_supports("avx2")) {
+    gpfEncRun = enc_run_avx2;
+    gpfDecRun = dec_run_avx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    gpfEncRun = enc_run_sse2;
+    gpfDecRun = dec_run_sse2;
+  }
+#endif
+}
+
+/*=== Read the next bytes from the files one after another ===========
+ * [out] pu8Buf : The buffer to store them
+ * [in]  uSize  : The size of the buffer
+ * [ret]        : The number of the bytes read (0 at the end of all)*/
+size_t read_input(uint8_t *pu8Buf, size_t uSize) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t iRead;
+
+  while (1) {
+    /*--- Open the next file if no file is open --------------------*/
+    if (giFd < 0) {
+      if (giNfiles == 0) {return 0;}
+      if (strcmp(gppszFiles[0],"-") == 0) {
+        giFd = STDIN_FILENO;
+      } else if ((giFd=open(gppszFiles[0],O_RDONLY)) < 0) {
+        warning("%s: %s\n", gppszFiles[0], strerror(errno));
+        giRet = 1;
+        gppszFiles++; giNfiles--;
+        continue;
+      }
+    }
+    /*--- Read it --------------------------------------------------*/
+    iRead = read(giFd, pu8Buf, uSize);
+    if (iRead > 0) {return (size_t)iRead;}
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      warning("%s: %s\n", gppszFiles[0], strerror(errno));
+      giRet = 1;
+    }
+    if (giFd != STDIN_FILENO) {close(giFd);}
+    giFd = -1;
+    gppszFiles++; giNfiles--;
+  }
+}
+
+/*=== Encode all of the files ========================================*/
+void encode(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  static uint8_t au8In[IBUF];
+  static char    acOut[OBUF];
+  const uint8_t *pu8, *pu8End;
+  char          *pc;
+  size_t         uRead, uRun;
+
+  /*--- Encode them chunk by chunk ---------------------------------*/
+  while ((uRead=read_input(au8In, IBUF)) > 0) {
+    pc     = acOut;
+    pu8End = au8In + uRead;
+    for (pu8=au8In; pu8<pu8End; pu8++) {
+      /* Copy the run of the characters which aren't encoded       */
+      uRun = gpfEncRun(pu8, pu8End);
+      memcpy(pc, pu8, uRun);
+      pc  += uRun;
+      pu8 += uRun;
+      if (pu8 >= pu8End) {break;}
+      /* Encode the next one                                       */
+      memcpy(pc, gac4Enc[*pu8], 4);
+      pc  += gau8EncLen[*pu8];
+    }
+    write_all(acOut, pc-acOut);
+  }
+}
+
+/*=== Decode all of the files ========================================*/
+void decode(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  static uint8_t au8In[IBUF];
+  static uint8_t au8Out[IBUF];
+  const uint8_t *pu8, *pu8End;
+  uint8_t       *pu8W;
+  size_t         uHave, uRead, uRun;
+  int            iEof;
+
+  /*--- Decode them chunk by chunk ---------------------------------*/
+  /* ("%" and one following byte at the end of the buffer are left
+   *  until the next reading when they may be a part of "%XX")      */
+  uHave = 0;
+  iEof  = 0;
+  while (! iEof) {
+    uRead  = read_input(au8In+uHave, IBUF-uHave);
+    iEof   = (uRead == 0);
+    uHave += uRead;
+    pu8W   = au8Out;
+    pu8End = au8In + uHave;
+    for (pu8=au8In; pu8<pu8End; ) {
+      /* Copy the run of the characters which aren't decoded       */
+      uRun  = gpfDecRun(pu8, pu8End);
+      memcpy(pu8W, pu8, uRun);
+      pu8W += uRun;
+      pu8  += uRun;
+      if (pu8 >= pu8End) {break;}
+      /* Decode the next one                                       */
+      if (*pu8 == '+') {*pu8W++ = ' '; pu8++; continue;}
+      if (pu8End-pu8 < 3 && ! iEof) {break;}
+      if (pu8End-pu8 >= 3 && gai8Hex[pu8[1]] >= 0 && gai8Hex[pu8[2]] >= 0) {
+        *pu8W++ = (uint8_t)(gai8Hex[pu8[1]]<<4 | gai8Hex[pu8[2]]);
+        pu8    += 3;
+      } else {
+        *pu8W++ = *pu8++;
+      }
+    }
+    write_all(au8Out, pu8W-au8Out);
+    uHave = pu8End - pu8;
+    memmove(au8In, pu8, uHave);
+  }
+}
+
+/*=== Count the leading characters not to be encoded (scalar) ========
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ * [ret]       : The number of the leading unreserved characters and
+ *               <0x0A>s                                            */
+size_t enc_run_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8;
+
+  /*--- Count them -------------------------------------------------*/
+  for (pu8=pu8Beg; pu8<pu8End; pu8++) {
+    if (gau8EncLen[*pu8]!=1 || gac4Enc[*pu8][0]!=(char)*pu8) {break;}
+  }
+  return pu8 - pu8Beg;
+}
+
+/*=== Count the leading characters not to be decoded (scalar) ========
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ * [ret]       : The number of the leading bytes but "%" and "+"    */
+size_t dec_run_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8;
+
+  /*--- Count them -------------------------------------------------*/
+  for (pu8=pu8Beg; pu8<pu8End; pu8++) {
+    if (*pu8=='%' || *pu8=='+') {break;}
+  }
+  return pu8 - pu8Beg;
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Count the leading characters not to be encoded (SSE2) ==========
+ * The same as enc_run_scalar() but 16 bytes at a time. The bytes over
+ * <0x7F> are negative in the signed comparisons, so they never fall
+ * into the ranges.                                                 */
+#define IN_RANGE128(v,lo,hi) \
+  _mm_and_si128(_mm_cmpgt_epi8((v), _mm_set1_epi8((lo)-1)), \
+                _mm_cmpgt_epi8(_mm_set1_epi8((hi)+1), (v)))
+__attribute__((target("sse2")))
+size_t enc_run_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  __m128i        v, m;
+  unsigned int   uMask;
+
+  /*--- Count them 16 bytes at a time ------------------------------*/
+  for (; pu8+16<=pu8End; pu8+=16) {
+    v = _mm_loadu_si128((const __m128i*)pu8);
+    m = _mm_or_si128(IN_RANGE128(v,'a','z'), IN_RANGE128(v,'A','Z'));
+    m = _mm_or_si128(m, IN_RANGE128(v,'0','9'));
+    m = _mm_or_si128(m, IN_RANGE128(v,'-','.'));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_' )));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('~' )));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    uMask = ~(unsigned int)_mm_movemask_epi8(m) & 0xFFFF;
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + enc_run_scalar(pu8, pu8End);
+}
+
+/*=== Count the leading characters not to be encoded (AVX2) ==========
+ * The same as enc_run_sse2() but 32 bytes at a time.               */
+#define IN_RANGE256(v,lo,hi) \
+  _mm256_and_si256(_mm256_cmpgt_epi8((v), _mm256_set1_epi8((lo)-1)), \
+                   _mm256_cmpgt_epi8(_mm256_set1_epi8((hi)+1), (v)))
+__attribute__((target("avx2")))
+size_t enc_run_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  __m256i        v, m;
+  unsigned int   uMask;
+
+  /*--- Count them 32 bytes at a time ------------------------------*/
+  for (; pu8+32<=pu8End; pu8+=32) {
+    v = _mm256_loadu_si256((const __m256i*)pu8);
+    m = _mm256_or_si256(IN_RANGE256(v,'a','z'), IN_RANGE256(v,'A','Z'));
+    m = _mm256_or_si256(m, IN_RANGE256(v,'0','9'));
+    m = _mm256_or_si256(m, IN_RANGE256(v,'-','.'));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_' )));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('~' )));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    uMask = ~(unsigned int)_mm256_movemask_epi8(m);
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + enc_run_scalar(pu8, pu8End);
+}
+
+/*=== Count the leading characters not to be decoded (SSE2) ==========
+ * The same as dec_run_scalar() but 16 bytes at a time.             */
+__attribute__((target("sse2")))
+size_t dec_run_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  __m128i        v;
+  unsigned int   uMask;
+
+  /*--- Count them 16 bytes at a time ------------------------------*/
+  for (; pu8+16<=pu8End; pu8+=16) {
+    v     = _mm_loadu_si128((const __m128i*)pu8);
+    uMask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+              _mm_cmpeq_epi8(v, _mm_set1_epi8('%')),
+              _mm_cmpeq_epi8(v, _mm_set1_epi8('+')) ));
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + dec_run_scalar(pu8, pu8End);
+}
+
+/*=== Count the leading characters not to be decoded (AVX2) ==========
+ * The same as dec_run_sse2() but 32 bytes at a time.               */
+__attribute__((target("avx2")))
+size_t dec_run_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  __m256i        v;
+  unsigned int   uMask;
+
+  /*--- Count them 32 bytes at a time ------------------------------*/
+  for (; pu8+32<=pu8End; pu8+=32) {
+    v     = _mm256_loadu_si256((const __m256i*)pu8);
+    uMask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+              _mm256_cmpeq_epi8(v, _mm256_set1_epi8('%')),
+              _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')) ));
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + dec_run_scalar(pu8, pu8End);
+}
+#endif
+
+/*=== Write all of the bytes to STDOUT ===============================
+ * [in] pv   : The bytes
+ *      uLen : The number of them                                   */
+void write_all(const void *pv, size_t uLen) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char *pc = pv;
+  ssize_t     iWritten;
+
+  /*--- Write them -------------------------------------------------*/
+  while (uLen > 0) {
+    iWritten = write(STDOUT_FILENO, pc, uLen);
+    if (iWritten < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write(): %s\n", strerror(errno));
+    }
+    pc   += iWritten;
+    uLen -= (size_t)iWritten;
+  }
+}
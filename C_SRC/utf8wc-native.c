@@ -0,0 +1,385 @@
+/*####################################################################
+#
+# UTF8WC-NATIVE - The Native Halfwidth Unit Ruler for "utf8wc"
+#
+# USAGE   : utf8wc-native [-l] [file ...]
+# Args    : file ...... Filepath to be measured ("-" means STDIN)
+# Options : -l ........ Print the length of every line instead of every
+#                       file
+# Retuen  : Return 0 only when all of the files were read successfully
+#
+# * This is the engine which the "utf8wc" command in the upper
+#   directory uses when it has been compiled. So, it prints exactly the
+#   same lengths as the POSIX version of "utf8wc" does, which means
+#   - every multibyte character is 2 halfwidth units long but the
+#     halfwidth katakana (U+FF60-U+FF9F, "\357\275\240"-"\357\276\237")
+#     are 1 unit long,
+#   - stray continuation bytes, <0xFE> and <0xFF> are 0 units long,
+#   - <0x08> (backspace) is -1 unit long,
+#   - the <0x0A>s between lines are 1 unit long but the one at the end
+#     of the file isn't counted, and
+#   - a zero-byte file is 0 units long.
+# * The ASCII runs are skipped 16 or 32 bytes at a time by SSE2 or AVX2
+#   if the CPU supports them.
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -DNOSIMD -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-19
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/misc-tools
+#
+####################################################################*/
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if !defined(NOSIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define HAVE_X86SIMD
+  #include <immintrin.h>
+#endif
+
+/*--- macros -------------------------------------------------------*/
+#define IBUF    65536 /* input buffer size                          */
+#define MAXSKIP 5     /* the max number of bytes following a lead   */
+
+/*--- prototype functions ------------------------------------------*/
+void   init_tables(void);
+int    measure_file(const char *pszFile);
+size_t measure(const uint8_t *pu8Beg, const uint8_t *pu8End, int iFinal);
+size_t plain_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End);
+#ifdef HAVE_X86SIMD
+  size_t plain_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+  size_t plain_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End);
+#endif
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname; /* The name of this command                    */
+int     giLines;     /* 1 when -l option is set                     */
+int64_t gi8Len;      /* the length of the current file (or line)    */
+int8_t  gai8Wid[256];/* the width of a character by the first byte  */
+uint8_t gau8Skip[256];/* the number of the bytes which follow it    */
+/* The function to count the leading plain ASCII bytes, which are
+ * 1 unit long and need nothing more (chosen on the CPU)            */
+size_t (*gpfPlain)(const uint8_t*, const uint8_t*) = plain_scalar;
+
+/*=== Define the functions for printing usage and error ============*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-l] [file ...]\n"
+    "Args    : file ...... Filepath to be measured (\"-\" means STDIN)\n"
+    "Options : -l ........ Print the length of every line instead of every\n"
+    "                      file\n"
+    "Retuen  : Return 0 only when all of the files were read successfully\n"
+    "Version : 2026-10-19 16:04:51 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/misc-tools\n"
+    ,gpszCmdname);
+  exit(1);
+}
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  return;
+}
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+int main(int argc, char *argv[]) {
+
+  /*=== Initial Setting ============================================*/
+  int iRet;
+  int i;
+
+  gpszCmdname = argv[0];
+  for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+    if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+  }
+  if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+    error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+  }
+
+  /*=== Parse options ==============================================*/
+  giLines = 0;
+  while ((i=getopt(argc, argv, "lh")) != -1) {
+    switch (i) {
+      case 'l': giLines = 1;
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+
+  /*=== Measure every file =========================================*/
+  init_tables();
+  iRet = 0;
+  if (argc == 0) {
+    iRet |= measure_file("-");
+  } else {
+    for (i=0; i<argc; i++) {iRet |= measure_file(argv[i]);}
+  }
+
+  /*=== Finish =====================================================*/
+  if (fflush(stdout) != 0) {
+    error_exit(errno,"fflush(): %s\n", strerror(errno));
+  }
+  return iRet;
+}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Make the tables and choose the ASCII skipper for the CPU =======*/
+void init_tables(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  int i;
+
+  /*--- Make the width table by the first byte ---------------------*/
+  for (i=0x00; i<0x80; i++) {gai8Wid[i]=1; gau8Skip[i]=0;}
+  for (i=0x80; i<0xC0; i++) {gai8Wid[i]=0; gau8Skip[i]=0;}
+  for (i=0xC0; i<0xE0; i++) {gai8Wid[i]=2; gau8Skip[i]=1;}
+  for (i=0xE0; i<0xF0; i++) {gai8Wid[i]=2; gau8Skip[i]=2;}
+  for (i=0xF0; i<0xF8; i++) {gai8Wid[i]=2; gau8Skip[i]=3;}
+  for (i=0xF8; i<0xFC; i++) {gai8Wid[i]=2; gau8Skip[i]=4;}
+  for (i=0xFC; i<0xFE; i++) {gai8Wid[i]=2; gau8Skip[i]=5;}
+  for (i=0xFE; i<0x100;i++) {gai8Wid[i]=0; gau8Skip[i]=0;}
+  gai8Wid['\b'] = -1;
+
+  /*--- Choose the ASCII skipper -----------------------------------*/
+#ifdef HAVE_X86SIMD
+  __builtin_cpu_init();
+  if      (__builtin_cpu_supports("avx2")) {gpfPlain = plain_avx2;}
+  else if (__builtin_cpu_supports("sse2")) {gpfPlain = plain_sse2;}
+#endif
+}
+
+/*=== Measure a file and print the length ============================
+ * [in] pszFile : Filepath to be measured ("-" means STDIN)
+ * [ret]        : 0 when successful, 1 when the file can't be read  */
+int measure_file(const char *pszFile) {
+
+  /*--- Variables --------------------------------------------------*/
+  static uint8_t au8Buf[IBUF];
+  int     iFd;
+  size_t  uHave;  /* bytes in au8Buf                                */
+  size_t  uDone;  /* bytes measured                                 */
+  ssize_t iRead;
+  int     iAny;   /* 1 when the file has one byte at least          */
+  uint8_t u8Last; /* the last byte of the file                      */
+
+  /*--- Open the file ----------------------------------------------*/
+  if (strcmp(pszFile,"-") == 0) {
+    iFd = STDIN_FILENO;
+  } else if ((iFd=open(pszFile,O_RDONLY)) < 0) {
+    warning("Cannot open the file: %s\n", pszFile);
+    return 1;
+  }
+
+  /*--- Measure it -------------------------------------------------*/
+  /* (A few bytes at the end of the buffer are left until the next
+   *  reading when they may be a part of a multibyte character)     */
+  gi8Len = 0;
+  uHave  = 0;
+  iAny   = 0;
+  u8Last = '\n';
+  while (1) {
+    iRead = read(iFd, au8Buf+uHave, IBUF-uHave);
+    if (iRead < 0) {
+      if (errno == EINTR) {continue;}
+      warning("Cannot open the file: %s\n", pszFile);
+      if (iFd != STDIN_FILENO) {close(iFd);}
+      return 1;
+    }
+    if (iRead == 0) {break;}
+    uHave += (size_t)iRead;
+    iAny   = 1;
+    u8Last = au8Buf[uHave-1];
+    uDone  = measure(au8Buf, au8Buf+uHave, 0);
+    memmove(au8Buf, au8Buf+uDone, uHave-uDone);
+    uHave -= uDone;
+  }
+  measure(au8Buf, au8Buf+uHave, 1);
+  if (iFd != STDIN_FILENO) {close(iFd);}
+
+  /*--- Print the length -------------------------------------------*/
+  if (giLines) {
+    if (u8Last != '\n') {printf("%lld\n", (long long)gi8Len);}
+  } else {
+    if (iAny && u8Last == '\n') {gi8Len--;}
+    printf("%lld\n", (long long)gi8Len);
+  }
+  return 0;
+}
+
+/*=== Measure bytes ==================================================
+ * It adds the length to gi8Len. In the per-line mode, it also prints
+ * and resets the length at every <0x0A>. In the per-file mode, every
+ * <0x0A> is counted as 1 unit, so the caller must uncount the one at
+ * the end of the file. The followers of a lead byte are never
+ * examined (but the kana ones), but they stop at the end of the line.
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ *      iFinal : 1 when no bytes follow them
+ * [ret]       : The number of the measured bytes. The rest ones (less
+ *               than MAXSKIP+1 bytes, only when iFinal is 0) must be
+ *               given again with the following bytes.            */
+size_t measure(const uint8_t *pu8Beg, const uint8_t *pu8End, int iFinal) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8;
+  const uint8_t *pu8Lim; /* the end of the safe range to look ahead */
+  int64_t        i8Len;
+  int            iSkip, j;
+
+  /*--- Measure them -----------------------------------------------*/
+  pu8Lim = (iFinal || pu8End-pu8Beg <= MAXSKIP) ? pu8End : pu8End-MAXSKIP;
+  if (! iFinal && pu8Lim == pu8End) {return 0;}
+  i8Len  = gi8Len;
+  for (pu8=pu8Beg; pu8<pu8Lim; ) {
+    /* Skip the plain ASCII run */
+    if (*pu8 < 0x80 && *pu8 != '\b' && (*pu8 != '\n' || ! giLines)) {
+      j       = (int)gpfPlain(pu8, pu8Lim);
+      i8Len  += j;
+      pu8    += j;
+      if (pu8 >= pu8Lim) {break;}
+    }
+    /* A <0x0A> in the per-line mode */
+    if (*pu8 == '\n') {
+      printf("%lld\n", (long long)i8Len);
+      i8Len = 0;
+      pu8++;
+      continue;
+    }
+    /* The other characters */
+    i8Len += gai8Wid[*pu8];
+    iSkip  = gau8Skip[*pu8];
+    if (iSkip > pu8End-pu8-1) {iSkip = (int)(pu8End-pu8-1);}
+    for (j=1; j<=iSkip; j++) {
+      if (pu8[j] == '\n') {iSkip = j-1; break;}
+    }
+    if (*pu8 == 0xEF && iSkip >= 2) {
+      if      (pu8[1]==0xBD) {if (pu8[2]>=0xA0 && pu8[2]< 0xC0) {i8Len--;}}
+      else if (pu8[1]==0xBE) {if (pu8[2]>=0x80 && pu8[2]< 0xA0) {i8Len--;}}
+    }
+    pu8 += iSkip+1;
+  }
+  gi8Len = i8Len;
+  return pu8 - pu8Beg;
+}
+
+/*=== Count the leading plain ASCII bytes (scalar version) ===========
+ * The plain ones are the bytes less than <0x80> but <0x08>, and also
+ * but <0x0A> in the per-line mode. (In the per-file mode, a <0x0A> is
+ * just 1 unit long because no multibyte character is in progress.)
+ * [in] pu8Beg : The beginning of the bytes
+ *      pu8End : The end of them
+ * [ret]       : The number of the leading plain bytes              */
+size_t plain_scalar(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8;
+
+  /*--- Count them -------------------------------------------------*/
+  for (pu8=pu8Beg; pu8<pu8End; pu8++) {
+    if (*pu8 >= 0x80 || *pu8 == '\b'     ) {break;}
+    if (*pu8 == '\n' && giLines          ) {break;}
+  }
+  return pu8 - pu8Beg;
+}
+
+#ifdef HAVE_X86SIMD
+/*=== Count the leading plain ASCII bytes (SSE2 version) =============
+ * The same as plain_scalar() but 16 bytes at a time.               */
+__attribute__((target("sse2")))
+size_t plain_sse2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  const __m128i  bs  = _mm_set1_epi8('\b');
+  const __m128i  nl  = _mm_set1_epi8('\n');
+  __m128i        v;
+  unsigned int   uMask;
+
+  /*--- Count them 16 bytes at a time ------------------------------*/
+  for (; pu8+16<=pu8End; pu8+=16) {
+    v     = _mm_loadu_si128((const __m128i*)pu8);
+    uMask = (unsigned int)_mm_movemask_epi8(v)
+          | (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bs));
+    if (giLines) {
+      uMask |= (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+    }
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + plain_scalar(pu8, pu8End);
+}
+
+/*=== Count the leading plain ASCII bytes (AVX2 version) =============
+ * The same as plain_sse2() but 32 bytes at a time.                 */
+__attribute__((target("avx2")))
+size_t plain_avx2(const uint8_t *pu8Beg, const uint8_t *pu8End) {
+
+  /*--- Variables --------------------------------------------------*/
+  const uint8_t *pu8 = pu8Beg;
+  const __m256i  bs  = _mm256_set1_epi8('\b');
+  const __m256i  nl  = _mm256_set1_epi8('\n');
+  __m256i        v;
+  unsigned int   uMask;
+
+  /*--- Count them 32 bytes at a time ------------------------------*/
+  for (; pu8+32<=pu8End; pu8+=32) {
+    v     = _mm256_loadu_si256((const __m256i*)pu8);
+    uMask = (unsigned int)_mm256_movemask_epi8(v)
+          | (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bs));
+    if (giLines) {
+      uMask |= (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+    }
+    if (uMask) {return pu8 - pu8Beg + __builtin_ctz(uMask);}
+  }
+  return pu8 - pu8Beg + plain_scalar(pu8, pu8End);
+}
+#endif